@@ -52,6 +52,7 @@ extern "C" {
 #include "ReactorFactory.h"
 #include "ReactorRunner.h"
 #include "Comm.h"
+#include "CommCompression.h"
 #include "IOHandlerAccept.h"
 #include "IOHandlerData.h"
 
@@ -223,6 +224,8 @@ Comm::listen(const CommAddress &addr, ConnectionHandlerFactoryPtr &chf,
 int
 Comm::send_request(const CommAddress &addr, uint32_t timeout_ms,
                    CommBufPtr &cbuf, DispatchHandler *resp_handler) {
+  CommCompression::compress(cbuf.get());
+
   ScopedLock lock(ms_mutex);
   IOHandlerDataPtr data_handler;
   int error;
@@ -265,6 +268,8 @@ int Comm::send_request(IOHandlerDataPtr &data_handler, uint32_t timeout_ms,
 
 
 int Comm::send_response(const CommAddress &addr, CommBufPtr &cbuf) {
+  CommCompression::compress(cbuf.get());
+
   ScopedLock lock(ms_mutex);
   IOHandlerDataPtr data_handler;
   int error;
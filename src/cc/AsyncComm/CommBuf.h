@@ -80,7 +80,8 @@ namespace Hypertable {
      * @param hdr comm header
      * @param len the length of the primary buffer to allocate
      */
-    CommBuf(CommHeader &hdr, uint32_t len=0) : header(hdr), ext_ptr(0) {
+    CommBuf(CommHeader &hdr, uint32_t len=0)
+      : header(hdr), ext_ptr(0), compression(0) {
       len += header.encoded_length();
       data.set(new uint8_t [len], len, true);
       data_ptr = data.base + header.encoded_length();
@@ -100,7 +101,7 @@ namespace Hypertable {
      * @param buffer extended buffer
      */
     CommBuf(CommHeader &hdr, uint32_t len, StaticBuffer &buffer)
-      : ext(buffer), header(hdr) {
+      : ext(buffer), header(hdr), compression(0) {
       len += header.encoded_length();
       data.set(new uint8_t [len], len, true);
       data_ptr = data.base + header.encoded_length();
@@ -124,7 +125,7 @@ namespace Hypertable {
      */
     CommBuf(CommHeader &hdr, uint32_t len,
 	    boost::shared_array<uint8_t> &ext_buffer, uint32_t ext_len) :
-      header(hdr), ext_shared_array(ext_buffer) {
+      header(hdr), ext_shared_array(ext_buffer), compression(0) {
       len += header.encoded_length();
       data.set(new uint8_t [len], len, true);
       data_ptr = data.base + header.encoded_length();
@@ -297,8 +298,18 @@ namespace Hypertable {
       Serialization::encode_inet_addr(&data_ptr, addr);
     }
 
+    /**
+     * Requests that the payload be compressed with the given codec when
+     * the message is sent (see CommCompression).  Whether it actually is
+     * depends on the payload size and on how well it compresses.
+     *
+     * @param codec compression codec id (0 for none)
+     */
+    void set_compression(uint8_t codec) { compression = codec; }
+
     friend class IOHandlerData;
     friend class IOHandlerDatagram;
+    friend class CommCompression;
 
     StaticBuffer data;
     StaticBuffer ext;
@@ -308,6 +319,7 @@ namespace Hypertable {
     uint8_t *data_ptr;
     const uint8_t *ext_ptr;
     boost::shared_array<uint8_t> ext_shared_array;
+    uint8_t compression;
   };
 
   typedef intrusive_ptr<CommBuf> CommBufPtr;
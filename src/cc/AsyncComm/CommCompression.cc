@@ -0,0 +1,143 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Mutex.h"
+
+#include "CommCompression.h"
+
+using namespace Hypertable;
+
+namespace {
+  Mutex registry_mutex;
+}
+
+CommCompression::Codec *CommCompression::ms_codecs[256];
+uint8_t CommCompression::ms_default_codec = CommCompression::NONE;
+size_t CommCompression::ms_threshold = 16 * 1024;
+uint32_t CommCompression::ms_max_ratio = 80;
+int CommCompression::ms_decompress_threads = 2;
+
+
+void CommCompression::register_codec(uint8_t id, Codec *codec) {
+  ScopedLock lock(registry_mutex);
+  HT_ASSERT(id != NONE);
+  if (ms_codecs[id])
+    delete codec;
+  else
+    ms_codecs[id] = codec;
+}
+
+
+bool CommCompression::compress(CommBuf *cbuf) {
+
+  // aligned payloads (e.g. for direct I/O) must go out as they are
+  if (cbuf->compression == NONE || cbuf->header.alignment ||
+      (cbuf->header.flags & CommHeader::FLAGS_BIT_COMPRESSED))
+    return false;
+
+  Codec *codec = ms_codecs[cbuf->compression];
+  if (codec == 0)
+    return false;
+
+  size_t header_len = cbuf->header.encoded_length();
+  size_t data_len = cbuf->data_ptr - (cbuf->data.base + header_len);
+  size_t payload_len = data_len + cbuf->ext.size;
+
+  if (payload_len < ms_threshold)
+    return false;
+
+  const uint8_t *input = cbuf->data.base + header_len;
+  DynamicBuffer gathered;
+
+  if (cbuf->ext.size) {
+    gathered.reserve(payload_len);
+    gathered.add_unchecked(input, data_len);
+    gathered.add_unchecked(cbuf->ext.base, cbuf->ext.size);
+    input = gathered.base;
+  }
+
+  DynamicBuffer output;
+
+  try {
+    codec->deflate(input, payload_len, output);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return false;
+  }
+
+  if ((uint64_t)(1 + output.fill()) * 100 >
+      (uint64_t)payload_len * ms_max_ratio)
+    return false;
+
+  size_t len = header_len + 1 + output.fill();
+  uint8_t *buf = new uint8_t [len];
+  uint8_t *ptr = buf + header_len;
+  *ptr++ = cbuf->compression;
+  memcpy(ptr, output.base, output.fill());
+
+  cbuf->data.set(buf, len, true);
+  cbuf->data_ptr = buf + len;
+  cbuf->ext.free();
+  cbuf->ext_shared_array.reset();
+  cbuf->ext_ptr = 0;
+  cbuf->header.flags |= CommHeader::FLAGS_BIT_COMPRESSED;
+  cbuf->header.set_total_length(len);
+  return true;
+}
+
+
+int CommCompression::decompress(CommHeader &header, uint8_t **payloadp) {
+  size_t len = header.total_len - header.header_len;
+
+  if (len == 0)
+    return Error::COMM_BAD_HEADER;
+
+  uint8_t id = **payloadp;
+  Codec *codec = ms_codecs[id];
+
+  if (codec == 0) {
+    HT_ERRORF("Received message payload compressed with unknown codec %d",
+              (int)id);
+    return Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE;
+  }
+
+  DynamicBuffer output;
+
+  try {
+    codec->inflate(*payloadp + 1, len - 1, output);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return e.code();
+  }
+
+  delete [] *payloadp;
+  *payloadp = output.base;
+  header.total_len = header.header_len + output.fill();
+  header.flags &= CommHeader::FLAGS_MASK_COMPRESSED;
+  output.base = output.ptr = output.mark = 0;
+  output.size = 0;
+  return Error::OK;
+}
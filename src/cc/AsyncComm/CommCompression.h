@@ -0,0 +1,126 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_COMMCOMPRESSION_H
+#define HYPERTABLE_COMMCOMPRESSION_H
+
+#include "Common/DynamicBuffer.h"
+
+#include "CommBuf.h"
+
+namespace Hypertable {
+
+  /**
+   * Optional compression of message payloads.  A sender asks for a
+   * message to be compressed with CommBuf::set_compression(); when the
+   * message is sent, the payload is compressed if it is at least
+   * <i>threshold</i> bytes long and the compressed form is no larger than
+   * <i>max_ratio</i> percent of the original.  A compressed message has
+   * CommHeader::FLAGS_BIT_COMPRESSED set and its payload starts with a one
+   * byte codec id, followed by the codec output.  The receiving end
+   * inflates the payload on a small pool of worker threads, off the
+   * reactor thread, before the event is delivered, so request and
+   * response handlers never see the compressed form.  A request that
+   * cannot be inflated is answered with an error response.
+   *
+   * AsyncComm itself has no codecs; they are supplied by the application
+   * with register_codec() (see CompressorFactory::register_comm_codecs).
+   * A peer that receives a message compressed with a codec it does not
+   * have fails the request, so servers must register their codecs before
+   * clients start asking for compression.
+   */
+  class CommCompression {
+  public:
+
+    enum { NONE = 0 };
+
+    class Codec {
+    public:
+      virtual ~Codec() { }
+
+      /** Compresses <code>len</code> bytes at <code>input</code> into
+       * <code>output</code>, which is cleared first.  Must be safe to call
+       * from multiple threads.  Throws an Exception on error.
+       */
+      virtual void deflate(const uint8_t *input, size_t len,
+                           DynamicBuffer &output) = 0;
+
+      /** Inverse of #deflate.  Throws an Exception on error. */
+      virtual void inflate(const uint8_t *input, size_t len,
+                           DynamicBuffer &output) = 0;
+    };
+
+    /** Makes a codec available under the given id and takes ownership
+     * of it.  Codecs stay registered for the life of the process; if the
+     * id is already taken, the new codec is deleted.
+     */
+    static void register_codec(uint8_t id, Codec *codec);
+
+    /** Sets the codec handed out by default_codec() */
+    static void set_default_codec(uint8_t id) { ms_default_codec = id; }
+    static uint8_t default_codec() { return ms_default_codec; }
+
+    /** Sets the minimum payload size, in bytes, worth compressing */
+    static void set_threshold(size_t bytes) { ms_threshold = bytes; }
+
+    /** Sets the largest compressed size, as a percentage of the original
+     * size, for which the compressed payload is sent.
+     */
+    static void set_max_ratio(uint32_t percent) { ms_max_ratio = percent; }
+
+    /** Sets the number of threads that inflate received messages.  Only
+     * takes effect if called before the first compressed message arrives.
+     */
+    static void set_decompress_threads(int count) {
+      ms_decompress_threads = count > 0 ? count : 1;
+    }
+    static int decompress_threads() { return ms_decompress_threads; }
+
+    /** Compresses the payload of a message that is about to be sent, if
+     * the message asked for compression and it pays off.  Must be called
+     * before CommBuf::write_header_and_reset.
+     *
+     * @param cbuf message buffer
+     * @return true if the payload was compressed
+     */
+    static bool compress(CommBuf *cbuf);
+
+    /** Inflates a received payload.  On success the payload buffer is
+     * replaced by the inflated one and the compressed flag and total
+     * length in the header are updated.
+     *
+     * @param header header of the received message
+     * @param payloadp address of the payload pointer (allocated with new[])
+     * @return Error::OK on success, otherwise an error code
+     */
+    static int decompress(CommHeader &header, uint8_t **payloadp);
+
+  private:
+    static Codec *ms_codecs[256];
+    static uint8_t ms_default_codec;
+    static size_t ms_threshold;
+    static uint32_t ms_max_ratio;
+    static int ms_decompress_threads;
+  };
+
+}
+
+#endif // HYPERTABLE_COMMCOMPRESSION_H
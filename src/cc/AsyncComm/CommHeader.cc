@@ -41,10 +41,12 @@ void CommHeader::encode(uint8_t **bufp) {
   Serialization::encode_i32(bufp, timeout_ms);
   Serialization::encode_i32(bufp, payload_checksum);
   Serialization::encode_i64(bufp, command);
-  // compute and serialize header checksum
+  // compute and serialize header checksum (fixed length portion only)
   header_checksum = fletcher32(base, (*bufp)-base);
   base += 6;
   Serialization::encode_i32(&base, header_checksum);
+  if (flags & FLAGS_BIT_TRACE)
+    Serialization::encode_i64(bufp, trace_id);
 }
 
 void CommHeader::decode(const uint8_t **bufp, size_t *remainp) {
@@ -70,4 +72,8 @@ void CommHeader::decode(const uint8_t **bufp, size_t *remainp) {
   if (checksum != header_checksum)
     HT_THROWF(Error::COMM_HEADER_CHECKSUM_MISMATCH, "%u != %u", checksum,
               header_checksum);
+  trace_id = 0;
+  if ((flags & FLAGS_BIT_TRACE) && header_len >= FIXED_LENGTH + TRACE_LENGTH
+      && *remainp >= TRACE_LENGTH)
+    trace_id = Serialization::decode_i64(bufp, remainp);
 }
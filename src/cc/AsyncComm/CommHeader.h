@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_COMMHEADER_H
 #define HYPERTABLE_COMMHEADER_H
 
+#include "Common/Trace.h"
+
 namespace Hypertable {
 
   class CommHeader {
@@ -32,38 +34,64 @@ namespace Hypertable {
 
     static const size_t FIXED_LENGTH = 38;
 
+    static const size_t TRACE_LENGTH = 8;
+
     static const uint16_t FLAGS_BIT_REQUEST          = 0x0001;
     static const uint16_t FLAGS_BIT_IGNORE_RESPONSE  = 0x0002;
     static const uint16_t FLAGS_BIT_URGENT           = 0x0004;
+    static const uint16_t FLAGS_BIT_TRACE            = 0x0008;
+    static const uint16_t FLAGS_BIT_COMPRESSED       = 0x0010;
     static const uint16_t FLAGS_BIT_PROXY_MAP_UPDATE = 0x4000;
     static const uint16_t FLAGS_BIT_PAYLOAD_CHECKSUM = 0x8000;
 
     static const uint16_t FLAGS_MASK_REQUEST          = 0xFFFE;
     static const uint16_t FLAGS_MASK_IGNORE_RESPONSE  = 0xFFFD;
     static const uint16_t FLAGS_MASK_URGENT           = 0xFFFB;
+    static const uint16_t FLAGS_MASK_TRACE            = 0xFFF7;
+    static const uint16_t FLAGS_MASK_COMPRESSED       = 0xFFEF;
     static const uint16_t FLAGS_MASK_PROXY_MAP_UPDATE = 0xBFFF;
     static const uint16_t FLAGS_MASK_PAYLOAD_CHECKSUM = 0x7FFF;
 
     CommHeader()
       : version(1), header_len(FIXED_LENGTH), alignment(0), flags(0),
         header_checksum(0), id(0), gid(0), total_len(0),
-        timeout_ms(0), payload_checksum(0), command(0) {  }
+        timeout_ms(0), payload_checksum(0), command(0), trace_id(0) {  }
 
     CommHeader(uint64_t cmd, uint32_t timeout=0)
       : version(1), header_len(FIXED_LENGTH), alignment(0), flags(0),
         header_checksum(0), id(0), gid(0), total_len(0),
         timeout_ms(timeout), payload_checksum(0),
-        command(cmd) {  }
+        command(cmd), trace_id(0) {
+      if (Trace::enabled())
+        set_trace_id(Trace::current());
+    }
 
     size_t fixed_length() const { return FIXED_LENGTH; }
-    size_t encoded_length() const { return FIXED_LENGTH; }
+    size_t encoded_length() const { return header_len; }
     void encode(uint8_t **bufp);
     void decode(const uint8_t **bufp, size_t *remainp);
 
     void set_total_length(uint32_t len) { total_len = len; }
 
+    /** Attaches a trace id to the message (see Trace).  Requests pick up
+     * the trace id of the sending thread automatically.  The id is sent as
+     * an optional extension after the fixed length header, so untraced
+     * messages are unchanged on the wire.
+     */
+    void set_trace_id(uint64_t id) {
+      trace_id = id;
+      if (trace_id) {
+        flags |= FLAGS_BIT_TRACE;
+        header_len = FIXED_LENGTH + TRACE_LENGTH;
+      }
+      else {
+        flags &= FLAGS_MASK_TRACE;
+        header_len = FIXED_LENGTH;
+      }
+    }
+
     void initialize_from_request_header(CommHeader &req_header) {
-      flags = req_header.flags;
+      flags = req_header.flags & FLAGS_MASK_TRACE & FLAGS_MASK_COMPRESSED;
       id = req_header.id;
       gid = req_header.gid;
       command = req_header.command;
@@ -81,6 +109,7 @@ namespace Hypertable {
     uint32_t timeout_ms;
     uint32_t payload_checksum;
     uint64_t command;
+    uint64_t trace_id;
   };
 
 }
@@ -52,7 +52,8 @@ namespace Hypertable {
      */
     Event(Type ct, const sockaddr_in &a, int err = 0)
       : type(ct), addr(a), proxy_buf(0), error(err), payload(0), payload_len(0),
-        thread_group(0), arrival_clocks(0), arrival_time(0) {
+        thread_group(0), arrival_clocks(0), arrival_time(0),
+        arrival_hrtime(0) {
       proxy = 0;
     }
 
@@ -65,7 +66,8 @@ namespace Hypertable {
      */
     Event(Type ct, const sockaddr_in &a, const String &p, int err = 0)
       : type(ct), addr(a), proxy_buf(0), error(err), payload(0), payload_len(0),
-        thread_group(0), arrival_clocks(0), arrival_time(0) {
+        thread_group(0), arrival_clocks(0), arrival_time(0),
+        arrival_hrtime(0) {
       set_proxy(p);
     }
 
@@ -75,7 +77,8 @@ namespace Hypertable {
      * @param err error code associated with this event
      */
     Event(Type ct, int err=0) : type(ct), proxy_buf(0), error(err), payload(0),
-        payload_len(0), thread_group(0), arrival_clocks(0), arrival_time(0) {
+        payload_len(0), thread_group(0), arrival_clocks(0), arrival_time(0),
+        arrival_hrtime(0) {
       proxy = 0;
     }
 
@@ -86,7 +89,7 @@ namespace Hypertable {
      */
     Event(Type ct, const String &p, int err=0) : type(ct), proxy_buf(0),
           error(err), payload(0), payload_len(0), thread_group(0),
-	  arrival_clocks(0), arrival_time(0) {
+	  arrival_clocks(0), arrival_time(0), arrival_hrtime(0) {
       set_proxy(p);
     }
 
@@ -186,6 +189,9 @@ namespace Hypertable {
     /** time (seconds since epoch) when message arrived **/
     time_t arrival_time;
 
+    /** time (nanoseconds since epoch) when message header was read **/
+    int64_t arrival_hrtime;
+
     /** Generates a one-line string representation of the event.  For example:
      * <pre>
      *   Event: type=MESSAGE id=2 gid=0 header_len=16 total_len=20 \
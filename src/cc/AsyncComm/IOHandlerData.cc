@@ -41,7 +41,10 @@ extern "C" {
 #include "Common/InetAddr.h"
 #include "Common/Time.h"
 
+#include "ApplicationQueue.h"
+#include "CommCompression.h"
 #include "IOHandlerData.h"
+#include "Protocol.h"
 #include "ReactorRunner.h"
 
 using namespace Hypertable;
@@ -50,6 +53,21 @@ using namespace std;
 
 namespace {
 
+  Mutex decompress_queue_mutex;
+  ApplicationQueue *decompress_queue = 0;
+
+  /**
+   * Returns the pool that inflates compressed messages, creating it on
+   * first use.  It is shared by all connections and lives until exit.
+   */
+  ApplicationQueue *get_decompress_queue() {
+    ScopedLock lock(decompress_queue_mutex);
+    if (decompress_queue == 0)
+      decompress_queue =
+          new ApplicationQueue(CommCompression::decompress_threads());
+    return decompress_queue;
+  }
+
   /**
    * Used to read data off a socket that is monotored with edge-triggered epoll.
    * When this function returns with *errnop set to EAGAIN, it is safe to call
@@ -552,6 +570,7 @@ void IOHandlerData::handle_message_header(clock_t arrival_clocks, time_t arrival
   m_event->load_header(m_sd, m_message_header, header_len);
   m_event->arrival_clocks = arrival_clocks;
   m_event->arrival_time = arrival_time;
+  m_event->arrival_hrtime = get_ts64();
 
 #if defined(__linux__)
   if (m_event->header.alignment > 0) {
@@ -598,16 +617,105 @@ void IOHandlerData::handle_message_body() {
                            - m_event->header.header_len;
     m_event->set_proxy(m_proxy);
     //HT_INFOF("Just received messaage of size %d", m_event->header.total_len);
-    deliver_event( m_event, dh );
+    if (m_event->header.flags & CommHeader::FLAGS_BIT_COMPRESSED)
+      queue_for_decompression(m_event, dh);
+    else
+      deliver_in_order(m_event, dh);
   }
 
   reset_incoming_message_state();
 }
 
 
+class IOHandlerData::DecompressHandler : public ApplicationHandler {
+public:
+  DecompressHandler(IOHandlerData *handler, PendingEvent *pending)
+    : m_handler(handler), m_pending(pending) { }
+
+  virtual void run() { m_handler->decompress_pending(m_pending); }
+
+private:
+  IOHandlerDataPtr m_handler;
+  PendingEvent *m_pending;
+};
+
+
+void IOHandlerData::queue_for_decompression(Event *event,
+                                            DispatchHandler *dh) {
+  PendingEvent *pending = new PendingEvent(event, dh, false);
+  {
+    ScopedLock lock(m_delivery_mutex);
+    m_pending_events.push_back(pending);
+  }
+  get_decompress_queue()->add(new DecompressHandler(this, pending));
+}
+
+
+void IOHandlerData::decompress_pending(PendingEvent *pending) {
+  Event *event = pending->event;
+  uint8_t *payload = (uint8_t *)event->payload;
+  int error = CommCompression::decompress(event->header, &payload);
+
+  event->payload = payload;
+  if (error == Error::OK)
+    event->payload_len = event->header.total_len - event->header.header_len;
+  else {
+    HT_ERRORF("Unable to decompress message from %s:%d (id=%d) - %s",
+              inet_ntoa(m_addr.sin_addr), ntohs(m_addr.sin_port),
+              (int)event->header.id, Error::get_text(error));
+    if (event->header.flags & CommHeader::FLAGS_BIT_REQUEST) {
+      // the request never reaches the application, answer it here
+      CommHeader header;
+      header.initialize_from_request_header(event->header);
+      CommBufPtr cbp(Protocol::create_error_message(header, error,
+                     "Unable to decompress request"));
+      send_message(cbp);
+      delete event;
+      pending->event = 0;
+    }
+    else {
+      delete [] event->payload;
+      event->payload = 0;
+      event->payload_len = 0;
+      event->type = Event::ERROR;
+      event->error = error;
+    }
+  }
+
+  // deliver whatever is ready at the head of the queue, in arrival order
+  ScopedLock lock(m_delivery_mutex);
+  pending->ready = true;
+  if (m_delivering)
+    return;
+  m_delivering = true;
+  while (!m_pending_events.empty() && m_pending_events.front()->ready) {
+    PendingEvent *front = m_pending_events.front();
+    m_pending_events.pop_front();
+    lock.unlock();
+    if (front->event)
+      deliver_event(front->event, front->dh);
+    delete front;
+    lock.lock();
+  }
+  m_delivering = false;
+}
+
+
+void IOHandlerData::deliver_in_order(Event *event, DispatchHandler *dh) {
+  {
+    ScopedLock lock(m_delivery_mutex);
+    if (m_delivering || !m_pending_events.empty()) {
+      m_pending_events.push_back(new PendingEvent(event, dh, true));
+      return;
+    }
+  }
+  deliver_event(event, dh);
+}
+
+
 void IOHandlerData::handle_disconnect(int error) {
   m_reactor_ptr->cancel_requests(this);
-  deliver_event(new Event(Event::DISCONNECT, m_addr, m_proxy, error));
+  deliver_in_order(new Event(Event::DISCONNECT, m_addr, m_proxy, error), 0);
 }
 
 
@@ -22,6 +22,7 @@
 #ifndef HYPERTABLE_IOHANDLERDATA_H
 #define HYPERTABLE_IOHANDLERDATA_H
 
+#include <deque>
 #include <list>
 
 extern "C" {
@@ -45,7 +46,7 @@ namespace Hypertable {
   public:
 
     IOHandlerData(int sd, const InetAddr &addr, DispatchHandlerPtr &dhp, bool connected=false)
-      : IOHandler(sd, addr, dhp), m_send_queue() {
+      : IOHandler(sd, addr, dhp), m_send_queue(), m_delivering(false) {
       m_connected = connected;
       reset_incoming_message_state();
     }
@@ -85,9 +86,27 @@ namespace Hypertable {
     bool handle_write_readiness();
 
   private:
+    class DecompressHandler;
+
+    /** A received event waiting to be delivered.  Compressed messages are
+     * inflated by a pool of worker threads, so that the reactor thread
+     * does not spend its time in a codec; events are still delivered in
+     * the order they arrived on the connection.
+     */
+    struct PendingEvent {
+      PendingEvent(Event *e, DispatchHandler *h, bool r)
+        : event(e), dh(h), ready(r) { }
+      Event *event;
+      DispatchHandler *dh;
+      bool ready;
+    };
+
     void handle_message_header(clock_t arrival_clocks, time_t arrival_time);
     void handle_message_body();
     void handle_disconnect(int error = Error::OK);
+    void queue_for_decompression(Event *event, DispatchHandler *dh);
+    void decompress_pending(PendingEvent *pending);
+    void deliver_in_order(Event *event, DispatchHandler *dh);
 
     bool                m_connected;
     Mutex               m_mutex;
@@ -100,6 +119,9 @@ namespace Hypertable {
     uint8_t            *m_message_ptr;
     size_t              m_message_remaining;
     std::list<CommBufPtr> m_send_queue;
+    Mutex               m_delivery_mutex;
+    std::deque<PendingEvent *> m_pending_events;
+    bool                m_delivering;
   };
 
   typedef intrusive_ptr<IOHandlerData> IOHandlerDataPtr;
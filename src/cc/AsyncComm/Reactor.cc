@@ -158,11 +158,20 @@ Reactor::Reactor() : m_mutex(), m_interrupt_in_progress(false) {
 }
 
 
+Reactor::~Reactor() {
+  std::vector<TimerWheel::Entry *> timers;
+  poll_loop_interrupt();
+  m_timer_wheel.clear(timers);
+  for (size_t i=0; i<timers.size(); i++)
+    delete static_cast<TimerNode *>(timers[i]);
+}
+
+
 void Reactor::handle_timeouts(PollTimeout &next_timeout) {
-  vector<ExpireTimer> expired_timers;
+  vector<TimerWheel::Entry *> expired;
+  vector<DispatchHandlerPtr> expired_timers;
   EventPtr event_ptr;
-  boost::xtime     now, next_req_timeout;
-  ExpireTimer timer;
+  boost::xtime     now, next_req_timeout, next_timer;
 
   while(true) {
     {
@@ -187,23 +196,21 @@ void Reactor::handle_timeouts(PollTimeout &next_timeout) {
         memset(&m_next_wakeup, 0, sizeof(m_next_wakeup));
       }
 
-      if (!m_timer_heap.empty()) {
-        ExpireTimer timer;
-
-        while (!m_timer_heap.empty()) {
-          timer = m_timer_heap.top();
-          if (xtime_cmp(timer.expire_time, now) > 0) {
-            if (next_req_timeout.sec == 0
-                || xtime_cmp(timer.expire_time, next_req_timeout) < 0) {
-              next_timeout.set(now, timer.expire_time);
-              memcpy(&m_next_wakeup, &timer.expire_time, sizeof(m_next_wakeup));
-            }
-            break;
-          }
-          expired_timers.push_back(timer);
-          m_timer_heap.pop();
-        }
+      // expire timers a tick at a time
+      expired.clear();
+      expired_timers.clear();
+      m_timer_wheel.advance(now, expired);
+      for (size_t i=0; i<expired.size(); i++) {
+        TimerNode *node = static_cast<TimerNode *>(expired[i]);
+        expired_timers.push_back(node->handler);
+        delete node;
+      }
 
+      if (m_timer_wheel.next_expiration(&next_timer) &&
+          (next_req_timeout.sec == 0 ||
+           xtime_cmp(next_timer, next_req_timeout) < 0)) {
+        next_timeout.set(now, next_timer);
+        memcpy(&m_next_wakeup, &next_timer, sizeof(m_next_wakeup));
       }
     }
 
@@ -212,23 +219,23 @@ void Reactor::handle_timeouts(PollTimeout &next_timeout) {
      */
     for (size_t i=0; i<expired_timers.size(); i++) {
       event_ptr = new Event(Event::TIMER, Error::OK);
-      if (expired_timers[i].handler)
-        expired_timers[i].handler->handle(event_ptr);
+      if (expired_timers[i])
+        expired_timers[i]->handle(event_ptr);
     }
 
     {
       ScopedLock lock(m_mutex);
 
-      if (!m_timer_heap.empty()) {
-        timer = m_timer_heap.top();
+      // timers that were added, and have expired, while delivering
+      if (m_timer_wheel.next_expiration(&next_timer)) {
 
-        if (xtime_cmp(now, timer.expire_time) > 0)
+        if (xtime_cmp(now, next_timer) >= 0)
           continue;
 
         if (next_req_timeout.sec == 0
-            || xtime_cmp(timer.expire_time, next_req_timeout) < 0) {
-          next_timeout.set(now, timer.expire_time);
-          memcpy(&m_next_wakeup, &timer.expire_time, sizeof(m_next_wakeup));
+            || xtime_cmp(next_timer, next_req_timeout) < 0) {
+          next_timeout.set(now, next_timer);
+          memcpy(&m_next_wakeup, &next_timer, sizeof(m_next_wakeup));
         }
       }
 
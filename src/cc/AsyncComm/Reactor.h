@@ -22,7 +22,6 @@
 #ifndef HYPERTABLE_REACTOR_H
 #define HYPERTABLE_REACTOR_H
 
-#include <queue>
 #include <set>
 #include <vector>
 
@@ -38,6 +37,7 @@ extern "C" {
 #include "PollTimeout.h"
 #include "RequestCache.h"
 #include "ExpireTimer.h"
+#include "TimerWheel.h"
 
 namespace Hypertable {
 
@@ -56,9 +56,7 @@ namespace Hypertable {
     static const int WRITE_READY;
 
     Reactor();
-    ~Reactor() {
-      poll_loop_interrupt();
-    }
+    ~Reactor();
 
     void operator()();
 
@@ -82,8 +80,12 @@ namespace Hypertable {
 
     void add_timer(ExpireTimer &timer) {
       ScopedLock lock(m_mutex);
-      m_timer_heap.push(timer);
-      poll_loop_interrupt();
+      TimerNode *node = new TimerNode;
+      node->handler = timer.handler;
+      m_timer_wheel.insert(node, timer.expire_time);
+      if (m_next_wakeup.sec == 0 ||
+          xtime_cmp(timer.expire_time, m_next_wakeup) < 0)
+        poll_loop_interrupt();
     }
 
     void schedule_removal(IOHandler *handler) {
@@ -120,12 +122,13 @@ namespace Hypertable {
     int interrupt_sd() { return m_interrupt_sd; }
 
   protected:
-    typedef std::priority_queue<ExpireTimer, std::vector<ExpireTimer>, LtTimer>
-            TimerHeap;
+    struct TimerNode : public TimerWheel::Entry {
+      DispatchHandlerPtr handler;
+    };
 
     Mutex           m_mutex;
     RequestCache    m_request_cache;
-    TimerHeap       m_timer_heap;
+    TimerWheel      m_timer_wheel;
     int             m_interrupt_sd;
     bool            m_interrupt_in_progress;
     boost::xtime    m_next_wakeup;
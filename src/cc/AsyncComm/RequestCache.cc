@@ -33,6 +33,13 @@
 using namespace Hypertable;
 using namespace std;
 
+RequestCache::~RequestCache() {
+  for (IdHandlerMap::iterator iter = m_id_map.begin();
+       iter != m_id_map.end(); ++iter)
+    delete (*iter).second;
+}
+
+
 void
 RequestCache::insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
                      boost::xtime &expire) {
@@ -47,18 +54,8 @@ RequestCache::insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
   node->id = id;
   node->handler = handler;
   node->dh = dh;
-  memcpy(&node->expire, &expire, sizeof(expire));
 
-  if (m_head == 0) {
-    node->next = node->prev = 0;
-    m_head = m_tail = node;
-  }
-  else {
-    node->next = m_tail;
-    node->next->prev = node;
-    node->prev = 0;
-    m_tail = node;
-  }
+  m_wheel.insert(node, expire);
 
   m_id_map[id] = node;
 }
@@ -77,15 +74,7 @@ DispatchHandler *RequestCache::remove(uint32_t id) {
 
   CacheNode *node = (*iter).second;
 
-  if (node->prev == 0)
-    m_tail = node->next;
-  else
-    node->prev->next = node->next;
-
-  if (node->next == 0)
-    m_head = node->prev;
-  else
-    node->next->prev = node->prev;
+  m_wheel.remove(node);
 
   m_id_map.erase(iter);
 
@@ -96,23 +85,26 @@ DispatchHandler *RequestCache::remove(uint32_t id) {
 
 
 
+/**
+ * Expired requests are taken from the wheel one tick batch at a time and
+ * handed out one per call.  The caller keeps calling (under the same lock)
+ * until 0 is returned, so the batch is always drained before any other
+ * method is called.
+ */
 DispatchHandler *
 RequestCache::get_next_timeout(boost::xtime &now, IOHandler *&handlerp,
                                boost::xtime *next_timeout) {
 
-  while (m_head && xtime_cmp(m_head->expire, now) <= 0) {
+  if (m_next_expired == m_expired.size()) {
+    m_expired.clear();
+    m_next_expired = 0;
+    m_wheel.advance(now, m_expired);
+  }
 
-    IdHandlerMap::iterator iter = m_id_map.find(m_head->id);
-    assert (iter != m_id_map.end());
-    CacheNode *node = m_head;
-    if (m_head->prev) {
-      m_head = m_head->prev;
-      m_head->next = 0;
-    }
-    else
-      m_head = m_tail = 0;
+  while (m_next_expired < m_expired.size()) {
+    CacheNode *node = static_cast<CacheNode *>(m_expired[m_next_expired++]);
 
-    m_id_map.erase(iter);
+    m_id_map.erase(node->id);
 
     if (node->handler != 0) {
       handlerp = node->handler;
@@ -123,9 +115,7 @@ RequestCache::get_next_timeout(boost::xtime &now, IOHandler *&handlerp,
     delete node;
   }
 
-  if (m_head)
-    memcpy(next_timeout, &m_head->expire, sizeof(boost::xtime));
-  else
+  if (!m_wheel.next_expiration(next_timeout))
     memset(next_timeout, 0, sizeof(boost::xtime));
 
   return 0;
@@ -134,7 +124,9 @@ RequestCache::get_next_timeout(boost::xtime &now, IOHandler *&handlerp,
 
 
 void RequestCache::purge_requests(IOHandler *handler, int32_t error) {
-  for (CacheNode *node = m_tail; node != 0; node = node->next) {
+  for (IdHandlerMap::iterator iter = m_id_map.begin();
+       iter != m_id_map.end(); ++iter) {
+    CacheNode *node = (*iter).second;
     if (node->handler == handler) {
       HT_DEBUGF("Purging request id %d", node->id);
       handler->deliver_event(new Event(Event::ERROR, ((IOHandlerData *)handler)->get_address(),
@@ -143,4 +135,3 @@ void RequestCache::purge_requests(IOHandler *handler, int32_t error) {
     }
   }
 }
-
@@ -23,21 +23,27 @@
 #ifndef HYPERTABLE_REQUESTCACHE_H
 #define HYPERTABLE_REQUESTCACHE_H
 
+#include <vector>
+
 #include <boost/thread/xtime.hpp>
 
 #include "Common/HashMap.h"
 
 #include "DispatchHandler.h"
+#include "TimerWheel.h"
 
 namespace Hypertable {
 
   class IOHandler;
 
+  /**
+   * Outstanding requests, indexed by id and by expiration time.  Request
+   * timeouts are kept in a TimerWheel, so insert and remove are O(1)
+   * regardless of the number of outstanding requests.
+   */
   class RequestCache {
 
-    struct CacheNode {
-      struct CacheNode  *prev, *next;
-      boost::xtime       expire;
+    struct CacheNode : public TimerWheel::Entry {
       uint32_t           id;
       IOHandler         *handler;
       DispatchHandler   *dh;
@@ -47,7 +53,9 @@ namespace Hypertable {
 
   public:
 
-    RequestCache() : m_id_map(), m_head(0), m_tail(0) { return; }
+    RequestCache() : m_id_map(), m_next_expired(0) { return; }
+
+    ~RequestCache();
 
     void insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
                 boost::xtime &expire);
@@ -59,9 +67,13 @@ namespace Hypertable {
 
     void purge_requests(IOHandler *handler, int32_t error);
 
+    size_t size() const { return m_id_map.size(); }
+
   private:
     IdHandlerMap  m_id_map;
-    CacheNode    *m_head, *m_tail;
+    TimerWheel    m_wheel;
+    std::vector<TimerWheel::Entry *> m_expired;
+    size_t        m_next_expired;
   };
 }
 
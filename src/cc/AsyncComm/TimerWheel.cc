@@ -0,0 +1,258 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+
+#include "Common/Logger.h"
+
+#include "TimerWheel.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  void list_init(TimerWheel::Entry *head) {
+    head->prev = head->next = head;
+  }
+
+  void list_append(TimerWheel::Entry *head, TimerWheel::Entry *entry) {
+    entry->next = head;
+    entry->prev = head->prev;
+    head->prev->next = entry;
+    head->prev = entry;
+  }
+
+  void list_unlink(TimerWheel::Entry *entry) {
+    entry->prev->next = entry->next;
+    entry->next->prev = entry->prev;
+    entry->prev = entry->next = 0;
+  }
+
+  struct LtTick {
+    bool operator()(const TimerWheel::Entry *e1,
+                    const TimerWheel::Entry *e2) const {
+      return e1->tick < e2->tick;
+    }
+  };
+
+}
+
+
+TimerWheel::TimerWheel(uint32_t resolution_millis)
+  : m_resolution_nanos((uint64_t)(resolution_millis ? resolution_millis : 1)
+                       * 1000000LL), m_count(0) {
+  boost::xtime now;
+  boost::xtime_get(&now, boost::TIME_UTC);
+  m_current = to_tick(now, false);
+  for (int level=0; level<LEVELS; level++) {
+    m_slots[level].resize(level_slots(level));
+    for (size_t i=0; i<m_slots[level].size(); i++)
+      list_init(&m_slots[level][i]);
+  }
+  list_init(&m_overdue);
+  memset(m_level_count, 0, sizeof(m_level_count));
+}
+
+
+uint64_t TimerWheel::to_tick(const boost::xtime &xt, bool round_up) const {
+  // nsec is not necessarily normalized
+  uint64_t nanos = (uint64_t)xt.sec * 1000000000LL + (int64_t)xt.nsec;
+  return (nanos + (round_up ? m_resolution_nanos - 1 : 0)) / m_resolution_nanos;
+}
+
+
+void TimerWheel::to_xtime(uint64_t tick, boost::xtime *xtp) const {
+  uint64_t nanos = tick * m_resolution_nanos;
+  xtp->sec = nanos / 1000000000LL;
+  xtp->nsec = nanos % 1000000000LL;
+}
+
+
+void TimerWheel::insert(Entry *entry, const boost::xtime &expire) {
+  HT_ASSERT(entry->prev == 0);
+  if (m_count == 0) {
+    // nothing to cascade, so catch up with the clock
+    boost::xtime now;
+    boost::xtime_get(&now, boost::TIME_UTC);
+    m_current = std::max(m_current, to_tick(now, false));
+  }
+  entry->tick = to_tick(expire, true);
+  place(entry);
+  m_count++;
+}
+
+
+void TimerWheel::place(Entry *entry) {
+  uint64_t tick = entry->tick;
+  size_t index = 0;
+
+  if (tick <= m_current)
+    entry->level = OVERDUE;
+  else {
+    uint64_t delta = tick - m_current;
+    uint64_t horizon = (uint64_t)1 << level_shift(LEVELS);
+    // entries beyond the last level wait in its farthest slot and are
+    // re-placed when that slot cascades
+    if (delta >= horizon)
+      tick = m_current + horizon - 1;
+    for (entry->level = 0; entry->level < LEVELS - 1; entry->level++) {
+      if (delta < ((uint64_t)1 << level_shift(entry->level + 1)))
+        break;
+    }
+    index = (tick >> level_shift(entry->level)) &
+      (level_slots(entry->level) - 1);
+  }
+  list_append(slot(entry->level, index), entry);
+  m_level_count[entry->level]++;
+}
+
+
+void TimerWheel::remove(Entry *entry) {
+  HT_ASSERT(entry->prev != 0);
+  m_level_count[entry->level]--;
+  list_unlink(entry);
+  m_count--;
+}
+
+
+void TimerWheel::cascade(int level) {
+  size_t index = (m_current >> level_shift(level)) & (level_slots(level) - 1);
+  Entry *head = slot(level, index);
+  Entry *entry;
+
+  while ((entry = head->next) != head) {
+    m_level_count[level]--;
+    list_unlink(entry);
+    place(entry);
+  }
+}
+
+
+void TimerWheel::advance(const boost::xtime &now,
+                         std::vector<Entry *> &expired) {
+  uint64_t now_tick = to_tick(now, false);
+  size_t start = expired.size();
+  Entry *head, *entry;
+
+  while ((entry = m_overdue.next) != &m_overdue) {
+    remove(entry);
+    expired.push_back(entry);
+  }
+
+  while (m_current < now_tick) {
+
+    if (m_count == 0) {
+      m_current = now_tick;
+      break;
+    }
+
+    // skip ahead over ticks for which the finer levels are empty
+    uint64_t mask = 0;
+    for (int level=0; level<LEVELS-1 && m_level_count[level]==0; level++)
+      mask = ((uint64_t)1 << level_shift(level + 1)) - 1;
+    if ((m_current | mask) > m_current) {
+      m_current = std::min(m_current | mask, now_tick);
+      if (m_current == now_tick)
+        break;
+    }
+
+    m_current++;
+
+    for (int level=1; level<LEVELS; level++) {
+      if ((m_current & (((uint64_t)1 << level_shift(level)) - 1)) != 0)
+        break;
+      cascade(level);
+    }
+
+    head = slot(0, m_current & (ROOT_SLOTS - 1));
+    while ((entry = head->next) != head) {
+      remove(entry);
+      expired.push_back(entry);
+    }
+    // entries cascaded straight into the overdue list
+    while ((entry = m_overdue.next) != &m_overdue) {
+      remove(entry);
+      expired.push_back(entry);
+    }
+  }
+
+  std::stable_sort(expired.begin() + start, expired.end(), LtTick());
+}
+
+
+void TimerWheel::clear(std::vector<Entry *> &removed) {
+  Entry *head, *entry;
+  for (int level=0; level<=LEVELS; level++) {
+    for (size_t i=0; i<(level == OVERDUE ? 1 : level_slots(level)); i++) {
+      head = slot(level, i);
+      while ((entry = head->next) != head) {
+        remove(entry);
+        removed.push_back(entry);
+      }
+    }
+  }
+}
+
+
+bool TimerWheel::next_expiration(boost::xtime *nextp) {
+
+  if (m_count == 0)
+    return false;
+
+  if (m_level_count[OVERDUE]) {
+    to_xtime(m_current, nextp);
+    return true;
+  }
+
+  // A coarser level may cascade before the first pending slot of a finer
+  // one expires (entries inserted after the clock moved), so every level
+  // contributes a candidate
+  uint64_t next_tick = 0;
+  for (int level=0; level<LEVELS; level++) {
+    if (m_level_count[level] == 0)
+      continue;
+    int shift = level_shift(level);
+    size_t slots = level_slots(level);
+    uint64_t base = m_current >> shift;
+    for (size_t i=1; i<=slots; i++) {
+      size_t index = (base + i) & (slots - 1);
+      Entry *head = slot(level, index);
+      if (head->next != head) {
+        // the slot is expired (level 0) or cascaded (coarser levels) when
+        // the clock reaches the first tick it covers
+        uint64_t tick = (base + i) << shift;
+        if (next_tick == 0 || tick < next_tick)
+          next_tick = tick;
+        break;
+      }
+    }
+  }
+
+  if (next_tick == 0) {
+    HT_ASSERT(!"timer wheel count inconsistent");
+    return false;
+  }
+
+  to_xtime(next_tick, nextp);
+  return true;
+}
@@ -0,0 +1,124 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_TIMERWHEEL_H
+#define HYPERTABLE_TIMERWHEEL_H
+
+#include <vector>
+
+#include <boost/thread/xtime.hpp>
+
+extern "C" {
+#include <stdint.h>
+}
+
+namespace Hypertable {
+
+  /**
+   * Hierarchical timing wheel.  Time is divided into ticks of a fixed
+   * resolution; an entry is hashed into a slot of the first level if it
+   * expires within the next 256 ticks, otherwise into a coarser level
+   * whose slots are cascaded into the finer levels as time advances.
+   * Insert and remove are O(1), and advance() expires the contents of a
+   * whole slot at a time.  Entries never expire early; they may expire up
+   * to one tick late.
+   *
+   * Entries are intrusive: users derive their node type from
+   * TimerWheel::Entry and own the memory.  The wheel does no locking.
+   */
+  class TimerWheel {
+  public:
+
+    struct Entry {
+      Entry() : prev(0), next(0), tick(0), level(-1) { }
+      Entry *prev, *next;
+      uint64_t tick;
+      int level;
+    };
+
+    TimerWheel(uint32_t resolution_millis=1);
+
+    /** Adds an entry that expires at <code>expire</code>.  The entry must
+     * not already be in the wheel.
+     */
+    void insert(Entry *entry, const boost::xtime &expire);
+
+    /** Removes an entry that is in the wheel */
+    void remove(Entry *entry);
+
+    /** Removes every entry that has expired as of <code>now</code> and
+     * appends it to <code>expired</code>, in expiration order (to the tick).
+     */
+    void advance(const boost::xtime &now, std::vector<Entry *> &expired);
+
+    /** Computes a time by which advance() should next be called.  This is
+     * the earliest of the expiration tick of the first pending first-level
+     * slot and the times at which the next non-empty slot of each coarser
+     * level cascades.  It is never later than the earliest pending
+     * expiration.
+     *
+     * @param nextp address of xtime to hold the wakeup time
+     * @return false if the wheel is empty
+     */
+    bool next_expiration(boost::xtime *nextp);
+
+    /** Removes every entry and appends it to <code>removed</code> */
+    void clear(std::vector<Entry *> &removed);
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+  private:
+
+    enum {
+      ROOT_BITS = 8,
+      ROOT_SLOTS = 1 << ROOT_BITS,
+      LEVEL_BITS = 6,
+      LEVEL_SLOTS = 1 << LEVEL_BITS,
+      LEVELS = 5,
+      OVERDUE = LEVELS
+    };
+
+    uint64_t to_tick(const boost::xtime &xt, bool round_up) const;
+    void to_xtime(uint64_t tick, boost::xtime *xtp) const;
+    int level_shift(int level) const {
+      return level == 0 ? 0 : ROOT_BITS + (level - 1) * LEVEL_BITS;
+    }
+    size_t level_slots(int level) const {
+      return level == 0 ? ROOT_SLOTS : LEVEL_SLOTS;
+    }
+    Entry *slot(int level, size_t index) {
+      return level == OVERDUE ? &m_overdue : &m_slots[level][index];
+    }
+    void place(Entry *entry);
+    void cascade(int level);
+
+    uint64_t m_resolution_nanos;
+    uint64_t m_current;        // last tick processed
+    size_t   m_count;
+    size_t   m_level_count[LEVELS + 1];
+    std::vector<Entry> m_slots[LEVELS];  // list sentinels
+    Entry    m_overdue;
+  };
+
+}
+
+#endif // HYPERTABLE_TIMERWHEEL_H
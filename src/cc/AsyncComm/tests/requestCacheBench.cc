@@ -0,0 +1,136 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Common/Logger.h"
+#include "Common/String.h"
+#include "Common/Time.h"
+
+#include "AsyncComm/RequestCache.h"
+
+using namespace Hypertable;
+using namespace std;
+
+/**
+ * Measures RequestCache insert, remove and expiration throughput with
+ * large numbers of outstanding requests, as seen by high-depth scanners
+ * and mutators.  Request timeouts are drawn uniformly from 10 to 180
+ * seconds.
+ *
+ * Usage: requestCacheBench [max-outstanding]
+ */
+
+namespace {
+
+  IOHandler *const handler = (IOHandler *)1;
+  DispatchHandler *const dh = (DispatchHandler *)1;
+
+  void make_expire(const boost::xtime &now, int64_t millis,
+                   boost::xtime *xtp) {
+    int64_t nanos = (int64_t)now.nsec + (millis % 1000) * 1000000LL;
+    xtp->sec = now.sec + millis / 1000 + nanos / 1000000000LL;
+    xtp->nsec = nanos % 1000000000LL;
+  }
+
+  double rate(size_t ops, int64_t nanos) {
+    return nanos ? (double)ops / ((double)nanos / 1000000000.0) : 0.0;
+  }
+
+  void run(uint32_t outstanding) {
+    RequestCache cache;
+    vector<uint32_t> ids(outstanding);
+    boost::xtime now, expire, next;
+    IOHandler *handlerp;
+    int64_t start, insert_nanos, remove_nanos, churn_nanos, expire_nanos;
+    size_t churn_ops = outstanding * 4;
+
+    boost::xtime_get(&now, boost::TIME_UTC);
+    for (uint32_t i=0; i<outstanding; i++)
+      ids[i] = i;
+    random_shuffle(ids.begin(), ids.end());
+
+    // fill
+    start = get_ts64();
+    for (uint32_t i=0; i<outstanding; i++) {
+      make_expire(now, 10000 + random() % 170000, &expire);
+      cache.insert(i, handler, dh, expire);
+    }
+    insert_nanos = get_ts64() - start;
+
+    // steady state: a response arrives and a new request is sent
+    uint32_t next_id = outstanding;
+    start = get_ts64();
+    for (size_t i=0; i<churn_ops; i++) {
+      uint32_t slot = i % outstanding;
+      HT_ASSERT(cache.remove(ids[slot]) == dh);
+      make_expire(now, 10000 + random() % 170000, &expire);
+      cache.insert(next_id, handler, dh, expire);
+      ids[slot] = next_id++;
+    }
+    churn_nanos = get_ts64() - start;
+
+    // drain in random order
+    start = get_ts64();
+    for (uint32_t i=0; i<outstanding; i++)
+      HT_ASSERT(cache.remove(ids[i]) == dh);
+    remove_nanos = get_ts64() - start;
+
+    // expire everything as of three minutes from now
+    for (uint32_t i=0; i<outstanding; i++) {
+      make_expire(now, 10000 + random() % 170000, &expire);
+      cache.insert(i, handler, dh, expire);
+    }
+    make_expire(now, 181000, &expire);
+    size_t expired = 0;
+    start = get_ts64();
+    while (cache.get_next_timeout(expire, handlerp, &next))
+      expired++;
+    expire_nanos = get_ts64() - start;
+    HT_ASSERT(expired == outstanding && cache.size() == 0);
+
+    cout << format("%11u %12.0f %12.0f %12.0f %12.0f\n", (unsigned)outstanding,
+                   rate(outstanding, insert_nanos),
+                   rate(churn_ops, churn_nanos),
+                   rate(outstanding, remove_nanos),
+                   rate(outstanding, expire_nanos)) << flush;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  uint32_t max_outstanding = argc > 1 ? atoi(argv[1]) : 1000000;
+
+  srandom(1);
+
+  cout << format("%11s %12s %12s %12s %12s\n", "outstanding", "insert/s",
+                 "replace/s", "remove/s", "expire/s");
+  for (uint32_t outstanding=1000; outstanding<=max_outstanding;
+       outstanding *= 10)
+    run(outstanding);
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Common/Logger.h"
+
+#include "AsyncComm/TimerWheel.h"
+
+using namespace Hypertable;
+using namespace std;
+
+/**
+ * Checks that TimerWheel entries expire no earlier than their expiration
+ * time and no later than one tick after it, in order, across all levels
+ * of the wheel, and that removed entries never expire.
+ */
+
+namespace {
+
+  struct TestEntry : public TimerWheel::Entry {
+    int64_t expire_millis;
+    bool removed;
+  };
+
+  void add_millis(const boost::xtime &base, int64_t millis,
+                  boost::xtime *xtp) {
+    int64_t nanos = (int64_t)base.nsec + (millis % 1000) * 1000000LL;
+    xtp->sec = base.sec + millis / 1000 + nanos / 1000000000LL;
+    xtp->nsec = nanos % 1000000000LL;
+  }
+
+  int64_t millis_since(const boost::xtime &base, const boost::xtime &xt) {
+    return ((int64_t)xt.sec - (int64_t)base.sec) * 1000LL +
+      ((int64_t)xt.nsec - (int64_t)base.nsec) / 1000000LL;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  TimerWheel wheel(1);
+  vector<TestEntry> entries(20000);
+  vector<TimerWheel::Entry *> expired;
+  boost::xtime base, now, expire, next;
+  int64_t max_millis[] = { 100, 10000, 1000000, 100000000, 10000000000LL };
+  size_t expired_count = 0, removed_count = 0;
+
+  srandom(1);
+  boost::xtime_get(&base, boost::TIME_UTC);
+
+  HT_ASSERT(!wheel.next_expiration(&next));
+
+  for (size_t i=0; i<entries.size(); i++) {
+    entries[i].expire_millis = 1 + random() % max_millis[i % 5];
+    entries[i].removed = false;
+    add_millis(base, entries[i].expire_millis, &expire);
+    wheel.insert(&entries[i], expire);
+  }
+  HT_ASSERT(wheel.size() == entries.size());
+
+  for (size_t i=0; i<entries.size(); i+=7) {
+    wheel.remove(&entries[i]);
+    entries[i].removed = true;
+    removed_count++;
+  }
+
+  // Advance a simulated clock by jumping to each suggested wakeup time
+  int64_t last_expire = 0;
+  now = base;
+  while (!wheel.empty()) {
+    HT_ASSERT(wheel.next_expiration(&next));
+    HT_ASSERT(xtime_cmp(next, now) > 0);
+    now = next;
+    expired.clear();
+    wheel.advance(now, expired);
+    int64_t elapsed = millis_since(base, now);
+    for (size_t i=0; i<expired.size(); i++) {
+      TestEntry *entry = static_cast<TestEntry *>(expired[i]);
+      HT_ASSERT(!entry->removed);
+      HT_ASSERT(entry->expire_millis <= elapsed);
+      HT_ASSERT(entry->expire_millis >= last_expire);
+      last_expire = entry->expire_millis;
+      expired_count++;
+    }
+    // wakeups for a non-empty first level are never late
+    if (!expired.empty())
+      HT_ASSERT(last_expire + 1 >= elapsed);
+  }
+
+  HT_ASSERT(expired_count + removed_count == entries.size());
+
+  // entries that are already due (on the simulated clock) expire on the
+  // next advance
+  add_millis(now, -5, &expire);
+  wheel.insert(&entries[0], expire);
+  HT_ASSERT(wheel.next_expiration(&next) && xtime_cmp(next, now) <= 0);
+  expired.clear();
+  wheel.advance(now, expired);
+  HT_ASSERT(expired.size() == 1 && expired[0] == &entries[0]);
+
+  // An entry inserted after the clock moved can land in the first level
+  // with a later expiration than an earlier entry that is still waiting in
+  // the second level.  The wakeup time must cover the earlier one.  Try
+  // every clock offset within a first level span so that the boundary is
+  // straddled.
+  now.sec += 1;
+  now.nsec = 0;
+  expired.clear();
+  wheel.advance(now, expired);
+  HT_ASSERT(expired.empty() && wheel.empty());
+  for (int64_t moved=0; moved<300; moved++) {
+    boost::xtime early_expire, late_expire;
+    add_millis(now, 300, &early_expire);
+    wheel.insert(&entries[0], early_expire);
+    add_millis(now, moved, &now);
+    expired.clear();
+    wheel.advance(now, expired);
+    HT_ASSERT(expired.empty());
+    add_millis(early_expire, 5, &late_expire);
+    wheel.insert(&entries[1], late_expire);
+    HT_ASSERT(wheel.next_expiration(&next));
+    HT_ASSERT(xtime_cmp(next, early_expire) <= 0);
+    // drain, by suggested wakeup times, in order
+    expired.clear();
+    while (!wheel.empty()) {
+      HT_ASSERT(wheel.next_expiration(&next));
+      HT_ASSERT(xtime_cmp(next, now) > 0);
+      now = next;
+      size_t expired_before = expired.size();
+      wheel.advance(now, expired);
+      if (expired_before == 0 && !expired.empty())
+        HT_ASSERT(xtime_cmp(now, early_expire) == 0);
+    }
+    HT_ASSERT(expired.size() == 2 && expired[0] == &entries[0] &&
+              expired[1] == &entries[1]);
+    HT_ASSERT(xtime_cmp(now, late_expire) == 0);
+  }
+
+  // clear
+  for (size_t i=0; i<100; i++) {
+    add_millis(now, i * 1000, &expire);
+    wheel.insert(&entries[i], expire);
+  }
+  expired.clear();
+  wheel.clear(expired);
+  HT_ASSERT(expired.size() == 100 && wheel.empty());
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
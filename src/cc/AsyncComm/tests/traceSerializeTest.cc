@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+#include "Common/Trace.h"
+
+#include "AsyncComm/CommHeader.h"
+
+using namespace Hypertable;
+using namespace std;
+
+/**
+ * Checks that trace context survives a round trip through the CommHeader
+ * trace extension and the span lists returned by the dump_traces RPCs,
+ * and that truncated buffers are rejected (or, for the optional header
+ * extension, ignored) rather than read past.
+ */
+
+namespace {
+
+  void test_header() {
+    uint8_t buf[CommHeader::FIXED_LENGTH + CommHeader::TRACE_LENGTH];
+    uint8_t *ptr;
+    const uint8_t *cptr;
+    size_t remain;
+
+    // untraced headers are unchanged on the wire
+    CommHeader plain(42, 1000);
+    plain.set_trace_id(0);
+    HT_ASSERT(plain.encoded_length() == CommHeader::FIXED_LENGTH);
+    ptr = buf;
+    plain.encode(&ptr);
+    HT_ASSERT((size_t)(ptr - buf) == CommHeader::FIXED_LENGTH);
+    CommHeader plain2;
+    plain2.trace_id = 7;
+    cptr = buf;
+    remain = CommHeader::FIXED_LENGTH;
+    plain2.decode(&cptr, &remain);
+    HT_ASSERT(remain == 0);
+    HT_ASSERT(plain2.command == 42 && plain2.timeout_ms == 1000);
+    HT_ASSERT((plain2.flags & CommHeader::FLAGS_BIT_TRACE) == 0);
+    HT_ASSERT(plain2.trace_id == 0);
+
+    // round trip
+    uint64_t trace_id = 0x8000123400000005ULL;
+    CommHeader traced(42, 1000);
+    traced.id = 17;
+    traced.set_trace_id(trace_id);
+    HT_ASSERT(traced.encoded_length() ==
+              CommHeader::FIXED_LENGTH + CommHeader::TRACE_LENGTH);
+    ptr = buf;
+    traced.encode(&ptr);
+    HT_ASSERT((size_t)(ptr - buf) == traced.encoded_length());
+    uint8_t copy[sizeof(buf)];
+    memcpy(copy, buf, sizeof(buf));
+    CommHeader traced2;
+    cptr = buf;
+    remain = sizeof(buf);
+    traced2.decode(&cptr, &remain);
+    HT_ASSERT(remain == 0);
+    HT_ASSERT(traced2.header_len == traced.header_len);
+    HT_ASSERT(traced2.flags & CommHeader::FLAGS_BIT_TRACE);
+    HT_ASSERT(traced2.id == 17 && traced2.command == 42);
+    HT_ASSERT(traced2.trace_id == trace_id);
+
+    // responses never carry the extension
+    CommHeader response;
+    response.initialize_from_request_header(traced2);
+    HT_ASSERT((response.flags & CommHeader::FLAGS_BIT_TRACE) == 0);
+    HT_ASSERT(response.encoded_length() == CommHeader::FIXED_LENGTH);
+
+    // extension truncated: fixed part still decodes, trace id is dropped
+    CommHeader traced3;
+    cptr = copy;
+    remain = CommHeader::FIXED_LENGTH + 3;
+    traced3.decode(&cptr, &remain);
+    HT_ASSERT(remain == 3);
+    HT_ASSERT(traced3.id == 17 && traced3.trace_id == 0);
+
+    // fixed part truncated
+    memcpy(copy, buf, sizeof(buf));
+    ptr = copy;
+    traced.encode(&ptr);
+    CommHeader traced4;
+    cptr = copy;
+    remain = CommHeader::FIXED_LENGTH - 1;
+    try {
+      traced4.decode(&cptr, &remain);
+      HT_ASSERT(!"truncated header decoded");
+    }
+    catch (Exception &e) {
+      HT_ASSERT(e.code() == Error::COMM_BAD_HEADER);
+    }
+  }
+
+  void test_spans() {
+    vector<Trace::Span> spans, spans2;
+    Trace::Span span;
+
+    for (int i=0; i<5; i++) {
+      span.trace_id = 0x8000123400000000ULL + i;
+      span.start = 1318000000000000000LL + i * 1000;
+      span.end = span.start + 500 + i;
+      span.name = (i % 2) ? "rs.update" : "cl.compress_and_write";
+      spans.push_back(span);
+    }
+    // a span with an empty name
+    span.name = "";
+    spans.push_back(span);
+
+    size_t len = Trace::encoded_length(spans);
+    uint8_t *buf = new uint8_t [len];
+    uint8_t *ptr = buf;
+    Trace::encode(spans, &ptr);
+    HT_ASSERT((size_t)(ptr - buf) == len);
+
+    // round trip, into a vector that already holds spans
+    spans2.push_back(span);
+    const uint8_t *cptr = buf;
+    size_t remain = len;
+    Trace::decode(spans2, &cptr, &remain);
+    HT_ASSERT(remain == 0);
+    HT_ASSERT(spans2.size() == spans.size());
+    for (size_t i=0; i<spans.size(); i++) {
+      HT_ASSERT(spans2[i].trace_id == spans[i].trace_id);
+      HT_ASSERT(spans2[i].start == spans[i].start);
+      HT_ASSERT(spans2[i].end == spans[i].end);
+      HT_ASSERT(spans2[i].name == spans[i].name);
+    }
+
+    // every truncation of the buffer is rejected
+    for (size_t trunc=0; trunc<len; trunc++) {
+      cptr = buf;
+      remain = trunc;
+      try {
+        Trace::decode(spans2, &cptr, &remain);
+        HT_ASSERT(!"truncated span list decoded");
+      }
+      catch (Exception &e) {
+        HT_ASSERT(e.code() == Error::SERIALIZATION_INPUT_OVERRUN);
+      }
+    }
+
+    // a corrupt count does not allocate for the spans it claims
+    ptr = buf;
+    Serialization::encode_i32(&ptr, 0x7fffffff);
+    cptr = buf;
+    remain = len;
+    try {
+      Trace::decode(spans2, &cptr, &remain);
+      HT_ASSERT(!"corrupt span count decoded");
+    }
+    catch (Exception &e) {
+      HT_ASSERT(e.code() == Error::SERIALIZATION_INPUT_OVERRUN);
+    }
+
+    // empty list
+    spans.clear();
+    len = Trace::encoded_length(spans);
+    HT_ASSERT(len == 4);
+    ptr = buf;
+    Trace::encode(spans, &ptr);
+    cptr = buf;
+    remain = len;
+    Trace::decode(spans2, &cptr, &remain);
+    HT_ASSERT(remain == 0 && spans2.empty());
+
+    delete [] buf;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  test_header();
+
+  test_spans();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -160,6 +160,16 @@ void DefaultPolicy::init_options() {
     ("Comm.DispatchDelay", i32()->default_value(0), "[TESTING ONLY] "
         "Delay dispatching of read requests by this number of milliseconds")
     ("Comm.UsePoll", boo()->default_value(false), "Use poll() interface")
+    ("Comm.Compression.Codec", str()->default_value("quicklz"),
+        "Codec used for messages that ask for payload compression "
+        "(zlib, lzo, quicklz or none)")
+    ("Comm.Compression.Threshold", i32()->default_value(16*K),
+        "Payloads smaller than this many bytes are sent uncompressed")
+    ("Comm.Compression.MaxRatio", i32()->default_value(80),
+        "Send a payload compressed only if the compressed size is at most "
+        "this percentage of the original size")
+    ("Comm.Compression.DecompressThreads", i32()->default_value(2),
+        "Number of threads that inflate received compressed messages")
     ("Hypertable.Verbose", boo()->default_value(false),
         "Enable verbose output (system wide)")
     ("Hypertable.Silent", boo()->default_value(false),
@@ -213,6 +223,8 @@ void DefaultPolicy::init_options() {
         "Number of local broker worker threads created")
     ("DfsBroker.Local.Reactors", i32(),
         "Number of local broker communication reactor threads created")
+    ("DfsBroker.Preadv.MaxBytes", i64()->default_value(64*M),
+        "Maximum total number of bytes a single preadv request may read")
     ("DfsBroker.Host", str()->default_value("localhost"),
         "Host on which the DFS broker is running (read by clients only)")
     ("DfsBroker.Port", i16()->default_value(38030),
@@ -230,6 +242,12 @@ void DefaultPolicy::init_options() {
         "log files after this much time")
     ("Hyperspace.LogGc.MaxUnusedLogs", i32()->default_value(200), "Number of unused BerkeleyDB "
         " to keep around in case of lagging replicas")
+    ("Hyperspace.GroupCommit", boo()->default_value(true), "Commit BerkeleyDB "
+        "write transactions without a log sync and acknowledge them after a "
+        "log flush shared by all concurrently committing transactions")
+    ("Hyperspace.SnapshotReads", boo()->default_value(true), "Run read only "
+        "Hyperspace requests as BerkeleyDB snapshot transactions, which take "
+        "no read locks and don't contend with writers")
     ("Hyperspace.Replica.Host", strs(), "Hostname of Hyperspace replica")
     ("Hyperspace.Replica.Port", i16()->default_value(38040),
         "Port number on which Hyperspace is or should be listening for requests")
@@ -253,12 +271,24 @@ void DefaultPolicy::init_options() {
         "Hyperspace Grace period (see Chubby paper)")
     ("Hyperspace.Session.Reconnect", boo()->default_value(false),
         "Reconnect to Hyperspace on session expiry")
+    ("Hyperspace.Client.Cache", boo()->default_value(false),
+        "Cache attribute values and directory listings of open handles in "
+        "the client session, kept consistent by master invalidation events")
     ("Hypertable.Directory", str()->default_value("hypertable"),
         "Top-level hypertable directory name")
     ("Hypertable.Monitoring.Interval", i32()->default_value(30000),
         "Monitoring statistics gathering interval (in milliseconds)")
+    ("Hypertable.Trace.SamplePeriod", i32()->default_value(0),
+        "Trace one out of every this many mutator flushes (0 disables tracing)")
+    ("Hypertable.Trace.BufferSize", i32()->default_value(8*K),
+        "Number of trace spans kept in each thread's trace buffer")
     ("Hypertable.HqlInterpreter.Mutator.NoLogSync", boo()->default_value(false),
         "Suspends CommitLog sync operation on updates until command completion")
+    ("Hypertable.Mutator.Compress", boo()->default_value(false),
+        "Compress updates sent by mutators (see Comm.Compression.*)")
+    ("Hypertable.Mutator.CoalesceCounters", boo()->default_value(false),
+        "Fold counter updates to the same cell in a mutator's buffer "
+        "into a single update before sending")
     ("Hypertable.Mutator.FlushDelay", i32()->default_value(0), "Number of "
         "milliseconds to wait prior to flushing scatter buffers (for testing)")
     ("Hypertable.Mutator.ScatterBuffer.FlushLimit.PerServer",
@@ -269,6 +299,11 @@ void DefaultPolicy::init_options() {
         "all servers to trigger a scatter buffer flush")
     ("Hypertable.Scanner.QueueSize",
      i32()->default_value(5), "Size of Scanner ScanBlock queue")
+    ("Hypertable.Scanner.CompactResults", boo()->default_value(true),
+        "Ask RangeServers to return scan results with prefix compressed keys")
+    ("Hypertable.Scanner.CompressResults", boo()->default_value(false),
+        "Ask RangeServers to block compress scan results (trades "
+        "RangeServer and client CPU for network bandwidth)")
     ("Hypertable.LocationCache.MaxEntries", i64()->default_value(1*M),
         "Size of range location cache in number of entries")
     ("Hypertable.Master.Host", str(),
@@ -318,12 +353,22 @@ void DefaultPolicy::init_options() {
         str()->default_value("rows"), "Default bloom filter for cell stores")
     ("Hypertable.RangeServer.CellStore.SkipNotFound",
         boo()->default_value(false), "Skip over cell stores that are non-existent")
+    ("Hypertable.RangeServer.CellStore.OpenThreads", i32()->default_value(4),
+        "Maximum number of cell stores of a range to open concurrently")
     ("Hypertable.RangeServer.CommitInterval", i32()->default_value(50),
      "Default minimum group commit interval in milliseconds")
+    ("Hypertable.RangeServer.GroupCommit.Adaptive", boo()->default_value(false),
+     "Commit group commit updates with a leader/follower scheme instead of "
+     "on a fixed CommitInterval timer")
+    ("Hypertable.RangeServer.GroupCommit.MaxWait", i32()->default_value(10),
+     "Maximum time in milliseconds an adaptive group commit leader waits "
+     "for followers before committing")
     ("Hypertable.RangeServer.BlockCache.MinMemory", i64()->default_value(150*M),
         "Minimum size of block cache")
     ("Hypertable.RangeServer.QueryCache.MaxMemory", i64()->default_value(50*M),
         "Maximum size of query cache")
+    ("Hypertable.RangeServer.QueryCache.Shards", i32()->default_value(16),
+        "Number of independently locked partitions of the query cache")
     ("Hypertable.RangeServer.Range.SplitSize", i64()->default_value(256*MiB),
         "Size of range in bytes before splitting")
     ("Hypertable.RangeServer.Range.MaximumSize", i64()->default_value(3*G),
@@ -332,8 +377,14 @@ void DefaultPolicy::init_options() {
         "range in bytes before splitting (for testing)")
     ("Hypertable.RangeServer.Range.SplitOff", str()->default_value("high"),
         "Portion of range to split off (high or low)")
+    ("Hypertable.RangeServer.Range.LoadThreads", i32()->default_value(8),
+        "Number of ranges to load concurrently during recovery")
     ("Hypertable.RangeServer.ClockSkew.Max", i32()->default_value(3*M),
         "Maximum amount of clock skew (microseconds) the system will tolerate")
+    ("Hypertable.RangeServer.DfsBroker.LocalDirect", boo()->default_value(false),
+        "Read CellStore files directly (memory-mapped) from the local broker "
+        "root directory instead of through the DFS broker (requires a "
+        "co-located local broker)")
     ("Hypertable.RangeServer.CommitLog.DfsBroker.Host", str(),
         "Host of DFS Broker to use for Commit Log")
     ("Hypertable.RangeServer.CommitLog.DfsBroker.Port", i16(),
@@ -350,6 +401,19 @@ void DefaultPolicy::init_options() {
     ("Hypertable.RangeServer.CommitLog.Compressor",
         str()->default_value("quicklz"),
         "Commit log compressor to use (zlib, lzo, quicklz, bmz, none)")
+    ("Hypertable.RangeServer.CommitLog.Local.Directory", str(),
+        "Local directory in which to write the user commit log before it is "
+        "shipped to the DFS (disabled if not set)")
+    ("Hypertable.RangeServer.CommitLog.Local.Preallocate",
+        i64()->default_value(100*M), "Number of bytes to preallocate for "
+        "each local commit log fragment")
+    ("Hypertable.RangeServer.CommitLog.Local.DirectIO",
+        boo()->default_value(true), "Write local commit log fragments "
+        "with O_DIRECT")
+    ("Hypertable.RangeServer.CommitLog.Local.ShipRetries",
+        i32()->default_value(30), "Number of times shipping a local commit "
+        "log fragment to the DFS is retried before closing the log gives up "
+        "waiting for it")
     ("Hypertable.CommitLog.Replication", i32(),
         "Replication factor for commit log files")
     ("Hypertable.CommitLog.RollLimit", i64()->default_value(100*M),
@@ -376,6 +440,9 @@ void DefaultPolicy::init_options() {
         "Number of maintenance threads.  Default is min(2, number-of-cores).")
     ("Hypertable.RangeServer.UpdateDelay", i32()->default_value(0),
         "Number of milliseconds to wait before carrying out an update (TESTING)")
+    ("Hypertable.RangeServer.UpdateApply.Threads", i32()->default_value(4),
+        "Number of extra threads used to insert the cells of a batch update "
+        "into the ranges it touches (0 inserts them on the update thread)")
     ("Hypertable.RangeServer.ProxyName", str()->default_value(""),
         "Use this value for the proxy name (if set) instead of reading from run dir.")
     ("ThriftBroker.Timeout", i32(), "Timeout (ms) for thrift broker")
@@ -391,6 +458,9 @@ void DefaultPolicy::init_options() {
         "Maximum flush interval in milliseconds")
     ("ThriftBroker.Workers", i32()->default_value(50), "Number of "
         "worker threads for thrift broker")
+    ("ThriftBroker.ServerType", str()->default_value("threaded"),
+        "Thrift broker server model: threaded, pool or nonblocking "
+        "(nonblocking does not support ThriftBroker.Timeout)")
 
     ;
   alias("Hypertable.RangeServer.CommitLog.RollLimit",
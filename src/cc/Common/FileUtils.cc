@@ -122,6 +122,29 @@ ssize_t FileUtils::pread(int fd, void *vptr, size_t n, off_t offset) {
 }
 
 
+ssize_t FileUtils::pwrite(int fd, const void *vptr, size_t n, off_t offset) {
+  size_t nleft;
+  ssize_t nwritten;
+  const char *ptr;
+
+  ptr = (const char *)vptr;
+  nleft = n;
+  while (nleft > 0) {
+    if ((nwritten = ::pwrite(fd, ptr, nleft, offset)) <= 0) {
+      if (errno == EINTR)
+        nwritten = 0; /* and call pwrite() again */
+      else
+        return -1;
+    }
+
+    nleft -= nwritten;
+    ptr   += nwritten;
+    offset += nwritten;
+  }
+  return n;
+}
+
+
 ssize_t FileUtils::write(const String &fname, String &contents) {
   int fd = open(fname.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
   if (fd < 0) {
@@ -37,6 +37,7 @@ namespace Hypertable {
     static ssize_t pread(int fd, void *vptr, size_t n, off_t offset);
     static ssize_t write(const String &fname, String &contents);
     static ssize_t write(int fd, const void *vptr, size_t n);
+    static ssize_t pwrite(int fd, const void *vptr, size_t n, off_t offset);
     static ssize_t writev(int fd, const struct iovec *vector, int count);
     static ssize_t sendto(int fd, const void *vptr, size_t n,
                           const sockaddr *to, socklen_t tolen);
@@ -104,6 +104,42 @@ Filesystem::decode_response_pread(EventPtr &event_ptr, void *dst, size_t len) {
 }
 
 
+/**
+ */
+void
+Filesystem::decode_response_preadv(EventPtr &event_ptr,
+                                   std::vector<ReadRegion> &regions) {
+  const uint8_t *decode_ptr = event_ptr->payload;
+  size_t decode_remain = event_ptr->payload_len;
+
+  int error = decode_i32(&decode_ptr, &decode_remain);
+
+  if (error != Error::OK)
+    HT_THROW(error, "");
+
+  uint32_t count = decode_i32(&decode_ptr, &decode_remain);
+
+  if (count != regions.size())
+    HT_THROWF(Error::PROTOCOL_ERROR, "preadv response region count mismatch "
+              "(%u != %u)", (unsigned)count, (unsigned)regions.size());
+
+  std::vector<uint32_t> nread(count);
+  for (uint32_t i=0; i<count; i++)
+    nread[i] = decode_i32(&decode_ptr, &decode_remain);
+
+  // data for region i occupies a slot of regions[i].amount bytes
+  for (uint32_t i=0; i<count; i++) {
+    if (decode_remain < regions[i].amount || nread[i] > regions[i].amount)
+      HT_THROWF(Error::RESPONSE_TRUNCATED, "%lu < %lu",
+                (Lu)decode_remain, (Lu)regions[i].amount);
+    memcpy(regions[i].dst, decode_ptr, nread[i]);
+    regions[i].nread = nread[i];
+    decode_ptr += regions[i].amount;
+    decode_remain -= regions[i].amount;
+  }
+}
+
+
 /**
  */
 size_t
@@ -47,6 +47,21 @@ namespace Hypertable {
     enum OptionType { O_FLUSH = 1 };
     enum OpenFlags { OPEN_FLAG_DIRECTIO = 0x00000001, OPEN_FLAG_OVERWRITE = 0x00000002 };
 
+    /** Describes one region of a vectored positional read (see preadv).
+     * On return from preadv(), <code>nread</code> holds the number of bytes
+     * copied into <code>dst</code>; EOF is indicated by a short read.
+     */
+    struct ReadRegion {
+      ReadRegion() : fd(-1), offset(0), amount(0), dst(0), nread(0) { }
+      ReadRegion(int32_t fd_, uint64_t offset_, uint32_t amount_, void *dst_)
+        : fd(fd_), offset(offset_), amount(amount_), dst(dst_), nread(0) { }
+      int32_t fd;
+      uint64_t offset;
+      uint32_t amount;
+      void *dst;
+      uint32_t nread;
+    };
+
     virtual ~Filesystem() { return; }
 
     /** Opens a file asynchronously.  Issues an open file request.  The caller
@@ -327,6 +342,36 @@ namespace Hypertable {
     static size_t decode_response_pread(EventPtr &event_ptr,
                                         void *dst, size_t len);
 
+    /** Reads several regions, possibly from different files, asynchronously.
+     * Issues a single preadv request that carries every (fd, offset, amount)
+     * tuple in <code>regions</code>.  The caller will get notified of
+     * successful completion or error via the given dispatch handler and should
+     * decode the response with decode_response_preadv().
+     *
+     * @param regions regions to read
+     * @param handler dispatch handler
+     */
+    virtual void preadv(const std::vector<ReadRegion> &regions,
+                        DispatchHandler *handler) = 0;
+
+    /** Reads several regions, possibly from different files.  Issues a
+     * single preadv request and waits for it to complete, copying the data
+     * for each region into its <code>dst</code> buffer and setting its
+     * <code>nread</code> field.
+     *
+     * @param regions regions to read
+     */
+    virtual void preadv(std::vector<ReadRegion> &regions) = 0;
+
+    /** Decodes the response from a preadv request
+     *
+     * @param event_ptr reference to response event
+     * @param regions regions passed to the request; data is copied into
+     *        each region's dst buffer and its nread field is set
+     */
+    static void decode_response_preadv(EventPtr &event_ptr,
+                                       std::vector<ReadRegion> &regions);
+
     /** Creates a directory asynchronously.  Issues a mkdirs request which
      * creates a directory, including all its missing parents.  The caller
      * will get notified of successful completion or error via the given
@@ -0,0 +1,162 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Compat.h"
+#include "Serialization.h"
+#include "LatencyHistogram.h"
+
+#include <cstring>
+
+using namespace Hypertable;
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+  if (value < SUB_BUCKETS)
+    return (size_t)value;
+  int msb = 63 - __builtin_clzll(value);
+  int shift = msb - SUB_BUCKET_BITS;
+  size_t sub = (size_t)(value >> shift) & (SUB_BUCKETS - 1);
+  return (size_t)(shift + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+  if (index < SUB_BUCKETS)
+    return index;
+  int shift = (int)(index / SUB_BUCKETS) - 1;
+  uint64_t low = (uint64_t)(SUB_BUCKETS + (index % SUB_BUCKETS)) << shift;
+  return low + (((uint64_t)1 << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value) {
+  __sync_fetch_and_add(&m_buckets[bucket_index(value)], 1);
+  __sync_fetch_and_add(&m_count, 1);
+  __sync_fetch_and_add(&m_sum, value);
+  uint64_t max = m_max;
+  while (value > max) {
+    uint64_t prev = __sync_val_compare_and_swap(&m_max, max, value);
+    if (prev == max)
+      break;
+    max = prev;
+  }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+  for (size_t i=0; i<BUCKETS; i++)
+    m_buckets[i] += other.m_buckets[i];
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+  if (other.m_max > m_max)
+    m_max = other.m_max;
+}
+
+void LatencyHistogram::reset_into(LatencyHistogram &dst) {
+  dst.clear();
+  dst.m_max = __sync_lock_test_and_set(&m_max, 0);
+  dst.m_sum = __sync_lock_test_and_set(&m_sum, 0);
+  for (size_t i=0; i<BUCKETS; i++) {
+    if (m_buckets[i]) {
+      dst.m_buckets[i] = __sync_lock_test_and_set(&m_buckets[i], 0);
+      dst.m_count += dst.m_buckets[i];
+    }
+  }
+  // derive the count from the buckets that were moved so that the two
+  // histograms stay self-consistent under concurrent record() calls
+  __sync_fetch_and_sub(&m_count, dst.m_count);
+}
+
+void LatencyHistogram::clear() {
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_count = m_sum = m_max = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double pct) const {
+  if (m_count == 0)
+    return 0;
+  uint64_t target = (uint64_t)((pct / 100.0) * (double)m_count + 0.5);
+  if (target == 0)
+    target = 1;
+  if (target > m_count)
+    target = m_count;
+  uint64_t seen = 0;
+  for (size_t i=0; i<BUCKETS; i++) {
+    seen += m_buckets[i];
+    if (seen >= target) {
+      uint64_t value = bucket_upper_bound(i);
+      return value < m_max ? value : m_max;
+    }
+  }
+  return m_max;
+}
+
+/**
+ * Encoding: vi64 count, vi64 sum, vi64 max, vi32 number of non-empty
+ * buckets, then (vi32 index, vi64 count) for each non-empty bucket.
+ */
+size_t LatencyHistogram::encoded_length() const {
+  size_t len = Serialization::encoded_length_vi64(m_count) +
+    Serialization::encoded_length_vi64(m_sum) +
+    Serialization::encoded_length_vi64(m_max);
+  uint32_t nonempty = 0;
+  for (size_t i=0; i<BUCKETS; i++) {
+    if (m_buckets[i]) {
+      len += Serialization::encoded_length_vi32(i) +
+        Serialization::encoded_length_vi64(m_buckets[i]);
+      nonempty++;
+    }
+  }
+  return len + Serialization::encoded_length_vi32(nonempty);
+}
+
+void LatencyHistogram::encode(uint8_t **bufp) const {
+  uint32_t nonempty = 0;
+  for (size_t i=0; i<BUCKETS; i++)
+    if (m_buckets[i])
+      nonempty++;
+  Serialization::encode_vi64(bufp, m_count);
+  Serialization::encode_vi64(bufp, m_sum);
+  Serialization::encode_vi64(bufp, m_max);
+  Serialization::encode_vi32(bufp, nonempty);
+  for (size_t i=0; i<BUCKETS; i++) {
+    if (m_buckets[i]) {
+      Serialization::encode_vi32(bufp, i);
+      Serialization::encode_vi64(bufp, m_buckets[i]);
+    }
+  }
+}
+
+void LatencyHistogram::decode(const uint8_t **bufp, size_t *remainp) {
+  clear();
+  m_count = Serialization::decode_vi64(bufp, remainp);
+  m_sum = Serialization::decode_vi64(bufp, remainp);
+  m_max = Serialization::decode_vi64(bufp, remainp);
+  uint32_t nonempty = Serialization::decode_vi32(bufp, remainp);
+  for (uint32_t i=0; i<nonempty; i++) {
+    uint32_t index = Serialization::decode_vi32(bufp, remainp);
+    uint64_t count = Serialization::decode_vi64(bufp, remainp);
+    if (index < BUCKETS)
+      m_buckets[index] = count;
+  }
+}
+
+bool LatencyHistogram::operator==(const LatencyHistogram &other) const {
+  return m_count == other.m_count && m_sum == other.m_sum &&
+    m_max == other.m_max &&
+    memcmp(m_buckets, other.m_buckets, sizeof(m_buckets)) == 0;
+}
@@ -0,0 +1,112 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_LATENCYHISTOGRAM_H
+#define HYPERTABLE_LATENCYHISTOGRAM_H
+
+extern "C" {
+#include <stddef.h>
+#include <stdint.h>
+}
+
+namespace Hypertable {
+
+  /**
+   * Log-bucketed histogram of latency values (HDR style).  Values below
+   * SUB_BUCKETS are counted exactly; larger values are grouped into
+   * power-of-two ranges, each split into SUB_BUCKETS linear sub-buckets,
+   * which bounds the relative error of a reported percentile to
+   * 1/SUB_BUCKETS.  record() is lock-free and may be called concurrently
+   * from any number of threads.  Histograms with the same layout can be
+   * merged by adding their bucket counts, so per-server histograms can be
+   * aggregated into cluster-wide ones.
+   */
+  class LatencyHistogram {
+  public:
+    enum {
+      SUB_BUCKET_BITS = 4,
+      SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+      BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS
+    };
+
+    LatencyHistogram() { clear(); }
+
+    /** Records a single value.  Safe to call concurrently with other
+     * record() calls and with reset_into().
+     *
+     * @param value value to record (typically microseconds)
+     */
+    void record(uint64_t value);
+
+    /** Adds the contents of another histogram to this one.  Not safe to
+     * call concurrently with record() on this histogram.
+     *
+     * @param other histogram to merge
+     */
+    void merge(const LatencyHistogram &other);
+
+    /** Moves the values recorded so far into <code>dst</code> (which is
+     * cleared first) and resets this histogram.  Values recorded
+     * concurrently end up in either this histogram or <code>dst</code>,
+     * never in both and never lost.
+     *
+     * @param dst histogram to receive the recorded values
+     */
+    void reset_into(LatencyHistogram &dst);
+
+    void clear();
+
+    uint64_t count() const { return m_count; }
+    uint64_t sum() const { return m_sum; }
+    uint64_t max() const { return m_max; }
+    double mean() const { return m_count ? (double)m_sum / m_count : 0.0; }
+
+    /** Returns the value at the given percentile.  The result is the upper
+     * bound of the bucket containing the percentile, clipped to the
+     * largest value recorded.
+     *
+     * @param pct percentile (0.0 - 100.0)
+     * @return value at percentile, or 0 if the histogram is empty
+     */
+    uint64_t percentile(double pct) const;
+
+    size_t encoded_length() const;
+    void encode(uint8_t **bufp) const;
+    void decode(const uint8_t **bufp, size_t *remainp);
+
+    bool operator==(const LatencyHistogram &other) const;
+    bool operator!=(const LatencyHistogram &other) const {
+      return !(*this == other);
+    }
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(size_t index);
+
+  private:
+    uint64_t m_buckets[BUCKETS];
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_max;
+  };
+
+}
+
+#endif // HYPERTABLE_LATENCYHISTOGRAM_H
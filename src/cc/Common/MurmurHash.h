@@ -33,6 +33,13 @@ namespace Hypertable {
  */
 uint32_t murmurhash2(const void *data, size_t len, uint32_t hash);
 
+/**
+ * The 64-bit MurmurHash 2 (MurmurHash64A), for 64-bit platforms.  Mixes 8
+ * bytes at a time, so it is roughly twice as fast as murmurhash2 on long
+ * keys and has far fewer collisions when used to index large tables.
+ */
+uint64_t murmurhash64(const void *data, size_t len, uint64_t seed);
+
 struct MurmurHash2 {
   uint32_t operator()(const String& s) const {
     return murmurhash2(s.c_str(), s.length(), 0);
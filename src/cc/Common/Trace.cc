@@ -0,0 +1,282 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/Mutex.h"
+#include "Common/Serialization.h"
+#include "Common/Time.h"
+#include "Common/Trace.h"
+
+#include <algorithm>
+
+#include <boost/thread/tss.hpp>
+
+extern "C" {
+#include <unistd.h>
+}
+
+using namespace Hypertable;
+
+namespace {
+
+  /** A span as recorded; the name is a string literal */
+  struct SpanRecord {
+    SpanRecord() : trace_id(0), start(0), end(0), name(0) { }
+    uint64_t trace_id;
+    int64_t start;
+    int64_t end;
+    const char *name;
+  };
+
+  /**
+   * Ring buffer of the spans recorded by one thread.  Its mutex is only
+   * contended by get_spans().  When the thread exits the buffer, spans
+   * included, is handed to the next thread that records a span.
+   */
+  struct SpanBuffer {
+    SpanBuffer(size_t size) : ring(size), next(0), wrapped(false) { }
+    Mutex mutex;
+    std::vector<SpanRecord> ring;
+    size_t next;
+    bool wrapped;
+  };
+
+  struct TraceState {
+    TraceState() : initialized(false), sample_period(0), sample_counter(0),
+                   id_prefix(0), id_counter(0), buffer_size(0) { }
+    Mutex mutex;
+    volatile bool initialized;
+    uint32_t sample_period;
+    uint32_t sample_counter;
+    uint64_t id_prefix;
+    uint32_t id_counter;
+    size_t buffer_size;
+    std::vector<SpanBuffer *> buffers;
+    std::vector<SpanBuffer *> free_buffers;
+  };
+
+  // Never destroyed, span buffers are released by thread exit handlers
+  // that may run during static destruction
+  TraceState &state() {
+    static TraceState *s = new TraceState();
+    return *s;
+  }
+
+  void release_span_buffer(SpanBuffer *buffer) {
+    TraceState &s = state();
+    ScopedLock lock(s.mutex);
+    s.free_buffers.push_back(buffer);
+  }
+
+  boost::thread_specific_ptr<uint64_t> current_trace_id;
+  boost::thread_specific_ptr<SpanBuffer> span_buffer(release_span_buffer);
+
+  SpanBuffer *get_span_buffer() {
+    SpanBuffer *buffer = span_buffer.get();
+    if (buffer == 0) {
+      TraceState &s = state();
+      {
+        ScopedLock lock(s.mutex);
+        if (!s.free_buffers.empty()) {
+          buffer = s.free_buffers.back();
+          s.free_buffers.pop_back();
+        }
+        else {
+          buffer = new SpanBuffer(s.buffer_size);
+          s.buffers.push_back(buffer);
+        }
+      }
+      span_buffer.reset(buffer);
+    }
+    return buffer;
+  }
+
+  struct LtSpanStart {
+    bool operator()(const Trace::Span &s1, const Trace::Span &s2) const {
+      return s1.start < s2.start;
+    }
+  };
+
+}
+
+volatile bool Trace::ms_enabled = false;
+
+
+void Trace::initialize() {
+  TraceState &s = state();
+  ScopedLock lock(s.mutex);
+  if (s.initialized)
+    return;
+  int32_t period = 0, size = 8*1024;
+  if (Config::properties) {
+    period = Config::properties->get_i32("Hypertable.Trace.SamplePeriod", 0);
+    size = Config::properties->get_i32("Hypertable.Trace.BufferSize", size);
+  }
+  s.sample_period = period > 0 ? period : 0;
+  s.buffer_size = size > 0 ? size : 1;
+  s.id_prefix = ((uint64_t)((getpid() << 16) ^ (get_ts64() / 1000)) | 1) << 32;
+  s.initialized = true;
+}
+
+
+uint64_t Trace::sample() {
+  TraceState &s = state();
+  if (!s.initialized)
+    initialize();
+  if (s.sample_period == 0)
+    return 0;
+  ScopedLock lock(s.mutex);
+  if (++s.sample_counter < s.sample_period)
+    return 0;
+  s.sample_counter = 0;
+  return s.id_prefix | ++s.id_counter;
+}
+
+
+uint64_t Trace::current() {
+  if (!ms_enabled)
+    return 0;
+  uint64_t *idp = current_trace_id.get();
+  return idp ? *idp : 0;
+}
+
+
+void Trace::set_current(uint64_t trace_id) {
+  uint64_t *idp = current_trace_id.get();
+  if (idp == 0) {
+    if (trace_id == 0)
+      return;
+    current_trace_id.reset(idp = new uint64_t);
+  }
+  *idp = trace_id;
+  if (trace_id)
+    ms_enabled = true;
+}
+
+
+void Trace::record(uint64_t trace_id, const char *name, int64_t start,
+                   int64_t end) {
+  if (trace_id == 0)
+    return;
+  if (!state().initialized)
+    initialize();
+  SpanBuffer *buffer = get_span_buffer();
+  ScopedLock lock(buffer->mutex);
+  SpanRecord &span = buffer->ring[buffer->next];
+  span.trace_id = trace_id;
+  span.start = start;
+  span.end = end;
+  span.name = name;
+  if (++buffer->next == buffer->ring.size()) {
+    buffer->next = 0;
+    buffer->wrapped = true;
+  }
+}
+
+
+void Trace::get_spans(std::vector<Span> &spans) {
+  TraceState &s = state();
+  std::vector<SpanBuffer *> buffers;
+  Span span;
+
+  if (!s.initialized)
+    initialize();
+
+  {
+    ScopedLock lock(s.mutex);
+    buffers = s.buffers;
+  }
+
+  spans.clear();
+  foreach(SpanBuffer *buffer, buffers) {
+    ScopedLock lock(buffer->mutex);
+    size_t count = buffer->wrapped ? buffer->ring.size() : buffer->next;
+    size_t i = buffer->wrapped ? buffer->next : 0;
+    for (; count > 0; count--) {
+      const SpanRecord &record = buffer->ring[i];
+      span.trace_id = record.trace_id;
+      span.start = record.start;
+      span.end = record.end;
+      span.name = record.name;
+      spans.push_back(span);
+      if (++i == buffer->ring.size())
+        i = 0;
+    }
+  }
+
+  std::stable_sort(spans.begin(), spans.end(), LtSpanStart());
+}
+
+
+size_t Trace::encoded_length(const std::vector<Span> &spans) {
+  size_t len = 4;
+  for (size_t i=0; i<spans.size(); i++)
+    len += 24 + Serialization::encoded_length_vstr(spans[i].name);
+  return len;
+}
+
+
+void Trace::encode(const std::vector<Span> &spans, uint8_t **bufp) {
+  Serialization::encode_i32(bufp, spans.size());
+  for (size_t i=0; i<spans.size(); i++) {
+    Serialization::encode_i64(bufp, spans[i].trace_id);
+    Serialization::encode_i64(bufp, spans[i].start);
+    Serialization::encode_i64(bufp, spans[i].end);
+    Serialization::encode_vstr(bufp, spans[i].name);
+  }
+}
+
+
+void Trace::decode(std::vector<Span> &spans, const uint8_t **bufp,
+                   size_t *remainp) {
+  size_t count = Serialization::decode_i32(bufp, remainp);
+  Span span;
+  spans.clear();
+  // each span takes at least 26 bytes, don't trust a corrupt count
+  spans.reserve(std::min(count, *remainp / 26));
+  for (size_t i=0; i<count; i++) {
+    span.trace_id = Serialization::decode_i64(bufp, remainp);
+    span.start = Serialization::decode_i64(bufp, remainp);
+    span.end = Serialization::decode_i64(bufp, remainp);
+    span.name = Serialization::decode_vstr(bufp, remainp);
+    spans.push_back(span);
+  }
+}
+
+
+TraceScope::TraceScope(uint64_t trace_id, const char *name, int64_t start)
+  : m_trace_id(trace_id), m_saved_trace_id(0), m_name(name), m_start(start) {
+  if (m_trace_id) {
+    m_saved_trace_id = Trace::current();
+    Trace::set_current(m_trace_id);
+    if (m_start == 0)
+      m_start = get_ts64();
+  }
+}
+
+
+TraceScope::~TraceScope() {
+  if (m_trace_id) {
+    Trace::record(m_trace_id, m_name, m_start, get_ts64());
+    Trace::set_current(m_saved_trace_id);
+  }
+}
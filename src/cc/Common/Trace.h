@@ -0,0 +1,118 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_TRACE_H
+#define HYPERTABLE_TRACE_H
+
+#include <vector>
+
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Lightweight request tracing.  A client starts a trace for a sampled
+   * request with sample(); the trace id of the calling thread (see
+   * TraceScope) is then carried in the CommHeader of every request the
+   * thread sends, and each process that handles a traced request records
+   * timestamped spans into a per-process ring buffer.  The buffers are
+   * fetched with the dump_traces RPCs of the RangeServer and DfsBroker and
+   * stitched into a timeline by tracedump.
+   *
+   * Tracing is controlled by the Hypertable.Trace.SamplePeriod and
+   * Hypertable.Trace.BufferSize properties, which are read on first use.
+   * Spans are buffered per thread, so recording does not contend on a
+   * process wide lock.
+   */
+  class Trace {
+  public:
+
+    struct Span {
+      Span() : trace_id(0), start(0), end(0) { }
+      uint64_t trace_id;
+      int64_t start;    // nanoseconds since the epoch
+      int64_t end;      // nanoseconds since the epoch
+      String name;
+    };
+
+    /** Returns a new trace id for one out of every SamplePeriod calls,
+     * otherwise 0.
+     */
+    static uint64_t sample();
+
+    /** Returns true once a trace id has been made current in this process.
+     * Hot paths check this before calling current(), which does a thread
+     * local lookup.
+     */
+    static bool enabled() { return ms_enabled; }
+
+    /** Returns the trace id associated with the calling thread, or 0 */
+    static uint64_t current();
+
+    /** Associates a trace id with the calling thread (0 clears it) */
+    static void set_current(uint64_t trace_id);
+
+    /** Records a span into the calling thread's ring buffer.  Does nothing
+     * if trace_id is 0.
+     *
+     * @param trace_id trace id
+     * @param name name of the span (e.g. "rs.batch_update"); only the
+     *        pointer is kept, so it must be a string literal
+     * @param start start time (nanoseconds since the epoch)
+     * @param end end time (nanoseconds since the epoch)
+     */
+    static void record(uint64_t trace_id, const char *name, int64_t start,
+                       int64_t end);
+
+    /** Copies the spans currently in the ring buffers, oldest first */
+    static void get_spans(std::vector<Span> &spans);
+
+    static size_t encoded_length(const std::vector<Span> &spans);
+    static void encode(const std::vector<Span> &spans, uint8_t **bufp);
+    static void decode(std::vector<Span> &spans, const uint8_t **bufp,
+                       size_t *remainp);
+
+  private:
+    static void initialize();
+
+    static volatile bool ms_enabled;
+  };
+
+  /**
+   * Makes a trace id current for the lifetime of the object and records a
+   * span covering that lifetime when it is destroyed.  If trace_id is 0
+   * this does nothing.
+   */
+  class TraceScope {
+  public:
+    TraceScope(uint64_t trace_id, const char *name, int64_t start=0);
+    ~TraceScope();
+
+  private:
+    uint64_t m_trace_id;
+    uint64_t m_saved_trace_id;
+    const char *m_name;
+    int64_t m_start;
+  };
+
+}
+
+#endif // HYPERTABLE_TRACE_H
@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/LatencyHistogram.h"
+#include "Common/Logger.h"
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  void check_buckets() {
+    uint64_t prev = 0;
+    for (size_t i=1; i<LatencyHistogram::BUCKETS; i++) {
+      uint64_t upper = LatencyHistogram::bucket_upper_bound(i);
+      HT_ASSERT(upper > prev);
+      HT_ASSERT(LatencyHistogram::bucket_index(upper) == i);
+      HT_ASSERT(LatencyHistogram::bucket_index(prev + 1) == i);
+      prev = upper;
+    }
+    HT_ASSERT(prev == (uint64_t)-1);
+  }
+
+  void check_percentiles() {
+    LatencyHistogram hist;
+
+    for (uint64_t i=1; i<=10000; i++)
+      hist.record(i);
+
+    HT_ASSERT(hist.count() == 10000);
+    HT_ASSERT(hist.max() == 10000);
+    HT_ASSERT(hist.sum() == 10000ULL*10001ULL/2);
+
+    // relative error is bounded by 1/SUB_BUCKETS
+    uint64_t p50 = hist.percentile(50.0);
+    uint64_t p99 = hist.percentile(99.0);
+    HT_ASSERT(p50 >= 5000 && p50 <= 5000 + 5000/LatencyHistogram::SUB_BUCKETS);
+    HT_ASSERT(p99 >= 9900 && p99 <= 10000);
+    HT_ASSERT(hist.percentile(100.0) == 10000);
+  }
+
+  void check_merge_and_serialize() {
+    LatencyHistogram a, b, merged, moved, decoded;
+
+    for (uint64_t i=0; i<1000; i++) {
+      a.record(random() % 100);
+      b.record(random() % 1000000);
+    }
+
+    merged.merge(a);
+    merged.merge(b);
+    HT_ASSERT(merged.count() == 2000);
+    HT_ASSERT(merged.sum() == a.sum() + b.sum());
+
+    size_t len = merged.encoded_length();
+    uint8_t *buf = new uint8_t [len];
+    uint8_t *ptr = buf;
+    merged.encode(&ptr);
+    HT_ASSERT((size_t)(ptr - buf) == len);
+
+    const uint8_t *cptr = buf;
+    size_t remain = len;
+    decoded.decode(&cptr, &remain);
+    HT_ASSERT(remain == 0);
+    HT_ASSERT(decoded == merged);
+    delete [] buf;
+
+    merged.reset_into(moved);
+    HT_ASSERT(moved == decoded);
+    HT_ASSERT(merged.count() == 0 && merged.percentile(99.0) == 0);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  check_buckets();
+  check_percentiles();
+  check_merge_and_serialize();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_DFSBROKER_BROKER_H
 #define HYPERTABLE_DFSBROKER_BROKER_H
 
+#include "Common/Error.h"
+#include "Common/Filesystem.h"
 #include "Common/ReferenceCount.h"
 #include "Common/StaticBuffer.h"
 
@@ -29,6 +31,7 @@
 
 #include "ResponseCallbackOpen.h"
 #include "ResponseCallbackRead.h"
+#include "ResponseCallbackPreadv.h"
 #include "ResponseCallbackAppend.h"
 #include "ResponseCallbackLength.h"
 #include "ResponseCallbackReaddir.h"
@@ -57,6 +60,14 @@ namespace Hypertable {
       virtual void length(ResponseCallbackLength *, const char *fname) = 0;
       virtual void pread(ResponseCallbackRead *, uint32_t fd, uint64_t offset,
                          uint32_t amount) = 0;
+      /** Reads several regions in one request.  The default implementation
+       * reports Error::NOT_IMPLEMENTED, in which case clients fall back to
+       * issuing individual pread requests.
+       */
+      virtual void preadv(ResponseCallbackPreadv *cb,
+                          std::vector<Filesystem::ReadRegion> &regions) {
+        cb->error(Error::NOT_IMPLEMENTED, "preadv not supported by broker");
+      }
       virtual void mkdirs(ResponseCallback *, const char *dname) = 0;
       virtual void rmdir(ResponseCallback *, const char *dname) = 0;
       virtual void readdir(ResponseCallbackReaddir *, const char *dname) = 0;
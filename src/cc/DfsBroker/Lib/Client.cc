@@ -38,14 +38,15 @@ using namespace Hypertable::DfsBroker;
 
 Client::Client(ConnectionManagerPtr &conn_mgr, const sockaddr_in &addr,
                uint32_t timeout_ms)
-    : m_conn_mgr(conn_mgr), m_addr(addr), m_timeout_ms(timeout_ms) {
+    : m_conn_mgr(conn_mgr), m_addr(addr), m_timeout_ms(timeout_ms),
+      m_preadv_unsupported(false) {
   m_comm = conn_mgr->get_comm();
   conn_mgr->add(m_addr, m_timeout_ms, "DFS Broker");
 }
 
 
 Client::Client(ConnectionManagerPtr &conn_mgr, PropertiesPtr &cfg)
-    : m_conn_mgr(conn_mgr) {
+    : m_conn_mgr(conn_mgr), m_preadv_unsupported(false) {
   m_comm = conn_mgr->get_comm();
   uint16_t port = cfg->get_i16("DfsBroker.Port");
   String host = cfg->get_str("DfsBroker.Host");
@@ -60,11 +61,12 @@ Client::Client(ConnectionManagerPtr &conn_mgr, PropertiesPtr &cfg)
 }
 
 Client::Client(Comm *comm, const sockaddr_in &addr, uint32_t timeout_ms)
-    : m_comm(comm), m_conn_mgr(0), m_addr(addr), m_timeout_ms(timeout_ms) {
+    : m_comm(comm), m_conn_mgr(0), m_addr(addr), m_timeout_ms(timeout_ms),
+      m_preadv_unsupported(false) {
 }
 
 Client::Client(const String &host, int port, uint32_t timeout_ms)
-    : m_timeout_ms(timeout_ms) {
+    : m_timeout_ms(timeout_ms), m_preadv_unsupported(false) {
   InetAddr::initialize(&m_addr, host.c_str(), port);
   m_comm = Comm::instance();
   m_conn_mgr = new ConnectionManager(m_comm);
@@ -419,6 +421,29 @@ Client::status() {
 }
 
 
+void
+Client::dump_traces(std::vector<Trace::Span> &spans) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event_ptr;
+  CommBufPtr cbp(m_protocol.create_dump_traces_request());
+
+  try {
+    send_message(cbp, &sync_handler);
+
+    if (!sync_handler.wait_for_reply(event_ptr))
+      HT_THROW(Protocol::response_code(event_ptr.get()),
+               m_protocol.string_format_message(event_ptr).c_str());
+
+    const uint8_t *decode_ptr = event_ptr->payload + 4;
+    size_t decode_remain = event_ptr->payload_len - 4;
+    Trace::decode(spans, &decode_ptr, &decode_remain);
+  }
+  catch (Exception &e) {
+    HT_THROW2(e.code(), e, "Error fetching DFS broker traces");
+  }
+}
+
+
 void
 Client::length(const String &name, DispatchHandler *handler) {
   CommBufPtr cbp(m_protocol.create_length_request(name));
@@ -488,6 +513,68 @@ Client::pread(int32_t fd, void *dst, size_t len, uint64_t offset) {
 }
 
 
+void
+Client::preadv(const std::vector<ReadRegion> &regions,
+               DispatchHandler *handler) {
+  CommBufPtr cbp(m_protocol.create_preadv_request(regions));
+
+  try { send_message(cbp, handler); }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Error sending preadv request for %u regions",
+               (unsigned)regions.size());
+  }
+}
+
+
+void
+Client::preadv(std::vector<ReadRegion> &regions) {
+
+  bool unsupported;
+  {
+    ScopedLock lock(m_mutex);
+    unsupported = m_preadv_unsupported;
+  }
+
+  if (!unsupported) {
+    DispatchHandlerSynchronizer sync_handler;
+    EventPtr event_ptr;
+    CommBufPtr cbp(m_protocol.create_preadv_request(regions));
+
+    try {
+      send_message(cbp, &sync_handler);
+
+      if (sync_handler.wait_for_reply(event_ptr)) {
+        decode_response_preadv(event_ptr, regions);
+        return;
+      }
+
+      int error = Protocol::response_code(event_ptr.get());
+      String message = m_protocol.string_format_message(event_ptr);
+
+      // Requests larger than the broker allows are read region by region
+      if (error == Error::DFSBROKER_INVALID_ARGUMENT)
+        HT_DEBUGF("preadv rejected by broker, falling back to pread - %s",
+                  message.c_str());
+      // Older brokers don't know about preadv; remember and fall back
+      else if (Protocol::is_unknown_command(error, message)) {
+        ScopedLock lock(m_mutex);
+        m_preadv_unsupported = true;
+      }
+      else
+        HT_THROW(error, message.c_str());
+    }
+    catch (Exception &e) {
+      HT_THROW2F(e.code(), e, "Error issuing preadv for %u regions",
+                 (unsigned)regions.size());
+    }
+  }
+
+  for (size_t i=0; i<regions.size(); i++)
+    regions[i].nread = pread(regions[i].fd, regions[i].dst, regions[i].amount,
+                             regions[i].offset);
+}
+
+
 void
 Client::mkdirs(const String &name, DispatchHandler *handler) {
   CommBufPtr cbp(m_protocol.create_mkdirs_request(name));
@@ -26,6 +26,7 @@
 #include "Common/Mutex.h"
 #include "Common/HashMap.h"
 #include "Common/Properties.h"
+#include "Common/Trace.h"
 
 #include "AsyncComm/Comm.h"
 #include "AsyncComm/DispatchHandlerSynchronizer.h"
@@ -138,6 +139,13 @@ namespace Hypertable { namespace DfsBroker {
                          DispatchHandler *handler);
       virtual size_t pread(int32_t fd, void *dst, size_t len, uint64_t offset);
 
+      virtual void preadv(const std::vector<ReadRegion> &regions,
+                          DispatchHandler *handler);
+      /** Falls back to one pread per region if the broker does not
+       * support preadv, or if the request exceeds the broker's
+       * DfsBroker.Preadv.MaxBytes limit. */
+      virtual void preadv(std::vector<ReadRegion> &regions);
+
       virtual void mkdirs(const String &name, DispatchHandler *handler);
       virtual void mkdirs(const String &name);
 
@@ -166,6 +174,12 @@ namespace Hypertable { namespace DfsBroker {
        */
       void status();
 
+      /** Fetches the contents of the DFS broker's trace buffer (see Trace).
+       *
+       * @param spans vector to hold the returned trace spans
+       */
+      void dump_traces(std::vector<Trace::Span> &spans);
+
       /** Shuts down the DFS broker.  Issues a shutdown command to the DFS
        * broker.  If the flag is set to Protocol::SHUTDOWN_FLAG_IMMEDIATE, then
        * the broker will call exit(0) directly from the I/O reactor thread.
@@ -205,6 +219,7 @@ namespace Hypertable { namespace DfsBroker {
       uint32_t              m_timeout_ms;
       Protocol              m_protocol;
       BufferedReaderMap     m_buffered_reader_map;
+      bool                  m_preadv_unsupported; // guarded by m_mutex
     };
 
     typedef intrusive_ptr<Client> ClientPtr;
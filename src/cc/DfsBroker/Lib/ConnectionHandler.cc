@@ -32,6 +32,7 @@
 #include "RequestHandlerClose.h"
 #include "RequestHandlerCreate.h"
 #include "RequestHandlerDebug.h"
+#include "RequestHandlerDumpTraces.h"
 #include "RequestHandlerOpen.h"
 #include "RequestHandlerRead.h"
 #include "RequestHandlerAppend.h"
@@ -39,6 +40,7 @@
 #include "RequestHandlerRemove.h"
 #include "RequestHandlerLength.h"
 #include "RequestHandlerPread.h"
+#include "RequestHandlerPreadv.h"
 #include "RequestHandlerMkdirs.h"
 #include "RequestHandlerFlush.h"
 #include "RequestHandlerStatus.h"
@@ -98,6 +100,9 @@ void ConnectionHandler::handle(EventPtr &event) {
       case Protocol::COMMAND_PREAD:
         handler = new RequestHandlerPread(m_comm, m_broker_ptr.get(), event);
         break;
+      case Protocol::COMMAND_PREADV:
+        handler = new RequestHandlerPreadv(m_comm, m_broker_ptr.get(), event);
+        break;
       case Protocol::COMMAND_MKDIRS:
         handler = new RequestHandlerMkdirs(m_comm, m_broker_ptr.get(), event);
         break;
@@ -122,6 +127,9 @@ void ConnectionHandler::handle(EventPtr &event) {
       case Protocol::COMMAND_STATUS:
         handler = new RequestHandlerStatus(m_comm, m_broker_ptr.get(), event);
         break;
+      case Protocol::COMMAND_DUMP_TRACES:
+        handler = new RequestHandlerDumpTraces(m_comm, event);
+        break;
       case Protocol::COMMAND_SHUTDOWN: {
           uint16_t flags = 0;
           ResponseCallback cb(m_comm, event);
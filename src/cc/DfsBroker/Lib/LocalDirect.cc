@@ -0,0 +1,553 @@
+/**
+ * Copyright (C) 2010 Doug Judd (Hypertable, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cerrno>
+#include <cstring>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include "AsyncComm/Event.h"
+
+#include "LocalDirect.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+using namespace Hypertable::DfsBroker;
+
+namespace {
+
+  /**
+   * Locally served file descriptors are allocated from this base so that
+   * they never collide with descriptors handed out by the broker.
+   */
+  const int32_t LOCAL_FD_BASE = 0x40000000;
+
+  int errno_to_error(int err) {
+    if (err == ENOTDIR || err == ENAMETOOLONG || err == ENOENT)
+      return Error::DFSBROKER_BAD_FILENAME;
+    else if (err == EACCES || err == EPERM)
+      return Error::DFSBROKER_PERMISSION_DENIED;
+    else if (err == EBADF)
+      return Error::DFSBROKER_BAD_FILE_HANDLE;
+    else if (err == EINVAL)
+      return Error::DFSBROKER_INVALID_ARGUMENT;
+    return Error::DFSBROKER_IO_ERROR;
+  }
+
+}
+
+
+MappedFile::MappedFile(const String &path)
+  : m_path(path), m_fd(-1), m_base(0), m_length(0) {
+  struct stat statbuf;
+
+  if ((m_fd = ::open(path.c_str(), O_RDONLY)) == -1) {
+    int saved_errno = errno;
+    HT_THROWF(errno_to_error(saved_errno), "open('%s') failed - %s",
+              path.c_str(), strerror(saved_errno));
+  }
+
+  if (fstat(m_fd, &statbuf) == -1) {
+    int saved_errno = errno;
+    ::close(m_fd);
+    HT_THROWF(errno_to_error(saved_errno), "fstat('%s') failed - %s",
+              path.c_str(), strerror(saved_errno));
+  }
+
+  m_length = statbuf.st_size;
+
+  // mmap() of a zero length region fails, so leave m_base null
+  if (m_length == 0)
+    return;
+
+  void *addr = mmap(0, m_length, PROT_READ, MAP_SHARED, m_fd, 0);
+  if (addr == MAP_FAILED) {
+    int saved_errno = errno;
+    ::close(m_fd);
+    HT_THROWF(errno_to_error(saved_errno), "mmap('%s', %llu) failed - %s",
+              path.c_str(), (Llu)m_length, strerror(saved_errno));
+  }
+  m_base = (uint8_t *)addr;
+}
+
+
+MappedFile::~MappedFile() {
+  if (m_base)
+    munmap(m_base, m_length);
+  if (m_fd != -1)
+    ::close(m_fd);
+}
+
+
+void
+MappedFile::advise(Access access, uint64_t offset, uint64_t length,
+                   uint64_t prefetch) {
+  if (m_base == 0 || offset >= m_length)
+    return;
+
+  // madvise() requires a page aligned starting address
+  static const uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t start = offset - (offset % page_size);
+
+  if (length == 0 || offset + length > m_length)
+    length = m_length - offset;
+  length += offset - start;
+
+  int advice = (access == ACCESS_SEQUENTIAL) ? MADV_SEQUENTIAL : MADV_RANDOM;
+  if (madvise(m_base + start, length, advice) != 0)
+    HT_WARNF("madvise('%s', %llu, %llu) failed - %s", m_path.c_str(),
+             (Llu)start, (Llu)length, strerror(errno));
+
+  if (access == ACCESS_SEQUENTIAL && prefetch) {
+    if (prefetch > length)
+      prefetch = length;
+    madvise(m_base + start, prefetch, MADV_WILLNEED);
+  }
+}
+
+
+atomic_t LocalDirect::ms_next_fd = ATOMIC_INIT(0);
+
+LocalDirect::LocalDirect(FilesystemPtr &broker, const String &rootdir,
+                         const String &mapped_prefix)
+  : m_broker(broker), m_rootdir(rootdir), m_mapped_prefix(mapped_prefix) {
+  HT_INFOF("Serving DFS reads of %s* directly from local root %s",
+           mapped_prefix.c_str(), rootdir.c_str());
+}
+
+
+LocalDirect::~LocalDirect() {
+}
+
+
+MappedFilePtr LocalDirect::get_mapping(int fd) {
+  ScopedLock lock(m_mutex);
+  OpenFileMap::iterator iter = m_open_files.find(fd);
+  if (iter == m_open_files.end())
+    return 0;
+  return (*iter).second.file;
+}
+
+
+int32_t
+LocalDirect::open_mapped(const String &name, MappedFile::Access access,
+                         uint64_t offset, uint64_t length, uint64_t prefetch) {
+  String abspath;
+
+  if (name[0] == '/')
+    abspath = m_rootdir + name;
+  else
+    abspath = m_rootdir + "/" + name;
+
+  try {
+    OpenFile of;
+    of.file = new MappedFile(abspath);
+    of.file->advise(access, offset, length, prefetch);
+    of.position = offset;
+
+    int32_t fd = LOCAL_FD_BASE + atomic_inc_return(&ms_next_fd);
+    {
+      ScopedLock lock(m_mutex);
+      m_open_files[fd] = of;
+    }
+    HT_DEBUGF("open( %s ) = %d (mapped %llu bytes)", name.c_str(), (int)fd,
+              (Llu)of.file->length());
+    return fd;
+  }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Error opening DFS file: %s", name.c_str());
+  }
+}
+
+
+bool LocalDirect::is_mapped(const String &name) const {
+  return name.compare(0, m_mapped_prefix.length(), m_mapped_prefix) == 0;
+}
+
+
+bool LocalDirect::lookup(int32_t fd, OpenFile **ofp) {
+  OpenFileMap::iterator iter = m_open_files.find(fd);
+  if (iter == m_open_files.end())
+    return false;
+  *ofp = &(*iter).second;
+  return true;
+}
+
+
+size_t
+LocalDirect::copy_out(MappedFile *file, void *dst, size_t len,
+                      uint64_t offset) {
+  if (offset >= file->length())
+    return 0;
+  if (offset + len > file->length())
+    len = file->length() - offset;
+  memcpy(dst, file->base() + offset, len);
+  return len;
+}
+
+
+/**
+ * Delivers a read-style response to <code>handler</code> synchronously, in
+ * the same wire format the broker uses, so that the standard
+ * Filesystem::decode_response_* methods work unchanged.
+ */
+void
+LocalDirect::deliver(DispatchHandler *handler, int error, uint64_t offset,
+                     const uint8_t *data, uint32_t len) {
+  if (handler == 0)
+    return;
+
+  EventPtr event = new Event(Event::MESSAGE, Error::OK);
+  event->payload_len = 16 + len;
+  uint8_t *buf = new uint8_t [ event->payload_len ];
+  event->payload = buf;
+  encode_i32(&buf, error);
+  encode_i64(&buf, offset);
+  encode_i32(&buf, len);
+  if (len)
+    memcpy(buf, data, len);
+  handler->handle(event);
+}
+
+
+void
+LocalDirect::open(const String &name, uint32_t flags,
+                  DispatchHandler *handler) {
+  m_broker->open(name, flags, handler);
+}
+
+
+int LocalDirect::open(const String &name, uint32_t flags) {
+  if (!is_mapped(name))
+    return m_broker->open(name, flags);
+  return open_mapped(name, MappedFile::ACCESS_RANDOM, 0, 0, 0);
+}
+
+
+int
+LocalDirect::open_buffered(const String &name, uint32_t flags,
+                           uint32_t buf_size, uint32_t outstanding,
+                           uint64_t start_offset, uint64_t end_offset) {
+  if (!is_mapped(name))
+    return m_broker->open_buffered(name, flags, buf_size, outstanding,
+                                   start_offset, end_offset);
+  uint64_t length = end_offset > start_offset ? end_offset - start_offset : 0;
+  return open_mapped(name, MappedFile::ACCESS_SEQUENTIAL, start_offset,
+                     length, (uint64_t)buf_size * outstanding);
+}
+
+
+void
+LocalDirect::create(const String &name, uint32_t flags, int32_t bufsz,
+                    int32_t replication, int64_t blksz,
+                    DispatchHandler *handler) {
+  m_broker->create(name, flags, bufsz, replication, blksz, handler);
+}
+
+
+int
+LocalDirect::create(const String &name, uint32_t flags, int32_t bufsz,
+                    int32_t replication, int64_t blksz) {
+  return m_broker->create(name, flags, bufsz, replication, blksz);
+}
+
+
+void LocalDirect::close(int32_t fd, DispatchHandler *handler) {
+  {
+    ScopedLock lock(m_mutex);
+    OpenFileMap::iterator iter = m_open_files.find(fd);
+    if (iter == m_open_files.end()) {
+      lock.unlock();
+      m_broker->close(fd, handler);
+      return;
+    }
+    m_open_files.erase(iter);
+  }
+  deliver(handler, Error::OK);
+}
+
+
+void LocalDirect::close(int32_t fd) {
+  {
+    ScopedLock lock(m_mutex);
+    OpenFileMap::iterator iter = m_open_files.find(fd);
+    if (iter != m_open_files.end()) {
+      m_open_files.erase(iter);
+      return;
+    }
+  }
+  m_broker->close(fd);
+}
+
+
+void LocalDirect::read(int32_t fd, size_t amount, DispatchHandler *handler) {
+  MappedFilePtr file;
+  uint64_t offset;
+  {
+    ScopedLock lock(m_mutex);
+    OpenFile *of;
+    if (!lookup(fd, &of)) {
+      lock.unlock();
+      m_broker->read(fd, amount, handler);
+      return;
+    }
+    file = of->file;
+    offset = of->position;
+    if (offset >= file->length())
+      amount = 0;
+    else if (offset + amount > file->length())
+      amount = file->length() - offset;
+    of->position += amount;
+  }
+  deliver(handler, Error::OK, offset, file->base() + offset, amount);
+}
+
+
+size_t LocalDirect::read(int32_t fd, void *dst, size_t amount) {
+  MappedFilePtr file;
+  uint64_t offset;
+  {
+    ScopedLock lock(m_mutex);
+    OpenFile *of;
+    if (!lookup(fd, &of)) {
+      lock.unlock();
+      return m_broker->read(fd, dst, amount);
+    }
+    file = of->file;
+    offset = of->position;
+    if (offset >= file->length())
+      amount = 0;
+    else if (offset + amount > file->length())
+      amount = file->length() - offset;
+    of->position += amount;
+  }
+  return copy_out(file.get(), dst, amount, offset);
+}
+
+
+void
+LocalDirect::append(int32_t fd, StaticBuffer &buffer, uint32_t flags,
+                    DispatchHandler *handler) {
+  m_broker->append(fd, buffer, flags, handler);
+}
+
+
+size_t
+LocalDirect::append(int32_t fd, StaticBuffer &buffer, uint32_t flags) {
+  return m_broker->append(fd, buffer, flags);
+}
+
+
+void
+LocalDirect::seek(int32_t fd, uint64_t offset, DispatchHandler *handler) {
+  {
+    ScopedLock lock(m_mutex);
+    OpenFile *of;
+    if (!lookup(fd, &of)) {
+      lock.unlock();
+      m_broker->seek(fd, offset, handler);
+      return;
+    }
+    of->position = offset;
+  }
+  deliver(handler, Error::OK, offset);
+}
+
+
+void LocalDirect::seek(int32_t fd, uint64_t offset) {
+  {
+    ScopedLock lock(m_mutex);
+    OpenFile *of;
+    if (lookup(fd, &of)) {
+      of->position = offset;
+      return;
+    }
+  }
+  m_broker->seek(fd, offset);
+}
+
+
+void LocalDirect::remove(const String &name, DispatchHandler *handler) {
+  m_broker->remove(name, handler);
+}
+
+
+void LocalDirect::remove(const String &name, bool force) {
+  m_broker->remove(name, force);
+}
+
+
+void LocalDirect::length(const String &name, DispatchHandler *handler) {
+  m_broker->length(name, handler);
+}
+
+
+int64_t LocalDirect::length(const String &name) {
+  return m_broker->length(name);
+}
+
+
+void
+LocalDirect::pread(int32_t fd, size_t len, uint64_t offset,
+                   DispatchHandler *handler) {
+  MappedFilePtr file = get_mapping(fd);
+
+  if (!file) {
+    m_broker->pread(fd, len, offset, handler);
+    return;
+  }
+
+  if (offset >= file->length())
+    len = 0;
+  else if (offset + len > file->length())
+    len = file->length() - offset;
+
+  deliver(handler, Error::OK, offset, file->base() + offset, len);
+}
+
+
+size_t
+LocalDirect::pread(int32_t fd, void *dst, size_t len, uint64_t offset) {
+  MappedFilePtr file = get_mapping(fd);
+
+  if (!file)
+    return m_broker->pread(fd, dst, len, offset);
+
+  return copy_out(file.get(), dst, len, offset);
+}
+
+
+void
+LocalDirect::preadv(const std::vector<ReadRegion> &regions,
+                    DispatchHandler *handler) {
+  m_broker->preadv(regions, handler);
+}
+
+
+void LocalDirect::preadv(std::vector<ReadRegion> &regions) {
+  std::vector<ReadRegion> remote;
+  std::vector<size_t> remote_index;
+
+  for (size_t i=0; i<regions.size(); i++) {
+    MappedFilePtr file = get_mapping(regions[i].fd);
+    if (file)
+      regions[i].nread = copy_out(file.get(), regions[i].dst,
+                                  regions[i].amount, regions[i].offset);
+    else {
+      remote.push_back(regions[i]);
+      remote_index.push_back(i);
+    }
+  }
+
+  if (!remote.empty()) {
+    m_broker->preadv(remote);
+    for (size_t i=0; i<remote.size(); i++)
+      regions[remote_index[i]].nread = remote[i].nread;
+  }
+}
+
+
+void LocalDirect::mkdirs(const String &name, DispatchHandler *handler) {
+  m_broker->mkdirs(name, handler);
+}
+
+
+void LocalDirect::mkdirs(const String &name) {
+  m_broker->mkdirs(name);
+}
+
+
+void LocalDirect::flush(int32_t fd, DispatchHandler *handler) {
+  m_broker->flush(fd, handler);
+}
+
+
+void LocalDirect::flush(int32_t fd) {
+  m_broker->flush(fd);
+}
+
+
+void LocalDirect::rmdir(const String &name, DispatchHandler *handler) {
+  m_broker->rmdir(name, handler);
+}
+
+
+void LocalDirect::rmdir(const String &name, bool force) {
+  m_broker->rmdir(name, force);
+}
+
+
+void LocalDirect::readdir(const String &name, DispatchHandler *handler) {
+  m_broker->readdir(name, handler);
+}
+
+
+void
+LocalDirect::readdir(const String &name, std::vector<String> &listing) {
+  m_broker->readdir(name, listing);
+}
+
+
+void LocalDirect::exists(const String &name, DispatchHandler *handler) {
+  m_broker->exists(name, handler);
+}
+
+
+bool LocalDirect::exists(const String &name) {
+  return m_broker->exists(name);
+}
+
+
+void
+LocalDirect::rename(const String &src, const String &dst,
+                    DispatchHandler *handler) {
+  m_broker->rename(src, dst, handler);
+}
+
+
+void LocalDirect::rename(const String &src, const String &dst) {
+  m_broker->rename(src, dst);
+}
+
+
+void
+LocalDirect::debug(int32_t command, StaticBuffer &serialized_parameters) {
+  m_broker->debug(command, serialized_parameters);
+}
+
+
+void
+LocalDirect::debug(int32_t command, StaticBuffer &serialized_parameters,
+                   DispatchHandler *handler) {
+  m_broker->debug(command, serialized_parameters, handler);
+}
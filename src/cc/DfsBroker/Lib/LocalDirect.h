@@ -0,0 +1,204 @@
+/** -*- c++ -*-
+ * Copyright (C) 2010 Doug Judd (Hypertable, Inc.)
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_DFSBROKER_LOCALDIRECT_H
+#define HYPERTABLE_DFSBROKER_LOCALDIRECT_H
+
+#include "Common/atomic.h"
+#include "Common/HashMap.h"
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+
+#include "Common/Filesystem.h"
+
+namespace Hypertable { namespace DfsBroker {
+
+    /**
+     * Read-only memory mapping of a local file.  The mapping (and the
+     * underlying file descriptor) is released when the last reference goes
+     * away, so callers holding a MappedFilePtr can safely use pointers into
+     * the mapping even if the file is concurrently closed.
+     */
+    class MappedFile : public ReferenceCount {
+    public:
+      enum Access { ACCESS_RANDOM, ACCESS_SEQUENTIAL };
+
+      MappedFile(const String &path);
+      ~MappedFile();
+
+      /** Passes an access pattern hint for the given region to the kernel
+       * (madvise).  For sequential access, the first <code>prefetch</code>
+       * bytes of the region are also scheduled for read-in.
+       *
+       * @param access expected access pattern
+       * @param offset starting offset of region
+       * @param length length of region (0 means to end of file)
+       * @param prefetch number of bytes to read ahead
+       */
+      void advise(Access access, uint64_t offset=0, uint64_t length=0,
+                  uint64_t prefetch=0);
+
+      const uint8_t *base() const { return m_base; }
+      uint64_t length() const { return m_length; }
+      const String &path() const { return m_path; }
+
+    private:
+      String   m_path;
+      int      m_fd;
+      uint8_t *m_base;
+      uint64_t m_length;
+    };
+
+    typedef intrusive_ptr<MappedFile> MappedFilePtr;
+
+    /**
+     * Filesystem for processes that are co-located with a LocalBroker.  Files
+     * opened for reading are memory-mapped directly from the broker's root
+     * directory and are served in-process, without a broker round trip.  All
+     * other operations (create, append, directory operations, etc.) are
+     * forwarded to the broker so that writes continue to have the usual
+     * ordering and durability semantics.  Since a mapping covers the file
+     * length at open time, only files that are immutable once written (such
+     * as CellStores) should be mapped; files outside the mapped prefix (logs
+     * that may still be growing) are opened through the broker as well.
+     */
+    class LocalDirect : public Filesystem {
+    public:
+
+      /** Constructor.
+       *
+       * @param broker filesystem to forward non-read operations to
+       * @param rootdir local root directory of the broker
+       * @param mapped_prefix only files whose (broker) name starts with this
+       *        prefix are mapped, all others are read through the broker
+       */
+      LocalDirect(FilesystemPtr &broker, const String &rootdir,
+                  const String &mapped_prefix="");
+
+      virtual ~LocalDirect();
+
+      /** Returns the mapping backing a file descriptor returned by open()
+       * or open_buffered(), which allows callers to read file data without
+       * copying it.
+       *
+       * @param fd file descriptor
+       * @return mapping or null if fd is not served locally
+       */
+      MappedFilePtr get_mapping(int fd);
+
+      virtual void open(const String &name, uint32_t flags, DispatchHandler *handler);
+      virtual int open(const String &name, uint32_t flags=0);
+      virtual int open_buffered(const String &name, uint32_t flags, uint32_t buf_size,
+                                uint32_t outstanding, uint64_t start_offset=0,
+                                uint64_t end_offset=0);
+
+      virtual void create(const String &name, uint32_t flags,
+                          int32_t bufsz, int32_t replication,
+                          int64_t blksz, DispatchHandler *handler);
+      virtual int create(const String &name, uint32_t flags, int32_t bufsz,
+                         int32_t replication, int64_t blksz);
+
+      virtual void close(int32_t fd, DispatchHandler *handler);
+      virtual void close(int32_t fd);
+
+      virtual void read(int32_t fd, size_t amount, DispatchHandler *handler);
+      virtual size_t read(int32_t fd, void *dst, size_t amount);
+
+      virtual void append(int32_t fd, StaticBuffer &buffer, uint32_t flags,
+                          DispatchHandler *handler);
+      virtual size_t append(int32_t fd, StaticBuffer &buffer,
+                            uint32_t flags = 0);
+
+      virtual void seek(int32_t fd, uint64_t offset, DispatchHandler *handler);
+      virtual void seek(int32_t fd, uint64_t offset);
+
+      virtual void remove(const String &name, DispatchHandler *handler);
+      virtual void remove(const String &name, bool force = true);
+
+      virtual void length(const String &name, DispatchHandler *handler);
+      virtual int64_t length(const String &name);
+
+      virtual void pread(int32_t fd, size_t len, uint64_t offset,
+                         DispatchHandler *handler);
+      virtual size_t pread(int32_t fd, void *dst, size_t len, uint64_t offset);
+
+      virtual void preadv(const std::vector<ReadRegion> &regions,
+                          DispatchHandler *handler);
+      virtual void preadv(std::vector<ReadRegion> &regions);
+
+      virtual void mkdirs(const String &name, DispatchHandler *handler);
+      virtual void mkdirs(const String &name);
+
+      virtual void flush(int32_t fd, DispatchHandler *handler);
+      virtual void flush(int32_t fd);
+
+      virtual void rmdir(const String &name, DispatchHandler *handler);
+      virtual void rmdir(const String &name, bool force = true);
+
+      virtual void readdir(const String &name, DispatchHandler *handler);
+      virtual void readdir(const String &name, std::vector<String> &listing);
+
+      virtual void exists(const String &name, DispatchHandler *handler);
+      virtual bool exists(const String &name);
+
+      virtual void rename(const String &src, const String &dst,
+                          DispatchHandler *handler);
+      virtual void rename(const String &src, const String &dst);
+
+      virtual void debug(int32_t command, StaticBuffer &serialized_parameters);
+      virtual void debug(int32_t command, StaticBuffer &serialized_parameters,
+                         DispatchHandler *handler);
+
+    private:
+
+      struct OpenFile {
+        OpenFile() : position(0) { }
+        MappedFilePtr file;
+        uint64_t position;
+      };
+
+      typedef hash_map<int32_t, OpenFile> OpenFileMap;
+
+      bool is_mapped(const String &name) const;
+      int32_t open_mapped(const String &name, MappedFile::Access access,
+                          uint64_t offset, uint64_t length, uint64_t prefetch);
+      bool lookup(int32_t fd, OpenFile **ofp);
+      size_t copy_out(MappedFile *file, void *dst, size_t len,
+                      uint64_t offset);
+      void deliver(DispatchHandler *handler, int error, uint64_t offset=0,
+                   const uint8_t *data=0, uint32_t len=0);
+
+      static atomic_t ms_next_fd;
+
+      Mutex         m_mutex;
+      FilesystemPtr m_broker;
+      String        m_rootdir;
+      String        m_mapped_prefix;
+      OpenFileMap   m_open_files;
+    };
+
+    typedef intrusive_ptr<LocalDirect> LocalDirectPtr;
+
+}} // namespace Hypertable::DfsBroker
+
+
+#endif // HYPERTABLE_DFSBROKER_LOCALDIRECT_H
@@ -24,6 +24,7 @@
 #include <cassert>
 #include <iostream>
 
+#include "Common/Error.h"
 #include "Common/Filesystem.h"
 #include "Common/Logger.h"
 #include "Common/Serialization.h"
@@ -60,7 +61,9 @@ namespace Hypertable {
       "readdir",
       "exists",
       "rename",
-      "debug"
+      "debug",
+      "preadv",
+      "dump traces"
     };
 
 
@@ -174,6 +177,22 @@ namespace Hypertable {
       return cbuf;
     }
 
+    /**
+     */
+    CommBuf *
+    Protocol::create_preadv_request(
+        const std::vector<Filesystem::ReadRegion> &regions) {
+      CommHeader header(COMMAND_PREADV);
+      CommBuf *cbuf = new CommBuf(header, 4 + 16*regions.size());
+      cbuf->append_i32(regions.size());
+      for (size_t i=0; i<regions.size(); i++) {
+        cbuf->append_i32(regions[i].fd);
+        cbuf->append_i64(regions[i].offset);
+        cbuf->append_i32(regions[i].amount);
+      }
+      return cbuf;
+    }
+
     /**
      */
     CommBuf *Protocol::create_mkdirs_request(const String &fname) {
@@ -232,6 +251,15 @@ namespace Hypertable {
     }
 
 
+    /**
+     */
+    CommBuf *Protocol::create_dump_traces_request() {
+      CommHeader header(COMMAND_DUMP_TRACES);
+      CommBuf *cbuf = new CommBuf(header);
+      return cbuf;
+    }
+
+
     /**
      */
     CommBuf *Protocol::create_exists_request(const String &fname) {
@@ -267,5 +295,13 @@ namespace Hypertable {
       return ms_command_strings[command];
     }
 
+    bool Protocol::is_unknown_command(int error, const String &message) {
+      if (error == Error::NOT_IMPLEMENTED)
+        return true;
+      return error == Error::PROTOCOL_ERROR &&
+        (message.find("Invalid command") != String::npos ||
+         message.find("Unimplemented command") != String::npos);
+    }
+
   }
 }
@@ -26,6 +26,7 @@
 #include "AsyncComm/Event.h"
 #include "AsyncComm/Protocol.h"
 
+#include "Common/Filesystem.h"
 #include "Common/StaticBuffer.h"
 #include "Common/String.h"
 
@@ -63,6 +64,9 @@ namespace Hypertable {
       static CommBuf *create_position_read_request(int32_t fd, uint64_t offset,
                                                    uint32_t amount);
 
+      static CommBuf *create_preadv_request(
+          const std::vector<Filesystem::ReadRegion> &regions);
+
       static CommBuf *create_mkdirs_request(const String &fname);
 
       static CommBuf *create_rmdir_request(const String &fname);
@@ -73,6 +77,8 @@ namespace Hypertable {
 
       static CommBuf *create_status_request();
 
+      static CommBuf *create_dump_traces_request();
+
       static CommBuf *create_shutdown_request(uint16_t flags);
 
       static CommBuf *create_exists_request(const String &fname);
@@ -85,6 +91,16 @@ namespace Hypertable {
 
       virtual const char *command_text(uint64_t command);
 
+      /** Returns true if an error response says that the broker doesn't
+       * know the command at all (brokers that predate it answer with a
+       * PROTOCOL_ERROR "Invalid command" or "Unimplemented command"), as
+       * opposed to having rejected a malformed request.
+       *
+       * @param error error code of the response
+       * @param message error message of the response
+       */
+      static bool is_unknown_command(int error, const String &message);
+
       static const uint64_t COMMAND_OPEN     = 0;
       static const uint64_t COMMAND_CREATE   = 1;
       static const uint64_t COMMAND_CLOSE    = 2;
@@ -103,7 +119,9 @@ namespace Hypertable {
       static const uint64_t COMMAND_EXISTS   = 15;
       static const uint64_t COMMAND_RENAME   = 16;
       static const uint64_t COMMAND_DEBUG    = 17;
-      static const uint64_t COMMAND_MAX      = 18;
+      static const uint64_t COMMAND_PREADV   = 18;
+      static const uint64_t COMMAND_DUMP_TRACES = 19;
+      static const uint64_t COMMAND_MAX      = 20;
 
       static const uint16_t SHUTDOWN_FLAG_IMMEDIATE = 0x0001;
 
@@ -23,6 +23,8 @@
 #include "Common/Error.h"
 #include "Common/Filesystem.h"
 #include "Common/Logger.h"
+#include "Common/Time.h"
+#include "Common/Trace.h"
 
 #include "AsyncComm/CommHeader.h"
 
@@ -41,6 +43,11 @@ using namespace Serialization;
  */
 void RequestHandlerAppend::run() {
   ResponseCallbackAppend cb(m_comm, m_event_ptr);
+  uint64_t trace_id = m_event_ptr->header.trace_id;
+  if (trace_id)
+    Trace::record(trace_id, "dfs.append.queue", m_event_ptr->arrival_hrtime,
+                  get_ts64());
+  TraceScope trace(trace_id, "dfs.append");
   const uint8_t *decode_ptr = m_event_ptr->payload;
   size_t decode_remain = m_event_ptr->payload_len;
 
@@ -0,0 +1,53 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Trace.h"
+
+#include "AsyncComm/CommBuf.h"
+#include "AsyncComm/CommHeader.h"
+#include "AsyncComm/ResponseCallback.h"
+
+#include "RequestHandlerDumpTraces.h"
+
+using namespace Hypertable;
+using namespace Hypertable::DfsBroker;
+
+/**
+ *
+ */
+void RequestHandlerDumpTraces::run() {
+  std::vector<Trace::Span> spans;
+  Trace::get_spans(spans);
+
+  CommHeader header;
+  header.initialize_from_request_header(m_event_ptr->header);
+  CommBufPtr cbp(new CommBuf(header, 4 + Trace::encoded_length(spans)));
+  cbp->append_i32(Error::OK);
+  Trace::encode(spans, cbp->get_data_ptr_address());
+
+  int error = m_comm->send_response(m_event_ptr->addr, cbp);
+  if (error != Error::OK)
+    HT_ERRORF("Problem sending dump traces response - %s",
+              Error::get_text(error));
+}
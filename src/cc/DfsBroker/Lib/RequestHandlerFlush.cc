@@ -22,6 +22,8 @@
 #include "Common/Compat.h"
 #include "Common/Error.h"
 #include "Common/Logger.h"
+#include "Common/Time.h"
+#include "Common/Trace.h"
 
 #include "AsyncComm/ResponseCallback.h"
 #include "Common/Serialization.h"
@@ -37,6 +39,11 @@ using namespace Serialization;
  */
 void RequestHandlerFlush::run() {
   ResponseCallback cb(m_comm, m_event_ptr);
+  uint64_t trace_id = m_event_ptr->header.trace_id;
+  if (trace_id)
+    Trace::record(trace_id, "dfs.flush.queue", m_event_ptr->arrival_hrtime,
+                  get_ts64());
+  TraceScope trace(trace_id, "dfs.flush");
   const uint8_t *decode_ptr = m_event_ptr->payload;
   size_t decode_remain = m_event_ptr->payload_len;
 
@@ -0,0 +1,74 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include "AsyncComm/ResponseCallback.h"
+#include "Common/Serialization.h"
+
+#include "RequestHandlerPreadv.h"
+
+using namespace Hypertable;
+using namespace DfsBroker;
+using namespace Serialization;
+
+/**
+ *
+ */
+void RequestHandlerPreadv::run() {
+  ResponseCallbackPreadv cb(m_comm, m_event_ptr);
+  const uint8_t *decode_ptr = m_event_ptr->payload;
+  size_t decode_remain = m_event_ptr->payload_len;
+
+  try {
+    uint32_t count = decode_i32(&decode_ptr, &decode_remain);
+
+    // each region is encoded as fd (4), offset (8) and amount (4)
+    if (count > decode_remain / 16)
+      HT_THROWF(Error::PROTOCOL_ERROR, "preadv region count %u exceeds "
+                "payload of %u bytes", (unsigned)count,
+                (unsigned)decode_remain);
+
+    int64_t max_bytes = Config::properties->get_i64("DfsBroker.Preadv.MaxBytes");
+    int64_t total = 0;
+    std::vector<Filesystem::ReadRegion> regions(count);
+    for (uint32_t i=0; i<count; i++) {
+      regions[i].fd = decode_i32(&decode_ptr, &decode_remain);
+      regions[i].offset = decode_i64(&decode_ptr, &decode_remain);
+      regions[i].amount = decode_i32(&decode_ptr, &decode_remain);
+      total += regions[i].amount;
+    }
+
+    if (total > max_bytes)
+      HT_THROWF(Error::DFSBROKER_INVALID_ARGUMENT, "preadv of %lld bytes "
+                "exceeds DfsBroker.Preadv.MaxBytes (%lld)", (Lld)total,
+                (Lld)max_bytes);
+
+    m_broker->preadv(&cb, regions);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    cb.error(e.code(), "Error handling PREADV message");
+  }
+}
@@ -0,0 +1,43 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+
+#include "AsyncComm/CommBuf.h"
+
+#include "ResponseCallbackPreadv.h"
+
+using namespace Hypertable;
+using namespace DfsBroker;
+
+int
+ResponseCallbackPreadv::response(
+    const std::vector<Filesystem::ReadRegion> &regions, StaticBuffer &buffer) {
+  CommHeader header;
+  header.initialize_from_request_header(m_event_ptr->header);
+  CommBufPtr cbp( new CommBuf(header, 8 + 4*regions.size(), buffer) );
+  cbp->append_i32(Error::OK);
+  cbp->append_i32(regions.size());
+  for (size_t i=0; i<regions.size(); i++)
+    cbp->append_i32(regions[i].nread);
+  return m_comm->send_response(m_event_ptr->addr, cbp);
+}
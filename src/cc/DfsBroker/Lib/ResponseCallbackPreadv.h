@@ -0,0 +1,55 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_RESPONSECALLBACKPREADV_H
+#define HYPERTABLE_RESPONSECALLBACKPREADV_H
+
+#include <vector>
+
+#include "Common/Error.h"
+#include "Common/Filesystem.h"
+#include "Common/StaticBuffer.h"
+
+#include "AsyncComm/CommBuf.h"
+#include "AsyncComm/ResponseCallback.h"
+
+namespace Hypertable {
+
+  namespace DfsBroker {
+
+    class ResponseCallbackPreadv : public ResponseCallback {
+    public:
+      ResponseCallbackPreadv(Comm *comm, EventPtr &event_ptr)
+        : ResponseCallback(comm, event_ptr) { }
+
+      /** Sends the preadv response.  <code>buffer</code> holds one slot of
+       * <code>regions[i].amount</code> bytes per region, in order, of which
+       * the first <code>regions[i].nread</code> bytes are valid.
+       */
+      int response(const std::vector<Filesystem::ReadRegion> &regions,
+                   StaticBuffer &buffer);
+    };
+  }
+
+}
+
+
+#endif // HYPERTABLE_RESPONSECALLBACKPREADV_H
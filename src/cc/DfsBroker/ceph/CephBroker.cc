@@ -307,6 +307,43 @@ void CephBroker::pread(ResponseCallbackRead *cb, uint32_t fd, uint64_t offset,
   cb->response(offset, buf);
 }
 
+void CephBroker::preadv(ResponseCallbackPreadv *cb,
+                        std::vector<Filesystem::ReadRegion> &regions) {
+  std::vector<OpenFileDataCephPtr> fdata(regions.size());
+  size_t total = 0;
+  ssize_t nread;
+
+  HT_DEBUGF("preadv count=%u", (unsigned)regions.size());
+
+  for (size_t i=0; i<regions.size(); i++) {
+    if (!m_open_file_map.get(regions[i].fd, fdata[i])) {
+      char errbuf[32];
+      sprintf(errbuf, "%d", regions[i].fd);
+      cb->error(Error::DFSBROKER_BAD_FILE_HANDLE, errbuf);
+      return;
+    }
+    total += regions[i].amount;
+  }
+
+  StaticBuffer buf(new uint8_t [total ? total : 1], total);
+  uint8_t *ptr = buf.base;
+
+  for (size_t i=0; i<regions.size(); i++) {
+    if ((nread = ceph_read(fdata[i]->fd, (char *)ptr, regions[i].amount,
+                           regions[i].offset)) < 0) {
+      HT_ERRORF("pread failed: fd=%d ceph_fd=%d amount=%d offset=%llu - %s",
+                regions[i].fd, fdata[i]->fd, (int)regions[i].amount,
+                (Llu)regions[i].offset, strerror(-nread));
+      report_error(cb, nread);
+      return;
+    }
+    regions[i].nread = nread;
+    ptr += regions[i].amount;
+  }
+
+  cb->response(regions, buf);
+}
+
 void CephBroker::mkdirs(ResponseCallback *cb, const char *dname) {
   String absdir;
 
@@ -79,6 +79,8 @@ namespace Hypertable {
     virtual void length(ResponseCallbackLength *cb, const char *fname);
     virtual void pread(ResponseCallbackRead *cb, uint32_t fd, uint64_t offset,
                        uint32_t amount);
+    virtual void preadv(ResponseCallbackPreadv *cb,
+                        std::vector<Filesystem::ReadRegion> &regions);
     virtual void mkdirs(ResponseCallback *cb, const char *dname);
     virtual void rmdir(ResponseCallback *cb, const char *dname);
     virtual void flush(ResponseCallback *cb, uint32_t fd);
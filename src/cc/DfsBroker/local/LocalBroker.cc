@@ -433,6 +433,69 @@ LocalBroker::pread(ResponseCallbackRead *cb, uint32_t fd, uint64_t offset,
 }
 
 
+void
+LocalBroker::preadv(ResponseCallbackPreadv *cb,
+                    std::vector<Filesystem::ReadRegion> &regions) {
+  std::vector<OpenFileDataLocalPtr> fdata(regions.size());
+  size_t total = 0;
+  ssize_t nread;
+  int error;
+
+  HT_DEBUGF("preadv count=%u", (unsigned)regions.size());
+
+  for (size_t i=0; i<regions.size(); i++) {
+    if (!m_open_file_map.get(regions[i].fd, fdata[i])) {
+      char errbuf[32];
+      sprintf(errbuf, "%d", regions[i].fd);
+      cb->error(Error::DFSBROKER_BAD_FILE_HANDLE, errbuf);
+      return;
+    }
+    total += regions[i].amount;
+  }
+
+#if defined(__linux__)
+  // Let the kernel start on all of the reads at once; the preads below then
+  // mostly wait on I/O that is already in flight
+  for (size_t i=0; i<regions.size(); i++)
+    posix_fadvise(fdata[i]->fd, (off_t)regions[i].offset,
+                  (off_t)regions[i].amount, POSIX_FADV_WILLNEED);
+#endif
+
+  StaticBuffer buf(new uint8_t [total ? total : 1], total);
+  uint8_t *ptr = buf.base;
+
+  for (size_t i=0; i<regions.size(); i++) {
+    if (m_directio && regions[i].amount) {
+      // direct i/o requires an aligned destination buffer
+      void *vptr = 0;
+      HT_ASSERT(posix_memalign(&vptr, HT_DIRECT_IO_ALIGNMENT,
+                               regions[i].amount) == 0);
+      nread = FileUtils::pread(fdata[i]->fd, vptr, regions[i].amount,
+                               (off_t)regions[i].offset);
+      if (nread > 0)
+        memcpy(ptr, vptr, nread);
+      free(vptr);
+    }
+    else
+      nread = FileUtils::pread(fdata[i]->fd, ptr, regions[i].amount,
+                               (off_t)regions[i].offset);
+    if (nread < 0) {
+      report_error(cb);
+      HT_ERRORF("pread failed: fd=%d amount=%d offset=%llu - %s",
+                fdata[i]->fd, (int)regions[i].amount,
+                (Llu)regions[i].offset, strerror(errno));
+      return;
+    }
+    regions[i].nread = nread;
+    ptr += regions[i].amount;
+  }
+
+  if ((error = cb->response(regions, buf)) != Error::OK)
+    HT_ERRORF("Problem sending response for preadv(count=%u) - %s",
+              (unsigned)regions.size(), Error::get_text(error));
+}
+
+
 void LocalBroker::mkdirs(ResponseCallback *cb, const char *dname) {
   String absdir;
   int error;
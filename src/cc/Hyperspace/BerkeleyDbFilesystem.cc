@@ -64,6 +64,71 @@ void close_db_cursor(Dbc **cursor) {
   }
 }
 
+namespace {
+  struct LogFlusherThread {
+    LogFlusherThread(LogFlusher *flusher) : m_flusher(flusher) { }
+    void operator()() { (*m_flusher)(); }
+    LogFlusher *m_flusher;
+  };
+}
+
+LogFlusher::LogFlusher(DbEnv *env)
+  : m_env(env), m_committed(0), m_flushed(0), m_shutdown(false) {
+  m_thread = new boost::thread(LogFlusherThread(this));
+}
+
+void LogFlusher::wait() {
+  ScopedLock lock(m_mutex);
+  // the caller's commit record is in the log buffer by now, so any flush
+  // that starts after this point covers it
+  uint64_t ticket = ++m_committed;
+  m_commit_cond.notify_one();
+  while (m_flushed < ticket)
+    m_flush_cond.wait(lock);
+}
+
+void LogFlusher::shutdown() {
+  {
+    ScopedLock lock(m_mutex);
+    if (m_thread == 0)
+      return;
+    m_shutdown = true;
+    m_commit_cond.notify_all();
+  }
+  m_thread->join();
+  delete m_thread;
+  m_thread = 0;
+}
+
+void LogFlusher::operator()() {
+  uint64_t committed;
+
+  while (true) {
+    {
+      ScopedLock lock(m_mutex);
+      while (m_flushed == m_committed && !m_shutdown)
+        m_commit_cond.wait(lock);
+      if (m_flushed == m_committed)
+        break;
+      committed = m_committed;
+    }
+
+    // commits that arrive during the flush are picked up by the next one
+    try {
+      m_env->log_flush(NULL);
+    }
+    catch (DbException &e) {
+      HT_FATALF("Error flushing Berkeley DB log: %s", e.what());
+    }
+
+    {
+      ScopedLock lock(m_mutex);
+      m_flushed = committed;
+      m_flush_cond.notify_all();
+    }
+  }
+}
+
 const char* BerkeleyDbFilesystem::ms_name_namespace_db = "namespace.db";
 const char* BerkeleyDbFilesystem::ms_name_state_db = "state.db";
 
@@ -74,8 +139,9 @@ BerkeleyDbFilesystem::BerkeleyDbFilesystem(PropertiesPtr &props,
                                            const std::string &basedir,
                                            const vector<Thread::id> &thread_ids,
                                            bool force_recover)
-    : m_base_dir(basedir), m_env(0) {
+    : m_base_dir(basedir), m_env(0), m_log_flusher(0) {
 
+  m_snapshot_reads = props->get_bool("Hyperspace.SnapshotReads");
   m_checkpoint_size = props->get_i32("Hyperspace.Checkpoint.Size");
   m_log_gc_interval = props->get_i32("Hyperspace.LogGc.Interval");
   m_max_unused_logs = props->get_i32("Hyperspace.LogGc.MaxUnusedLogs");
@@ -95,6 +161,8 @@ BerkeleyDbFilesystem::BerkeleyDbFilesystem(PropertiesPtr &props,
     env_flags |= DB_RECOVER_FATAL;
 
    m_db_flags = DB_CREATE | DB_AUTO_COMMIT | DB_THREAD;
+   if (m_snapshot_reads)
+     m_db_flags |= DB_MULTIVERSION;
 
   /**
    * Open Berkeley DB environment and namespace database
@@ -287,6 +355,9 @@ BerkeleyDbFilesystem::BerkeleyDbFilesystem(PropertiesPtr &props,
 
   // initialize per thread DB handles
   init_db_handles(thread_ids);
+
+  if (props->get_bool("Hyperspace.GroupCommit"))
+    m_log_flusher = new LogFlusher(&m_env);
   HT_DEBUG_OUT <<"namespace initialized"<< HT_END;
 }
 
@@ -296,6 +367,7 @@ BerkeleyDbFilesystem::~BerkeleyDbFilesystem() {
   /**
    * Close Berkeley DB "namespace" database and environment
    */
+  delete m_log_flusher;
   try {
     HT_INFO_OUT << "Closed DB handles for all threads " << HT_END;
     foreach(ThreadHandleMap::value_type &val, m_thread_handle_map) {
@@ -455,7 +527,7 @@ void BerkeleyDbFilesystem::do_checkpoint() {
 
 }
 
-void BerkeleyDbFilesystem::start_transaction(BDbTxn &txn) {
+void BerkeleyDbFilesystem::start_transaction(BDbTxn &txn, bool read_only) {
 
   // begin transaction
   try {
@@ -483,7 +555,14 @@ void BerkeleyDbFilesystem::start_transaction(BDbTxn &txn) {
     txn.m_handle_state_db = it->second->m_handle_state_db;
 
     // open txn
-    m_env.txn_begin(NULL, &txn.m_db_txn, 0);
+    if (read_only && m_snapshot_reads)
+      m_env.txn_begin(NULL, &txn.m_db_txn, DB_TXN_SNAPSHOT);
+    else {
+      m_env.txn_begin(NULL, &txn.m_db_txn, 0);
+      // read only txns write no commit record, nothing to flush
+      if (!read_only)
+        txn.m_log_flusher = m_log_flusher;
+    }
   }
   catch (DbException &e) {
     HT_FATALF("Error starting Berkeley DB transaction: %s", e.what());
@@ -120,13 +120,51 @@ namespace Hyperspace {
 
   typedef intrusive_ptr<BDbHandles> BDbHandlesPtr;
 
+  /**
+   * Group commit of write transactions.  Transactions commit with
+   * DB_TXN_WRITE_NOSYNC and then call wait(); a dedicated thread flushes
+   * the log once for all of the transactions that committed since its
+   * previous flush, so concurrent writers share the cost of a log sync.
+   */
+  class LogFlusher {
+  public:
+    LogFlusher(DbEnv *env);
+    ~LogFlusher() { shutdown(); }
+
+    /**
+     * Waits until the log has been flushed to disk up to (at least) the
+     * commit record of the calling thread's last transaction
+     */
+    void wait();
+
+    void shutdown();
+
+    void operator()();
+
+  private:
+    DbEnv *m_env;
+    Mutex m_mutex;
+    boost::condition m_commit_cond;
+    boost::condition m_flush_cond;
+    uint64_t m_committed;
+    uint64_t m_flushed;
+    bool m_shutdown;
+    boost::thread *m_thread;
+  };
+
   class BDbTxn{
   public:
-    BDbTxn(): m_handle_namespace_db(0), m_handle_state_db(0), m_db_txn(0) {}
+    BDbTxn(): m_handle_namespace_db(0), m_handle_state_db(0), m_db_txn(0),
+              m_log_flusher(0) {}
     ~BDbTxn() {}
 
     void commit(int flag=0) {
-      m_db_txn->commit(flag);
+      if (m_log_flusher && flag == 0) {
+        m_db_txn->commit(DB_TXN_WRITE_NOSYNC);
+        m_log_flusher->wait();
+      }
+      else
+        m_db_txn->commit(flag);
     }
 
     void abort() {
@@ -136,6 +174,8 @@ namespace Hyperspace {
     Db *m_handle_namespace_db;
     Db *m_handle_state_db;
     DbTxn *m_db_txn;
+    // set for write transactions when group commit is enabled
+    LogFlusher *m_log_flusher;
   };
 
   ostream &operator<<(ostream &out, const BDbTxn &txn);
@@ -170,10 +210,12 @@ namespace Hyperspace {
 
     /**
      * Creates a new BerkeleyDB transaction within the context of a parent
-     * transaction.
+     * transaction.  A read only transaction runs with snapshot isolation
+     * (if Hyperspace.SnapshotReads is set), so it reads without taking
+     * read locks and never blocks or is blocked by writers.
      *
      */
-    void start_transaction(BDbTxn &txn);
+    void start_transaction(BDbTxn &txn, bool read_only=false);
 
     bool get_xattr_i32(BDbTxn &txn, const String &fname,
                        const String &aname, uint32_t *valuep);
@@ -717,6 +759,8 @@ namespace Hyperspace {
     String m_base_dir;
     DbEnv  m_env;
     uint32_t m_db_flags;
+    bool m_snapshot_reads;
+    LogFlusher *m_log_flusher;
     static const char *ms_name_namespace_db;
     static const char *ms_name_state_db;
     typedef map<Thread::id, BDbHandlesPtr> ThreadHandleMap;
@@ -22,13 +22,17 @@
 #ifndef HYPERSPACE_CLIENTHANDLESTATE_H
 #define HYPERSPACE_CLIENTHANDLESTATE_H
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <boost/thread/condition.hpp>
+#include <boost/thread/xtime.hpp>
 
 #include "Common/ReferenceCount.h"
 #include "Common/Mutex.h"
 
+#include "DirEntry.h"
 #include "HandleCallback.h"
 #include "LockSequencer.h"
 
@@ -36,6 +40,38 @@ namespace Hyperspace {
 
   class ClientHandleState : public Hypertable::ReferenceCount {
   public:
+    ClientHandleState() : cache(false), cache_generation(0),
+                          listing_cached(false), listing_epoch(0) { }
+
+    /** Cached state of one attribute of the node */
+    struct CachedAttr {
+      bool exists;
+      bool has_value;     // false if only attr_exists() was answered
+      std::string value;
+      uint64_t epoch;     // Session cache epoch the entry was read in
+      boost::xtime expire;
+    };
+    typedef std::map<std::string, CachedAttr> CachedAttrMap;
+
+    /**
+     * Drops the cached state of an attribute.  Called when the master
+     * reports that the attribute was set or deleted, and after this
+     * session changes it.
+     */
+    void invalidate_attr(const std::string &name) {
+      ScopedLock lock(cache_mutex);
+      cache_generation++;
+      cached_attrs.erase(name);
+    }
+
+    /** Drops the cached directory listing */
+    void invalidate_listing() {
+      ScopedLock lock(cache_mutex);
+      cache_generation++;
+      listing_cached = false;
+      cached_listing.clear();
+    }
+
     uint64_t     handle;
     uint32_t     open_flags;
     uint32_t     event_mask;
@@ -47,6 +83,25 @@ namespace Hyperspace {
     uint64_t lock_generation;
     Mutex              mutex;
     boost::condition   cond;
+
+    /**
+     * Attribute values and directory listing of the node, kept when the
+     * handle was opened with Hyperspace.Client.Cache enabled.  The handle
+     * is then registered for the ATTR_SET, ATTR_DEL and CHILD_NODE_*
+     * events, which the master delivers (and waits for) before it
+     * acknowledges the change, so that entries are dropped before anyone
+     * can observe the new state.  Every invalidation bumps
+     * cache_generation, so a reply that raced with one is not cached.
+     * Entries also expire after the lease interval.
+     */
+    bool               cache;
+    Mutex              cache_mutex;
+    uint64_t           cache_generation;
+    CachedAttrMap      cached_attrs;
+    bool               listing_cached;
+    uint64_t           listing_epoch;
+    boost::xtime       listing_expire;
+    std::vector<DirEntry> cached_listing;
   };
   typedef boost::intrusive_ptr<ClientHandleState> ClientHandleStatePtr;
 
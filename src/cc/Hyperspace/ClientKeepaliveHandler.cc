@@ -273,10 +273,21 @@ void ClientKeepaliveHandler::handle(Hypertable::EventPtr &event) {
                 event_mask == EVENT_MASK_CHILD_NODE_REMOVED) {
               name = decode_vstr(&decode_ptr, &decode_remain);
 
+              // drop cached entries before the event is acknowledged
+              if (handle_state->cache) {
+                if (event_mask == EVENT_MASK_ATTR_SET ||
+                    event_mask == EVENT_MASK_ATTR_DEL)
+                  handle_state->invalidate_attr(name);
+                else
+                  handle_state->invalidate_listing();
+              }
+
               if (event_id <= m_last_known_event)
                 continue;
 
-              if (handle_state->callback) {
+              // cached handles also receive events their callback did not ask for
+              if (handle_state->callback &&
+                  (handle_state->event_mask & event_mask)) {
                 if (event_mask == EVENT_MASK_ATTR_SET)
                   handle_state->callback->attr_set(name);
                 else if (event_mask == EVENT_MASK_ATTR_DEL)
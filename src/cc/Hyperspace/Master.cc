@@ -69,6 +69,17 @@ using namespace std;
     m_bdb_fs->start_transaction(txn); \
     try
 
+/**
+ * Same as HT_BDBTXN_BEGIN, for requests that only read: the transaction
+ * runs with snapshot isolation and is not part of group commit
+ */
+#define HT_BDBTXN_READ_BEGIN() \
+  do { \
+    BDbTxn txn;\
+    HT_ASSERT(is_master());\
+    m_bdb_fs->start_transaction(txn, true); \
+    try
+
 #define HT_BDBTXN_END_CB(_cb_) \
     catch (Exception &e) { \
       if (e.code() == Error::HYPERSPACE_BERKELEYDB_DEADLOCK) { \
@@ -1084,7 +1095,7 @@ Master::attr_get(ResponseCallbackAttrGet *cb, uint64_t session_id,
     HT_INFOF("attrget(session=%llu(%s), handle=%llu, name=%s)",
              (Llu)session_id, session_data->get_name(), (Llu)handle, name);
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
     // (re) initialize vars
     aborted = false; commited = false;
 
@@ -1146,6 +1157,7 @@ Master::attr_get(ResponseCallbackAttrGet *cb, uint64_t session_id,
  * > Start BDB txn
  *   > Lock node data
  *   > atomically increment attribute in BDB
+ *   > Deliver ATTR_SET event notifications, if anyone asked for them
  * > End BDB txn
  * > Send previous attr value back in response
  *
@@ -1159,6 +1171,10 @@ Master::attr_incr(ResponseCallbackAttrIncr *cb, uint64_t session_id,
   bool aborted=false, commited=false;
   String error_msg;
   uint64_t attr_val;
+  uint64_t event_id;
+  HyperspaceEventPtr attr_set_event;
+  NotificationMap attr_set_notifications;
+  bool persisted_notifications = false;
 
   if (!get_session(session_id, session_data))
     HT_THROWF(Error::HYPERSPACE_EXPIRED_SESSION, "%llu", (Llu)session_id);
@@ -1169,7 +1185,8 @@ Master::attr_incr(ResponseCallbackAttrIncr *cb, uint64_t session_id,
 
   HT_BDBTXN_BEGIN() {
     // (re) initialize vars
-    aborted = false; commited = false;
+    persisted_notifications = false; aborted = false; commited = false;
+    attr_set_notifications.clear();
 
     // make sure session is still valid
     if (!m_bdb_fs->session_exists(txn, session_id)) {
@@ -1194,6 +1211,17 @@ Master::attr_incr(ResponseCallbackAttrIncr *cb, uint64_t session_id,
       goto txn_commit;
     }
 
+    // counters are bumped often, so only create the event when some
+    // handle (e.g. a cached one) has to hear about it
+    if (m_bdb_fs->get_node_event_notification_map(txn, node, EVENT_MASK_ATTR_SET,
+                                                  attr_set_notifications)) {
+      event_id = m_bdb_fs->get_next_id_i64(txn, EVENT_ID, true);
+      m_bdb_fs->create_event(txn, EVENT_TYPE_NAMED, event_id, EVENT_MASK_ATTR_SET, name);
+      attr_set_event = new EventNamed(event_id, EVENT_MASK_ATTR_SET, name);
+      persist_event_notifications(txn, event_id, attr_set_notifications);
+      persisted_notifications = true;
+    }
+
     txn_commit:
       if (aborted)
         txn.abort();
@@ -1212,6 +1240,10 @@ Master::attr_incr(ResponseCallbackAttrIncr *cb, uint64_t session_id,
     return;
   }
 
+  // deliver notifications
+  if (commited && persisted_notifications)
+    deliver_event_notifications(attr_set_event, attr_set_notifications);
+
   HT_DEBUG_OUT << "attrincr(session=" << session_id << ", handle=" << handle << ", name='"
                << name << "', value="<< attr_val << HT_END;
 
@@ -1326,7 +1358,7 @@ Master::attr_exists(ResponseCallbackAttrExists *cb, uint64_t session_id, uint64_
   if (!get_session(session_id, session_data))
     HT_THROWF(Error::HYPERSPACE_EXPIRED_SESSION, "%llu", (Llu)session_id);
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
     // (re) initialize vars
     aborted = false; exists = false;
 
@@ -1387,7 +1419,7 @@ Master::attr_list(ResponseCallbackAttrList *cb, uint64_t session_id, uint64_t ha
     HT_THROWF(Error::HYPERSPACE_EXPIRED_SESSION, "%llu", (Llu)session_id);
 
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
     aborted = false;
 
     // make sure session is still valid
@@ -1452,7 +1484,7 @@ Master::exists(ResponseCallbackExists *cb, uint64_t session_id,
 
   HT_ASSERT(name[0] == '/' && name[strlen(name)-1] != '/');
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
     file_exists = m_bdb_fs->exists(txn, name);
     txn.commit(0);
   }
@@ -1495,7 +1527,7 @@ Master::readdir(ResponseCallbackReaddir *cb, uint64_t session_id,
     HT_INFOF("readdir(session=%llu(%s), handle=%llu)",
              (Llu)session_id, session_data->get_name(),(Llu)handle);
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
 
     // make sure session is still valid
     if (!m_bdb_fs->session_exists(txn, session_id)) {
@@ -1564,7 +1596,7 @@ Master::readdir_attr(ResponseCallbackReaddirAttr *cb, uint64_t session_id,
     HT_INFOF("readdir_attr(session=%llu(%s), handle=%llu, attr=%s)",
              (Llu)session_id, session_data->get_name(),(Llu)handle, name);
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
 
     // make sure session is still valid
     if (!m_bdb_fs->session_exists(txn, session_id)) {
@@ -1634,7 +1666,7 @@ Master::readpath_attr(ResponseCallbackReadpathAttr *cb, uint64_t session_id,
     HT_INFOF("readpath_attr(session=%llu(%s), handle=%llu, attr=%s)",
              (Llu)session_id, session_data->get_name(),(Llu)handle, name);
 
-  HT_BDBTXN_BEGIN() {
+  HT_BDBTXN_READ_BEGIN() {
     size_t pos = 0;
     String path_component;
     DynamicBuffer attr_buf;
@@ -1703,6 +1735,253 @@ Master::readpath_attr(ResponseCallbackReadpathAttr *cb, uint64_t session_id,
   cb->response(listing);
 }
 
+/**
+ * multi does the following:
+ *
+ * > Make sure session is valid
+ * > Start BDB txn
+ *   > Run each operation, stopping at the first one that fails
+ *   > Persist the event notifications of the operations
+ * > End BDB txn (aborted if an operation failed)
+ * > Deliver notifications
+ * > Send back the results of the operations
+ *
+ */
+void
+Master::multi(ResponseCallbackMulti *cb, uint64_t session_id,
+              std::vector<MultiOp> &ops) {
+  SessionDataPtr session_data;
+  PendingEventVec events;
+  bool aborted = false, commited = false;
+  int error = 0;
+  String error_msg;
+
+  if (!get_session(session_id, session_data))
+    HT_THROWF(Error::HYPERSPACE_EXPIRED_SESSION, "%llu", (Llu)session_id);
+
+  if (m_verbose)
+    HT_INFOF("multi(session=%llu(%s), ops=%d)", (Llu)session_id,
+             session_data->get_name(), (int)ops.size());
+
+  HT_BDBTXN_BEGIN() {
+    // (re) initialize vars
+    aborted = false; commited = false;
+    events.clear();
+
+    // make sure session is still valid
+    if (!m_bdb_fs->session_exists(txn, session_id)) {
+      error = Error::HYPERSPACE_EXPIRED_SESSION;
+      error_msg = (String) "session:" + session_id;
+      aborted = true;
+      goto txn_commit;
+    }
+
+    for (size_t i=0; i<ops.size(); i++) {
+      if (!multi_op(txn, ops[i], events, error, error_msg)) {
+        error_msg = format("operation %d (%s '%s') - %s", (int)i,
+                           MultiOp::type_str(ops[i].type), ops[i].name.c_str(),
+                           error_msg.c_str());
+        aborted = true;
+        goto txn_commit;
+      }
+    }
+
+    txn_commit:
+      if (aborted)
+        txn.abort();
+      else {
+        txn.commit(0);
+        commited = true;
+      }
+  }
+  HT_BDBTXN_END_CB(cb);
+
+  if (aborted) {
+    HT_DEBUG_OUT << "multi(session=" << session_id << ") ERROR = "
+                 << Error::get_text(error) << " " << error_msg << HT_END;
+    cb->error(error, error_msg);
+    return;
+  }
+
+  // deliver notifications
+  if (commited) {
+    foreach(PendingEvent &pending, events)
+      deliver_event_notifications(pending.first, pending.second);
+  }
+
+  if ((error = cb->response(ops)) != Error::OK)
+    HT_ERRORF("Problem sending back response - %s", Error::get_text(error));
+}
+
+/**
+ * Runs one operation of a multi request within the given txn, with the
+ * same checks and events as the corresponding single request.  Returns
+ * false, with error and error_msg set, if the operation fails.
+ */
+bool
+Master::multi_op(BDbTxn &txn, MultiOp &op, PendingEventVec &events,
+                 int &error, String &error_msg) {
+  bool optional = (op.flags & MultiOp::FLAG_OPTIONAL) != 0;
+  String parent_node, child_name;
+  DynamicBuffer dbuf;
+
+  op.exists = false;
+  op.number = 0;
+  if (op.type == MultiOp::ATTR_GET)
+    op.value.clear();
+
+  if (op.name.empty() || op.name[0] != '/' ||
+      (op.name.length() > 1 && op.name[op.name.length()-1] == '/')) {
+    error = Error::HYPERSPACE_BAD_PATHNAME;
+    error_msg = "bad pathname";
+    return false;
+  }
+
+  switch (op.type) {
+  case MultiOp::MKDIR:
+  case MultiOp::CREATE:
+    if ((op.exists = m_bdb_fs->exists(txn, op.name))) {
+      if (optional)
+        return true;
+      error = Error::HYPERSPACE_FILE_EXISTS;
+      error_msg = "node exists";
+      return false;
+    }
+    find_parent_node(op.name, parent_node, child_name);
+    if (!validate_and_create_node_data(txn, parent_node)) {
+      error = Error::HYPERSPACE_FILE_NOT_FOUND;
+      error_msg = (String)"parent node: '" + parent_node + "'";
+      return false;
+    }
+    if (op.type == MultiOp::MKDIR)
+      m_bdb_fs->mkdir(txn, op.name);
+    else {
+      m_bdb_fs->create(txn, op.name, false);
+      m_bdb_fs->set_xattr_i64(txn, op.name, "lock.generation", 1);
+    }
+    m_bdb_fs->create_node(txn, op.name, false, 1);
+    persist_named_event(txn, parent_node, EVENT_MASK_CHILD_NODE_ADDED,
+                        child_name, events);
+    return true;
+
+  case MultiOp::DELETE:
+    if (op.name == "/") {
+      error = Error::HYPERSPACE_PERMISSION_DENIED;
+      error_msg = "Cannot remove '/' directory";
+      return false;
+    }
+    find_parent_node(op.name, parent_node, child_name);
+    if (!validate_and_create_node_data(txn, parent_node) ||
+        !validate_and_create_node_data(txn, op.name)) {
+      if (optional)
+        return true;
+      error = Error::HYPERSPACE_FILE_NOT_FOUND;
+      error_msg = "node does not exist";
+      return false;
+    }
+    op.exists = true;
+    if (m_bdb_fs->node_has_open_handles(txn, op.name)) {
+      error = Error::HYPERSPACE_FILE_OPEN;
+      error_msg = "File is still open and referred to by some handle";
+      return false;
+    }
+    persist_named_event(txn, parent_node, EVENT_MASK_CHILD_NODE_REMOVED,
+                        child_name, events);
+    m_bdb_fs->unlink(txn, op.name);
+    m_bdb_fs->delete_node(txn, op.name);
+    return true;
+
+  case MultiOp::EXISTS:
+    op.exists = m_bdb_fs->exists(txn, op.name);
+    return true;
+
+  case MultiOp::ATTR_SET:
+  case MultiOp::ATTR_GET:
+  case MultiOp::ATTR_INCR:
+  case MultiOp::ATTR_EXISTS:
+  case MultiOp::ATTR_DEL:
+    if (!validate_and_create_node_data(txn, op.name)) {
+      if (optional && op.type != MultiOp::ATTR_SET &&
+          op.type != MultiOp::ATTR_INCR)
+        return true;
+      error = Error::HYPERSPACE_FILE_NOT_FOUND;
+      error_msg = "node does not exist";
+      return false;
+    }
+    break;
+
+  default:
+    error = Error::PROTOCOL_ERROR;
+    error_msg = format("unknown operation type %u", op.type);
+    return false;
+  }
+
+  if (op.type == MultiOp::ATTR_SET) {
+    m_bdb_fs->set_xattr(txn, op.name, op.attr, op.value.data(),
+                        op.value.length());
+    persist_named_event(txn, op.name, EVENT_MASK_ATTR_SET, op.attr, events);
+    return true;
+  }
+
+  if (op.type == MultiOp::ATTR_INCR) {
+    if (!m_bdb_fs->incr_attr(txn, op.name, op.attr, &op.number)) {
+      error = Error::HYPERSPACE_ATTR_NOT_FOUND;
+      error_msg = op.attr;
+      return false;
+    }
+    op.exists = true;
+    persist_named_event(txn, op.name, EVENT_MASK_ATTR_SET, op.attr, events);
+    return true;
+  }
+
+  if (op.type == MultiOp::ATTR_GET) {
+    if ((op.exists = m_bdb_fs->get_xattr(txn, op.name, op.attr, dbuf)))
+      op.value.assign((const char *)dbuf.base, dbuf.fill());
+    else if (!optional) {
+      error = Error::HYPERSPACE_ATTR_NOT_FOUND;
+      error_msg = op.attr;
+      return false;
+    }
+    return true;
+  }
+
+  op.exists = m_bdb_fs->exists_xattr(txn, op.name, op.attr);
+
+  if (op.type == MultiOp::ATTR_DEL) {
+    if (!op.exists) {
+      if (optional)
+        return true;
+      error = Error::HYPERSPACE_ATTR_NOT_FOUND;
+      error_msg = op.attr;
+      return false;
+    }
+    m_bdb_fs->del_xattr(txn, op.name, op.attr);
+    persist_named_event(txn, op.name, EVENT_MASK_ATTR_DEL, op.attr, events);
+  }
+  return true;
+}
+
+/**
+ * Creates a named event on <code>node</code> and persists its
+ * notifications, if any handle has asked for it.  The event is added to
+ * <code>events</code> to be delivered once the txn commits.
+ */
+void
+Master::persist_named_event(BDbTxn &txn, const String &node,
+                            uint32_t event_mask, const String &name,
+                            PendingEventVec &events) {
+  NotificationMap notifications;
+
+  if (m_bdb_fs->get_node_event_notification_map(txn, node, event_mask,
+                                                notifications)) {
+    uint64_t event_id = m_bdb_fs->get_next_id_i64(txn, EVENT_ID, true);
+    m_bdb_fs->create_event(txn, EVENT_TYPE_NAMED, event_id, event_mask, name);
+    persist_event_notifications(txn, event_id, notifications);
+    events.push_back(PendingEvent(new EventNamed(event_id, event_mask, name),
+                                  notifications));
+  }
+}
+
 /**
  * lock
  */
@@ -46,6 +46,7 @@
 #include "ResponseCallbackAttrExists.h"
 #include "ResponseCallbackAttrList.h"
 #include "ResponseCallbackLock.h"
+#include "ResponseCallbackMulti.h"
 #include "ResponseCallbackReaddir.h"
 #include "ResponseCallbackReaddirAttr.h"
 #include "ResponseCallbackReadpathAttr.h"
@@ -112,6 +113,8 @@ namespace Hyperspace {
     void lock(ResponseCallbackLock *cb, uint64_t session_id, uint64_t handle,
               uint32_t mode, bool try_lock);
     void release(ResponseCallback *cb, uint64_t session_id, uint64_t handle);
+    void multi(ResponseCallbackMulti *cb, uint64_t session_id,
+               std::vector<MultiOp> &ops);
 
     /**
      * Creates a new session by allocating a new SessionData object, obtaining a
@@ -207,6 +210,15 @@ namespace Hyperspace {
         HyperspaceEventPtr &lock_acquired_event, NotificationMap &lock_acquired_notifications);
     void recover_state();
 
+    typedef std::pair<HyperspaceEventPtr, NotificationMap> PendingEvent;
+    typedef std::vector<PendingEvent> PendingEventVec;
+
+    bool multi_op(BDbTxn &txn, MultiOp &op, PendingEventVec &events,
+                  int &error, String &error_msg);
+    void persist_named_event(BDbTxn &txn, const String &node,
+                             uint32_t event_mask, const String &name,
+                             PendingEventVec &events);
+
     typedef std::vector<SessionDataPtr> SessionDataVec;
     typedef hash_map<uint64_t, SessionDataPtr> SessionMap;
 
@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Serialization.h"
+#include "Common/Logger.h"
+
+#include "MultiOp.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+
+namespace {
+
+  const char *type_strs[] = {
+    "unknown", "mkdir", "create", "delete", "exists", "attr_set",
+    "attr_get", "attr_incr", "attr_exists", "attr_del"
+  };
+
+  inline bool has_value(uint32_t type, bool result) {
+    return result ? type == Hyperspace::MultiOp::ATTR_GET
+                  : type == Hyperspace::MultiOp::ATTR_SET;
+  }
+
+}
+
+namespace Hyperspace {
+
+  const char *MultiOp::type_str(uint32_t type) {
+    return (type < TYPE_MAX) ? type_strs[type] : type_strs[0];
+  }
+
+  size_t encoded_length_multi_op(const MultiOp &op) {
+    size_t len = 8 + encoded_length_vstr(op.name) + encoded_length_vstr(op.attr);
+    if (has_value(op.type, false))
+      len += 4 + op.value.length();
+    return len;
+  }
+
+  void encode_multi_op(uint8_t **bufp, const MultiOp &op) {
+    encode_i32(bufp, op.type);
+    encode_i32(bufp, op.flags);
+    encode_vstr(bufp, op.name);
+    encode_vstr(bufp, op.attr);
+    if (has_value(op.type, false))
+      encode_bytes32(bufp, op.value.data(), op.value.length());
+  }
+
+  MultiOp &
+  decode_multi_op(const uint8_t **bufp, size_t *remainp, MultiOp &op) {
+    HT_TRY("decoding multi op",
+      op.type = decode_i32(bufp, remainp);
+      op.flags = decode_i32(bufp, remainp);
+      op.name = decode_vstr(bufp, remainp);
+      op.attr = decode_vstr(bufp, remainp);
+      op.value.clear();
+      if (has_value(op.type, false)) {
+        uint32_t len;
+        const char *value = (const char *)decode_bytes32(bufp, remainp, &len);
+        op.value.assign(value, len);
+      });
+    return op;
+  }
+
+  size_t encoded_length_multi_op_result(const MultiOp &op) {
+    size_t len = 9;
+    if (has_value(op.type, true))
+      len += 4 + op.value.length();
+    return len;
+  }
+
+  void encode_multi_op_result(uint8_t **bufp, const MultiOp &op) {
+    encode_bool(bufp, op.exists);
+    encode_i64(bufp, op.number);
+    if (has_value(op.type, true))
+      encode_bytes32(bufp, op.value.data(), op.value.length());
+  }
+
+  MultiOp &
+  decode_multi_op_result(const uint8_t **bufp, size_t *remainp, MultiOp &op) {
+    HT_TRY("decoding multi op result",
+      op.exists = decode_bool(bufp, remainp);
+      op.number = decode_i64(bufp, remainp);
+      if (has_value(op.type, true)) {
+        uint32_t len;
+        const char *value = (const char *)decode_bytes32(bufp, remainp, &len);
+        op.value.assign(value, len);
+      });
+    return op;
+  }
+
+}
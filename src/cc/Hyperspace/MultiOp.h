@@ -0,0 +1,143 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERSPACE_MULTIOP_H
+#define HYPERSPACE_MULTIOP_H
+
+#include <string>
+
+namespace Hyperspace {
+
+  /**
+   * One operation of a Session::multi() request.  Operations name their
+   * node by absolute path instead of by handle, and the master executes
+   * all of the operations of a request in a single BerkeleyDB transaction:
+   * either all of them take effect or, if one of them fails, none does.
+   * The <code>exists</code>, <code>number</code> and <code>value</code>
+   * members receive the results.
+   */
+  class MultiOp {
+  public:
+    enum {
+      /** Create directory <i>name</i> */
+      MKDIR = 1,
+      /** Create (empty) file <i>name</i> */
+      CREATE,
+      /** Delete file or directory <i>name</i> */
+      DELETE,
+      /** Check whether node <i>name</i> exists */
+      EXISTS,
+      /** Set attribute <i>attr</i> of <i>name</i> to <i>value</i> */
+      ATTR_SET,
+      /** Get attribute <i>attr</i> of <i>name</i> into <i>value</i> */
+      ATTR_GET,
+      /** Increment attribute <i>attr</i> of <i>name</i>, old value into
+       * <i>number</i> */
+      ATTR_INCR,
+      /** Check whether attribute <i>attr</i> of <i>name</i> exists */
+      ATTR_EXISTS,
+      /** Delete attribute <i>attr</i> of <i>name</i> */
+      ATTR_DEL,
+      TYPE_MAX
+    };
+
+    enum {
+      /**
+       * Don't fail if the operation has nothing to do: MKDIR and CREATE
+       * leave an existing node alone, DELETE and ATTR_DEL skip a missing
+       * node or attribute, and ATTR_GET and ATTR_EXISTS report a missing
+       * one through <code>exists</code>.
+       */
+      FLAG_OPTIONAL = 0x0001
+    };
+
+    MultiOp() : type(0), flags(0), exists(false), number(0) { }
+
+    MultiOp(uint32_t type_, const std::string &name_, uint32_t flags_=0)
+      : type(type_), flags(flags_), name(name_), exists(false), number(0) { }
+
+    MultiOp(uint32_t type_, const std::string &name_, const std::string &attr_,
+            uint32_t flags_=0)
+      : type(type_), flags(flags_), name(name_), attr(attr_), exists(false),
+        number(0) { }
+
+    MultiOp(uint32_t type_, const std::string &name_, const std::string &attr_,
+            const std::string &value_, uint32_t flags_=0)
+      : type(type_), flags(flags_), name(name_), attr(attr_), value(value_),
+        exists(false), number(0) { }
+
+    /** Returns the name of an operation type, for messages */
+    static const char *type_str(uint32_t type);
+
+    uint32_t type;
+    uint32_t flags;
+    std::string name;
+    std::string attr;
+    /** Value to set (ATTR_SET) or value read (ATTR_GET) */
+    std::string value;
+
+    /** Whether the node (or attribute) existed before the operation */
+    bool exists;
+    /** Value of the attribute before an ATTR_INCR */
+    uint64_t number;
+  };
+
+  /** Returns the number of bytes required to encode the request part of
+   * the given operation.
+   */
+  size_t encoded_length_multi_op(const MultiOp &op);
+
+  /** Encodes the request part of an operation (type, flags, name, attr and,
+   * for ATTR_SET, value) to a buffer.
+   *
+   * @param bufp address of pointer to buffer (advanced after encode)
+   * @param op the operation to encode
+   */
+  void encode_multi_op(uint8_t **bufp, const MultiOp &op);
+
+  /** Decodes the request part of an operation.
+   *
+   * @param bufp address of pointer to buffer (advanced after decode)
+   * @param remainp address of count of bytes remaining in buffer
+   *        (decremented after decode)
+   * @param op the operation to decode into
+   */
+  MultiOp &decode_multi_op(const uint8_t **bufp, size_t *remainp, MultiOp &op);
+
+  /** Returns the number of bytes required to encode the results of the
+   * given operation.
+   */
+  size_t encoded_length_multi_op_result(const MultiOp &op);
+
+  /** Encodes the results (exists, number and, for ATTR_GET, value) of an
+   * operation to a buffer.
+   */
+  void encode_multi_op_result(uint8_t **bufp, const MultiOp &op);
+
+  /** Decodes the results of an operation into <code>op</code>, which holds
+   * the request.
+   */
+  MultiOp &decode_multi_op_result(const uint8_t **bufp, size_t *remainp,
+                                  MultiOp &op);
+
+}
+
+#endif // HYPERSPACE_MULTIOP_H
@@ -48,19 +48,21 @@ const char *Hyperspace::Protocol::command_strs[COMMAND_MAX] = {
   "mkdir",
   "attrset",
   "attrget",
-  "attrincr",
   "attrdel",
-  "attrlist",
   "attrexists",
+  "attrlist",
   "exists",
   "delete",
   "readdir",
-  "readdirattr",
-  "readpathattr",
   "lock",
   "release",
   "checksequencer",
-  "status"
+  "status",
+  "redirect",
+  "readdirattr",
+  "attrincr",
+  "readpathattr",
+  "multi"
 };
 
 
@@ -152,7 +154,7 @@ CommBuf *Hyperspace::Protocol::create_handshake_request(uint64_t session_id,
  */
 CommBuf *
 Hyperspace::Protocol::create_open_request(const std::string &name,
-    uint32_t flags, HandleCallbackPtr &callback,
+    uint32_t flags, uint32_t event_mask,
     std::vector<Attribute> &init_attrs) {
   size_t len = 12 + encoded_length_vstr(name.size());
   CommHeader header(COMMAND_OPEN);
@@ -163,10 +165,7 @@ Hyperspace::Protocol::create_open_request(const std::string &name,
   CommBuf *cbuf = new CommBuf(header, len);
 
   cbuf->append_i32(flags);
-  if (callback)
-    cbuf->append_i32(callback->get_event_mask());
-  else
-    cbuf->append_i32(0);
+  cbuf->append_i32(event_mask);
   cbuf->append_vstr(name);
 
   // append initial attributes
@@ -335,6 +334,19 @@ CommBuf *Hyperspace::Protocol::create_release_request(uint64_t handle) {
 /**
  *
  */
+CommBuf *
+Hyperspace::Protocol::create_multi_request(const std::vector<MultiOp> &ops) {
+  CommHeader header(COMMAND_MULTI);
+  size_t len = 4;
+  foreach(const MultiOp &op, ops)
+    len += encoded_length_multi_op(op);
+  CommBuf *cbuf = new CommBuf(header, len);
+  cbuf->append_i32(ops.size());
+  foreach(const MultiOp &op, ops)
+    encode_multi_op(cbuf->get_data_ptr_address(), op);
+  return cbuf;
+}
+
 CommBuf *Hyperspace::Protocol::create_status_request() {
   CommHeader header(COMMAND_STATUS);
   header.flags |= CommHeader::FLAGS_BIT_URGENT;
@@ -27,6 +27,7 @@
 #include "AsyncComm/Protocol.h"
 
 #include "HandleCallback.h"
+#include "MultiOp.h"
 #include "Notification.h"
 #include "SessionData.h"
 
@@ -64,7 +65,7 @@ namespace Hyperspace {
     static CommBuf *create_handshake_request(uint64_t session_id, const std::string &name);
     static CommBuf *
     create_open_request(const std::string &name, uint32_t flags,
-        HandleCallbackPtr &callback, std::vector<Attribute> &init_attrs);
+        uint32_t event_mask, std::vector<Attribute> &init_attrs);
     static CommBuf *create_close_request(uint64_t handle);
     static CommBuf *create_mkdir_request(const std::string &name);
     static CommBuf *create_delete_request(const std::string &name);
@@ -93,6 +94,7 @@ namespace Hyperspace {
                               const void *value, size_t value_len);
 
     static CommBuf *create_status_request();
+    static CommBuf *create_multi_request(const std::vector<MultiOp> &ops);
 
     static const uint64_t COMMAND_KEEPALIVE      = 0;
     static const uint64_t COMMAND_HANDSHAKE      = 1;
@@ -118,7 +120,8 @@ namespace Hyperspace {
     static const uint64_t COMMAND_READDIRATTR    = 21;
     static const uint64_t COMMAND_ATTRINCR       = 22;
     static const uint64_t COMMAND_READPATHATTR   = 23;
-    static const uint64_t COMMAND_MAX            = 24;
+    static const uint64_t COMMAND_MULTI          = 24;
+    static const uint64_t COMMAND_MAX            = 25;
 
     static const char * command_strs[COMMAND_MAX];
 
@@ -34,6 +34,7 @@
 #include "RequestHandlerAttrExists.h"
 #include "RequestHandlerAttrList.h"
 #include "RequestHandlerMkdir.h"
+#include "RequestHandlerMulti.h"
 #include "RequestHandlerDelete.h"
 #include "RequestHandlerOpen.h"
 #include "RequestHandlerClose.h"
@@ -164,6 +165,10 @@ void ServerConnectionHandler::handle(EventPtr &event) {
         handler = new RequestHandlerRelease(m_comm, m_master_ptr.get(),
                                             m_session_id, event);
         break;
+      case Protocol::COMMAND_MULTI:
+        handler = new RequestHandlerMulti(m_comm, m_master_ptr.get(),
+                                          m_session_id, event);
+        break;
       case Protocol::COMMAND_STATUS:
         handler = new RequestHandlerStatus(m_comm, m_master_ptr.get(),
                                            m_session_id, event);
@@ -49,7 +49,8 @@ using namespace Serialization;
 
 Session::Session(Comm *comm, PropertiesPtr &cfg)
   : m_comm(comm), m_cfg(cfg), m_verbose(false), m_silent(false),
-    m_state(STATE_JEOPARDY), m_last_callback_id(0) {
+    m_state(STATE_JEOPARDY), m_last_callback_id(0), m_cache(false),
+    m_cache_epoch(0), m_request_count(0) {
 
   HT_TRY("getting config values",
     m_verbose = cfg->get_bool("Hypertable.Verbose");
@@ -57,7 +58,8 @@ Session::Session(Comm *comm, PropertiesPtr &cfg)
     m_grace_period = cfg->get_i32("Hyperspace.GracePeriod");
     m_lease_interval = cfg->get_i32("Hyperspace.Lease.Interval");
     m_hyperspace_port = cfg->get_i16("Hyperspace.Replica.Port");
-    m_reconnect = cfg->get_bool("Hyperspace.Session.Reconnect"));
+    m_reconnect = cfg->get_bool("Hyperspace.Session.Reconnect");
+    m_cache = cfg->get_bool("Hyperspace.Client.Cache", false));
 
   foreach(const String &replica, cfg->get_strs("Hyperspace.Replica.Host")) {
     m_hyperspace_replicas.push_back(replica);
@@ -160,11 +162,12 @@ Session::open(const std::string &name, uint32_t flags,
   handle_state->open_flags = flags;
   handle_state->event_mask = (callback) ? callback->get_event_mask() : 0;
   handle_state->callback = callback;
+  handle_state->cache = m_cache;
 
   normalize_name(name, handle_state->normal_name);
 
   CommBufPtr cbuf_ptr(Protocol::create_open_request(handle_state->normal_name,
-                      flags, callback, empty_attrs));
+                      flags, server_event_mask(handle_state), empty_attrs));
 
   return open(handle_state, cbuf_ptr, timer);
 }
@@ -185,15 +188,57 @@ Session::create(const std::string &name, uint32_t flags,
   handle_state->open_flags = flags | OPEN_FLAG_CREATE | OPEN_FLAG_EXCL;
   handle_state->event_mask = (callback) ? callback->get_event_mask() : 0;
   handle_state->callback = callback;
+  handle_state->cache = m_cache;
   normalize_name(name, handle_state->normal_name);
 
   CommBufPtr cbuf_ptr(Protocol::create_open_request(handle_state->normal_name,
-                      handle_state->open_flags, callback, init_attrs));
+                      handle_state->open_flags, server_event_mask(handle_state),
+                      init_attrs));
 
   return open(handle_state, cbuf_ptr, timer);
 }
 
 
+/**
+ * Returns the events the master is asked to deliver for a handle: the ones
+ * its callback wants plus, if the handle is cached, the ones that
+ * invalidate the cache.  ClientKeepaliveHandler only passes the former on
+ * to the callback.
+ */
+uint32_t Session::server_event_mask(ClientHandleStatePtr &handle_state) {
+  uint32_t event_mask = handle_state->event_mask;
+
+  if (handle_state->cache)
+    event_mask |= EVENT_MASK_ATTR_SET | EVENT_MASK_ATTR_DEL |
+        EVENT_MASK_CHILD_NODE_ADDED | EVENT_MASK_CHILD_NODE_REMOVED;
+  return event_mask;
+}
+
+
+/**
+ * Looks up the state of a cached handle.  Returns false if the handle is
+ * not cached or the session is not safe, in which case reads go to the
+ * master.  Otherwise *epochp is set to the current cache epoch, which
+ * changes whenever the session leaves the safe state.
+ */
+bool Session::get_cached_handle(uint64_t handle,
+    ClientHandleStatePtr &handle_state, uint64_t *epochp) {
+
+  if (!m_cache)
+    return false;
+
+  {
+    ScopedLock lock(m_mutex);
+    if (m_state != STATE_SAFE)
+      return false;
+    *epochp = m_cache_epoch;
+  }
+
+  return m_keepalive_handler_ptr->get_handle_state(handle, handle_state) &&
+      handle_state->cache;
+}
+
+
 /**
  *
  */
@@ -314,6 +359,51 @@ void Session::unlink(const std::string &name, Timer *timer) {
 }
 
 
+void Session::multi(std::vector<MultiOp> &ops, Timer *timer) {
+  DispatchHandlerSynchronizer sync_handler;
+  Hypertable::EventPtr event_ptr;
+  String normal_name;
+
+  foreach(MultiOp &op, ops) {
+    normalize_name(op.name, normal_name);
+    op.name = normal_name;
+  }
+
+  CommBufPtr cbuf_ptr(Protocol::create_multi_request(ops));
+
+ try_again:
+  if (!wait_for_safe())
+    HT_THROW(Error::HYPERSPACE_EXPIRED_SESSION, "");
+
+  int error = send_message(cbuf_ptr, &sync_handler, timer);
+  if (error == Error::OK) {
+    if (!sync_handler.wait_for_reply(event_ptr))
+      HT_THROW((int)Protocol::response_code(event_ptr.get()),
+               Protocol::string_format_message(event_ptr).c_str());
+    else {
+      const uint8_t *decode_ptr = event_ptr->payload + 4;
+      size_t decode_remain = event_ptr->payload_len - 4;
+      uint32_t count;
+      try {
+        count = decode_i32(&decode_ptr, &decode_remain);
+        if (count != ops.size())
+          HT_THROWF(Error::PROTOCOL_ERROR, "%u results for %u operations",
+                    (unsigned)count, (unsigned)ops.size());
+        foreach(MultiOp &op, ops)
+          decode_multi_op_result(&decode_ptr, &decode_remain, op);
+      }
+      catch (Exception &e) {
+        HT_THROW2(Error::PROTOCOL_ERROR, e, "Problem decoding MULTI response");
+      }
+    }
+  }
+  else {
+    state_transition(Session::STATE_JEOPARDY);
+    goto try_again;
+  }
+}
+
+
 bool Session::exists(const std::string &name, Timer *timer) {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
@@ -370,6 +460,9 @@ void Session::attr_set(uint64_t handle, const std::string &name,
                 "Problem setting attribute '%s' of hyperspace file '%s'",
                 name.c_str(), fname.c_str());
     }
+    ClientHandleStatePtr handle_state;
+    if (m_cache && m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      handle_state->invalidate_attr(name);
     return;
   }
 
@@ -403,7 +496,10 @@ uint64_t Session::attr_incr(uint64_t handle, const std::string &name, Timer *tim
       const uint8_t *decode_ptr = event_ptr->payload + 4;
       size_t decode_remain = event_ptr->payload_len - 4;
       uint64_t attr_val = decode_i64(&decode_ptr, &decode_remain);
+      ClientHandleStatePtr handle_state;
 
+      if (m_cache && m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+        handle_state->invalidate_attr(name);
       return attr_val;
     }
   }
@@ -420,6 +516,26 @@ Session::attr_get(uint64_t handle, const std::string &name,
                   DynamicBuffer &value, Timer *timer) {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
+  ClientHandleStatePtr cached_state;
+  uint64_t epoch = 0, generation = 0;
+
+  if (get_cached_handle(handle, cached_state, &epoch)) {
+    ScopedLock lock(cached_state->cache_mutex);
+    ClientHandleState::CachedAttrMap::iterator iter =
+        cached_state->cached_attrs.find(name);
+    boost::xtime now;
+    boost::xtime_get(&now, boost::TIME_UTC);
+    if (iter != cached_state->cached_attrs.end() && iter->second.has_value &&
+        iter->second.epoch == epoch && xtime_cmp(now, iter->second.expire) < 0) {
+      value.clear();
+      value.ensure(iter->second.value.length()+1);
+      value.add_unchecked(iter->second.value.data(), iter->second.value.length());
+      *value.ptr = 0;
+      return;
+    }
+    generation = cached_state->cache_generation;
+  }
+
   CommBufPtr cbuf_ptr(Protocol::create_attr_get_request(handle, name));
 
  try_again:
@@ -448,6 +564,19 @@ Session::attr_get(uint64_t handle, const std::string &name,
       value.add_unchecked(attr_val, attr_val_len);
       // nul-terminate to make caller's lives easier
       *value.ptr = 0;
+
+      if (cached_state) {
+        ScopedLock lock(cached_state->cache_mutex);
+        if (cached_state->cache_generation == generation) {
+          ClientHandleState::CachedAttr &cached = cached_state->cached_attrs[name];
+          cached.exists = true;
+          cached.has_value = true;
+          cached.value.assign((const char *)attr_val, attr_val_len);
+          cached.epoch = epoch;
+          boost::xtime_get(&cached.expire, boost::TIME_UTC);
+          xtime_add_millis(cached.expire, m_lease_interval);
+        }
+      }
     }
   }
   else {
@@ -461,6 +590,20 @@ Session::attr_exists(uint64_t handle, const std::string& name, Timer *timer)
 {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
+  ClientHandleStatePtr cached_state;
+  uint64_t epoch = 0, generation = 0;
+
+  if (get_cached_handle(handle, cached_state, &epoch)) {
+    ScopedLock lock(cached_state->cache_mutex);
+    ClientHandleState::CachedAttrMap::iterator iter =
+        cached_state->cached_attrs.find(name);
+    boost::xtime now;
+    boost::xtime_get(&now, boost::TIME_UTC);
+    if (iter != cached_state->cached_attrs.end() &&
+        iter->second.epoch == epoch && xtime_cmp(now, iter->second.expire) < 0)
+      return iter->second.exists;
+    generation = cached_state->cache_generation;
+  }
 
   CommBufPtr cbuf_ptr(Protocol::create_attr_exists_request(handle, name));
 
@@ -478,6 +621,21 @@ Session::attr_exists(uint64_t handle, const std::string& name, Timer *timer)
       const uint8_t *decode_ptr = event_ptr->payload + 4;
       size_t decode_remain = event_ptr->payload_len - 4;
       uint8_t bval = decode_byte(&decode_ptr, &decode_remain);
+
+      if (cached_state) {
+        ScopedLock lock(cached_state->cache_mutex);
+        if (cached_state->cache_generation == generation) {
+          ClientHandleState::CachedAttr &cached = cached_state->cached_attrs[name];
+          if (cached.epoch != epoch || !cached.has_value || bval == 0) {
+            cached.has_value = false;
+            cached.value.clear();
+          }
+          cached.exists = (bval != 0);
+          cached.epoch = epoch;
+          boost::xtime_get(&cached.expire, boost::TIME_UTC);
+          xtime_add_millis(cached.expire, m_lease_interval);
+        }
+      }
       return (bval == 0) ? false : true;
     }
   }
@@ -509,6 +667,9 @@ void Session::attr_del(uint64_t handle, const std::string &name, Timer *timer) {
                 "Problem deleting attribute '%s' of hyperspace file '%s'",
                 name.c_str(), fname.c_str());
     }
+    ClientHandleStatePtr handle_state;
+    if (m_cache && m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      handle_state->invalidate_attr(name);
   }
   else {
     state_transition(Session::STATE_JEOPARDY);
@@ -563,6 +724,21 @@ Session::readdir(uint64_t handle, std::vector<DirEntry> &listing,
                  Timer *timer) {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
+  ClientHandleStatePtr cached_state;
+  uint64_t epoch = 0, generation = 0;
+
+  if (get_cached_handle(handle, cached_state, &epoch)) {
+    ScopedLock lock(cached_state->cache_mutex);
+    boost::xtime now;
+    boost::xtime_get(&now, boost::TIME_UTC);
+    if (cached_state->listing_cached && cached_state->listing_epoch == epoch &&
+        xtime_cmp(now, cached_state->listing_expire) < 0) {
+      listing = cached_state->cached_listing;
+      return;
+    }
+    generation = cached_state->cache_generation;
+  }
+
   CommBufPtr cbuf_ptr(Protocol::create_readdir_request(handle));
 
  try_again:
@@ -597,6 +773,17 @@ Session::readdir(uint64_t handle, std::vector<DirEntry> &listing,
         }
         listing.push_back(dentry);
       }
+
+      if (cached_state) {
+        ScopedLock lock(cached_state->cache_mutex);
+        if (cached_state->cache_generation == generation) {
+          cached_state->cached_listing = listing;
+          cached_state->listing_cached = true;
+          cached_state->listing_epoch = epoch;
+          boost::xtime_get(&cached_state->listing_expire, boost::TIME_UTC);
+          xtime_add_millis(cached_state->listing_expire, m_lease_interval);
+        }
+      }
     }
   }
   else {
@@ -913,6 +1100,10 @@ int Session::state_transition(int state) {
   ScopedLock lock(m_mutex);
   int old_state = m_state;
   m_state = state;
+  // notifications may be missed from here on, so cached entries read
+  // so far can't be trusted anymore
+  if (old_state == STATE_SAFE && m_state != STATE_SAFE)
+    m_cache_epoch++;
   if (m_state == STATE_SAFE) {
     m_cond.notify_all();
     if (old_state == STATE_JEOPARDY) {
@@ -1017,6 +1208,8 @@ Session::send_message(CommBufPtr &cbuf_ptr, DispatchHandler *handler,
   int error;
   uint32_t timeout_ms = timer ? (time_t)timer->remaining() : m_timeout_ms;
 
+  // callers on any thread count here, under m_mutex
+  m_request_count++;
   if ((error = m_comm->send_request(m_master_addr, timeout_ms, cbuf_ptr,
       handler)) != Error::OK) {
     std::string str;
@@ -42,6 +42,7 @@
 #include "ClientKeepaliveHandler.h"
 #include "HandleCallback.h"
 #include "LockSequencer.h"
+#include "MultiOp.h"
 #include "Protocol.h"
 #include "DirEntry.h"
 #include "DirEntryAttr.h"
@@ -333,6 +334,17 @@ namespace Hyperspace {
      */
     void unlink(const std::string &name, Timer *timer=0);
 
+    /** Executes a list of operations in one request.  The master runs
+     * them in order within a single transaction, so if one of them fails
+     * none of them takes effect and an exception is thrown.  Otherwise the
+     * results are stored in the operations (see MultiOp).  Change events
+     * are delivered to open handles as for the single requests.
+     *
+     * @param ops operations to execute, receive the results
+     * @param timer maximum wait timer
+     */
+    void multi(std::vector<MultiOp> &ops, Timer *timer=0);
+
     /** Gets a directory listing.  The listing comes back as a vector of
      * DireEntry which contains a name and boolean flag indicating if the
      * entry is an element or not.
@@ -508,6 +520,16 @@ namespace Hyperspace {
 
     void update_master_addr(const String &host);
 
+    /**
+     * Returns the number of requests this session has sent to the master,
+     * not counting keepalives.  Reads answered from the handle cache (see
+     * Hyperspace.Client.Cache) are not counted.
+     */
+    uint64_t get_request_count() {
+      ScopedLock lock(m_mutex);
+      return m_request_count;
+    }
+
   private:
 
     typedef hash_map<uint64_t, SessionCallback *> CallbackMap;
@@ -516,6 +538,9 @@ namespace Hyperspace {
     int send_message(CommBufPtr &, DispatchHandler *, Timer *timer);
     void normalize_name(const std::string &name, std::string &normal);
     uint64_t open(ClientHandleStatePtr &, CommBufPtr &, Timer *timer);
+    uint32_t server_event_mask(ClientHandleStatePtr &handle_state);
+    bool get_cached_handle(uint64_t handle, ClientHandleStatePtr &handle_state,
+                           uint64_t *epochp);
 
     Mutex                     m_mutex;
     boost::condition          m_cond;
@@ -537,6 +562,9 @@ namespace Hyperspace {
     Mutex                     m_callback_mutex;
     vector<String>            m_hyperspace_replicas;
     String                    m_hyperspace_master;
+    bool                      m_cache;
+    uint64_t                  m_cache_epoch;
+    uint64_t                  m_request_count;  // guarded by m_mutex
   };
 
   typedef boost::intrusive_ptr<Session> SessionPtr;
@@ -0,0 +1,203 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/Config.h"
+
+#include "Hyperspace/Config.h"
+#include "Hyperspace/Session.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace Hyperspace;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "usage: hyperspace_cache_stress [options]\n\n"
+    "Description:\n"
+    "  Reads attributes and directory listings of a set of Hyperspace files\n"
+    "  through a session without and then with Hyperspace.Client.Cache, and\n"
+    "  reports the operations/s and the requests/s sent to the master for\n"
+    "  each.  A second session periodically updates the attributes; every\n"
+    "  read that follows an update must see the new value.";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("dir", str()->default_value("/hyperspace_cache_stress"),
+            "Hyperspace directory holding the test files")
+        ("files", i32()->default_value(10), "Number of files")
+        ("ops", i32()->default_value(100000), "Number of reads per run")
+        ("write-interval", i32()->default_value(1000),
+            "Update an attribute every this many reads (0 for never)")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, HyperspaceClientPolicy, DefaultCommPolicy>
+          Policies;
+
+  SessionPtr connect(Comm *comm, bool cache) {
+    // only read when the session is constructed
+    properties->set("Hyperspace.Client.Cache", cache);
+    SessionPtr session = new Hyperspace::Session(comm, properties);
+    if (!session->wait_for_connection(30000))
+      HT_THROW(Error::REQUEST_TIMEOUT, "Unable to connect to Hyperspace");
+    return session;
+  }
+
+  void open_files(SessionPtr &session, const String &dir, int nfiles,
+                  vector<uint64_t> &handles, uint64_t *dir_handlep) {
+    uint32_t flags = OPEN_FLAG_READ | OPEN_FLAG_WRITE;
+    for (int i = 0; i < nfiles; i++)
+      handles.push_back(session->open(format("%s/file%d", dir.c_str(), i),
+                                      flags));
+    *dir_handlep = session->open(dir, OPEN_FLAG_READ);
+  }
+
+  void close_files(SessionPtr &session, vector<uint64_t> &handles,
+                   uint64_t dir_handle) {
+    foreach(uint64_t handle, handles)
+      session->close(handle);
+    session->close(dir_handle);
+  }
+
+  /**
+   * Runs the reads through a session with or without the cache and
+   * returns the number of reads that did not see the latest value
+   */
+  int run(Comm *comm, bool cache, SessionPtr &writer,
+          vector<uint64_t> &writer_handles, const String &dir, int nfiles,
+          int ops, int write_interval, vector<String> &values) {
+    SessionPtr session = connect(comm, cache);
+    vector<uint64_t> handles;
+    uint64_t dir_handle;
+    vector<DirEntry> listing;
+    DynamicBuffer value;
+    int stale = 0;
+
+    open_files(session, dir, nfiles, handles, &dir_handle);
+
+    uint64_t requests = session->get_request_count();
+    Stopwatch stopwatch;
+
+    for (int i = 0; i < ops; i++) {
+      int n = i % nfiles;
+      if (write_interval && i % write_interval == 0) {
+        values[n] = format("%s-%d-%d", cache ? "cached" : "uncached", n, i);
+        writer->attr_set(writer_handles[n], "value", values[n].c_str(),
+                         values[n].length());
+      }
+      if (i % 10 == 9) {
+        session->readdir(dir_handle, listing);
+        if ((int)listing.size() != nfiles)
+          stale++;
+      }
+      else {
+        session->attr_get(handles[n], "value", value);
+        if (values[n] != (const char *)value.base)
+          stale++;
+      }
+    }
+
+    stopwatch.stop();
+    requests = session->get_request_count() - requests;
+
+    printf("%8s %10d %12.2f %14llu %14.2f %8d\n", cache ? "on" : "off", ops,
+           (double)ops / stopwatch.elapsed(), (Llu)requests,
+           (double)requests / stopwatch.elapsed(), stale);
+    fflush(stdout);
+
+    close_files(session, handles, dir_handle);
+    return stale;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  int stale = 0;
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    Comm *comm = Comm::instance();
+    String dir = get_str("dir");
+    int nfiles = get_i32("files");
+    int ops = get_i32("ops");
+    int write_interval = get_i32("write-interval");
+    vector<uint64_t> writer_handles;
+    uint64_t writer_dir_handle;
+    vector<String> values;
+
+    if (nfiles <= 0)
+      HT_THROW(Error::CONFIG_BAD_VALUE, "--files must be positive");
+
+    SessionPtr writer = connect(comm, false);
+
+    if (!writer->exists(dir))
+      writer->mkdir(dir);
+    for (int i = 0; i < nfiles; i++) {
+      String fname = format("%s/file%d", dir.c_str(), i);
+      uint64_t handle = writer->open(fname, OPEN_FLAG_READ | OPEN_FLAG_WRITE |
+                                     OPEN_FLAG_CREATE);
+      values.push_back(format("initial-%d", i));
+      writer->attr_set(handle, "value", values[i].c_str(), values[i].length());
+      writer->close(handle);
+    }
+
+    open_files(writer, dir, nfiles, writer_handles, &writer_dir_handle);
+
+    printf("%8s %10s %12s %14s %14s %8s\n", "cache", "reads", "reads/s",
+           "requests", "requests/s", "stale");
+
+    stale += run(comm, false, writer, writer_handles, dir, nfiles, ops,
+                 write_interval, values);
+    stale += run(comm, true, writer, writer_handles, dir, nfiles, ops,
+                 write_interval, values);
+
+    close_files(writer, writer_handles, writer_dir_handle);
+    for (int i = 0; i < nfiles; i++)
+      writer->unlink(format("%s/file%d", dir.c_str(), i));
+    writer->unlink(dir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+
+  if (stale) {
+    cerr << stale << " reads returned stale data" << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "Hyperspace/MultiOp.h"
+
+using namespace Hyperspace;
+using namespace Hypertable;
+using namespace std;
+
+int main(int argc, char **argv) {
+  vector<MultiOp> ops, decoded;
+  string binary("a\0b", 3);
+
+  ops.push_back(MultiOp(MultiOp::MKDIR, "/a", MultiOp::FLAG_OPTIONAL));
+  ops.push_back(MultiOp(MultiOp::CREATE, "/a/b"));
+  ops.push_back(MultiOp(MultiOp::ATTR_SET, "/a/b", "value", binary));
+  ops.push_back(MultiOp(MultiOp::ATTR_GET, "/a/b", "value"));
+  ops.push_back(MultiOp(MultiOp::ATTR_INCR, "/a", "nid"));
+  ops.push_back(MultiOp(MultiOp::DELETE, "/a/b", MultiOp::FLAG_OPTIONAL));
+
+  // requests
+  size_t len = 0;
+  foreach(const MultiOp &op, ops)
+    len += encoded_length_multi_op(op);
+
+  vector<uint8_t> buf(len);
+  uint8_t *ptr = &buf[0];
+  foreach(const MultiOp &op, ops)
+    encode_multi_op(&ptr, op);
+  HT_ASSERT(ptr == &buf[0] + len);
+
+  const uint8_t *decode_ptr = &buf[0];
+  size_t remain = len;
+  decoded.resize(ops.size());
+  for (size_t i=0; i<ops.size(); i++) {
+    decode_multi_op(&decode_ptr, &remain, decoded[i]);
+    HT_ASSERT(decoded[i].type == ops[i].type);
+    HT_ASSERT(decoded[i].flags == ops[i].flags);
+    HT_ASSERT(decoded[i].name == ops[i].name);
+    HT_ASSERT(decoded[i].attr == ops[i].attr);
+  }
+  HT_ASSERT(remain == 0);
+  HT_ASSERT(decoded[2].value == binary);
+
+  // results, as filled in by the master
+  decoded[0].exists = true;
+  decoded[3].exists = true;
+  decoded[3].value = binary;
+  decoded[4].exists = true;
+  decoded[4].number = 41;
+
+  len = 0;
+  foreach(const MultiOp &op, decoded)
+    len += encoded_length_multi_op_result(op);
+
+  buf.resize(len);
+  ptr = &buf[0];
+  foreach(const MultiOp &op, decoded)
+    encode_multi_op_result(&ptr, op);
+  HT_ASSERT(ptr == &buf[0] + len);
+
+  decode_ptr = &buf[0];
+  remain = len;
+  foreach(MultiOp &op, ops)
+    decode_multi_op_result(&decode_ptr, &remain, op);
+  HT_ASSERT(remain == 0);
+
+  HT_ASSERT(ops[0].exists && !ops[1].exists);
+  HT_ASSERT(ops[2].value == binary);
+  HT_ASSERT(ops[3].exists && ops[3].value == binary);
+  HT_ASSERT(ops[4].number == 41);
+  HT_ASSERT(!strcmp(MultiOp::type_str(MultiOp::ATTR_INCR), "attr_incr"));
+
+  // truncated request
+  decode_ptr = &buf[0];
+  remain = 3;
+  try {
+    decode_multi_op(&decode_ptr, &remain, decoded[0]);
+    HT_ASSERT(!"decoding a truncated request succeeded");
+  }
+  catch (Exception &e) {
+  }
+
+  return 0;
+}
@@ -29,6 +29,7 @@
 #include "Common/FileUtils.h"
 #include "Common/Logger.h"
 #include "Common/StringExt.h"
+#include "Common/Trace.h"
 #include "Common/md5.h"
 
 #include "AsyncComm/Protocol.h"
@@ -63,8 +64,8 @@ CommitLog::CommitLog(FilesystemPtr &fs, const String &log_dir)
 }
 
 CommitLog::~CommitLog() {
-  delete m_compressor;
   close();
+  delete m_compressor;
 }
 
 void
@@ -76,6 +77,8 @@ CommitLog::initialize(const String &log_dir,
   m_cur_fragment_length = 0;
   m_cur_fragment_num = 0;
   m_needs_roll = false;
+  m_fd = -1;
+  m_local_file = 0;
 
   SubProperties cfg(props, "Hypertable.CommitLog.");
 
@@ -89,6 +92,21 @@ CommitLog::initialize(const String &log_dir,
 
   FileUtils::add_trailing_slash(m_log_dir);
 
+  if (!m_local_dir.empty()) {
+    FileUtils::add_trailing_slash(m_local_dir);
+    m_local_preallocate =
+      props->get_i64("Hypertable.RangeServer.CommitLog.Local.Preallocate",
+                     m_max_fragment_size);
+    m_local_direct_io =
+      props->get_bool("Hypertable.RangeServer.CommitLog.Local.DirectIO", true);
+    if (!FileUtils::mkdirs(m_local_dir))
+      HT_THROWF(Error::LOCAL_IO_ERROR, "Unable to create local commit log "
+                "directory '%s'", m_local_dir.c_str());
+    m_shipper = new CommitLogShipper(m_fs, m_replication,
+        props->get_i32("Hypertable.RangeServer.CommitLog.Local.ShipRetries",
+                       30));
+  }
+
   if (init_log) {
     stitch_in(init_log);
     foreach (const CommitLogFileInfo &frag, m_fragment_queue) {
@@ -107,12 +125,20 @@ CommitLog::initialize(const String &log_dir,
     }
   }
 
+  // don't reuse the number of a local fragment that was never shipped
+  if (m_shipper) {
+    std::vector<uint32_t> local_fragments;
+    CommitLogShipper::list_fragments(m_local_dir, local_fragments);
+    if (!local_fragments.empty() &&
+        local_fragments.back() >= m_cur_fragment_num)
+      m_cur_fragment_num = local_fragments.back() + 1;
+  }
+
   m_cur_fragment_fname = m_log_dir + m_cur_fragment_num;
 
   try {
     m_fs->mkdirs(m_log_dir);
-    m_fd = m_fs->create(m_cur_fragment_fname, Filesystem::OPEN_FLAG_OVERWRITE,
-                        -1, m_replication, -1);
+    create_fragment();
   }
   catch (Hypertable::Exception &e) {
     HT_ERRORF("Problem initializing commit log '%s' - %s (%s)",
@@ -123,6 +149,43 @@ CommitLog::initialize(const String &log_dir,
 }
 
 
+void CommitLog::create_fragment() {
+  if (m_shipper)
+    m_local_file = new CommitLogLocalFile(m_local_dir + m_cur_fragment_num,
+                                          m_local_preallocate,
+                                          m_local_direct_io);
+  else
+    m_fd = m_fs->create(m_cur_fragment_fname, Filesystem::OPEN_FLAG_OVERWRITE,
+                        -1, m_replication, -1);
+}
+
+
+void CommitLog::append_fragment(StaticBuffer &buf, bool sync) {
+  if (m_local_file)
+    m_local_file->append(buf.base, buf.size, sync);
+  else
+    m_fs->append(m_fd, buf, sync);
+}
+
+
+/**
+ * Closes the current fragment.  A local fragment is sealed and handed to the
+ * shipper, which copies it into the DFS log directory.
+ */
+void CommitLog::close_fragment() {
+  if (m_local_file) {
+    m_local_file->seal();
+    m_shipper->add(m_local_file->name(), m_cur_fragment_fname);
+    delete m_local_file;
+    m_local_file = 0;
+  }
+  else if (m_fd > 0) {
+    m_fs->close(m_fd);
+    m_fd = -1;
+  }
+}
+
+
 int64_t CommitLog::get_timestamp() {
   ScopedLock lock(m_mutex);
   boost::xtime now;
@@ -133,11 +196,15 @@ int64_t CommitLog::get_timestamp() {
 int
 CommitLog::sync() {
   int error = Error::OK;
+  TraceScope trace(Trace::current(), "cl.sync");
 
   // Sync commit log update (protected by lock)
   try {
     ScopedLock lock(m_mutex);
-    m_fs->flush(m_fd);
+    if (m_local_file)
+      m_local_file->sync();
+    else
+      m_fs->flush(m_fd);
     HT_DEBUG_OUT << "synced commit log explicitly" << HT_END;
   }
   catch (Exception &e) {
@@ -220,7 +287,7 @@ int CommitLog::link_log(CommitLogBase *log_base) {
     size_t amount = input.fill();
     StaticBuffer send_buf(input);
 
-    m_fs->append(m_fd, send_buf, false);
+    append_fragment(send_buf, false);
     m_cur_fragment_length += amount;
 
     roll();
@@ -240,10 +307,7 @@ int CommitLog::close() {
 
   try {
     ScopedLock lock(m_mutex);
-    if (m_fd > 0) {
-      m_fs->close(m_fd);
-      m_fd = -1;
-    }
+    close_fragment();
   }
   catch (Hypertable::Exception &e) {
     HT_ERRORF("Problem closing commit log file '%s' - %s (%s)",
@@ -252,6 +316,16 @@ int CommitLog::close() {
     return e.code();
   }
 
+  // wait for the remaining local fragments to reach the DFS
+  if (m_shipper) {
+    int error = m_shipper->wait_for_empty();
+    if (error != Error::OK) {
+      HT_ERRORF("Problem shipping local commit log fragments of '%s' to "
+                "the DFS - %s", m_log_dir.c_str(), Error::get_text(error));
+      return error;
+    }
+  }
+
   return Error::OK;
 }
 
@@ -266,9 +340,15 @@ int CommitLog::purge(int64_t revision) {
 
   while (!m_fragment_queue.empty()) {
     file_info = m_fragment_queue.front();
-    if (file_info.revision < revision) {
+    fname = file_info.log_dir + file_info.num;
+
+    if (m_shipper && m_shipper->pending(fname)) {
+      HT_DEBUGF("clgc LOG FRAGMENT PURGE breaking because %s has not been "
+                "shipped", fname.c_str());
+      break;
+    }
 
-      fname = file_info.log_dir + file_info.num;
+    if (file_info.revision < revision) {
 
       try {
         m_fs->remove(fname);
@@ -316,9 +396,9 @@ int CommitLog::roll() {
 
   m_needs_roll = true;
 
-  if (m_fd > 0) {
+  if (m_fd > 0 || m_local_file) {
     try {
-      m_fs->close(m_fd);
+      close_fragment();
     }
     catch (Exception &e) {
       if (e.code() != Error::DFSBROKER_BAD_FILE_HANDLE) {
@@ -355,8 +435,7 @@ int CommitLog::roll() {
   }
 
   try {
-    m_fd = m_fs->create(m_cur_fragment_fname, Filesystem::OPEN_FLAG_OVERWRITE,
-                        -1, m_replication, -1);
+    create_fragment();
   }
   catch (Exception &e) {
     HT_ERRORF("Problem rolling commit log: %s: %s",
@@ -375,6 +454,7 @@ CommitLog::compress_and_write(DynamicBuffer &input,
     BlockCompressionHeader *header, int64_t revision, bool sync) {
   int error = Error::OK;
   DynamicBuffer zblock;
+  TraceScope trace(Trace::current(), "cl.compress_and_write");
 
   // Compress block and kick off log write (protected by lock)
   try {
@@ -385,7 +465,7 @@ CommitLog::compress_and_write(DynamicBuffer &input,
     size_t amount = zblock.fill();
     StaticBuffer send_buf(zblock);
 
-    m_fs->append(m_fd, send_buf, sync);
+    append_fragment(send_buf, sync);
     assert(revision != 0);
     if (revision > m_latest_revision)
       m_latest_revision = revision;
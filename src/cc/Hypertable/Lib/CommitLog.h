@@ -40,6 +40,8 @@
 
 #include "CommitLogBase.h"
 #include "CommitLogBlockStream.h"
+#include "CommitLogLocalFile.h"
+#include "CommitLogShipper.h"
 
 namespace Hypertable {
 
@@ -63,6 +65,11 @@ namespace Hypertable {
    *<pre>
    * Hypertable.RangeServer.CommitLog.RollLimit
    *</pre>
+   * If a local directory is supplied, the current fragment is written to
+   * (and synced on) the RangeServer's local disk instead of the DFS.  When
+   * the fragment rolls it is sealed and shipped to the DFS log directory by
+   * a CommitLogShipper.  Fragments are not purged until they have been
+   * shipped.
    */
 
   class CommitLog : public CommitLogBase {
@@ -77,10 +84,13 @@ namespace Hypertable {
      * @param log_dir directory of the commit log
      * @param props reference to properties map
      * @param init_log base log to pull fragments from
+     * @param local_dir local directory to write the current fragment into
+     *        before it is shipped to log_dir (empty to write to the DFS)
      */
     CommitLog(FilesystemPtr &fs, const String &log_dir,
-              PropertiesPtr &props, CommitLogBase *init_log = 0)
-      : CommitLogBase(log_dir), m_fs(fs) {
+              PropertiesPtr &props, CommitLogBase *init_log = 0,
+              const String &local_dir = "")
+      : CommitLogBase(log_dir), m_fs(fs), m_local_dir(local_dir) {
       initialize(log_dir, props, init_log);
     }
 
@@ -186,6 +196,9 @@ namespace Hypertable {
     int roll();
     int compress_and_write(DynamicBuffer &input, BlockCompressionHeader *header,
                            int64_t revision, bool sync);
+    void create_fragment();
+    void append_fragment(StaticBuffer &buf, bool sync);
+    void close_fragment();
 
     Mutex                   m_mutex;
     FilesystemPtr           m_fs;
@@ -197,6 +210,11 @@ namespace Hypertable {
     int32_t                 m_fd;
     int32_t                 m_replication;
     bool                    m_needs_roll;
+    String                  m_local_dir;
+    CommitLogLocalFile     *m_local_file;
+    CommitLogShipperPtr     m_shipper;
+    int64_t                 m_local_preallocate;
+    bool                    m_local_direct_io;
   };
 
   typedef intrusive_ptr<CommitLog> CommitLogPtr;
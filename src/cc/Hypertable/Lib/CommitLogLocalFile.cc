@@ -0,0 +1,211 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include "Common/Checksum.h"
+#include "Common/Error.h"
+#include "Common/FileUtils.h"
+#include "Common/Logger.h"
+
+#include "BlockCompressionHeaderCommitLog.h"
+#include "CommitLog.h"
+#include "CommitLogLocalFile.h"
+
+using namespace Hypertable;
+
+CommitLogLocalFile::CommitLogLocalFile(const String &fname,
+                                       int64_t preallocate, bool direct_io)
+  : m_fname(fname), m_fd(-1), m_direct(false), m_length(0), m_buf(0),
+    m_buf_size(0), m_tail_len(0) {
+  int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+#if defined(O_DIRECT)
+  if (direct_io) {
+    if ((m_fd = ::open(fname.c_str(), flags | O_DIRECT, 0644)) >= 0)
+      m_direct = true;
+    else if (errno != EINVAL)
+      HT_THROWF(Error::LOCAL_IO_ERROR, "open('%s') failed - %s",
+                fname.c_str(), strerror(errno));
+    else
+      HT_WARNF("O_DIRECT not supported for '%s', using buffered I/O",
+               fname.c_str());
+  }
+#endif
+
+  if (m_fd < 0 && (m_fd = ::open(fname.c_str(), flags, 0644)) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "open('%s') failed - %s",
+              fname.c_str(), strerror(errno));
+
+#if defined(__linux__)
+  if (preallocate > 0) {
+    int error = posix_fallocate(m_fd, 0, preallocate);
+    if (error)
+      HT_WARNF("posix_fallocate('%s', %lld) failed - %s", fname.c_str(),
+               (Lld)preallocate, strerror(error));
+  }
+#endif
+
+  if (m_direct) {
+    m_buf_size = 64 * 1024;
+    if (posix_memalign((void **)&m_buf, PAGE_SIZE, m_buf_size))
+      HT_THROW(Error::LOCAL_IO_ERROR, "posix_memalign failed");
+  }
+}
+
+
+CommitLogLocalFile::~CommitLogLocalFile() {
+  if (m_fd >= 0)
+    ::close(m_fd);
+  free(m_buf);
+}
+
+
+void CommitLogLocalFile::append(const uint8_t *data, size_t len, bool sync) {
+
+  if (m_direct)
+    write_direct(data, len);
+  else {
+    if (FileUtils::pwrite(m_fd, data, len, m_length) != (ssize_t)len)
+      HT_THROWF(Error::LOCAL_IO_ERROR, "pwrite('%s', %lld) failed - %s",
+                m_fname.c_str(), (Lld)m_length, strerror(errno));
+    m_length += len;
+  }
+
+  if (sync)
+    this->sync();
+}
+
+
+/**
+ * Appends the new data behind the partial last page in the staging
+ * buffer, zero pads to a page boundary and writes everything from the start
+ * of that page.  The (new) partial last page is then moved to the front of
+ * the buffer.
+ */
+void CommitLogLocalFile::write_direct(const uint8_t *data, size_t len) {
+  size_t total = m_tail_len + len;
+  size_t padded = (total + PAGE_SIZE - 1) & ~((size_t)PAGE_SIZE - 1);
+  int64_t offset = m_length - m_tail_len;
+
+  if (padded > m_buf_size) {
+    uint8_t *buf;
+    if (posix_memalign((void **)&buf, PAGE_SIZE, padded))
+      HT_THROW(Error::LOCAL_IO_ERROR, "posix_memalign failed");
+    memcpy(buf, m_buf, m_tail_len);
+    free(m_buf);
+    m_buf = buf;
+    m_buf_size = padded;
+  }
+
+  memcpy(m_buf + m_tail_len, data, len);
+  memset(m_buf + total, 0, padded - total);
+
+  if (FileUtils::pwrite(m_fd, m_buf, padded, offset) != (ssize_t)padded)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "pwrite('%s', %lld) failed - %s",
+              m_fname.c_str(), (Lld)offset, strerror(errno));
+
+  m_length += len;
+
+  size_t full = total & ~((size_t)PAGE_SIZE - 1);
+  m_tail_len = total - full;
+  if (full && m_tail_len)
+    memmove(m_buf, m_buf + full, m_tail_len);
+}
+
+
+void CommitLogLocalFile::sync() {
+#if defined(__linux__)
+  if (fdatasync(m_fd) < 0)
+#else
+  if (fsync(m_fd) < 0)
+#endif
+    HT_THROWF(Error::LOCAL_IO_ERROR, "fdatasync('%s') failed - %s",
+              m_fname.c_str(), strerror(errno));
+}
+
+
+void CommitLogLocalFile::seal() {
+  if (m_fd < 0)
+    return;
+  if (ftruncate(m_fd, m_length) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "ftruncate('%s', %lld) failed - %s",
+              m_fname.c_str(), (Lld)m_length, strerror(errno));
+  if (fsync(m_fd) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "fsync('%s') failed - %s",
+              m_fname.c_str(), strerror(errno));
+  ::close(m_fd);
+  m_fd = -1;
+}
+
+
+int64_t CommitLogLocalFile::valid_length(const String &fname) {
+  BlockCompressionHeaderCommitLog header;
+  uint8_t hbuf[BlockCompressionHeaderCommitLog::LENGTH];
+  const uint8_t *ptr;
+  size_t remain;
+  int64_t offset = 0;
+  ssize_t nread;
+  String payload;
+  int fd;
+
+  if ((fd = ::open(fname.c_str(), O_RDONLY)) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "open('%s') failed - %s",
+              fname.c_str(), strerror(errno));
+
+  while (true) {
+    nread = FileUtils::pread(fd, hbuf, sizeof(hbuf), offset);
+    if (nread != (ssize_t)sizeof(hbuf))
+      break;
+    ptr = hbuf;
+    remain = sizeof(hbuf);
+    try {
+      header.decode(&ptr, &remain);
+    }
+    catch (Exception &e) {
+      break;
+    }
+    if (!header.check_magic(CommitLog::MAGIC_DATA) &&
+        !header.check_magic(CommitLog::MAGIC_LINK))
+      break;
+    payload.resize(header.get_data_zlength());
+    nread = FileUtils::pread(fd, (void *)payload.data(), payload.size(),
+                             offset + sizeof(hbuf));
+    if (nread != (ssize_t)payload.size() ||
+        fletcher32(payload.data(), payload.size()) != header.get_data_checksum())
+      break;
+    offset += sizeof(hbuf) + payload.size();
+  }
+
+  ::close(fd);
+  return offset;
+}
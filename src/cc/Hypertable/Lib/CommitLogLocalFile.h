@@ -0,0 +1,93 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_COMMITLOGLOCALFILE_H
+#define HYPERTABLE_COMMITLOGLOCALFILE_H
+
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * A commit log fragment file on the RangeServer's local disk.  The file
+   * is preallocated so that fdatasync() does not have to update the file
+   * size, and is optionally written with O_DIRECT.  With O_DIRECT, the
+   * partially filled last page of the file is kept in an aligned buffer and
+   * rewritten (zero padded) with each append.
+   *
+   * Because of the preallocation and padding, an unsealed file is followed
+   * by zeros.  seal() truncates the file to its real length; after a crash
+   * valid_length() finds the end of the last complete commit block.
+   */
+  class CommitLogLocalFile {
+  public:
+
+    /**
+     * Creates (truncating) a local fragment file.
+     *
+     * @param fname path of the file
+     * @param preallocate number of bytes to preallocate (0 for none)
+     * @param direct_io open the file with O_DIRECT if supported
+     */
+    CommitLogLocalFile(const String &fname, int64_t preallocate,
+                       bool direct_io);
+
+    /** Closes the file without sealing it */
+    ~CommitLogLocalFile();
+
+    /** Appends data to the file, optionally followed by fdatasync().
+     * Throws Error::LOCAL_IO_ERROR on failure.
+     */
+    void append(const uint8_t *data, size_t len, bool sync);
+
+    /** fdatasync()s the file.  Throws Error::LOCAL_IO_ERROR on failure. */
+    void sync();
+
+    /** Truncates the file to its length, syncs and closes it */
+    void seal();
+
+    int64_t length() const { return m_length; }
+
+    const String &name() const { return m_fname; }
+
+    /**
+     * Returns the length of the prefix of a fragment file that consists of
+     * complete, checksummed commit blocks.
+     */
+    static int64_t valid_length(const String &fname);
+
+  private:
+    enum { PAGE_SIZE = 4096 };
+
+    void write_direct(const uint8_t *data, size_t len);
+
+    String   m_fname;
+    int      m_fd;
+    bool     m_direct;
+    int64_t  m_length;
+    uint8_t *m_buf;       // page aligned staging buffer (O_DIRECT only)
+    size_t   m_buf_size;
+    size_t   m_tail_len;  // bytes of the last, partial page held in m_buf
+  };
+
+}
+
+#endif // HYPERTABLE_COMMITLOGLOCALFILE_H
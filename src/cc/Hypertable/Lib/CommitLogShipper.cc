@@ -0,0 +1,265 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <boost/thread/xtime.hpp>
+
+extern "C" {
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+#include "Common/Error.h"
+#include "Common/FileUtils.h"
+#include "Common/Logger.h"
+#include "Common/StaticBuffer.h"
+#include "Common/StringExt.h"
+
+#include "CommitLogLocalFile.h"
+#include "CommitLogShipper.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  struct ShipperThread {
+    ShipperThread(CommitLogShipper *shipper) : m_shipper(shipper) { }
+    void operator()() { (*m_shipper)(); }
+    CommitLogShipper *m_shipper;
+  };
+
+  const size_t SHIP_BUFFER_SIZE = 4 * 1024 * 1024;
+
+  /** Local fragment names are their (numeric) fragment number */
+  bool fragment_name(const char *name) {
+    if (*name == 0)
+      return false;
+    for (const char *ptr = name; *ptr; ptr++)
+      if (!isdigit(*ptr))
+        return false;
+    return true;
+  }
+
+}
+
+
+CommitLogShipper::CommitLogShipper(FilesystemPtr &fs, int32_t replication,
+                                   int32_t max_retries)
+  : m_fs(fs), m_replication(replication), m_max_retries(max_retries),
+    m_failures(0), m_error(Error::OK), m_shutdown(false) {
+  m_thread = new boost::thread(ShipperThread(this));
+}
+
+
+CommitLogShipper::~CommitLogShipper() {
+  shutdown();
+}
+
+
+void CommitLogShipper::add(const String &local_fname,
+                           const String &dfs_fname) {
+  ScopedLock lock(m_mutex);
+  Fragment fragment;
+  fragment.local_fname = local_fname;
+  fragment.dfs_fname = dfs_fname;
+  m_queue.push_back(fragment);
+  m_pending.insert(dfs_fname);
+  m_cond.notify_all();
+}
+
+
+bool CommitLogShipper::pending(const String &dfs_fname) {
+  ScopedLock lock(m_mutex);
+  return m_pending.count(dfs_fname) > 0;
+}
+
+
+int CommitLogShipper::wait_for_empty() {
+  ScopedLock lock(m_mutex);
+  while (!m_queue.empty()) {
+    if (m_failures > m_max_retries || (m_shutdown && m_thread == 0))
+      return m_error != Error::OK ? m_error : Error::FAILED_EXPECTATION;
+    m_empty_cond.wait(lock);
+  }
+  return Error::OK;
+}
+
+
+void CommitLogShipper::shutdown() {
+  {
+    ScopedLock lock(m_mutex);
+    if (m_thread == 0)
+      return;
+    m_shutdown = true;
+    m_cond.notify_all();
+  }
+  m_thread->join();
+  ScopedLock lock(m_mutex);
+  delete m_thread;
+  m_thread = 0;
+  m_empty_cond.notify_all();
+}
+
+
+void CommitLogShipper::operator()() {
+  Fragment fragment;
+
+  while (true) {
+    {
+      ScopedLock lock(m_mutex);
+      while (m_queue.empty() && !m_shutdown)
+        m_cond.wait(lock);
+      if (m_queue.empty())
+        break;
+      fragment = m_queue.front();
+    }
+
+    try {
+      ship(m_fs, fragment.local_fname, fragment.dfs_fname,
+           FileUtils::length(fragment.local_fname), m_replication);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << "Problem shipping commit log fragment "
+                   << fragment.local_fname << " to " << fragment.dfs_fname
+                   << " - " << e << HT_END;
+      ScopedLock lock(m_mutex);
+      m_error = e.code();
+      if (++m_failures > m_max_retries)
+        m_empty_cond.notify_all();
+      if (m_shutdown) {
+        HT_ERRORF("Leaving %d unshipped commit log fragments in local "
+                  "directory", (int)m_queue.size());
+        break;
+      }
+      boost::xtime retry_time;
+      boost::xtime_get(&retry_time, boost::TIME_UTC);
+      retry_time.sec += 1;
+      m_cond.timed_wait(lock, retry_time);
+      continue;
+    }
+
+    {
+      ScopedLock lock(m_mutex);
+      m_failures = 0;
+      m_error = Error::OK;
+      m_queue.pop_front();
+      m_pending.erase(fragment.dfs_fname);
+      if (m_queue.empty())
+        m_empty_cond.notify_all();
+    }
+  }
+}
+
+
+void CommitLogShipper::ship(FilesystemPtr &fs, const String &local_fname,
+                            const String &dfs_fname, int64_t length,
+                            int32_t replication) {
+  int64_t offset = 0;
+  int local_fd, dfs_fd;
+
+  if ((local_fd = ::open(local_fname.c_str(), O_RDONLY)) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "open('%s') failed - %s",
+              local_fname.c_str(), strerror(errno));
+
+  try {
+    dfs_fd = fs->create(dfs_fname, Filesystem::OPEN_FLAG_OVERWRITE, -1,
+                        replication, -1);
+    while (offset < length) {
+      size_t amount = std::min((int64_t)SHIP_BUFFER_SIZE, length - offset);
+      StaticBuffer buf(amount);
+      if (FileUtils::pread(local_fd, buf.base, amount, offset)
+          != (ssize_t)amount)
+        HT_THROWF(Error::LOCAL_IO_ERROR, "pread('%s', %lld) failed - %s",
+                  local_fname.c_str(), (Lld)offset, strerror(errno));
+      offset += amount;
+      fs->append(dfs_fd, buf, offset == length ? Filesystem::O_FLUSH : 0);
+    }
+    if (length == 0) {
+      StaticBuffer buf((size_t)0);
+      fs->append(dfs_fd, buf, Filesystem::O_FLUSH);
+    }
+    fs->close(dfs_fd);
+  }
+  catch (...) {
+    ::close(local_fd);
+    throw;
+  }
+
+  ::close(local_fd);
+
+  if (!FileUtils::unlink(local_fname))
+    HT_ERRORF("Unable to remove shipped commit log fragment '%s'",
+              local_fname.c_str());
+
+  HT_INFOF("Shipped commit log fragment %s (%lld bytes) to %s",
+           local_fname.c_str(), (Lld)length, dfs_fname.c_str());
+}
+
+
+size_t CommitLogShipper::recover(FilesystemPtr &fs, const String &local_dir,
+                                 const String &dfs_dir) {
+  std::vector<uint32_t> fragments;
+
+  list_fragments(local_dir, fragments);
+
+  String local_prefix = local_dir;
+  String dfs_prefix = dfs_dir;
+  FileUtils::add_trailing_slash(local_prefix);
+  FileUtils::add_trailing_slash(dfs_prefix);
+
+  if (!fragments.empty())
+    fs->mkdirs(dfs_dir);
+
+  foreach (uint32_t num, fragments) {
+    String local_fname = local_prefix + num;
+    int64_t length = CommitLogLocalFile::valid_length(local_fname);
+    HT_INFOF("Recovering local commit log fragment %s (%lld valid bytes)",
+             local_fname.c_str(), (Lld)length);
+    ship(fs, local_fname, dfs_prefix + num, length, -1);
+  }
+
+  return fragments.size();
+}
+
+
+void CommitLogShipper::list_fragments(const String &local_dir,
+                                      std::vector<uint32_t> &fragments) {
+  struct dirent *dp;
+  DIR *dirp;
+
+  fragments.clear();
+
+  if ((dirp = opendir(local_dir.c_str())) == 0)
+    return;
+  while ((dp = readdir(dirp)) != 0) {
+    if (fragment_name(dp->d_name))
+      fragments.push_back((uint32_t)atoi(dp->d_name));
+  }
+  closedir(dirp);
+
+  std::sort(fragments.begin(), fragments.end());
+}
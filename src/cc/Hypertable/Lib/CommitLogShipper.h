@@ -0,0 +1,136 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_COMMITLOGSHIPPER_H
+#define HYPERTABLE_COMMITLOGSHIPPER_H
+
+#include <deque>
+#include <set>
+#include <vector>
+
+#include <boost/thread/condition.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "Common/Filesystem.h"
+#include "Common/Mutex.h"
+#include "Common/ReferenceCount.h"
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Copies sealed commit log fragments from the RangeServer's local disk
+   * into the commit log directory in the DFS.  Fragments are shipped in
+   * the order they are added by a background thread; a fragment is
+   * removed from the local disk once it has been written and flushed to
+   * the DFS.  A fragment that fails to ship is retried every second until
+   * it succeeds or the shipper is shut down; once it has failed
+   * <code>max_retries</code> times in a row, wait_for_empty() stops waiting
+   * and returns the error.
+   */
+  class CommitLogShipper : public ReferenceCount {
+  public:
+
+    CommitLogShipper(FilesystemPtr &fs, int32_t replication,
+                     int32_t max_retries);
+    virtual ~CommitLogShipper();
+
+    /** Queues a sealed local fragment for shipping */
+    void add(const String &local_fname, const String &dfs_fname);
+
+    /** Returns true if the DFS fragment has been queued but not shipped */
+    bool pending(const String &dfs_fname);
+
+    /** Waits until all queued fragments have been shipped, or until
+     * shipping a fragment has failed <code>max_retries</code> times in a row
+     * or the shipper has been shut down.
+     *
+     * @return Error::OK if all fragments were shipped, otherwise the error
+     *         of the last failed attempt
+     */
+    int wait_for_empty();
+
+    /** Ships the queued fragments and stops the background thread.  A
+     * fragment that fails to ship is not retried; it stays on the local
+     * disk, from which recover() ships it on the next start.
+     */
+    void shutdown();
+
+    /**
+     * Copies a local fragment into the DFS and removes the local file.
+     *
+     * @param fs filesystem holding the commit log
+     * @param local_fname local fragment file
+     * @param dfs_fname fragment file to create in the DFS
+     * @param length number of bytes of the local file to copy
+     * @param replication replication of the DFS file (-1 for default)
+     */
+    static void ship(FilesystemPtr &fs, const String &local_fname,
+                     const String &dfs_fname, int64_t length,
+                     int32_t replication);
+
+    /**
+     * Ships the fragments left in a local commit log directory by a
+     * previous process, truncated to their last complete block.  Must be
+     * called before the DFS commit log is read for replay.
+     *
+     * @param fs filesystem holding the commit log
+     * @param local_dir local commit log directory
+     * @param dfs_dir DFS commit log directory
+     * @return number of fragments shipped
+     */
+    static size_t recover(FilesystemPtr &fs, const String &local_dir,
+                          const String &dfs_dir);
+
+    /** Returns the numbers of the fragments in a local commit log directory,
+     * in ascending order
+     */
+    static void list_fragments(const String &local_dir,
+                               std::vector<uint32_t> &fragments);
+
+    void operator()();
+
+  private:
+
+    struct Fragment {
+      String local_fname;
+      String dfs_fname;
+    };
+
+    Mutex                m_mutex;
+    boost::condition     m_cond;
+    boost::condition     m_empty_cond;
+    std::deque<Fragment> m_queue;
+    std::set<String>     m_pending;
+    FilesystemPtr        m_fs;
+    int32_t              m_replication;
+    int32_t              m_max_retries;
+    int32_t              m_failures;
+    int                  m_error;
+    bool                 m_shutdown;
+    boost::thread       *m_thread;
+  };
+
+  typedef intrusive_ptr<CommitLogShipper> CommitLogShipperPtr;
+
+}
+
+#endif // HYPERTABLE_COMMITLOGSHIPPER_H
@@ -20,7 +20,12 @@
  */
 
 #include "Common/Compat.h"
+#include "Common/Config.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Mutex.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/tss.hpp>
+#include "AsyncComm/CommCompression.h"
 #include "CompressorFactory.h"
 #include "BlockCompressionCodecBmz.h"
 #include "BlockCompressionCodecNone.h"
@@ -32,6 +37,55 @@ using namespace Hypertable;
 using namespace std;
 using namespace boost;
 
+namespace {
+
+  const char COMM_MAGIC[10] = { 'R','P','C','P','A','Y','L','O','A','D' };
+
+  /**
+   * Adapts a block codec to CommCompression.  Block codecs keep scratch
+   * state, so each thread gets its own instance.
+   */
+  class CommCodecAdapter : public CommCompression::Codec {
+  public:
+    CommCodecAdapter(BlockCompressionCodec::Type type) : m_type(type) { }
+
+    virtual void deflate(const uint8_t *input, size_t len,
+                         DynamicBuffer &output) {
+      DynamicBuffer in(0, false);
+      in.base = (uint8_t *)input;
+      in.ptr = in.base + len;
+      BlockCompressionHeader header(COMM_MAGIC);
+      codec()->deflate(in, output, header);
+    }
+
+    virtual void inflate(const uint8_t *input, size_t len,
+                         DynamicBuffer &output) {
+      DynamicBuffer in(0, false);
+      in.base = (uint8_t *)input;
+      in.ptr = in.base + len;
+      BlockCompressionHeader header;
+      codec()->inflate(in, output, header);
+      if (!header.check_magic(COMM_MAGIC))
+        HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC, "RPC payload");
+    }
+
+  private:
+    BlockCompressionCodec *codec() {
+      BlockCompressionCodec *codec = m_codec.get();
+      if (codec == 0)
+        m_codec.reset(codec = CompressorFactory::create_block_codec(m_type));
+      return codec;
+    }
+
+    BlockCompressionCodec::Type m_type;
+    thread_specific_ptr<BlockCompressionCodec> m_codec;
+  };
+
+  Mutex comm_codecs_mutex;
+  bool comm_codecs_registered = false;
+
+}
+
 BlockCompressionCodec::Type
 CompressorFactory::parse_block_codec_spec(const std::string &spec,
                                           BlockCompressionCodec::Args &args) {
@@ -82,3 +136,37 @@ CompressorFactory::create_block_codec(BlockCompressionCodec::Type type,
               "type: '%d'", (int)type);
   }
 }
+
+void CompressorFactory::register_comm_codecs() {
+  ScopedLock lock(comm_codecs_mutex);
+
+  if (comm_codecs_registered)
+    return;
+
+  CommCompression::register_codec(BlockCompressionCodec::ZLIB,
+      new CommCodecAdapter(BlockCompressionCodec::ZLIB));
+  CommCompression::register_codec(BlockCompressionCodec::LZO,
+      new CommCodecAdapter(BlockCompressionCodec::LZO));
+  CommCompression::register_codec(BlockCompressionCodec::QUICKLZ,
+      new CommCodecAdapter(BlockCompressionCodec::QUICKLZ));
+
+  if (Config::properties) {
+    BlockCompressionCodec::Args args;
+    BlockCompressionCodec::Type type = parse_block_codec_spec(
+        Config::properties->get_str("Comm.Compression.Codec", "quicklz"), args);
+    if (type == BlockCompressionCodec::ZLIB ||
+        type == BlockCompressionCodec::LZO ||
+        type == BlockCompressionCodec::QUICKLZ)
+      CommCompression::set_default_codec(type);
+    CommCompression::set_threshold(
+        Config::properties->get_i32("Comm.Compression.Threshold", 16*1024));
+    CommCompression::set_max_ratio(
+        Config::properties->get_i32("Comm.Compression.MaxRatio", 80));
+    CommCompression::set_decompress_threads(
+        Config::properties->get_i32("Comm.Compression.DecompressThreads", 2));
+  }
+  else
+    CommCompression::set_default_codec(BlockCompressionCodec::QUICKLZ);
+
+  comm_codecs_registered = true;
+}
@@ -46,6 +46,13 @@ public:
     BlockCompressionCodec::Args args;
     return create_block_codec(parse_block_codec_spec(spec, args));
   }
+
+  /**
+   * Registers the zlib, lzo and quicklz codecs for RPC payload compression
+   * (see CommCompression) and configures it from the Comm.Compression.*
+   * properties.  Only the first call has any effect.
+   */
+  static void register_comm_codecs();
 };
 
 } // namespace Hypertable
@@ -1097,6 +1097,8 @@ namespace {
     "       | TIMESTAMP_COLUMN '=' name |",
     "       | HEADER_FILE '=' '\"' filename '\"'",
     "       | ROW_UNIQUIFY_CHARS '=' n",
+    "       | PARSERS '=' n",
+    "       | MUTATORS '=' n",
     "       | DUPLICATE_KEY_COLUMNS",
     "       | IGNORE_UNKNOWN_COLUMNS",
     "       | NO_ESCAPE)*",
@@ -1283,6 +1285,16 @@ namespace {
     "timestamp usually only has resolution down to the second and there may be",
     "many entries that fall within the same second.",
     "",
+    "PARSERS = n",
+    "MUTATORS = n",
+    "",
+    "The PARSERS option loads the input in parallel: it is read in chunks of",
+    "whole lines that are parsed by n threads, which insert the cells through",
+    "MUTATORS mutators (default, and at most, one per parser).  All cells of",
+    "a row go through the same mutator, in input order, so several versions",
+    "of a cell with auto-assigned timestamps are loaded as they would be",
+    "without PARSERS.  Only applies to loads INTO TABLE.",
+    "",
     "DUPLICATE_KEY_COLUMNS",
     "",
     "Normally input fields that represent the row key (the first field or the",
@@ -1588,6 +1600,7 @@ namespace {
     "      (REVS revision_count",
     "      | INTO FILE filename[.gz]",
     "      | BUCKETS <n>",
+    "      | PARALLEL <n>",
     "      | NO_ESCAPE)*",
     "",
     "    timestamp:",
@@ -1636,6 +1649,18 @@ namespace {
     "20.  It is recommended that <n> is at least as large as the number of nodes",
     "in the cluster that the backup with be restored to.",
     "",
+    "PARALLEL <n>",
+    "",
+    "This option dumps the table range by range, scanning <n> ranges at a time",
+    "(alternating between RangeServers), and requires INTO FILE.  The file name",
+    "names a directory that receives one file per range, part-NNNNN.tsv (or",
+    "part-NNNNN.tsv.gz, gzip compressed, if the directory name ends in .gz), and",
+    "a MANIFEST file.  The MANIFEST lists the cell count of each part together",
+    "with a LOAD DATA INFILE statement for it.  Since the parts hold disjoint",
+    "row ranges, the backup is best restored by running these statements",
+    "concurrently, e.g. by splitting the MANIFEST across several hypertable",
+    "shells.  The BUCKETS option has no effect in this mode.",
+    "",
     "NO_ESCAPE",
     "",
     "The output format of a DUMP TABLE command comprises tab delimited lines, one",
@@ -1664,6 +1689,7 @@ namespace {
     "  DUMP TABLE foo WHERE '2008-07-28 00:00:02' < TIMESTAMP < '2008-07-28 00:00:07';",
     "  DUMP TABLE foo INTO FILE 'foo.tsv.gz'",
     "  DUMP TABLE foo REVS 1 BUCKETS 1000;",
+    "  DUMP TABLE foo INTO FILE 'dfs://backup/foo.gz' PARALLEL 16;",
     "  DUMP TABLE LoadTest COLUMNS user:/^a/ WHERE ROW REGEXP \"1.*2\" AND VALUE REGEXP \"foob\";",
     "",
     0
@@ -52,9 +52,11 @@ extern "C" {
 #include "Key.h"
 #include "LoadDataEscape.h"
 #include "LoadDataFlags.h"
+#include "LoadDataParallel.h"
 #include "LoadDataSource.h"
 #include "LoadDataSourceFactory.h"
 #include "ScanSpec.h"
+#include "TableDumperParallel.h"
 #include "TableSplit.h"
 #include "Types.h"
 
@@ -71,6 +73,16 @@ void close_file(int fd) {
     close(fd);
 }
 
+void report_load_progress(HqlInterpreter::Callback &cb, bool largefile_mode,
+                          ::uint32_t consumed, int64_t *last_totalp) {
+  if (largefile_mode == true) {
+    int64_t new_total = *last_totalp + consumed;
+    consumed = (unsigned long)((new_total / 1048576LL) - (*last_totalp / 1048576LL));
+    *last_totalp = new_total;
+  }
+  cb.on_progress(consumed);
+}
+
 void cmd_help(ParserState &state, HqlInterpreter::Callback &cb) {
   const char **text = HqlHelpText::get(state.str);
 
@@ -455,6 +467,29 @@ cmd_dump_table(NamespacePtr &ns,
 
   // verify parameters
 
+  if (state.scan.parallel > 0) {
+    if (state.scan.outfile.empty())
+      HT_THROW(Error::HQL_PARSE_ERROR,
+               "DUMP TABLE PARALLEL requires INTO FILE directory");
+    FileUtils::expand_tilde(state.scan.outfile);
+    // init Dfs client if not done yet
+    if (boost::algorithm::starts_with(state.scan.outfile, dfs) && !dfs_client)
+      dfs_client = new DfsBroker::Client(conn_manager, Config::properties);
+
+    TableDumperParallel dumper(ns, state.table_name, state.scan.builder.get(),
+                               dfs_client, state.scan.outfile, state.escape,
+                               state.scan.parallel);
+    dumper.run();
+
+    if (cb.normal_mode) {
+      cb.total_cells += dumper.get_total_cells();
+      cb.total_keys_size += dumper.get_total_keys_size();
+      cb.total_values_size += dumper.get_total_values_size();
+    }
+    cb.on_finish(0);
+    return;
+  }
+
   TableDumperPtr dumper = new TableDumper(ns, state.table_name, state.scan.builder.get());
 
   // whether it's select into file
@@ -489,8 +524,6 @@ cmd_dump_table(NamespacePtr &ns,
   Cell cell;
   LoadDataEscape row_escaper;
   LoadDataEscape escaper;
-  const char *unescaped_buf, *row_unescaped_buf;
-  size_t unescaped_len, row_unescaped_len;
 
   while (dumper->next(cell)) {
     if (cb.normal_mode) {
@@ -504,41 +537,10 @@ cmd_dump_table(NamespacePtr &ns,
       cb.total_values_size += cell.value_len;
     }
 
-    fout << cell.timestamp << "\t";
-
     if (state.escape)
-      row_escaper.escape(cell.row_key, strlen(cell.row_key),
-			 &row_unescaped_buf, &row_unescaped_len);
-    else
-      row_unescaped_buf = cell.row_key;
-
-    if (cell.column_family) {
-      fout << row_unescaped_buf << "\t" << cell.column_family;
-      if (cell.column_qualifier && *cell.column_qualifier) {
-	if (state.escape)
-	  escaper.escape(cell.column_qualifier, strlen(cell.column_qualifier),
-			 &unescaped_buf, &unescaped_len);
-	else
-	  unescaped_buf = cell.column_qualifier;
-	fout << ":" << unescaped_buf;
-      }
-    }
+      write_dump_cell(fout, cell, &row_escaper, &escaper);
     else
-      fout << row_unescaped_buf;
-
-    if (state.escape)
-      escaper.escape((const char *)cell.value, (size_t)cell.value_len,
-		     &unescaped_buf, &unescaped_len);
-    else {
-      unescaped_buf = (const char *)cell.value;
-      unescaped_len = (size_t)cell.value_len;
-    }
-
-    HT_ASSERT(cell.flag == FLAG_INSERT);
-
-    fout << "\t" ;
-    fout.write(unescaped_buf, unescaped_len);
-    fout << "\n";
+      write_dump_cell(fout, cell, 0, 0);
   }
 
   fout.strict_sync();
@@ -560,7 +562,7 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   FILE *outf = cb.output;
   int out_fd = -1;
   bool largefile_mode = false;
-  int64_t last_total = 0, new_total;
+  int64_t last_total = 0;
 
   if (LoadDataFlags::ignore_unknown_cfs(state.load_flags))
     mutator_flags |= TableMutator::FLAG_IGNORE_UNKNOWN_CFS;
@@ -580,7 +582,8 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
     else
       fout.push(boost::iostreams::null_sink());
     table = ns->open_table(state.table_name);
-    mutator = table->create_mutator(0, mutator_flags);
+    if (state.load_parsers == 0)
+      mutator = table->create_mutator(0, mutator_flags);
   }
 
   HT_ON_SCOPE_EXIT(&close_file, out_fd);
@@ -614,6 +617,24 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
       fout << "row\tcolumn\tvalue\n";
   }
 
+  if (into_table && state.load_parsers > 0) {
+    LoadDataParallel loader(lds, table, mutator_flags, state.escape,
+                            state.load_parsers, state.load_mutators);
+    ::uint32_t consumed;
+
+    while (loader.read(&consumed)) {
+      if (cb.normal_mode && state.input_file_src != STDIN)
+        report_load_progress(cb, largefile_mode, consumed, &last_total);
+    }
+    loader.finish();
+
+    cb.total_cells += loader.get_total_cells();
+    cb.total_keys_size += loader.get_total_keys_size();
+    cb.total_values_size += loader.get_total_values_size();
+    cb.on_finish(0);
+    return;
+  }
+
   KeySpec key;
   ::uint8_t *value;
   ::uint32_t value_len;
@@ -667,14 +688,8 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
           fout << key.row << "\t" << key.column_family << "\t" << escaped_buf << "\n";
       }
 
-      if (cb.normal_mode && state.input_file_src != STDIN) {
-        if (largefile_mode == true) {
-          new_total = last_total + consumed;
-          consumed = (unsigned long)((new_total / 1048576LL) - (last_total / 1048576LL));
-          last_total = new_total;
-        }
-        cb.on_progress(consumed);
-      }
+      if (cb.normal_mode && state.input_file_src != STDIN)
+        report_load_progress(cb, largefile_mode, consumed, &last_total);
     }
   }
   catch (Exception &e) {
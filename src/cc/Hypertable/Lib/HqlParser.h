@@ -210,7 +210,7 @@ namespace Hypertable {
       ScanState() : display_timestamps(false), keys_only(false),
           current_rowkey_set(false), start_time_set(false),
           end_time_set(false), current_timestamp_set(false),
-	  current_relop(0), buckets(0) { }
+	  current_relop(0), buckets(0), parallel(0) { }
 
       void set_time_interval(::int64_t start, ::int64_t end) {
         HQL_DEBUG("("<< start <<", "<< end <<")");
@@ -246,6 +246,7 @@ namespace Hypertable {
       bool    current_timestamp_set;
       int current_relop;
       int buckets;
+      int parallel;
     };
 
     class ParserState {
@@ -256,7 +257,8 @@ namespace Hypertable {
                       decimal_seconds(0), delete_all_columns(false),
                       delete_time(0), if_exists(false), tables_only(false), with_ids(false),
                       replay(false), scanner_id(-1), row_uniquify_chars(0),
-                      escape(true), nokeys(false) {
+                      load_parsers(0), load_mutators(0), escape(true),
+                      nokeys(false) {
         memset(&tmval, 0, sizeof(tmval));
       }
       int command;
@@ -304,6 +306,8 @@ namespace Hypertable {
       String range_end_row;
       ::int32_t scanner_id;
       ::int32_t row_uniquify_chars;
+      ::uint32_t load_parsers;
+      ::uint32_t load_mutators;
       bool escape;
       bool nokeys;
       String current_rename_column_old_name;
@@ -834,6 +838,22 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct set_load_parsers {
+      set_load_parsers(ParserState &state) : state(state) { }
+      void operator()(int n) const {
+        state.load_parsers = n;
+      }
+      ParserState &state;
+    };
+
+    struct set_load_mutators {
+      set_load_mutators(ParserState &state) : state(state) { }
+      void operator()(int n) const {
+        state.load_mutators = n;
+      }
+      ParserState &state;
+    };
+
     struct set_ignore_unknown_cfs {
       set_ignore_unknown_cfs(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -1074,6 +1094,17 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct scan_set_parallel {
+      scan_set_parallel(ParserState &state) : state(state) { }
+      void operator()(int ival) const {
+        if (state.scan.parallel != 0)
+          HT_THROW(Error::HQL_PARSE_ERROR,
+                   "DUMP TABLE PARALLEL predicate multiply defined.");
+        state.scan.parallel = ival;
+      }
+      ParserState &state;
+    };
+
     struct scan_set_outfile {
       scan_set_outfile(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -1589,6 +1620,8 @@ namespace Hypertable {
           Token TIMESTAMP_COLUMN        = as_lower_d["timestamp_column"];
           Token HEADER_FILE             = as_lower_d["header_file"];
           Token ROW_UNIQUIFY_CHARS      = as_lower_d["row_uniquify_chars"];
+          Token PARSERS                 = as_lower_d["parsers"];
+          Token MUTATORS                = as_lower_d["mutators"];
           Token IGNORE_UNKNOWN_CFS      = as_lower_d["ignore_unknown_cfs"];
           Token IGNORE_UNKNOWN_COLUMNS  = as_lower_d["ignore_unknown_columns"];
           Token DUP_KEY_COLS            = as_lower_d["dup_key_cols"];
@@ -1652,6 +1685,7 @@ namespace Hypertable {
           Token NOKEYS       = as_lower_d["nokeys"];
           Token SINGLE_CELL_FORMAT = as_lower_d["single_cell_format"];
           Token BUCKETS      = as_lower_d["buckets"];
+          Token PARALLEL     = as_lower_d["parallel"];
           Token REPLICATION  = as_lower_d["replication"];
           Token WAIT         = as_lower_d["wait"];
           Token FOR          = as_lower_d["for"];
@@ -1796,8 +1830,11 @@ namespace Hypertable {
           dump_table_option_spec
             = MAX_VERSIONS >> EQUAL >> uint_p[scan_set_max_versions(self.state)]
             | BUCKETS >> uint_p[scan_set_buckets(self.state)]
+            | PARALLEL >> uint_p[scan_set_parallel(self.state)]
             | REVS >> !EQUAL >> uint_p[scan_set_max_versions(self.state)]
             | INTO >> FILE >> string_literal[scan_set_outfile(self.state)]
+            | NOESCAPE[set_noescape(self.state)]
+            | NO_ESCAPE[set_noescape(self.state)]
             ;
 
           dump_table_statement
@@ -2207,6 +2244,8 @@ namespace Hypertable {
                 set_header_file(self.state)]
             | ROW_UNIQUIFY_CHARS >> EQUAL >> uint_p[
                 set_row_uniquify_chars(self.state)]
+            | PARSERS >> EQUAL >> uint_p[set_load_parsers(self.state)]
+            | MUTATORS >> EQUAL >> uint_p[set_load_mutators(self.state)]
             | DUP_KEY_COLS >> EQUAL >> boolean_literal[
                 set_dup_key_cols(self.state)]
             | DUP_KEY_COLS[set_dup_key_cols_true(self.state)]
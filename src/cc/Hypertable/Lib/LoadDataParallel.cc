@@ -0,0 +1,319 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstring>
+
+#include <boost/bind.hpp>
+
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/MurmurHash.h"
+#include "Common/String.h"
+
+#include "LoadDataParallel.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /** Arena pages hold the row keys and unescaped strings of a chunk */
+  const size_t ARENA_PAGE_SIZE = 1024 * 1024;
+
+}
+
+
+LoadDataParallel::LoadDataParallel(LoadDataSourcePtr &source,
+    TablePtr &table, uint32_t mutator_flags, bool unescape, size_t parsers,
+    size_t mutators, size_t chunk_size)
+  : m_source(source), m_unescape(unescape), m_chunk_size(chunk_size),
+    m_next_seq(0), m_done(false),
+    m_failed(false), m_total_cells(0), m_total_keys_size(0),
+    m_total_values_size(0) {
+
+  HT_ASSERT(parsers > 0 && chunk_size > 0);
+  if (mutators == 0 || mutators > parsers)
+    mutators = parsers;
+
+  for (size_t i = 0; i < mutators; i++) {
+    MutatorSlot *slot = new MutatorSlot();
+    slot->mutator = table->create_mutator(0, mutator_flags);
+    m_mutators.push_back(slot);
+  }
+
+  // two chunks per parser, so reading overlaps parsing
+  for (size_t i = 0; i < 2 * parsers; i++) {
+    m_chunks.push_back(new Chunk());
+    m_free_chunks.push_back(m_chunks.back());
+  }
+
+  for (size_t i = 0; i < parsers; i++) {
+    Parser *parser = new Parser();
+    parser->source = m_source->create_chunk_parser();
+    parser->cells.resize(mutators);
+    parser->arena.set_page_size(ARENA_PAGE_SIZE);
+    m_parsers.push_back(parser);
+  }
+
+  foreach(Parser *parser, m_parsers)
+    m_threads.create_thread(boost::bind(&LoadDataParallel::parse, this,
+                                        parser));
+}
+
+
+LoadDataParallel::~LoadDataParallel() {
+  stop();
+  foreach(Parser *parser, m_parsers)
+    delete parser;
+  foreach(Chunk *chunk, m_chunks)
+    delete chunk;
+  foreach(MutatorSlot *slot, m_mutators)
+    delete slot;
+}
+
+
+bool LoadDataParallel::read(uint32_t *consumedp) {
+  Chunk *chunk;
+
+  {
+    ScopedLock lock(m_mutex);
+    while (m_free_chunks.empty() && !m_failed)
+      m_free_cond.wait(lock);
+    if (m_failed)
+      HT_THROW(Error::HQL_BAD_LOAD_FILE_FORMAT, m_error_msg);
+    chunk = m_free_chunks.back();
+    m_free_chunks.pop_back();
+  }
+
+  bool more = m_source->next_chunk(m_chunk_size, chunk->buf, &chunk->first_line,
+                                   consumedp);
+
+  ScopedLock lock(m_mutex);
+  if (!more) {
+    m_free_chunks.push_back(chunk);
+    return false;
+  }
+  chunk->seq = m_next_seq++;
+  m_queue.push_back(chunk);
+  m_queue_cond.notify_one();
+  return true;
+}
+
+
+void LoadDataParallel::finish() {
+  stop();
+
+  if (m_failed)
+    HT_THROW(Error::HQL_BAD_LOAD_FILE_FORMAT, m_error_msg);
+
+  foreach(MutatorSlot *slot, m_mutators) {
+    try {
+      slot->mutator->flush();
+    }
+    catch (Exception &e) {
+      do {
+        slot->mutator->show_failed(e);
+      } while (!slot->mutator->retry());
+    }
+  }
+}
+
+
+uint64_t LoadDataParallel::get_resend_count() {
+  uint64_t count = 0;
+  foreach(MutatorSlot *slot, m_mutators)
+    count += slot->mutator->get_resend_count();
+  return count;
+}
+
+
+void LoadDataParallel::parse(Parser *parser) {
+  Chunk *chunk;
+  bool failed;
+
+  while (true) {
+    {
+      ScopedLock lock(m_mutex);
+      while (m_queue.empty() && !m_done)
+        m_queue_cond.wait(lock);
+      if (m_queue.empty())
+        break;
+      chunk = m_queue.front();
+      m_queue.pop_front();
+      failed = m_failed;
+    }
+
+    foreach(vector<ParsedCell> &cells, parser->cells)
+      cells.clear();
+
+    // after an error, just drain the queue
+    if (!failed) {
+      try {
+        load_chunk(parser, chunk);
+      }
+      catch (Exception &e) {
+        set_failed(format("line number %lld - %s",
+                          (Lld)parser->source->get_current_lineno(),
+                          e.what()));
+        foreach(vector<ParsedCell> &cells, parser->cells)
+          cells.clear();
+      }
+    }
+
+    // the mutators wait for every chunk in turn, even one that isn't loaded
+    submit_chunk(parser, chunk);
+
+    ScopedLock lock(m_mutex);
+    m_free_chunks.push_back(chunk);
+    m_free_cond.notify_all();
+  }
+}
+
+
+void LoadDataParallel::load_chunk(Parser *parser, Chunk *chunk) {
+  const char *base = (const char *)chunk->buf.base;
+  const char *end = base + chunk->buf.fill();
+  ParsedCell cell;
+  uint8_t *value;
+  uint32_t value_len;
+  const char *buf;
+  size_t len;
+  int64_t row_line = -1;
+  const char *row_copy = 0;
+  uint64_t keys_size = 0, values_size = 0, cell_count = 0;
+
+  parser->arena.free();
+  parser->source->set_chunk((char *)chunk->buf.base, chunk->buf.fill(),
+                            chunk->first_line);
+
+  /**
+   * Fields are parsed in place and stay valid with the chunk; only row
+   * keys assembled by the parser and unescaped strings get copied
+   */
+  while (parser->source->next(0, &cell.key, &value, &value_len, 0)) {
+    const char *row = (const char *)cell.key.row;
+
+    keys_size += cell.key.row_len;
+    values_size += value_len;
+
+    if (m_unescape && parser->row_escaper.unescape(row, cell.key.row_len,
+                                                   &buf, &len)) {
+      cell.key.row = parser->arena.dup(buf, len + 1);
+      cell.key.row_len = len;
+    }
+    else if (row < base || row >= end) {
+      // one copy per line, the row key buffer is reused for the next one
+      if (parser->source->get_current_lineno() != row_line) {
+        row_line = parser->source->get_current_lineno();
+        char *copy = parser->arena.alloc(cell.key.row_len + 1);
+        memcpy(copy, row, cell.key.row_len);
+        copy[cell.key.row_len] = 0;
+        row_copy = copy;
+      }
+      cell.key.row = row_copy;
+    }
+
+    if (m_unescape && parser->qualifier_escaper.unescape(
+            cell.key.column_qualifier, cell.key.column_qualifier_len,
+            &buf, &len)) {
+      cell.key.column_qualifier = parser->arena.dup(buf, len + 1);
+      cell.key.column_qualifier_len = len;
+    }
+
+    if (m_unescape && parser->value_escaper.unescape((const char *)value,
+                                                     value_len, &buf, &len)) {
+      cell.value = parser->arena.dup(buf, len + 1);
+      cell.value_len = len;
+    }
+    else {
+      cell.value = (const char *)value;
+      cell.value_len = value_len;
+    }
+
+    // all cells of a row go through the same mutator
+    size_t slot = murmurhash2(cell.key.row, cell.key.row_len, 0)
+        % m_mutators.size();
+    parser->cells[slot].push_back(cell);
+    cell_count++;
+  }
+
+  ScopedLock lock(m_mutex);
+  m_total_cells += cell_count;
+  m_total_keys_size += keys_size;
+  m_total_values_size += values_size;
+}
+
+
+/**
+ * Hands the cells of a chunk to the mutators.  Each mutator takes the
+ * chunks in input order, so this waits, mutator by mutator, until the
+ * chunks before this one have been handed to it.
+ */
+void LoadDataParallel::submit_chunk(Parser *parser, Chunk *chunk) {
+  for (size_t i = 0; i < m_mutators.size(); i++) {
+    MutatorSlot *slot = m_mutators[i];
+    ScopedLock lock(slot->mutex);
+
+    while (slot->next_seq != chunk->seq)
+      slot->cond.wait(lock);
+
+    try {
+      foreach(const ParsedCell &pc, parser->cells[i]) {
+        try {
+          slot->mutator->set(pc.key, pc.value, pc.value_len);
+        }
+        catch (Exception &e) {
+          do {
+            slot->mutator->show_failed(e);
+          } while (!slot->mutator->retry());
+        }
+      }
+    }
+    catch (Exception &e) {
+      set_failed(e.what());
+    }
+
+    slot->next_seq++;
+    slot->cond.notify_all();
+  }
+}
+
+
+void LoadDataParallel::set_failed(const String &msg) {
+  ScopedLock lock(m_mutex);
+  if (!m_failed) {
+    m_failed = true;
+    m_error_msg = msg;
+  }
+}
+
+
+void LoadDataParallel::stop() {
+  {
+    ScopedLock lock(m_mutex);
+    if (m_done)
+      return;
+    m_done = true;
+    m_queue_cond.notify_all();
+  }
+  m_threads.join_all();
+}
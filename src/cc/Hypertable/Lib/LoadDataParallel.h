@@ -0,0 +1,157 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_LOADDATAPARALLEL_H
+#define HYPERTABLE_LOADDATAPARALLEL_H
+
+#include <boost/thread/condition.hpp>
+
+#include <list>
+#include <vector>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Mutex.h"
+#include "Common/PageArena.h"
+#include "Common/Thread.h"
+
+#include "LoadDataEscape.h"
+#include "LoadDataSource.h"
+#include "Table.h"
+#include "TableMutator.h"
+
+namespace Hypertable {
+
+  /**
+   * Parallel LOAD DATA INFILE.  The caller reads the input in chunks of
+   * whole lines with read(); the chunks are parsed in place by a pool of
+   * parser threads, each using a chunk parser of the source, and the cells
+   * are written through a (smaller or equal) set of mutators shared by
+   * the parsers.  Each row goes to the mutator picked by the hash of the
+   * row key, and each mutator takes the cells of the chunks in input
+   * order, so the cells of a row are loaded in the order they appear in
+   * the input.
+   */
+  class LoadDataParallel {
+  public:
+    enum { DEFAULT_CHUNK_SIZE = 4 * 1024 * 1024 };
+
+    /**
+     * Constructor.
+     *
+     * @param source initialized load data source
+     * @param table table to load
+     * @param mutator_flags flags for the mutators
+     * @param unescape whether to unescape rows, qualifiers and values
+     * @param parsers number of parser threads
+     * @param mutators number of mutators (at most <code>parsers</code>)
+     * @param chunk_size size of the chunks handed to the parsers
+     */
+    LoadDataParallel(LoadDataSourcePtr &source, TablePtr &table,
+                     uint32_t mutator_flags, bool unescape, size_t parsers,
+                     size_t mutators, size_t chunk_size=DEFAULT_CHUNK_SIZE);
+    ~LoadDataParallel();
+
+    /**
+     * Reads the next chunk of input and queues it for the parsers,
+     * waiting while all chunk buffers are in use.  Throws the first error
+     * a parser ran into, if any.
+     *
+     * @param consumedp address to return number of input bytes consumed
+     * @return false at end of input
+     */
+    bool read(uint32_t *consumedp);
+
+    /**
+     * Waits for the queued chunks to be loaded, stops the parser threads
+     * and flushes the mutators.  Throws the first error a parser ran into.
+     */
+    void finish();
+
+    uint64_t get_total_cells() const { return m_total_cells; }
+    uint64_t get_total_keys_size() const { return m_total_keys_size; }
+    uint64_t get_total_values_size() const { return m_total_values_size; }
+    uint64_t get_resend_count();
+
+  private:
+    struct Chunk {
+      Chunk() : buf(0), first_line(0), seq(0) { }
+      DynamicBuffer buf;
+      int64_t first_line;
+      /** Position of the chunk in the input */
+      uint64_t seq;
+    };
+
+    struct ParsedCell {
+      KeySpec key;
+      const char *value;
+      uint32_t value_len;
+    };
+
+    struct MutatorSlot {
+      MutatorSlot() : next_seq(0) { }
+      Mutex mutex;
+      boost::condition cond;
+      TableMutatorPtr mutator;
+      /** Sequence number of the chunk whose cells the mutator takes next */
+      uint64_t next_seq;
+    };
+
+    /** State of one parser thread */
+    struct Parser {
+      LoadDataSourcePtr source;
+      LoadDataEscape row_escaper;
+      LoadDataEscape qualifier_escaper;
+      LoadDataEscape value_escaper;
+      /** Cells of the current chunk, by mutator */
+      std::vector<std::vector<ParsedCell> > cells;
+      CharArena arena;
+    };
+
+    void parse(Parser *parser);
+    void load_chunk(Parser *parser, Chunk *chunk);
+    void submit_chunk(Parser *parser, Chunk *chunk);
+    void set_failed(const String &msg);
+    void stop();
+
+    LoadDataSourcePtr m_source;
+    bool m_unescape;
+    size_t m_chunk_size;
+    Mutex m_mutex;
+    boost::condition m_queue_cond;
+    boost::condition m_free_cond;
+    std::list<Chunk *> m_queue;
+    std::vector<Chunk *> m_free_chunks;
+    std::vector<Chunk *> m_chunks;
+    uint64_t m_next_seq;
+    std::vector<MutatorSlot *> m_mutators;
+    std::vector<Parser *> m_parsers;
+    ThreadGroup m_threads;
+    bool m_done;
+    bool m_failed;
+    String m_error_msg;
+    uint64_t m_total_cells;
+    uint64_t m_total_keys_size;
+    uint64_t m_total_values_size;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_LOADDATAPARALLEL_H
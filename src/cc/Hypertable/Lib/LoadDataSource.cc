@@ -54,6 +54,26 @@ using namespace boost::iostreams;
 using namespace Hypertable;
 using namespace std;
 
+namespace {
+
+  const size_t CHUNK_READ_SIZE = 1024 * 1024;
+
+  /**
+   * Parses chunks of another source's input on behalf of a parallel
+   * load, see LoadDataSource::create_chunk_parser()
+   */
+  class LoadDataSourceChunk : public LoadDataSource {
+  public:
+    LoadDataSourceChunk(int row_uniquify_chars, int load_flags)
+      : LoadDataSource("", row_uniquify_chars, load_flags) { }
+
+  protected:
+    void init_src() { }
+    uint64_t incr_consumed() { return 0; }
+  };
+
+}
+
 
 /**
  *
@@ -64,7 +84,8 @@ LoadDataSource::LoadDataSource(const String &header_fname, int row_uniquify_char
     m_timestamp_index(-1), m_timestamp(AUTO_ASSIGN), m_offset(0),
     m_zipped(false), m_rsgen(0), m_header_fname(header_fname),
     m_row_uniquify_chars(row_uniquify_chars),
-    m_load_flags(load_flags), m_first_line_cached(false), m_source_size(0) {
+    m_load_flags(load_flags), m_first_line_cached(false), m_source_size(0),
+    m_chunk_carry(0), m_chunk_ptr(0), m_chunk_end(0) {
   if (row_uniquify_chars)
     m_rsgen = new FixedRandomStringGenerator(row_uniquify_chars);
 
@@ -290,9 +311,9 @@ LoadDataSource::parse_header(const String &header, const std::vector<String> &ke
 bool
 LoadDataSource::next(uint32_t *type_flagp, KeySpec *keyp,
     uint8_t **valuep, uint32_t *value_lenp, uint32_t *consumedp) {
-  String line;
   int index;
-  char *base, *ptr, *colon;
+  char *base, *ptr, *colon, *end;
+  size_t line_len;
 
   if (type_flagp)
     *type_flagp = FLAG_INSERT;
@@ -302,17 +323,11 @@ LoadDataSource::next(uint32_t *type_flagp, KeySpec *keyp,
 
   if (m_hyperformat) {
 
-    while (get_next_line(line)) {
+    while (get_next_line(&base, &line_len)) {
       m_cur_line++;
 
       if (consumedp && !m_zipped)
-        *consumedp += line.length() + 1;
-
-      m_line_buffer.clear();
-
-      m_line_buffer.add(line.c_str(), strlen(line.c_str())+1);
-
-      base = (char *)m_line_buffer.base;
+        *consumedp += line_len + 1;
 
       /**
        *  Get timestamp
@@ -446,23 +461,25 @@ LoadDataSource::next(uint32_t *type_flagp, KeySpec *keyp,
       return true;
     }
 
-    while (get_next_line(line)) {
+    while (get_next_line(&base, &line_len)) {
       m_cur_line++;
       index = 0;
 
       if (consumedp && !m_zipped)
-        *consumedp += line.length() + 1;
-
-      boost::trim(line);
-      if (line.length() == 0)
+        *consumedp += line_len + 1;
+
+      // trim in place
+      while (isspace(*base))
+        base++;
+      end = base + strlen(base);
+      while (end > base && isspace(end[-1]))
+        end--;
+      if (end == base)
         continue;
+      *end = 0;
 
-      m_line_buffer.clear();
-      m_line_buffer.add(line.c_str(), strlen(line.c_str())+1);
       m_values.clear();
 
-      base = (char *)m_line_buffer.base;
-
       while ((ptr = strchr(base, '\t')) != 0) {
         *ptr++ = 0;
 
@@ -578,6 +595,138 @@ LoadDataSource::next(uint32_t *type_flagp, KeySpec *keyp,
 
 
 
+bool LoadDataSource::get_next_line(char **linep, size_t *lenp) {
+
+  if (m_chunk_ptr) {
+    if (m_chunk_ptr >= m_chunk_end)
+      return false;
+    char *eol = (char *)memchr(m_chunk_ptr, '\n', m_chunk_end - m_chunk_ptr);
+    if (eol == 0)
+      eol = m_chunk_end;
+    *eol = 0;
+    *linep = m_chunk_ptr;
+    *lenp = eol - m_chunk_ptr;
+    m_chunk_ptr = eol + 1;
+    return true;
+  }
+
+  if (m_first_line_cached) {
+    m_line = m_first_line;
+    m_first_line_cached = false;
+  }
+  else if (!getline(m_fin, m_line))
+    return false;
+
+  m_line_buffer.clear();
+  m_line_buffer.add(m_line.c_str(), m_line.length() + 1);
+  *linep = (char *)m_line_buffer.base;
+  *lenp = m_line.length();
+  return true;
+}
+
+
+bool
+LoadDataSource::next_chunk(size_t target_size, DynamicBuffer &chunk,
+                           int64_t *first_linep, uint32_t *consumedp) {
+  uint8_t *eol = 0;
+  size_t scanned = 0;
+  bool eof = false;
+  // don't read far past a small target, the rest would only be carried
+  size_t read_size = (target_size && target_size < CHUNK_READ_SIZE) ?
+    target_size : CHUNK_READ_SIZE;
+
+  chunk.clear();
+
+  if (m_first_line_cached) {
+    chunk.add(m_first_line.c_str(), m_first_line.length());
+    chunk.add("\n", 1);
+    m_first_line_cached = false;
+  }
+
+  if (m_chunk_carry.fill()) {
+    chunk.add(m_chunk_carry.base, m_chunk_carry.fill());
+    m_chunk_carry.clear();
+  }
+
+  // read until the chunk is big enough and has a line boundary
+  while (true) {
+    if (chunk.fill() >= target_size) {
+      for (uint8_t *ptr = chunk.ptr; ptr > chunk.base + scanned; ptr--) {
+        if (ptr[-1] == '\n') {
+          eol = ptr - 1;
+          break;
+        }
+      }
+      if (eol)
+        break;
+      scanned = chunk.fill();
+    }
+    chunk.ensure(read_size + 1);
+    m_fin.read((char *)chunk.ptr, read_size);
+    chunk.ptr += m_fin.gcount();
+    if ((size_t)m_fin.gcount() < read_size) {
+      eof = true;
+      break;
+    }
+  }
+
+  if (eof) {
+    if (chunk.fill() == 0)
+      return false;
+    if (chunk.ptr[-1] != '\n') {
+      chunk.ensure(2);
+      *chunk.ptr++ = '\n';
+    }
+  }
+  else {
+    // hold back the partial last line for the next chunk
+    m_chunk_carry.add(eol + 1, chunk.ptr - (eol + 1));
+    chunk.ptr = eol + 1;
+  }
+
+  chunk.ensure(1);
+  *chunk.ptr = 0;
+
+  *first_linep = m_cur_line + 1;
+  for (uint8_t *ptr = chunk.base; ptr < chunk.ptr; ptr++) {
+    if ((ptr = (uint8_t *)memchr(ptr, '\n', chunk.ptr - ptr)) == 0)
+      break;
+    m_cur_line++;
+  }
+
+  if (consumedp)
+    *consumedp = m_zipped ? incr_consumed() : chunk.fill();
+
+  return true;
+}
+
+
+LoadDataSource *LoadDataSource::create_chunk_parser() {
+  HT_ASSERT(m_type_mask);
+  LoadDataSource *parser = new LoadDataSourceChunk(m_row_uniquify_chars,
+                                                   m_load_flags);
+  parser->m_column_info = m_column_info;
+  parser->m_key_comps = m_key_comps;
+  parser->m_type_mask = new uint32_t [257];
+  memcpy(parser->m_type_mask, m_type_mask, 257*sizeof(uint32_t));
+  parser->m_hyperformat = m_hyperformat;
+  parser->m_leading_timestamps = m_leading_timestamps;
+  parser->m_timestamp_index = m_timestamp_index;
+  parser->m_next_value = m_column_info.size();
+  parser->m_limit = 0;
+  return parser;
+}
+
+
+void LoadDataSource::set_chunk(char *base, size_t len, int64_t first_line) {
+  m_chunk_ptr = base;
+  m_chunk_end = base + len;
+  m_cur_line = first_line - 1;
+  m_next_value = m_column_info.size();
+  m_limit = 0;
+}
+
+
 bool LoadDataSource::add_row_component(int index) {
   const char *value = m_values[m_key_comps[index].index];
   size_t value_len = 0;
@@ -55,7 +55,10 @@ namespace Hypertable {
 		   int row_uniquify_chars = 0,
                    int load_flags = 0);
 
-    virtual ~LoadDataSource() { delete [] m_type_mask; return; }
+    virtual ~LoadDataSource() {
+      delete [] m_type_mask;
+      delete m_rsgen;
+    }
 
     bool has_timestamps() {
       return m_leading_timestamps || (m_timestamp_index != -1);
@@ -70,16 +73,40 @@ namespace Hypertable {
     int64_t get_current_lineno() { return m_cur_line; }
     unsigned long get_source_size() const { return m_source_size; }
 
+    /**
+     * Reads the next chunk of raw input for parsing on another thread.  The
+     * chunk holds whole lines, roughly <code>target_size</code> bytes of
+     * them, and is followed by a NUL byte (not counted in its fill).
+     *
+     * @param target_size approximate chunk size
+     * @param chunk buffer to read the chunk into
+     * @param first_linep address to return line number of first line
+     * @param consumedp address to return number of input bytes consumed
+     * @return false at end of input
+     */
+    bool next_chunk(size_t target_size, DynamicBuffer &chunk,
+                    int64_t *first_linep, uint32_t *consumedp);
+
+    /**
+     * Returns a new source that parses chunks obtained from next_chunk()
+     * the same way this (initialized) source parses its input.
+     */
+    LoadDataSource *create_chunk_parser();
+
+    /**
+     * Makes next() return the cells of the given chunk, which is parsed in
+     * place.  <code>base[len]</code> must be writable.  Only for sources
+     * returned by create_chunk_parser().
+     */
+    void set_chunk(char *base, size_t len, int64_t first_line);
+
   protected:
 
-    bool get_next_line(String &line) {
-      if (m_first_line_cached) {
-	       line = m_first_line;
-	       m_first_line_cached = false;
-	       return true;
-      }
-      return getline(m_fin, line);
-    }
+    /**
+     * Returns the next input line, NUL terminated and writable; chunk lines
+     * are returned in place, stream lines in m_line_buffer
+     */
+    bool get_next_line(char **linep, size_t *lenp);
 
     virtual void parse_header(const String& header,
                               const std::vector<String> &key_columns,
@@ -143,6 +170,10 @@ namespace Hypertable {
     String m_first_line;
     bool m_first_line_cached;
     unsigned long m_source_size;
+    String m_line;
+    DynamicBuffer m_chunk_carry;
+    char *m_chunk_ptr;
+    char *m_chunk_end;
   };
 
  typedef boost::intrusive_ptr<LoadDataSource> LoadDataSourcePtr;
@@ -89,37 +89,39 @@ bool NameIdMapper::id_to_name(const String &id, String &name, bool *is_namespace
 
 void NameIdMapper::add_entry(const String &names_parent, const String &names_entry,
                              std::vector<uint64_t> &ids, bool is_namespace) {
-  uint64_t handle_names_file = 0;
   uint64_t handle_ids_file = 0;
-  uint64_t handle_parent_ids_file = 0;
   uint64_t id = 0;
   String names_file = m_names_dir + names_parent + "/" + names_entry;
+  std::vector<Hyperspace::MultiOp> ops;
 
-  HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, m_hyperspace, &handle_names_file);
   HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, m_hyperspace, &handle_ids_file);
-  HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, m_hyperspace, &handle_parent_ids_file);
 
   String parent_ids_file = m_ids_dir;
   for (size_t i=0; i<ids.size(); i++)
     parent_ids_file += String("/") + ids[i];
 
   if (!m_hyperspace->exists(names_file)) {
-    handle_parent_ids_file = m_hyperspace->open(parent_ids_file, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
-    id = m_hyperspace->attr_incr(handle_parent_ids_file, "nid");
+    ops.push_back(MultiOp(MultiOp::ATTR_INCR, parent_ids_file, "nid"));
+    m_hyperspace->multi(ops);
+    id = ops.back().number;
+    ops.clear();
   }
   else {
-    handle_names_file = m_hyperspace->open(names_file, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
-    if (m_hyperspace->attr_exists(handle_names_file, "id")) {
-      DynamicBuffer dbuf;
-      m_hyperspace->attr_get(handle_names_file, "id", dbuf);
-      id = strtoll((const char *)dbuf.base, 0, 0);
-    }
+    char buf[16];
+    ops.push_back(MultiOp(MultiOp::ATTR_GET, names_file, "id",
+                          MultiOp::FLAG_OPTIONAL));
+    m_hyperspace->multi(ops);
+    if (ops.back().exists)
+      id = strtoll(ops.back().value.c_str(), 0, 0);
     else {
-      handle_parent_ids_file = m_hyperspace->open(parent_ids_file, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
-      id = m_hyperspace->attr_incr(handle_parent_ids_file, "nid");
-      char buf[16];
+      ops.clear();
+      ops.push_back(MultiOp(MultiOp::ATTR_INCR, parent_ids_file, "nid"));
+      m_hyperspace->multi(ops);
+      id = ops.back().number;
       sprintf(buf, "%llu", (Llu)id);
-      m_hyperspace->attr_set(handle_names_file, "id", buf, strlen(buf));
+      ops.clear();
+      ops.push_back(MultiOp(MultiOp::ATTR_SET, names_file, "id", buf));
+      m_hyperspace->multi(ops);
     }
     ids.push_back(id);
     return;
@@ -138,56 +140,30 @@ void NameIdMapper::add_entry(const String &names_parent, const String &names_ent
     }
   }
   else {
-    if (is_namespace) {
-      try {
-        m_hyperspace->mkdir(ids_file);
-      }
-      catch (Exception &e) {
-        HT_ERROR_OUT << e << HT_END;
-        throw;
-      }
-      handle_ids_file = m_hyperspace->open(ids_file, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
-      m_hyperspace->attr_set(handle_ids_file, "name", names_entry.c_str(), names_entry.length());
-      m_hyperspace->attr_set(handle_ids_file, "nid", "0", 1);
-    }
-    else {
-      std::vector<Hyperspace::Attribute> init_attrs;
-      Hyperspace::HandleCallbackPtr null_callback;
-      int oflags = OPEN_FLAG_READ|OPEN_FLAG_WRITE|OPEN_FLAG_CREATE|OPEN_FLAG_EXCL;
-      init_attrs.push_back(Hyperspace::Attribute("name", names_entry.c_str(), names_entry.length()));
-      handle_ids_file = m_hyperspace->create(ids_file, oflags, null_callback, init_attrs);
-    }
-  }
-
-  // At this point the ID file exists, we now need to
-  // create the names file/dir and update the "id" attribute
-
-  if (is_namespace) {
-    m_hyperspace->mkdir(names_file);
-    handle_names_file = m_hyperspace->open(names_file, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
+    ops.push_back(MultiOp(is_namespace ? MultiOp::MKDIR : MultiOp::CREATE, ids_file));
+    ops.push_back(MultiOp(MultiOp::ATTR_SET, ids_file, "name", names_entry));
+    if (is_namespace)
+      ops.push_back(MultiOp(MultiOp::ATTR_SET, ids_file, "nid", "0"));
   }
-  else
-    handle_names_file = m_hyperspace->open(names_file, OPEN_FLAG_READ|OPEN_FLAG_WRITE|OPEN_FLAG_CREATE|OPEN_FLAG_EXCL);
 
   /**
-   * Set the "id" attribute of the names file
+   * Create the names file/dir and set its "id" attribute, together with
+   * the ID file if it still had to be created
    */
   char buf[16];
   sprintf(buf, "%llu", (Llu)id);
-  m_hyperspace->attr_set(handle_names_file, "id", buf, strlen(buf));
+  ops.push_back(MultiOp(is_namespace ? MultiOp::MKDIR : MultiOp::CREATE, names_file));
+  ops.push_back(MultiOp(MultiOp::ATTR_SET, names_file, "id", buf));
+  m_hyperspace->multi(ops);
   ids.push_back(id);
 }
 
 void NameIdMapper::add_mapping(const String &name, String &id, int flags, bool ignore_exists) {
   ScopedLock lock(m_mutex);
-  uint64_t handle = 0;
   typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
   boost::char_separator<char> sep("/");
   std::vector<String> name_components;
   std::vector<uint64_t> id_components;
-  DynamicBuffer value_buf;
-
-  HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, m_hyperspace, &handle);
 
   tokenizer tokens(name, sep);
   for (tokenizer::iterator tok_iter = tokens.begin();
@@ -198,25 +174,26 @@ void NameIdMapper::add_mapping(const String &name, String &id, int flags, bool i
 
   String names_parent = "";
   String names_child = "";
+  std::vector<Hyperspace::MultiOp> ops;
 
+  // look up the ids of all of the intermediate namespaces in one request
   for (size_t i=0; i<name_components.size()-1; i++) {
-
     names_child += String("/") + name_components[i];
+    ops.push_back(MultiOp(MultiOp::ATTR_GET, m_names_dir + names_child, "id",
+                          MultiOp::FLAG_OPTIONAL));
+  }
+  if (!ops.empty())
+    m_hyperspace->multi(ops);
 
-    try {
-      String names_file = m_names_dir + names_child;
-      handle = m_hyperspace->open(names_file, OPEN_FLAG_READ);
-      m_hyperspace->attr_get(handle, "id", value_buf);
-      m_hyperspace->close(handle);
-      handle = 0;
-      id_components.push_back( strtoll((const char *)value_buf.base, 0, 0) );
-    }
-    catch (Exception &e) {
+  names_child = "";
 
-      if (e.code() != Error::HYPERSPACE_BAD_PATHNAME &&
-          e.code() != Error::HYPERSPACE_FILE_NOT_FOUND)
-        throw;
+  for (size_t i=0; i<name_components.size()-1; i++) {
 
+    names_child += String("/") + name_components[i];
+
+    if (ops[i].exists)
+      id_components.push_back( strtoll(ops[i].value.c_str(), 0, 0) );
+    else {
       if (!(flags & CREATE_INTERMEDIATE))
         HT_THROW(Error::NAMESPACE_DOES_NOT_EXIST, names_child);
 
@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/ByteString.h"
+#include "Common/Serialization.h"
+
+#include "PendingCounters.h"
+
+using namespace Hypertable;
+
+
+/**
+ * Builds the name a counter cell is tracked under: row, '\\0', column
+ * family code and, if <code>with_qualifier</code> is set, the qualifier.
+ * The names of all the cells of a row (or of a column family within a
+ * row) share the name of the row (or column family) as a prefix.
+ */
+void
+PendingCounters::cell_name(const Key &key, bool with_qualifier,
+                           String &name) {
+  name = key.row;
+  name.append(1, '\0');
+  if (key.column_family_code) {
+    name.append(1, (char)key.column_family_code);
+    if (with_qualifier && key.column_qualifier)
+      name += key.column_qualifier;
+  }
+}
+
+
+void
+PendingCounters::add(const Key &key, DynamicBuffer *buf,
+                     size_t value_offset) {
+  String name;
+  cell_name(key, true, name);
+  Entry &entry = m_map[name];
+  entry.buf = buf;
+  entry.value_offset = value_offset;
+}
+
+
+bool
+PendingCounters::fold(const Key &key, const uint8_t *value, bool reset) {
+  String name;
+  cell_name(key, true, name);
+  EntryMap::iterator iter = m_map.find(name);
+
+  if (iter == m_map.end())
+    return false;
+
+  ByteString bs((*iter).second.buf->base + (*iter).second.value_offset);
+  const uint8_t *data;
+  size_t len = bs.decode_length(&data);
+  uint8_t *ptr = (uint8_t *)data;
+
+  if (!reset) {
+    const uint8_t *decode = data;
+    size_t remain = 8;
+    uint64_t count = Serialization::decode_i64(&decode, &remain);
+    remain = 8;
+    count += Serialization::decode_i64(&value, &remain);
+    Serialization::encode_i64(&ptr, count);
+    return true;
+  }
+
+  if (len == 9) {
+    memcpy(ptr, value, 9);
+    return true;
+  }
+
+  return false;
+}
+
+
+void PendingCounters::drop(const Key &key, uint8_t flag) {
+  String name;
+
+  if (flag == FLAG_DELETE_CELL) {
+    cell_name(key, true, name);
+    m_map.erase(name);
+    return;
+  }
+
+  // row and column family deletes cover every cell under the prefix
+  cell_name(key, false, name);
+  if (flag == FLAG_DELETE_ROW)
+    name.resize(strlen(key.row) + 1);
+
+  for (EntryMap::iterator iter = m_map.begin(); iter != m_map.end(); ) {
+    if (!iter->first.compare(0, name.length(), name))
+      m_map.erase(iter++);
+    else
+      ++iter;
+  }
+}
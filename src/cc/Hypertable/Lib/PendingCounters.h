@@ -0,0 +1,96 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_PENDINGCOUNTERS_H
+#define HYPERTABLE_PENDINGCOUNTERS_H
+
+#include "Common/DynamicBuffer.h"
+#include "Common/HashMap.h"
+#include "Common/String.h"
+
+#include "Key.h"
+
+namespace Hypertable {
+
+  /**
+   * Keeps track of the counter updates buffered by a mutator that have not
+   * been sent yet, so that later updates of the same cell can be folded
+   * into them.  Counter values are encoded as a 64 bit int, followed by a
+   * '=' character if the update is a counter reset.  An increment is added
+   * to the buffered value, keeping its reset flag, and a reset replaces a
+   * buffered reset.  A reset that follows buffered increments is not
+   * folded; it has to be buffered as a cell of its own, after them, and
+   * later increments are folded into it.  Nothing is folded across a
+   * delete of the cell.
+   */
+  class PendingCounters {
+  public:
+    /**
+     * Records the location of a buffered counter update.
+     *
+     * @param key key of the counter cell
+     * @param buf buffer holding the update
+     * @param value_offset offset of the encoded value within <code>buf</code>
+     */
+    void add(const Key &key, DynamicBuffer *buf, size_t value_offset);
+
+    /**
+     * Folds an encoded counter update into the buffered update of the same
+     * cell, if there is one.
+     *
+     * @param key key of the counter cell
+     * @param value encoded counter value (9 bytes if it is a reset)
+     * @param reset true if the update is a counter reset
+     * @return true if the update was folded
+     */
+    bool fold(const Key &key, const uint8_t *value, bool reset);
+
+    /**
+     * Forgets the buffered updates covered by a delete, so that nothing
+     * buffered after the delete is folded into them.
+     *
+     * @param key key of the delete
+     * @param flag FLAG_DELETE_ROW, FLAG_DELETE_COLUMN_FAMILY or
+     *        FLAG_DELETE_CELL
+     */
+    void drop(const Key &key, uint8_t flag);
+
+    /** Forgets all buffered updates (e.g. once they are sent) */
+    void clear() { m_map.clear(); }
+
+    size_t size() const { return m_map.size(); }
+
+  private:
+    /** Location of the buffered update of a counter cell */
+    struct Entry {
+      DynamicBuffer *buf;
+      size_t value_offset;
+    };
+    typedef hash_map<String, Entry> EntryMap;
+
+    static void cell_name(const Key &key, bool with_qualifier, String &name);
+
+    EntryMap m_map;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_PENDINGCOUNTERS_H
@@ -35,9 +35,19 @@ using namespace Hypertable::Config;
 
 
 RangeServerClient::RangeServerClient(Comm *comm, uint32_t timeout_ms)
-  : m_comm(comm), m_default_timeout_ms(timeout_ms) {
+  : m_comm(comm), m_default_timeout_ms(timeout_ms),
+    m_create_scanner_flags(0) {
   if (timeout_ms == 0)
     m_default_timeout_ms = get_i32("Hypertable.Request.Timeout");
+  if (properties) {
+    if (properties->get_bool("Hypertable.Scanner.CompactResults", true))
+      m_create_scanner_flags |=
+        RangeServerProtocol::CREATE_SCANNER_FLAG_COMPACT;
+    if (properties->get_bool("Hypertable.Scanner.CompressResults", false))
+      m_create_scanner_flags |=
+        RangeServerProtocol::CREATE_SCANNER_FLAG_COMPACT |
+        RangeServerProtocol::CREATE_SCANNER_FLAG_COMPRESS;
+  }
 }
 
 
@@ -167,7 +177,7 @@ RangeServerClient::create_scanner(const CommAddress &addr,
     const TableIdentifier &table, const RangeSpec &range,
     const ScanSpec &scan_spec, DispatchHandler *handler) {
   CommBufPtr cbp(RangeServerProtocol::create_request_create_scanner(table,
-                 range, scan_spec));
+                 range, scan_spec, m_create_scanner_flags));
   send_message(addr, cbp, handler, m_default_timeout_ms);
 }
 
@@ -177,7 +187,7 @@ RangeServerClient::create_scanner(const CommAddress &addr,
     const ScanSpec &scan_spec, DispatchHandler *handler,
     Timer &timer) {
   CommBufPtr cbp(RangeServerProtocol::create_request_create_scanner(table,
-                 range, scan_spec));
+                 range, scan_spec, m_create_scanner_flags));
   send_message(addr, cbp, handler, timer.remaining());
 }
 
@@ -207,7 +217,7 @@ RangeServerClient::do_create_scanner(const CommAddress &addr,
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommBufPtr cbp(RangeServerProtocol::create_request_create_scanner(table,
-                 range, scan_spec));
+                 range, scan_spec, m_create_scanner_flags));
   send_message(addr, cbp, &sync_handler, timeout_ms);
 
   if (!sync_handler.wait_for_reply(event))
@@ -503,6 +513,26 @@ RangeServerClient::decode_response_get_statistics(EventPtr &event, StatsRangeSer
 }
 
 
+void
+RangeServerClient::dump_traces(const CommAddress &addr,
+                               std::vector<Trace::Span> &spans) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event;
+  CommBufPtr cbp(RangeServerProtocol::create_request_dump_traces());
+  send_message(addr, cbp, &sync_handler, m_default_timeout_ms);
+
+  if (!sync_handler.wait_for_reply(event))
+    HT_THROW((int)Protocol::response_code(event),
+             String("RangeServer dump_traces() failure : ")
+             + Protocol::string_format_message(event));
+
+  size_t remaining = event->payload_len - 4;
+  const uint8_t *ptr = event->payload + 4;
+
+  Trace::decode(spans, &ptr, &remaining);
+}
+
+
 void
 RangeServerClient::replay_begin(const CommAddress &addr, uint16_t group,
                                 DispatchHandler *handler) {
@@ -27,6 +27,7 @@
 #include "Common/InetAddr.h"
 #include "Common/StaticBuffer.h"
 #include "Common/ReferenceCount.h"
+#include "Common/Trace.h"
 
 #include "AsyncComm/Comm.h"
 #include "AsyncComm/CommBuf.h"
@@ -448,6 +449,14 @@ namespace Hypertable {
     static void decode_response_get_statistics(EventPtr &event,
                                                StatsRangeServer &stats);
 
+    /** Issues a synchronous "dump_traces" request, which fetches the
+     * contents of the RangeServer's trace buffer (see Trace).
+     *
+     * @param addr address of RangeServer
+     * @param spans vector to hold the returned trace spans
+     */
+    void dump_traces(const CommAddress &addr, std::vector<Trace::Span> &spans);
+
 
     /** Issues an asynchronous "replay begin" request.
      *
@@ -581,6 +590,7 @@ namespace Hypertable {
 
     Comm *m_comm;
     uint32_t m_default_timeout_ms;
+    uint32_t m_create_scanner_flags;
   };
 
   typedef boost::intrusive_ptr<RangeServerClient> RangeServerClientPtr;
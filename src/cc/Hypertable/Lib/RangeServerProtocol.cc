@@ -21,6 +21,7 @@
 
 #include "Common/Compat.h"
 #include "AsyncComm/CommBuf.h"
+#include "AsyncComm/CommCompression.h"
 #include "AsyncComm/CommHeader.h"
 
 #include "RangeServerProtocol.h"
@@ -51,6 +52,7 @@ namespace Hypertable {
     "close",
     "wait for maintenance",
     "acknowledge load",
+    "dump traces",
     (const char *)0
   };
 
@@ -87,6 +89,8 @@ namespace Hypertable {
     table.encode(cbuf->get_data_ptr_address());
     cbuf->append_i32(count);
     cbuf->append_i32(flags);
+    if (flags & UPDATE_FLAG_COMPRESS)
+      cbuf->set_compression(CommCompression::default_codec());
     return cbuf;
   }
 
@@ -114,15 +118,18 @@ namespace Hypertable {
 
   CommBuf *RangeServerProtocol::
   create_request_create_scanner(const TableIdentifier &table,
-      const RangeSpec &range, const ScanSpec &scan_spec) {
+      const RangeSpec &range, const ScanSpec &scan_spec, uint32_t flags) {
     CommHeader header(COMMAND_CREATE_SCANNER);
     if (table.is_system()) // If system table, set the urgent bit
       header.flags |= CommHeader::FLAGS_BIT_URGENT;
     CommBuf *cbuf = new CommBuf(header, table.encoded_length()
-        + range.encoded_length() + scan_spec.encoded_length());
+        + range.encoded_length() + scan_spec.encoded_length()
+        + (flags ? 4 : 0));
     table.encode(cbuf->get_data_ptr_address());
     range.encode(cbuf->get_data_ptr_address());
     scan_spec.encode(cbuf->get_data_ptr_address());
+    if (flags)
+      cbuf->append_i32(flags);
     return cbuf;
   }
 
@@ -251,4 +258,11 @@ namespace Hypertable {
     return cbuf;
   }
 
+  CommBuf *RangeServerProtocol::create_request_dump_traces() {
+    CommHeader header(COMMAND_DUMP_TRACES);
+    header.flags |= CommHeader::FLAGS_BIT_URGENT;
+    CommBuf *cbuf = new CommBuf(header);
+    return cbuf;
+  }
+
 } // namespace Hypertable
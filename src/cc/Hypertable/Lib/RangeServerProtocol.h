@@ -57,7 +57,8 @@ namespace Hypertable {
     static const uint64_t COMMAND_CLOSE                = 18;
     static const uint64_t COMMAND_WAIT_FOR_MAINTENANCE = 19;
     static const uint64_t COMMAND_ACKNOWLEDGE_LOAD     = 20;
-    static const uint64_t COMMAND_MAX                  = 21;
+    static const uint64_t COMMAND_DUMP_TRACES          = 21;
+    static const uint64_t COMMAND_MAX                  = 22;
 
     static const char *m_command_strings[];
 
@@ -72,7 +73,17 @@ namespace Hypertable {
     enum {
       /* Don't force a commit log sync on update */
       UPDATE_FLAG_NO_LOG_SYNC        = 0x0001,
-      UPDATE_FLAG_IGNORE_UNKNOWN_CFS = 0x0002
+      UPDATE_FLAG_IGNORE_UNKNOWN_CFS = 0x0002,
+      /* Compress the request payload; ignored by the RangeServer */
+      UPDATE_FLAG_COMPRESS           = 0x0004
+    };
+
+    // Create scanner flags, select the encoding of returned scan blocks
+    enum {
+      /* Prefix compress the keys of each scan block (see ScanBlockEncoder) */
+      CREATE_SCANNER_FLAG_COMPACT    = 0x0001,
+      /* Also block compress each scan block; implies COMPACT */
+      CREATE_SCANNER_FLAG_COMPRESS   = 0x0002
     };
 
     /** Creates a "load range" request message
@@ -124,10 +135,12 @@ namespace Hypertable {
      * @param table table identifier
      * @param range range specification
      * @param scan_spec scan specification
+     * @param flags create scanner flags (sent only if non-zero, servers
+     *        that don't know about them return plain scan blocks)
      * @return protocol message
      */
     static CommBuf *create_request_create_scanner(const TableIdentifier &table,
-        const RangeSpec &range, const ScanSpec &scan_spec);
+        const RangeSpec &range, const ScanSpec &scan_spec, uint32_t flags = 0);
 
     /** Creates a "destroy scanner" request message.
      *
@@ -235,6 +248,12 @@ namespace Hypertable {
      */
     static CommBuf *create_request_get_statistics();
 
+    /** Creates a "dump traces" request message.
+     *
+     * @return protocol message
+     */
+    static CommBuf *create_request_dump_traces();
+
     virtual const char *command_text(uint64_t command);
   };
 
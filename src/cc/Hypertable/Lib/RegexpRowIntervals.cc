@@ -0,0 +1,225 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <re2/re2.h>
+
+#include "RegexpRowIntervals.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  // longest bound computed by RE2::PossibleMatchRange()
+  const int MAX_BOUND_LENGTH = 256;
+
+  /**
+   * Returns the offset of the parenthesis that closes the group opened at
+   * <code>open</code>, or String::npos if the group is not closed.  With
+   * <code>open</code> set to -1 the whole pattern is scanned and its
+   * length is returned if it is balanced.  The offsets of the top-level
+   * '|' characters inside the group are added to <code>bars</code>.
+   */
+  size_t scan_group(const String &re, long open, vector<size_t> &bars) {
+    int depth = 0;
+    bool in_class = false;
+
+    for (size_t i = open + 1; i < re.length(); i++) {
+      char c = re[i];
+      if (c == '\\')
+        i++;
+      else if (in_class) {
+        if (c == ']')
+          in_class = false;
+      }
+      else if (c == '[') {
+        in_class = true;
+        // a ']' right after '[' or '[^' is a literal
+        if (i + 1 < re.length() && re[i+1] == '^')
+          i++;
+        if (i + 1 < re.length() && re[i+1] == ']')
+          i++;
+      }
+      else if (c == '(')
+        depth++;
+      else if (c == ')') {
+        if (depth == 0)
+          return (open < 0) ? String::npos : i;
+        depth--;
+      }
+      else if (c == '|' && depth == 0)
+        bars.push_back(i);
+    }
+    if (open >= 0 || depth || in_class)
+      return String::npos;
+    return re.length();
+  }
+
+  void split(const String &re, size_t begin, size_t end,
+             const vector<size_t> &bars, vector<String> &parts) {
+    foreach(size_t bar, bars) {
+      parts.push_back(re.substr(begin, bar - begin));
+      begin = bar + 1;
+    }
+    parts.push_back(re.substr(begin, end - begin));
+  }
+
+  /**
+   * Returns the smallest string that is greater than every string that
+   * starts with <code>str</code>, or an empty string if there is none.
+   */
+  String prefix_successor(String str) {
+    while (!str.empty() && (uint8_t)str[str.length()-1] == 0xff)
+      str.erase(str.length()-1);
+    if (!str.empty())
+      str[str.length()-1] = (char)((uint8_t)str[str.length()-1] + 1);
+    return str;
+  }
+
+  bool lt_start(const RegexpRowIntervals::Interval &i1,
+                const RegexpRowIntervals::Interval &i2) {
+    return i1.start < i2.start;
+  }
+
+}
+
+
+RegexpRowIntervals::RegexpRowIntervals(const char *regexp) {
+  String re = regexp ? regexp : "";
+  vector<size_t> bars;
+  vector<String> branches;
+
+  if (re.empty() || scan_group(re, -1, bars) == String::npos)
+    return;
+
+  split(re, 0, re.length(), bars, branches);
+
+  foreach(const String &branch, branches) {
+    if (!add_alternative(branch)) {
+      m_intervals.clear();
+      return;
+    }
+  }
+
+  sort(m_intervals.begin(), m_intervals.end(), lt_start);
+
+  // merge overlapping and adjacent intervals
+  size_t last = 0;
+  for (size_t i=1; i<m_intervals.size(); i++) {
+    if (m_intervals[i].start <= m_intervals[last].end) {
+      if (m_intervals[i].end > m_intervals[last].end)
+        m_intervals[last].end = m_intervals[i].end;
+    }
+    else
+      m_intervals[++last] = m_intervals[i];
+  }
+  m_intervals.resize(last + 1);
+
+  // too many to be worth separate scans; keep the interval spanning them
+  if (m_intervals.size() > MAX_INTERVALS) {
+    String end = m_intervals.back().end;
+    m_intervals.resize(1);
+    m_intervals[0].end = end;
+  }
+}
+
+
+/**
+ * Adds the intervals of one top-level alternative.  If it starts with a
+ * group of alternatives that is not repeated, e.g. "^(a|b)c", it is
+ * expanded into "^ac" and "^bc" first.
+ *
+ * @return false if the alternative is not anchored or does not fix a
+ * prefix of the rows it matches
+ */
+bool RegexpRowIntervals::add_alternative(const String &branch) {
+
+  if (branch.length() < 2 || branch[0] != '^')
+    return false;
+
+  if (branch[1] == '(') {
+    vector<size_t> bars;
+    size_t close = scan_group(branch, 1, bars);
+    if (close != String::npos && !bars.empty() &&
+        (close + 1 == branch.length() ||
+         !strchr("*+?{", branch[close+1]))) {
+      size_t begin = 2;
+      if (branch.compare(2, 2, "?:") == 0)
+        begin = 4;
+      else if (branch[2] == '?')
+        begin = 0;   // flags or named group, leave it to RE2
+      if (begin) {
+        vector<String> parts;
+        String rest = branch.substr(close + 1);
+        split(branch, begin, close, bars, parts);
+        foreach(const String &part, parts) {
+          if (!add_alternative(String("^") + part + rest))
+            return false;
+        }
+        return true;
+      }
+    }
+  }
+
+  RE2 re(branch);
+  Interval interval;
+  String max;
+  size_t common = 0;
+
+  if (!re.ok() ||
+      !re.PossibleMatchRange(&interval.start, &max, MAX_BOUND_LENGTH))
+    return false;
+
+  /**
+   * The bounds hold for the part of the row that the pattern matches,
+   * which may be followed by anything.  Every string between the bounds
+   * starts with their common prefix, so the rows that match do too.
+   */
+  while (common < interval.start.length() && common < max.length() &&
+         interval.start[common] == max[common])
+    common++;
+  interval.end = prefix_successor(max.substr(0, common));
+  if (interval.end.empty())
+    return false;
+
+  m_intervals.push_back(interval);
+  return true;
+}
+
+
+const RegexpRowIntervals::Interval *
+RegexpRowIntervals::find(const char *row) const {
+  size_t lo = 0, hi = m_intervals.size(), mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    if (strcmp(m_intervals[mid].end.c_str(), row) <= 0)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (lo < m_intervals.size()) ? &m_intervals[lo] : 0;
+}
@@ -0,0 +1,76 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_REGEXPROWINTERVALS_H
+#define HYPERTABLE_REGEXPROWINTERVALS_H
+
+#include <vector>
+
+#include "Common/String.h"
+
+namespace Hypertable {
+
+  /**
+   * Derives, from a ROW REGEXP, the row intervals outside of which no row
+   * can match.  A pattern is only restricted when every one of its
+   * alternatives is anchored with '^'; a leading group of alternatives,
+   * as in "^(user1|user7):", is distributed over the rest of the pattern
+   * so that each alternative yields an interval of its own.  The bounds of
+   * each alternative come from RE2::PossibleMatchRange().  The regexp
+   * itself still has to be applied to the rows inside the intervals.
+   */
+  class RegexpRowIntervals {
+  public:
+    enum { MAX_INTERVALS = 32 };
+
+    /** Row interval [start, end) */
+    struct Interval {
+      String start;
+      String end;
+    };
+
+    RegexpRowIntervals(const char *regexp);
+
+    /**
+     * Returns true if no intervals could be derived from the regexp, in
+     * which case any row may match
+     */
+    bool empty() const { return m_intervals.empty(); }
+
+    /** Returns the intervals, sorted and non-overlapping */
+    const std::vector<Interval> &get() const { return m_intervals; }
+
+    /**
+     * Returns the first interval that ends after <code>row</code>, or 0
+     * if there is none, in which case neither <code>row</code> nor any row
+     * after it can match.
+     */
+    const Interval *find(const char *row) const;
+
+  private:
+    bool add_alternative(const String &branch);
+
+    std::vector<Interval> m_intervals;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_REGEXPROWINTERVALS_H
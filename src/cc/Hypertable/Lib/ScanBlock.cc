@@ -26,7 +26,9 @@
 #include "AsyncComm/Protocol.h"
 #include "Common/Serialization.h"
 
+#include "CompressorFactory.h"
 #include "ScanBlock.h"
+#include "ScanBlockEncoder.h"
 
 using namespace Hypertable;
 using namespace Serialization;
@@ -35,8 +37,8 @@ using namespace Serialization;
 /**
  *
  */
-ScanBlock::ScanBlock() : m_flags(0x0001), m_scanner_id(-1) {
-  m_iter = m_vec.end();
+ScanBlock::ScanBlock() : m_flags(FLAG_EOS), m_scanner_id(-1), m_count(0),
+    m_base(0), m_ptr(0), m_end(0), m_prev_key(0), m_prev_key_len(0) {
 }
 
 
@@ -49,8 +51,8 @@ int ScanBlock::load(EventPtr &event_ptr) {
   uint32_t len;
 
   m_event_ptr = event_ptr;
-  m_vec.clear();
-  m_iter = m_vec.end();
+  m_count = 0;
+  m_base = m_ptr = m_end = 0;
 
   if ((m_error = (int)Protocol::response_code(event_ptr)) != Error::OK)
     return m_error;
@@ -59,40 +61,116 @@ int ScanBlock::load(EventPtr &event_ptr) {
     m_flags = decode_i16(&decode_ptr, &decode_remain);
     m_scanner_id = decode_i32(&decode_ptr, &decode_remain);
     len = decode_i32(&decode_ptr, &decode_remain);
+    if (len > decode_remain)
+      HT_THROWF(Error::PROTOCOL_ERROR, "Scan block length %u exceeds "
+                "remaining payload %u", (unsigned)len, (unsigned)decode_remain);
+
+    if (m_flags & FLAG_COMPACT)
+      load_compact(decode_ptr, len);
+    else {
+      m_base = decode_ptr;
+      m_end = decode_ptr + len;
+      SerializedKey key;
+      ByteString value;
+      for (const uint8_t *p = m_base; p < m_end; m_count++) {
+        key.ptr = p;
+        p += key.length();
+        value.ptr = p;
+        p += value.length();
+      }
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
+    m_base = m_ptr = m_end = 0;
+    m_count = 0;
     return e.code();
   }
-  uint8_t *p = (uint8_t *)decode_ptr;
-  uint8_t *endp = p + len;
-  SerializedKey key;
-  ByteString value;
-
-  while (p < endp) {
-    key.ptr = p;
-    p += key.length();
-    value.ptr = p;
-    p += value.length();
-    m_vec.push_back(std::make_pair(key, value));
-  }
-  m_iter = m_vec.begin();
+
+  reset();
 
   return m_error;
 }
 
 
+/**
+ * Sets up iteration over a compact block.  A compressed block is inflated
+ * into m_inflated; the key buffer is sized to hold every key of the block
+ * so that keys handed out by #next stay put until the next #load.
+ */
+void ScanBlock::load_compact(const uint8_t *ptr, size_t len) {
+  size_t remain = len;
+  uint8_t encoding = decode_i8(&ptr, &remain);
+
+  if (encoding & ScanBlockEncoder::COMPRESSED) {
+    BlockCompressionHeader header;
+    const uint8_t *hptr = ptr;
+    size_t hremain = remain;
+    header.decode(&hptr, &hremain);
+    BlockCompressionCodecPtr codec = CompressorFactory::create_block_codec(
+        (BlockCompressionCodec::Type)header.get_compression_type());
+    DynamicBuffer input(0, false);
+    input.base = (uint8_t *)ptr;
+    input.ptr = input.base + remain;
+    m_inflated.clear();
+    codec->inflate(input, m_inflated, header);
+    ptr = m_inflated.base;
+    remain = m_inflated.fill();
+  }
+
+  m_count = decode_vi32(&ptr, &remain);
+  size_t keys_length = decode_vi32(&ptr, &remain);
+
+  m_keys.clear();
+  m_keys.reserve(keys_length, true);
+
+  m_base = ptr;
+  m_end = ptr + remain;
+}
+
+
+void ScanBlock::reset() {
+  m_ptr = m_base;
+  m_keys.clear();
+  m_prev_key = 0;
+  m_prev_key_len = 0;
+}
+
+
 bool ScanBlock::next(SerializedKey &key, ByteString &value) {
 
   assert(m_error == Error::OK);
 
-  if (m_iter == m_vec.end())
+  if (m_ptr >= m_end)
     return false;
 
-  key = (*m_iter).first;
-  value = (*m_iter).second;
+  if (m_flags & FLAG_COMPACT) {
+    size_t remain = m_end - m_ptr;
+    size_t shared = decode_vi32(&m_ptr, &remain);
+    size_t suffix_len = decode_vi32(&m_ptr, &remain);
+    size_t key_len = shared + suffix_len;
+
+    if (shared > m_prev_key_len || suffix_len > remain ||
+        Serialization::encoded_length_vi32(key_len) + key_len
+        > m_keys.remaining())
+      HT_THROW(Error::PROTOCOL_ERROR, "Corrupt compact scan block");
+
+    key.ptr = m_keys.ptr;
+    encode_vi32(&m_keys.ptr, key_len);
+    memcpy(m_keys.ptr, m_prev_key, shared);
+    memcpy(m_keys.ptr + shared, m_ptr, suffix_len);
+    m_prev_key = m_keys.ptr;
+    m_prev_key_len = key_len;
+    m_keys.ptr += key_len;
+    m_ptr += suffix_len;
+  }
+  else {
+    key.ptr = m_ptr;
+    m_ptr += key.length();
+  }
 
-  ++m_iter;
+  value.ptr = m_ptr;
+  m_ptr += value.length();
 
   return true;
 }
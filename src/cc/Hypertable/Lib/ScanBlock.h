@@ -22,11 +22,10 @@
 #ifndef HYPERTABLE_SCANBLOCK_H
 #define HYPERTABLE_SCANBLOCK_H
 
-#include <vector>
-
 #include "AsyncComm/Event.h"
 #include "Common/ReferenceCount.h"
 #include "Common/ByteString.h"
+#include "Common/DynamicBuffer.h"
 #include "SerializedKey.h"
 
 namespace Hypertable {
@@ -34,12 +33,18 @@ namespace Hypertable {
   /** Encapsulates a block of scan results.  The CREATE_SCANNER and
    * FETCH_SCANBLOCK RangeServer methods return a block of scan results
    * and this class parses and provides easy access to the key/value
-   * pairs in that result.
+   * pairs in that result.  Blocks in the compact encoding (see
+   * ScanBlockEncoder) are decoded as they are iterated, reconstructing the
+   * keys into a single buffer sized when the block is loaded.
    */
   class ScanBlock : public ReferenceCount {
   public:
 
-    typedef std::vector< std::pair<SerializedKey, ByteString> > Vector;
+    // Response flags
+    enum {
+      FLAG_EOS     = 0x0001,
+      FLAG_COMPACT = 0x0002  // block is in the ScanBlockEncoder encoding
+    };
 
     ScanBlock();
 
@@ -56,10 +61,10 @@ namespace Hypertable {
      *
      * @return number of key/value pairs in the scanblock
      */
-    size_t size() { return m_vec.size(); }
+    size_t size() { return m_count; }
 
     /** Resets iterator to first key/value pair in the scanblock. */
-    void reset() { m_iter = m_vec.begin(); }
+    void reset();
 
     /** Returns the next key/value pair in the scanblock.  <b>NOTE:</b>
      * invoking the #load method invalidates all pointers previously returned
@@ -75,29 +80,34 @@ namespace Hypertable {
      *
      * @return true if this is the final scanblock, or false if more to come
      */
-    bool eos() { return ((m_flags & 0x0001) == 0x0001); }
+    bool eos() { return ((m_flags & FLAG_EOS) == FLAG_EOS); }
 
     /** Indicates whether or not there are more key/value pairs in block
      *
      * @return ture if #next will return more key/value pairs, false otherwise
      */
-    bool more() {
-      if (m_iter == m_vec.end())
-        return false;
-      return true;
-    }
+    bool more() { return m_ptr < m_end; }
 
     /** Returns scanner ID associated with this scanblock.
      *
      * @return scanner ID
      */
     int get_scanner_id() { return m_scanner_id; }
+
   private:
+    void load_compact(const uint8_t *ptr, size_t len);
+
     int m_error;
     uint16_t m_flags;
     int m_scanner_id;
-    Vector m_vec;
-    Vector::iterator m_iter;
+    size_t m_count;
+    const uint8_t *m_base;
+    const uint8_t *m_ptr;
+    const uint8_t *m_end;
+    DynamicBuffer m_inflated;   // cells of a compressed compact block
+    DynamicBuffer m_keys;       // reconstructed keys of a compact block
+    const uint8_t *m_prev_key;  // previous key (body) in m_keys
+    size_t m_prev_key_len;
     EventPtr m_event_ptr;
   };
   typedef intrusive_ptr<ScanBlock> ScanBlockPtr;
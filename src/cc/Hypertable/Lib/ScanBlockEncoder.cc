@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Serialization.h"
+
+#include "CompressorFactory.h"
+#include "ScanBlockEncoder.h"
+
+using namespace Hypertable;
+
+namespace {
+  const char MAGIC_SCANBLOCK[10] =
+    { 'S','C','A','N','B','L','O','C','K',' ' };
+}
+
+
+ScanBlockEncoder::ScanBlockEncoder(bool compress)
+  : m_count(0), m_keys_length(0), m_compress(compress) {
+}
+
+
+void
+ScanBlockEncoder::add(SerializedKey key, const uint8_t *value,
+                      size_t value_len) {
+  const uint8_t *body = key.ptr;
+  size_t body_len = Serialization::decode_vi32(&body);
+  size_t prev_len = m_prev_key.fill();
+  size_t shared = 0;
+
+  while (shared < prev_len && shared < body_len &&
+         m_prev_key.base[shared] == body[shared])
+    shared++;
+
+  m_cells.ensure(10 + (body_len - shared) + value_len);
+  Serialization::encode_vi32(&m_cells.ptr, shared);
+  Serialization::encode_vi32(&m_cells.ptr, body_len - shared);
+  m_cells.add_unchecked(body + shared, body_len - shared);
+  m_cells.add_unchecked(value, value_len);
+
+  m_prev_key.clear();
+  m_prev_key.add(body, body_len);
+
+  m_keys_length += (body - key.ptr) + body_len;
+  m_count++;
+}
+
+
+void ScanBlockEncoder::finish(DynamicBuffer &dst) {
+  size_t header_len = Serialization::encoded_length_vi32(m_count)
+    + Serialization::encoded_length_vi32(m_keys_length);
+  uint8_t *ptr;
+
+  HT_ASSERT(dst.base == 0);
+
+  if (m_compress) {
+    BlockCompressionCodecPtr codec =
+      CompressorFactory::create_block_codec(BlockCompressionCodec::QUICKLZ);
+    BlockCompressionHeader header(MAGIC_SCANBLOCK);
+    DynamicBuffer input(header_len + m_cells.fill());
+    DynamicBuffer output;
+
+    Serialization::encode_vi32(&input.ptr, m_count);
+    Serialization::encode_vi32(&input.ptr, m_keys_length);
+    input.add_unchecked(m_cells.base, m_cells.fill());
+    codec->deflate(input, output, header);
+
+    dst.reserve(5 + output.fill());
+    dst.ptr = dst.base + 4;
+    *dst.ptr++ = COMPRESSED;
+    dst.add_unchecked(output.base, output.fill());
+  }
+  else {
+    dst.reserve(5 + header_len + m_cells.fill());
+    dst.ptr = dst.base + 4;
+    *dst.ptr++ = 0;
+    Serialization::encode_vi32(&dst.ptr, m_count);
+    Serialization::encode_vi32(&dst.ptr, m_keys_length);
+    dst.add_unchecked(m_cells.base, m_cells.fill());
+  }
+
+  ptr = dst.base;
+  Serialization::encode_i32(&ptr, dst.fill() - 4);
+}
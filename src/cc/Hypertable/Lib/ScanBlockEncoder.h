@@ -0,0 +1,93 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_SCANBLOCKENCODER_H
+#define HYPERTABLE_SCANBLOCKENCODER_H
+
+#include "Common/DynamicBuffer.h"
+
+#include "BlockCompressionCodec.h"
+#include "SerializedKey.h"
+
+namespace Hypertable {
+
+  /**
+   * Builds a scan block in the compact encoding requested with
+   * RangeServerProtocol::CREATE_SCANNER_FLAG_COMPACT.  A plain scan block
+   * is a sequence of serialized key / value pairs; in a compact block each
+   * key is stored as the number of leading bytes it shares with the
+   * previous key plus the remaining suffix, so a run of cells from the same
+   * row and column is sent with the row key and column family only once.
+   * The encoded block is:
+   *
+   * <pre>
+   *   i32   length of the rest of the block
+   *   i8    encoding (ScanBlockEncoder::COMPRESSED)
+   *   [BlockCompressionHeader, if compressed]
+   *   vi32  number of cells
+   *   vi32  total length of the cells' serialized keys
+   *   cells:
+   *     vi32  bytes shared with the previous key (excluding its length)
+   *     vi32  suffix length
+   *     suffix bytes
+   *     value (ByteString)
+   * </pre>
+   *
+   * The total key length lets ScanBlock reconstruct the keys into a single
+   * buffer as they are read.
+   */
+  class ScanBlockEncoder {
+  public:
+    enum { COMPRESSED = 0x01 };
+
+    /**
+     * @param compress block compress the cells (with quicklz)
+     */
+    ScanBlockEncoder(bool compress);
+
+    /** Adds a cell to the block
+     *
+     * @param key serialized key
+     * @param value serialized (ByteString) value
+     * @param value_len length of serialized value
+     */
+    void add(SerializedKey key, const uint8_t *value, size_t value_len);
+
+    /** Returns the number of cells added */
+    uint32_t count() const { return m_count; }
+
+    /** Writes the encoded block into an empty buffer
+     *
+     * @param dst buffer to receive the block
+     */
+    void finish(DynamicBuffer &dst);
+
+  private:
+    DynamicBuffer m_cells;
+    DynamicBuffer m_prev_key;
+    uint32_t m_count;
+    uint32_t m_keys_length;
+    bool m_compress;
+  };
+
+}
+
+#endif // HYPERTABLE_SCANBLOCKENCODER_H
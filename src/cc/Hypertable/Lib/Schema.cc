@@ -74,7 +74,7 @@ bool desc_inited = false;
 PropertiesDesc
   compressor_desc("  bmz|lzo|quicklz|zlib|none [compressor_options]\n\n"
       "compressor_options"),
-  bloom_filter_desc("  rows|rows+cols|none [bloom_filter_options]\n\n"
+  bloom_filter_desc("  rows|rows+cols|prefix|none [bloom_filter_options]\n\n"
       "  Default bloom filter is defined by the config property:\n"
       "  Hypertable.RangeServer.CellStore.DefaultBloomFilter.\n\n"
       "bloom_filter_options");
@@ -108,9 +108,17 @@ void init_schema_options_desc() {
      "probability for the Bloom filter")
     ("max-approx-items", i32()->default_value(1000), "Number of cell store "
         "items used to guess the number of actual Bloom filter entries")
+    ("prefix-length", i32(), "For prefix Bloom filters, length of the row "
+        "prefix entered into the filter")
+    ("prefix-delimiter", str(), "For prefix Bloom filters, character that "
+        "separates the components of a row key (default ':')")
+    ("prefix-delimiter-count", i32(), "For prefix Bloom filters, the row "
+        "prefix entered into the filter ends before this occurrence of the "
+        "delimiter")
     ;
   bloom_filter_hidden_desc.add_options()
-    ("bloom-filter-mode", str(), "Bloom filter mode (rows|rows+cols|none)")
+    ("bloom-filter-mode", str(), "Bloom filter mode "
+        "(rows|rows+cols|prefix|none)")
     ;
   bloom_filter_pos_desc.add("bloom-filter-mode", 1);
   desc_inited = true;
@@ -239,6 +247,12 @@ Schema::parse_bloom_filter(const String &bloom_filter, PropertiesPtr &props) {
            || mode == "rows-cols" || mode == "row-col"
            || mode == "rows_cols" || mode == "row_col")
     props->set("bloom-filter-mode", BLOOM_FILTER_ROWS_COLS);
+  else if (mode == "prefix" || mode == "rows+prefix" || mode == "row+prefix") {
+    if (!props->has("prefix-length") && !props->has("prefix-delimiter-count"))
+      HT_THROW(Error::BAD_SCHEMA, "prefix bloom filter requires "
+               "--prefix-length or --prefix-delimiter-count");
+    props->set("bloom-filter-mode", BLOOM_FILTER_ROWS_PREFIX);
+  }
   else HT_THROWF(Error::BAD_SCHEMA, "unknown bloom filter mode: '%s'",
                  mode.c_str());
 }
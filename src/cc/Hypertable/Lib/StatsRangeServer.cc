@@ -28,16 +28,35 @@ using namespace Hypertable;
 
 namespace {
   enum Group {
-    PRIMARY_GROUP = 0
+    PRIMARY_GROUP = 0,
+    LATENCY_GROUP = 1,
+    UPDATE_PHASE_GROUP = 2,
+    QUERY_CACHE_GROUP = 3
+  };
+
+  const char *rpc_type_names[StatsRangeServer::RPC_TYPE_COUNT] = {
+    "update",
+    "create_scanner",
+    "fetch_scanblock",
+    "load_range"
+  };
+
+  const char *update_phase_names[StatsRangeServer::UPDATE_PHASE_COUNT] = {
+    "decode",
+    "log_write",
+    "apply"
   };
 }
 
-StatsRangeServer::StatsRangeServer() : StatsSerializable(RANGE_SERVER, 1), timestamp(TIMESTAMP_MIN) {
+StatsRangeServer::StatsRangeServer() : StatsSerializable(RANGE_SERVER, 4), timestamp(TIMESTAMP_MIN) {
   group_ids[0] = PRIMARY_GROUP;
+  group_ids[1] = LATENCY_GROUP;
+  group_ids[2] = UPDATE_PHASE_GROUP;
+  group_ids[3] = QUERY_CACHE_GROUP;
 }
 
 
-StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RANGE_SERVER, 1), timestamp(TIMESTAMP_MIN) {
+StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RANGE_SERVER, 4), timestamp(TIMESTAMP_MIN) {
   const char *base, *ptr;
   String datadirs = props->get_str("Hypertable.RangeServer.Monitoring.DataDirectories");
   String dir;
@@ -60,6 +79,9 @@ StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RAN
                         StatsSystem::DISK|StatsSystem::SWAP|StatsSystem::NET|
                         StatsSystem::PROC | StatsSystem::FS, dirs);
   group_ids[0] = PRIMARY_GROUP;
+  group_ids[1] = LATENCY_GROUP;
+  group_ids[2] = UPDATE_PHASE_GROUP;
+  group_ids[3] = QUERY_CACHE_GROUP;
 }
 
 StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSerializable(other.id, other.group_count) {
@@ -84,6 +106,23 @@ StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSeriali
   block_cache_hits = other.block_cache_hits;
   system = other.system;
   tables = other.tables;
+  for (int i=0; i<RPC_TYPE_COUNT; i++) {
+    queue_latency[i] = other.queue_latency[i];
+    response_latency[i] = other.response_latency[i];
+  }
+  for (int i=0; i<UPDATE_PHASE_COUNT; i++)
+    update_phase_latency[i] = other.update_phase_latency[i];
+  query_cache_shards = other.query_cache_shards;
+}
+
+const char *StatsRangeServer::rpc_type_name(int type) {
+  HT_ASSERT(type >= 0 && type < RPC_TYPE_COUNT);
+  return rpc_type_names[type];
+}
+
+const char *StatsRangeServer::update_phase_name(int phase) {
+  HT_ASSERT(phase >= 0 && phase < UPDATE_PHASE_COUNT);
+  return update_phase_names[phase];
 }
 
 bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
@@ -113,6 +152,17 @@ bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
     if (tables[i] != other.tables[i])
       return false;
   }
+  for (int i=0; i<RPC_TYPE_COUNT; i++) {
+    if (queue_latency[i] != other.queue_latency[i] ||
+        response_latency[i] != other.response_latency[i])
+      return false;
+  }
+  for (int i=0; i<UPDATE_PHASE_COUNT; i++) {
+    if (update_phase_latency[i] != other.update_phase_latency[i])
+      return false;
+  }
+  if (query_cache_shards != other.query_cache_shards)
+    return false;
   return true;
 }
 
@@ -127,6 +177,27 @@ size_t StatsRangeServer::encoded_length_group(int group) const {
       len += tables[i].encoded_length();
     return len;
   }
+  else if (group == LATENCY_GROUP) {
+    size_t len = Serialization::encoded_length_vi32(RPC_TYPE_COUNT);
+    for (int i=0; i<RPC_TYPE_COUNT; i++)
+      len += queue_latency[i].encoded_length() +
+        response_latency[i].encoded_length();
+    return len;
+  }
+  else if (group == UPDATE_PHASE_GROUP) {
+    size_t len = Serialization::encoded_length_vi32(UPDATE_PHASE_COUNT);
+    for (int i=0; i<UPDATE_PHASE_COUNT; i++)
+      len += update_phase_latency[i].encoded_length();
+    return len;
+  }
+  else if (group == QUERY_CACHE_GROUP) {
+    size_t len = Serialization::encoded_length_vi32(query_cache_shards.size());
+    for (size_t i=0; i<query_cache_shards.size(); i++)
+      len += Serialization::encoded_length_vi64(query_cache_shards[i].accesses) +
+        Serialization::encoded_length_vi64(query_cache_shards[i].hits) +
+        Serialization::encoded_length_vi64(query_cache_shards[i].negative_hits);
+    return len;
+  }
   else
     HT_FATALF("Invalid group number (%d)", group);
   return 0;
@@ -157,6 +228,26 @@ void StatsRangeServer::encode_group(int group, uint8_t **bufp) const {
     for (size_t i=0; i<tables.size(); i++)
       tables[i].encode(bufp);
   }
+  else if (group == LATENCY_GROUP) {
+    Serialization::encode_vi32(bufp, RPC_TYPE_COUNT);
+    for (int i=0; i<RPC_TYPE_COUNT; i++) {
+      queue_latency[i].encode(bufp);
+      response_latency[i].encode(bufp);
+    }
+  }
+  else if (group == UPDATE_PHASE_GROUP) {
+    Serialization::encode_vi32(bufp, UPDATE_PHASE_COUNT);
+    for (int i=0; i<UPDATE_PHASE_COUNT; i++)
+      update_phase_latency[i].encode(bufp);
+  }
+  else if (group == QUERY_CACHE_GROUP) {
+    Serialization::encode_vi32(bufp, query_cache_shards.size());
+    for (size_t i=0; i<query_cache_shards.size(); i++) {
+      Serialization::encode_vi64(bufp, query_cache_shards[i].accesses);
+      Serialization::encode_vi64(bufp, query_cache_shards[i].hits);
+      Serialization::encode_vi64(bufp, query_cache_shards[i].negative_hits);
+    }
+  }
   else
     HT_FATALF("Invalid group number (%d)", group);
 }
@@ -190,6 +281,29 @@ void StatsRangeServer::decode_group(int group, uint16_t len, const uint8_t **buf
       tables.push_back(table);
     }
   }
+  else if (group == LATENCY_GROUP) {
+    size_t rpc_count = Serialization::decode_vi32(bufp, remainp);
+    LatencyHistogram unknown;
+    for (size_t i=0; i<rpc_count; i++) {
+      // skip over histograms for RPC types this version doesn't know about
+      (i < RPC_TYPE_COUNT ? queue_latency[i] : unknown).decode(bufp, remainp);
+      (i < RPC_TYPE_COUNT ? response_latency[i] : unknown).decode(bufp, remainp);
+    }
+  }
+  else if (group == UPDATE_PHASE_GROUP) {
+    size_t phase_count = Serialization::decode_vi32(bufp, remainp);
+    LatencyHistogram unknown;
+    for (size_t i=0; i<phase_count; i++)
+      (i < UPDATE_PHASE_COUNT ? update_phase_latency[i] : unknown).decode(bufp, remainp);
+  }
+  else if (group == QUERY_CACHE_GROUP) {
+    query_cache_shards.resize(Serialization::decode_vi32(bufp, remainp));
+    for (size_t i=0; i<query_cache_shards.size(); i++) {
+      query_cache_shards[i].accesses = Serialization::decode_vi64(bufp, remainp);
+      query_cache_shards[i].hits = Serialization::decode_vi64(bufp, remainp);
+      query_cache_shards[i].negative_hits = Serialization::decode_vi64(bufp, remainp);
+    }
+  }
   else {
     HT_WARNF("Unrecognized StatsRangeServer group %d, skipping...", group);
     (*bufp) += len;
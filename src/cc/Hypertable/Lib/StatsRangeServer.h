@@ -26,6 +26,7 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include "Common/LatencyHistogram.h"
 #include "Common/Properties.h"
 #include "Common/ReferenceCount.h"
 #include "Common/StatsSerializable.h"
@@ -53,6 +54,39 @@ namespace Hypertable {
       if (loc != location)
         location = loc;
     }
+    /** RPC types for which latency histograms are kept */
+    enum {
+      RPC_UPDATE = 0,
+      RPC_CREATE_SCANNER,
+      RPC_FETCH_SCANBLOCK,
+      RPC_LOAD_RANGE,
+      RPC_TYPE_COUNT
+    };
+
+    static const char *rpc_type_name(int type);
+
+    /** Phases of RangeServer::batch_update for which timings are kept */
+    enum {
+      UPDATE_PHASE_DECODE = 0,
+      UPDATE_PHASE_LOG_WRITE,
+      UPDATE_PHASE_APPLY,
+      UPDATE_PHASE_COUNT
+    };
+
+    static const char *update_phase_name(int phase);
+
+    /** Cumulative lookup counts of one QueryCache shard */
+    struct QueryCacheShard {
+      QueryCacheShard() : accesses(0), hits(0), negative_hits(0) { }
+      bool operator==(const QueryCacheShard &other) const {
+        return accesses == other.accesses && hits == other.hits &&
+          negative_hits == other.negative_hits;
+      }
+      uint64_t accesses;
+      uint64_t hits;
+      uint64_t negative_hits;   // hits on cached empty results
+    };
+
     bool operator==(const StatsRangeServer &other) const;
     bool operator!=(const StatsRangeServer &other) const {
       return !(*this == other);
@@ -77,6 +111,17 @@ namespace Hypertable {
     uint64_t block_cache_accesses;
     uint64_t block_cache_hits;
 
+    /** Time (microseconds) spent in the ApplicationQueue, from message
+     * arrival until a worker thread picked up the request */
+    LatencyHistogram queue_latency[RPC_TYPE_COUNT];
+    /** Time (microseconds) from message arrival until the response was sent */
+    LatencyHistogram response_latency[RPC_TYPE_COUNT];
+    /** Time (microseconds) each batch update spent validating and
+     * rewriting the incoming cells, writing (and syncing) the commit logs,
+     * and inserting the cells into the CellCaches */
+    LatencyHistogram update_phase_latency[UPDATE_PHASE_COUNT];
+    std::vector<QueryCacheShard> query_cache_shards;
+
     StatsSystem system;
     std::vector<StatsTable> tables;
     StatsTableMap table_map;
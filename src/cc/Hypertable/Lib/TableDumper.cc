@@ -20,12 +20,15 @@
  */
 
 #include "Common/Compat.h"
+#include <cstring>
+#include <ostream>
 #include <vector>
 
 #include "Common/Error.h"
 #include "Common/Random.h"
 #include "Common/String.h"
 
+#include "LoadDataEscape.h"
 #include "Table.h"
 #include "TableDumper.h"
 
@@ -134,3 +137,46 @@ void Hypertable::copy(TableDumper &dumper, CellsBuilder &b) {
   while (dumper.next(cell))
     b.add(cell);
 }
+
+
+void Hypertable::write_dump_cell(std::ostream &out, const Cell &cell,
+                                 LoadDataEscape *row_escaper,
+                                 LoadDataEscape *escaper) {
+  const char *buf, *row_buf;
+  size_t len, row_len;
+
+  out << cell.timestamp << "\t";
+
+  if (row_escaper)
+    row_escaper->escape(cell.row_key, strlen(cell.row_key), &row_buf, &row_len);
+  else
+    row_buf = cell.row_key;
+
+  if (cell.column_family) {
+    out << row_buf << "\t" << cell.column_family;
+    if (cell.column_qualifier && *cell.column_qualifier) {
+      if (escaper)
+        escaper->escape(cell.column_qualifier, strlen(cell.column_qualifier),
+                        &buf, &len);
+      else
+        buf = cell.column_qualifier;
+      out << ":" << buf;
+    }
+  }
+  else
+    out << row_buf;
+
+  if (escaper)
+    escaper->escape((const char *)cell.value, (size_t)cell.value_len,
+                    &buf, &len);
+  else {
+    buf = (const char *)cell.value;
+    len = (size_t)cell.value_len;
+  }
+
+  HT_ASSERT(cell.flag == FLAG_INSERT);
+
+  out << "\t";
+  out.write(buf, len);
+  out << "\n";
+}
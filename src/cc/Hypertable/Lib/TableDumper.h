@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_TABLEDUMPER_H
 #define HYPERTABLE_TABLEDUMPER_H
 
+#include <iosfwd>
+
 #include "Common/ReferenceCount.h"
 
 #include "Cells.h"
@@ -78,6 +80,21 @@ namespace Hypertable {
   void copy(TableDumper &, CellsBuilder &);
   inline void copy(TableDumperPtr &p, CellsBuilder &v) { copy(*p.get(), v); }
 
+  class LoadDataEscape;
+
+  /**
+   * Writes a cell as one line of DUMP TABLE output: timestamp, row, column
+   * and value, tab delimited.  If the escapers are given, the row, column
+   * qualifier and value are escaped for LOAD DATA INFILE.
+   *
+   * @param out output stream
+   * @param cell cell to write
+   * @param row_escaper escaper for the row, or 0
+   * @param escaper escaper for the qualifier and value, or 0
+   */
+  void write_dump_cell(std::ostream &out, const Cell &cell,
+                       LoadDataEscape *row_escaper, LoadDataEscape *escaper);
+
 } // namespace Hypertable
 
 #endif // HYPERTABLE_TABLEDUMPER_H
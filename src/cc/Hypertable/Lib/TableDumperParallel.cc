@@ -0,0 +1,234 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstring>
+#include <map>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include "Common/Error.h"
+#include "Common/FileUtils.h"
+#include "Common/Logger.h"
+#include "Common/String.h"
+
+#include "DfsBroker/Lib/FileDevice.h"
+
+#include "LoadDataEscape.h"
+#include "TableDumper.h"
+#include "TableDumperParallel.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const String dfs = "dfs://";
+  const String localfs = "file://";
+}
+
+
+TableDumperParallel::TableDumperParallel(NamespacePtr &ns, const String &name,
+    ScanSpec &scan_spec, DfsBroker::ClientPtr &dfs_client,
+    const String &outdir, bool escape, size_t threads)
+  : m_name(name), m_scan_spec(scan_spec), m_dfs_client(dfs_client),
+    m_outdir(outdir), m_escape(escape), m_threads(threads), m_failed(false),
+    m_error(Error::OK), m_total_cells(0), m_total_keys_size(0),
+    m_total_values_size(0) {
+
+  HT_ASSERT(m_threads > 0);
+  boost::trim_right_if(m_outdir, boost::is_any_of("/"));
+  m_compress = boost::algorithm::ends_with(m_outdir, ".gz");
+
+  ns->get_table_splits(name, m_splits);
+  m_table = ns->open_table(name);
+
+  // parts are numbered in row order
+  m_parts.resize(m_splits.size());
+  for (size_t i=0; i<m_splits.size(); i++) {
+    m_parts[i].fname = format("part-%05d.tsv%s", (int)i,
+                              m_compress ? ".gz" : "");
+    m_parts[i].split = &m_splits[i];
+  }
+
+  /**
+   * Hand out the splits alternating between RangeServers, so that the
+   * scans in progress are spread across the cluster
+   */
+  typedef map<String, list<Part *> > LocationMap;
+  LocationMap by_location;
+  foreach(Part &part, m_parts)
+    by_location[part.split->location ? part.split->location : ""]
+        .push_back(&part);
+
+  while (!by_location.empty()) {
+    for (LocationMap::iterator iter = by_location.begin();
+         iter != by_location.end(); ) {
+      m_queue.push_back(iter->second.front());
+      iter->second.pop_front();
+      if (iter->second.empty())
+        by_location.erase(iter++);
+      else
+        ++iter;
+    }
+  }
+}
+
+
+void TableDumperParallel::run() {
+  if (boost::algorithm::starts_with(m_outdir, dfs)) {
+    HT_ASSERT(m_dfs_client);
+    m_dfs_client->mkdirs(m_outdir.substr(dfs.size()));
+  }
+  else {
+    String dir = boost::algorithm::starts_with(m_outdir, localfs)
+        ? m_outdir.substr(localfs.size()) : m_outdir;
+    if (!FileUtils::mkdirs(dir))
+      HT_THROWF(Error::LOCAL_IO_ERROR, "Unable to create directory '%s'",
+                dir.c_str());
+  }
+
+  {
+    ThreadGroup threads;
+    for (size_t i=0; i<m_threads && i<m_parts.size(); i++)
+      threads.create_thread(boost::bind(&TableDumperParallel::dump, this));
+    threads.join_all();
+  }
+
+  if (m_failed)
+    HT_THROW(m_error, m_error_msg);
+
+  boost::iostreams::filtering_ostream fout;
+  open_sink(fout, "MANIFEST", false);
+
+  fout << "# DUMP TABLE " << m_name << ", " << m_parts.size()
+       << " parts, " << m_total_cells << " cells\n";
+  fout << "# The parts hold disjoint row ranges and can be loaded "
+       << "concurrently\n";
+  foreach(Part &part, m_parts) {
+    fout << "# " << part.fname << " " << part.cells << " cells\n";
+    fout << "LOAD DATA INFILE " << (m_escape ? "" : "NO_ESCAPE ") << "\""
+         << m_outdir << "/" << part.fname << "\" INTO TABLE " << m_name
+         << ";\n";
+  }
+
+  fout.strict_sync();
+}
+
+
+void TableDumperParallel::dump() {
+  Part *part;
+
+  while (true) {
+    {
+      ScopedLock lock(m_mutex);
+      if (m_failed || m_queue.empty())
+        return;
+      part = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    try {
+      dump_part(*part);
+    }
+    catch (Exception &e) {
+      ScopedLock lock(m_mutex);
+      if (!m_failed) {
+        m_failed = true;
+        m_error = e.code();
+        m_error_msg = format("%s - %s", part->fname.c_str(), e.what());
+      }
+      return;
+    }
+    catch (std::exception &e) {
+      ScopedLock lock(m_mutex);
+      if (!m_failed) {
+        m_failed = true;
+        m_error = Error::LOCAL_IO_ERROR;
+        m_error_msg = format("%s - %s", part->fname.c_str(), e.what());
+      }
+      return;
+    }
+  }
+}
+
+
+void TableDumperParallel::dump_part(Part &part) {
+  boost::iostreams::filtering_ostream fout;
+  LoadDataEscape row_escaper;
+  LoadDataEscape escaper;
+  uint64_t keys_size = 0, values_size = 0;
+  ScanSpec scan_spec = m_scan_spec;
+  RowInterval ri;
+  Cell cell;
+
+  ri.start = part.split->start_row;
+  ri.start_inclusive = false;
+  ri.end = part.split->end_row;
+  ri.end_inclusive = true;
+  scan_spec.row_intervals.clear();
+  scan_spec.row_intervals.push_back(ri);
+
+  open_sink(fout, part.fname, m_compress);
+  fout << "#timestamp\trow\tcolumn\tvalue\n";
+
+  TableScannerPtr scanner = m_table->create_scanner(scan_spec);
+
+  while (scanner->next(cell)) {
+    part.cells++;
+    keys_size += strlen(cell.row_key);
+    if (cell.column_family && cell.column_qualifier)
+      keys_size += strlen(cell.column_qualifier) + 1;
+    values_size += cell.value_len;
+
+    if (m_escape)
+      write_dump_cell(fout, cell, &row_escaper, &escaper);
+    else
+      write_dump_cell(fout, cell, 0, 0);
+  }
+
+  fout.strict_sync();
+
+  ScopedLock lock(m_mutex);
+  m_total_cells += part.cells;
+  m_total_keys_size += keys_size;
+  m_total_values_size += values_size;
+}
+
+
+void TableDumperParallel::open_sink(boost::iostreams::filtering_ostream &fout,
+                                    const String &fname, bool compress) {
+  if (compress)
+    fout.push(boost::iostreams::gzip_compressor());
+
+  if (boost::algorithm::starts_with(m_outdir, dfs)) {
+    String path = m_outdir.substr(dfs.size()) + "/" + fname;
+    fout.push(DfsBroker::FileSink(m_dfs_client, path));
+  }
+  else if (boost::algorithm::starts_with(m_outdir, localfs)) {
+    String path = m_outdir.substr(localfs.size()) + "/" + fname;
+    fout.push(boost::iostreams::file_descriptor_sink(path));
+  }
+  else
+    fout.push(boost::iostreams::file_descriptor_sink(m_outdir + "/" + fname));
+}
@@ -0,0 +1,116 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_TABLEDUMPERPARALLEL_H
+#define HYPERTABLE_TABLEDUMPERPARALLEL_H
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <list>
+#include <vector>
+
+#include "Common/Mutex.h"
+#include "Common/Thread.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Namespace.h"
+#include "ScanSpec.h"
+#include "Table.h"
+#include "TableSplit.h"
+
+namespace Hypertable {
+
+  /**
+   * Parallel, range-partitioned DUMP TABLE.  Each table split (as of
+   * construction) is scanned into its own output file
+   * <code>part-NNNNN.tsv[.gz]</code> in the output directory, by a pool of
+   * threads taking the splits in an order that alternates between
+   * RangeServers.  A <code>MANIFEST</code> file written at the end lists the
+   * parts as LOAD DATA INFILE statements; the parts hold disjoint row
+   * ranges, so they can be loaded concurrently.
+   */
+  class TableDumperParallel {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param ns pointer to namespace object
+     * @param name table name
+     * @param scan_spec scan specification (its row intervals are replaced)
+     * @param dfs_client DFS client, required if <code>outdir</code> starts
+     *        with dfs://
+     * @param outdir output directory, [file://|dfs://]dirname[.gz]; if it
+     *        ends in .gz the parts are gzip compressed
+     * @param escape whether to escape rows, qualifiers and values
+     * @param threads number of ranges scanned concurrently
+     */
+    TableDumperParallel(NamespacePtr &ns, const String &name,
+                        ScanSpec &scan_spec, DfsBroker::ClientPtr &dfs_client,
+                        const String &outdir, bool escape, size_t threads);
+
+    /**
+     * Dumps all of the parts and writes the manifest.  Throws the first
+     * error any of the threads ran into.
+     */
+    void run();
+
+    size_t get_part_count() const { return m_parts.size(); }
+    uint64_t get_total_cells() const { return m_total_cells; }
+    uint64_t get_total_keys_size() const { return m_total_keys_size; }
+    uint64_t get_total_values_size() const { return m_total_values_size; }
+
+  private:
+    struct Part {
+      Part() : split(0), cells(0) { }
+      String fname;
+      const TableSplit *split;
+      uint64_t cells;
+    };
+
+    void dump();
+    void dump_part(Part &part);
+    void open_sink(boost::iostreams::filtering_ostream &fout,
+                   const String &fname, bool compress);
+
+    String m_name;
+    ScanSpec m_scan_spec;
+    TableSplitsContainer m_splits;
+    TablePtr m_table;
+    DfsBroker::ClientPtr m_dfs_client;
+    String m_outdir;
+    bool m_escape;
+    bool m_compress;
+    size_t m_threads;
+    std::vector<Part> m_parts;
+    Mutex m_mutex;
+    std::list<Part *> m_queue;
+    bool m_failed;
+    int m_error;
+    String m_error_msg;
+    uint64_t m_total_cells;
+    uint64_t m_total_keys_size;
+    uint64_t m_total_values_size;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_TABLEDUMPERPARALLEL_H
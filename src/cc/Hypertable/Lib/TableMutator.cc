@@ -31,6 +31,7 @@ extern "C" {
 #include "Common/Config.h"
 #include "Common/StringExt.h"
 
+#include "CompressorFactory.h"
 #include "Key.h"
 #include "TableMutator.h"
 #include "TableMutatorSyncDispatchHandler.h"
@@ -71,8 +72,15 @@ TableMutator::TableMutator(PropertiesPtr & props, Comm *comm, Table *table,
   m_flush_delay = props->get_i32("Hypertable.Mutator.FlushDelay");
   m_max_memory = props->get_i64("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate");
   m_refresh_schema = props->get_bool("Hypertable.Client.RefreshSchema");
+  if (props->get_bool("Hypertable.Mutator.Compress", false))
+    m_flags |= FLAG_COMPRESS;
+  if (m_flags & FLAG_COMPRESS)
+    CompressorFactory::register_comm_codecs();
+  if (props->get_bool("Hypertable.Mutator.CoalesceCounters", false))
+    m_flags |= FLAG_COALESCE_COUNTERS;
   m_buffer = new TableMutatorScatterBuffer(m_comm, &m_table_identifier,
-      m_schema, m_range_locator, timeout_ms);
+      m_schema, m_range_locator, timeout_ms,
+      m_flags & FLAG_COALESCE_COUNTERS);
 }
 
 TableMutator::~TableMutator() {
@@ -236,11 +244,13 @@ void TableMutator::auto_flush(Timer &timer) {
       if (m_flush_delay)
         poll(0, 0, m_flush_delay);
 
-      m_buffer->send(m_rangeserver_flags_map, m_flags);
+      // counter coalescing is done here, not by the range server
+      m_prev_buffer_flags = m_flags & ~FLAG_COALESCE_COUNTERS;
+      m_buffer->send(m_rangeserver_flags_map, m_prev_buffer_flags);
       m_prev_buffer = m_buffer;
-      m_prev_buffer_flags = m_flags;
       m_buffer = new TableMutatorScatterBuffer(m_comm, &m_table_identifier,
-          m_schema, m_range_locator, m_timeout_ms);
+          m_schema, m_range_locator, m_timeout_ms,
+          m_flags & FLAG_COALESCE_COUNTERS);
       m_memory_used = 0;
     }
     HT_RETHROW("auto flushing")
@@ -261,11 +271,11 @@ void TableMutator::flush() {
      */
     if (m_memory_used > 0) {
       // flush & sync non-empty buffers
-      m_buffer->send(m_rangeserver_flags_map, 0);
+      m_buffer->send(m_rangeserver_flags_map, m_flags & FLAG_COMPRESS);
       // sync remaining unsynced rangeservers
       sync();
       m_prev_buffer = m_buffer;
-      m_prev_buffer_flags = 0;
+      m_prev_buffer_flags = m_flags & FLAG_COMPRESS;
       wait_for_previous_buffer(timer);
       m_rangeserver_flags_map.clear();
     }
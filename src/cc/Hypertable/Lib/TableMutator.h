@@ -176,7 +176,11 @@ namespace Hypertable {
     enum {
       /* Don't force a commit log sync on update */
       FLAG_NO_LOG_SYNC        = 0x0001,
-      FLAG_IGNORE_UNKNOWN_CFS = 0x0002
+      FLAG_IGNORE_UNKNOWN_CFS = 0x0002,
+      /* Compress update payloads (see CommCompression) */
+      FLAG_COMPRESS           = 0x0004,
+      /* Fold buffered counter updates to the same cell (client side only) */
+      FLAG_COALESCE_COUNTERS  = 0x0008
     };
 
   protected:
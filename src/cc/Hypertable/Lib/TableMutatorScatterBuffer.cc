@@ -21,7 +21,9 @@
 
 #include "Common/Compat.h"
 #include "Common/Config.h"
+#include "Common/Time.h"
 #include "Common/Timer.h"
+#include "Common/Trace.h"
 
 #include "Key.h"
 #include "KeySpec.h"
@@ -34,10 +36,12 @@ using namespace Hypertable;
 
 TableMutatorScatterBuffer::TableMutatorScatterBuffer(Comm *comm,
     const TableIdentifier *table_identifier, SchemaPtr &schema,
-    RangeLocatorPtr &range_locator, uint32_t timeout_ms)
+    RangeLocatorPtr &range_locator, uint32_t timeout_ms,
+    bool coalesce_counters)
   : m_comm(comm), m_schema(schema), m_range_locator(range_locator),
     m_range_server(comm, timeout_ms), m_table_identifier(*table_identifier),
-    m_full(false), m_resends(0), m_timeout_ms(timeout_ms), m_counter_value(9)  {
+    m_full(false), m_resends(0), m_timeout_ms(timeout_ms), m_counter_value(9),
+    m_coalesce_counters(coalesce_counters), m_trace_id(0), m_send_start(0) {
 
   m_loc_cache = m_range_locator->location_cache();
 
@@ -54,6 +58,24 @@ TableMutatorScatterBuffer::set(const Key &key, const void *value,
                                uint32_t value_len, Timer &timer) {
   RangeLocationInfo range_info;
   TableMutatorSendBufferMap::const_iterator iter;
+  bool counter = key.column_family_code &&
+    m_schema->get_column_family(key.column_family_code)->counter;
+  bool counter_reset = false;
+  bool coalesce = false;
+
+  // if the CF is a counter then re-encode value to 64 bit int
+  if (counter) {
+    encode_counter(key, value, value_len, &counter_reset);
+    coalesce = m_coalesce_counters && key.flag == FLAG_INSERT &&
+      key.timestamp == AUTO_ASSIGN;
+    if (coalesce &&
+        m_pending_counters.fold(key, m_counter_value.base, counter_reset))
+      return;
+  }
+
+  // nothing buffered after a delete may be folded into updates before it
+  if (key.flag != FLAG_INSERT)
+    m_pending_counters.drop(key, key.flag);
 
   if (!m_loc_cache->lookup(m_table_identifier.id, key.row, &range_info)) {
     timer.start();
@@ -75,36 +97,12 @@ TableMutatorScatterBuffer::set(const Key &key, const void *value,
   create_key_and_append((*iter).second->accum, key.flag, key.row,
       key.column_family_code, key.column_qualifier, key.timestamp);
 
-  // if the CF is a counter then re-encode value to 64 bit int
-  if (key.column_family_code && m_schema->get_column_family(key.column_family_code)->counter) {
-    bool counter_reset = false;
-    const char *ascii_value = (const char *)value;
-    char *endptr;
-    m_counter_value.clear();
-    m_counter_value.ensure(value_len+1);
-    if (value_len > 0 && (*ascii_value == '=' || *ascii_value == '+')) {
-      counter_reset = (*ascii_value == '=');
-      m_counter_value.add_unchecked(ascii_value+1, value_len-1);
-    }
-    else
-      m_counter_value.add_unchecked(value, value_len);
-    m_counter_value.add_unchecked((const void *)"\0",1);
-    uint64_t val = strtoull((const char *)m_counter_value.base, &endptr, 0);
-    if (*endptr)
-      HT_THROWF(Error::BAD_KEY, "Expected integer value, got %s, row=%s",
-          (char*)m_counter_value.base, key.row);
-    m_counter_value.clear();
-    Serialization::encode_i64(&m_counter_value.ptr, val);
-    /**
-     * If the value represents a counter reset (e.g. "=0"), then
-     * append a '=' character after the seralized reset value
-     */
-    if (counter_reset) {
-      *m_counter_value.ptr++ = '=';
-      append_as_byte_string((*iter).second->accum, m_counter_value.base, 9);
-    }
-    else
-      append_as_byte_string((*iter).second->accum, m_counter_value.base, 8);
+  if (counter) {
+    if (coalesce)
+      m_pending_counters.add(key, &(*iter).second->accum,
+                             (*iter).second->accum.fill());
+    append_as_byte_string((*iter).second->accum, m_counter_value.base,
+                          m_counter_value.fill());
   }
   else
     append_as_byte_string((*iter).second->accum, value, value_len);
@@ -114,6 +112,38 @@ TableMutatorScatterBuffer::set(const Key &key, const void *value,
 }
 
 
+/**
+ * Encodes a counter update into m_counter_value as a 64 bit int.  If the
+ * value represents a counter reset (e.g. "=0"), then a '=' character is
+ * appended after the serialized reset value.
+ */
+void
+TableMutatorScatterBuffer::encode_counter(const Key &key, const void *value,
+                                          uint32_t value_len, bool *resetp) {
+  const char *ascii_value = (const char *)value;
+  char *endptr;
+
+  *resetp = false;
+  m_counter_value.clear();
+  m_counter_value.ensure(value_len+1);
+  if (value_len > 0 && (*ascii_value == '=' || *ascii_value == '+')) {
+    *resetp = (*ascii_value == '=');
+    m_counter_value.add_unchecked(ascii_value+1, value_len-1);
+  }
+  else
+    m_counter_value.add_unchecked(value, value_len);
+  m_counter_value.add_unchecked((const void *)"\0",1);
+  uint64_t val = strtoull((const char *)m_counter_value.base, &endptr, 0);
+  if (*endptr)
+    HT_THROWF(Error::BAD_KEY, "Expected integer value, got %s, row=%s",
+        (char*)m_counter_value.base, key.row);
+  m_counter_value.clear();
+  Serialization::encode_i64(&m_counter_value.ptr, val);
+  if (*resetp)
+    *m_counter_value.ptr++ = '=';
+}
+
+
 void TableMutatorScatterBuffer::set_delete(const Key &key, Timer &timer) {
   RangeLocationInfo range_info;
   TableMutatorSendBufferMap::const_iterator iter;
@@ -142,6 +172,8 @@ void TableMutatorScatterBuffer::set_delete(const Key &key, Timer &timer) {
   else
     key_flag = FLAG_DELETE_COLUMN_FAMILY;
 
+  m_pending_counters.drop(key, key_flag);
+
   create_key_and_append((*iter).second->accum, key_flag, key.row,
       key.column_family_code, key.column_qualifier, key.timestamp);
   append_as_byte_string((*iter).second->accum, 0, 0);
@@ -212,6 +244,15 @@ void TableMutatorScatterBuffer::send(RangeServerFlagsMap &rangeserver_flags_map,
   size_t len;
   String range_location;
 
+  // The trace id is made current so that it is carried in the header of
+  // each update request sent below
+  if ((m_trace_id = Trace::sample()) != 0)
+    m_send_start = get_ts64();
+  TraceScope trace(m_trace_id, "client.scatter_send", m_send_start);
+
+  // buffered counter updates can't be folded into once they are sent
+  m_pending_counters.clear();
+
   m_completion_counter.set(m_buffer_map.size());
 
   for (TableMutatorSendBufferMap::const_iterator iter = m_buffer_map.begin();
@@ -335,6 +376,10 @@ bool TableMutatorScatterBuffer::wait_for_completion(Timer &timer) {
     }
     return false;
   }
+  if (m_trace_id) {
+    Trace::record(m_trace_id, "client.update", m_send_start, get_ts64());
+    m_trace_id = 0;
+  }
   return true;
 }
 
@@ -381,6 +426,7 @@ TableMutatorScatterBuffer::create_redo_buffer(Timer &timer) {
 
 
 void TableMutatorScatterBuffer::reset() {
+  m_pending_counters.clear();
   for (TableMutatorSendBufferMap::const_iterator iter = m_buffer_map.begin();
        iter != m_buffer_map.end(); ++iter)
     (*iter).second->reset();
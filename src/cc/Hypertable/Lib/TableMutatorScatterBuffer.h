@@ -34,6 +34,7 @@
 #include "Common/atomic.h"
 #include "Common/ByteString.h"
 #include "Common/FlyweightString.h"
+#include "Common/HashMap.h"
 #include "Common/ReferenceCount.h"
 #include "Common/StringExt.h"
 #include "Common/Timer.h"
@@ -41,6 +42,7 @@
 
 #include "Cell.h"
 #include "Key.h"
+#include "PendingCounters.h"
 #include "RangeLocator.h"
 #include "Schema.h"
 #include "TableMutatorSendBuffer.h"
@@ -55,7 +57,8 @@ namespace Hypertable {
 
   public:
     TableMutatorScatterBuffer(Comm *, const TableIdentifier *,
-                              SchemaPtr &, RangeLocatorPtr &, uint32_t timeout_ms);
+                              SchemaPtr &, RangeLocatorPtr &, uint32_t timeout_ms,
+                              bool coalesce_counters=false);
     void set(const Key &, const void *value, uint32_t value_len, Timer &timer);
     void set_delete(const Key &key, Timer &timer);
     void set(SerializedKey key, ByteString value, Timer &timer);
@@ -79,6 +82,9 @@ namespace Hypertable {
 
     friend class TableMutatorDispatchHandler;
 
+    void encode_counter(const Key &key, const void *value, uint32_t value_len,
+                        bool *resetp);
+
     typedef CommAddressMap<TableMutatorSendBufferPtr> TableMutatorSendBufferMap;
 
     Comm                *m_comm;
@@ -98,6 +104,10 @@ namespace Hypertable {
     uint32_t             m_last_send_flags;
     bool                 m_refresh_schema;
     DynamicBuffer        m_counter_value;
+    bool                 m_coalesce_counters;
+    PendingCounters      m_pending_counters;
+    uint64_t             m_trace_id;
+    int64_t              m_send_start;
   };
 
   typedef intrusive_ptr<TableMutatorScatterBuffer> TableMutatorScatterBufferPtr;
@@ -25,6 +25,7 @@
 #include "Common/Error.h"
 #include "Common/String.h"
 
+#include "RegexpRowIntervals.h"
 #include "Table.h"
 #include "TableScannerAsync.h"
 
@@ -60,7 +61,8 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
 
   try {
     if (scan_spec.row_intervals.empty()) {
-      if (scan_spec.cell_intervals.empty()) {
+      RegexpRowIntervals regexp_intervals(scan_spec.row_regexp);
+      if (scan_spec.cell_intervals.empty() && regexp_intervals.empty()) {
         ri_scanner = 0;
         ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator, scan_spec,
             timeout_ms, retry_table_not_found, !current_set, this, scanner_id++);
@@ -69,6 +71,30 @@ TableScannerAsync::TableScannerAsync(Comm *comm, ApplicationQueuePtr &app_queue,
         m_interval_scanners.push_back(ri_scanner);
         m_outstanding++;
       }
+      else if (scan_spec.cell_intervals.empty()) {
+        /**
+         * Only the rows that can match the row regexp are scanned.  The
+         * row limit applies to each interval scanner, so with a limit
+         * a single interval spanning them all is scanned instead.
+         */
+        const std::vector<RegexpRowIntervals::Interval> &intervals =
+          regexp_intervals.get();
+        size_t count = scan_spec.row_limit ? 1 : intervals.size();
+        for (size_t i=0; i<count; i++) {
+          const String &end = scan_spec.row_limit ? intervals.back().end
+            : intervals[i].end;
+          scan_spec.base_copy(interval_scan_spec);
+          interval_scan_spec.row_intervals.push_back(
+              RowInterval(intervals[i].start.c_str(), true, end.c_str(), false));
+          ri_scanner = 0;
+          ri_scanner = new IntervalScannerAsync(comm, app_queue, table, range_locator,
+              interval_scan_spec, timeout_ms, retry_table_not_found, !current_set,
+              this, scanner_id++);
+          current_set = true;
+          m_interval_scanners.push_back(ri_scanner);
+          m_outstanding++;
+        }
+      }
       else {
         for (size_t i=0; i<scan_spec.cell_intervals.size(); i++) {
           scan_spec.base_copy(interval_scan_spec);
@@ -0,0 +1,142 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "AsyncComm/CommBuf.h"
+#include "AsyncComm/CommCompression.h"
+
+#include "Hypertable/Lib/BlockCompressionCodec.h"
+#include "Hypertable/Lib/CompressorFactory.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /**
+   * Simulates the receiving end: decodes the header written into the
+   * message buffer and returns a copy of the payload.
+   */
+  uint8_t *receive(CommBuf *cbuf, CommHeader &header) {
+    const uint8_t *ptr = cbuf->data.base;
+    size_t remain = cbuf->data.size;
+    header.decode(&ptr, &remain);
+    size_t len = header.total_len - header.header_len;
+    uint8_t *payload = new uint8_t [len];
+    memcpy(payload, ptr, remain);
+    if (cbuf->ext.size)
+      memcpy(payload + remain, cbuf->ext.base, cbuf->ext.size);
+    HT_ASSERT(remain + cbuf->ext.size == len);
+    return payload;
+  }
+
+  /** Fills a buffer with update-like records */
+  void fill(uint8_t *buf, size_t len) {
+    char record[64];
+    size_t n = 0;
+    for (int i=0; n < len; i++) {
+      int rlen = sprintf(record, "com.example/row/%08d\tcolumn:q%d\tv%d\n",
+                         i, i % 13, i % 101);
+      memcpy(buf + n, record, std::min((size_t)rlen, len - n));
+      n += rlen;
+    }
+  }
+
+  void check_round_trip() {
+    const size_t data_len = 100, ext_len = 64 * 1024;
+    uint8_t *ext_data = new uint8_t [ext_len];
+    uint8_t expected[data_len + ext_len];
+
+    fill(expected, sizeof(expected));
+    memcpy(ext_data, expected + data_len, ext_len);
+
+    CommHeader hdr(1);
+    StaticBuffer ext(ext_data, ext_len);
+    CommBuf *cbuf = new CommBuf(hdr, data_len, ext);
+    cbuf->append_bytes(expected, data_len);
+    cbuf->set_compression(CommCompression::default_codec());
+
+    HT_ASSERT(CommCompression::compress(cbuf));
+    cbuf->write_header_and_reset();
+    HT_ASSERT(cbuf->ext.size == 0);
+    HT_ASSERT(cbuf->data.size < sizeof(expected) / 2);
+
+    CommHeader header;
+    uint8_t *payload = receive(cbuf, header);
+    HT_ASSERT(header.flags & CommHeader::FLAGS_BIT_COMPRESSED);
+    HT_ASSERT(CommCompression::decompress(header, &payload) == Error::OK);
+    HT_ASSERT((header.flags & CommHeader::FLAGS_BIT_COMPRESSED) == 0);
+    HT_ASSERT(header.total_len - header.header_len == sizeof(expected));
+    HT_ASSERT(memcmp(payload, expected, sizeof(expected)) == 0);
+    delete [] payload;
+    delete cbuf;
+  }
+
+  void check_skipped() {
+    uint8_t buf[64 * 1024];
+
+    // below the threshold
+    CommHeader hdr(1);
+    CommBuf *cbuf = new CommBuf(hdr, 100);
+    fill(buf, 100);
+    cbuf->append_bytes(buf, 100);
+    cbuf->set_compression(CommCompression::default_codec());
+    HT_ASSERT(!CommCompression::compress(cbuf));
+    delete cbuf;
+
+    // incompressible
+    cbuf = new CommBuf(hdr, sizeof(buf));
+    for (size_t i=0; i<sizeof(buf); i++)
+      buf[i] = random();
+    cbuf->append_bytes(buf, sizeof(buf));
+    cbuf->set_compression(CommCompression::default_codec());
+    HT_ASSERT(!CommCompression::compress(cbuf));
+    cbuf->write_header_and_reset();
+    CommHeader header;
+    uint8_t *payload = receive(cbuf, header);
+    HT_ASSERT((header.flags & CommHeader::FLAGS_BIT_COMPRESSED) == 0);
+    HT_ASSERT(memcmp(payload, buf, sizeof(buf)) == 0);
+    delete [] payload;
+    delete cbuf;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  CompressorFactory::register_comm_codecs();
+  HT_ASSERT(CommCompression::default_codec() == BlockCompressionCodec::QUICKLZ);
+
+  check_round_trip();
+  check_skipped();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstdlib>
+#include <iostream>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Init.h"
+#include "Common/LatencyHistogram.h"
+#include "Common/Logger.h"
+#include "Common/System.h"
+#include "Common/Time.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/CommitLog.h"
+#include "Hypertable/Lib/Config.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+/**
+ * Compares the latency of synced commit log writes when the current
+ * fragment is written to the DFS and when it is written to local disk and
+ * shipped to the DFS in the background.
+ *
+ * Usage: commit_log_latency_bench --dfs-host localhost --dfs-port 38030
+ *            [--local-dir /data/commit]
+ */
+
+namespace {
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc().add_options()
+        ("count", i32()->default_value(10000),
+            "Number of commits per run")
+        ("block-size", i32()->default_value(256),
+            "Size of each commit in bytes")
+        ("log-dir", str()->default_value("/hypertable/commit_log_latency"),
+            "DFS directory to write the commit logs into")
+        ("local-dir", str(),
+            "Local directory for the local commit log "
+            "(default: <install_dir>/tmp/commit_log_latency)")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DfsClientPolicy, DefaultCommPolicy> Policies;
+
+  void run(FilesystemPtr &fs, const char *name, const String &log_dir,
+           const String &local_dir, int count, size_t block_size) {
+    DynamicBuffer dbuf(block_size);
+    LatencyHistogram latency;
+    int error;
+
+    for (size_t i=0; i<block_size; i++)
+      dbuf.base[i] = (uint8_t)random();
+    dbuf.ptr = dbuf.base + block_size;
+
+    fs->mkdirs(log_dir);
+    CommitLog *log = new CommitLog(fs, log_dir, properties, 0, local_dir);
+
+    int64_t start = get_ts64();
+    for (int i=0; i<count; i++) {
+      int64_t commit_start = get_ts64();
+      if ((error = log->write(dbuf, log->get_timestamp(), true)) != Error::OK)
+        HT_THROW(error, "Problem writing to commit log");
+      latency.record((get_ts64() - commit_start) / 1000);
+    }
+    double elapsed = (double)(get_ts64() - start) / 1000000000.0;
+
+    int64_t close_start = get_ts64();
+    log->close();
+    int64_t close_time = (get_ts64() - close_start) / 1000000;
+    delete log;
+
+    cout << format("%-6s %12.1f %10.1f %10llu %10llu %10llu %10llu %10lld\n",
+                   name, (double)latency.count() / elapsed, latency.mean(),
+                   (Llu)latency.percentile(50.0),
+                   (Llu)latency.percentile(99.0),
+                   (Llu)latency.percentile(99.9), (Llu)latency.max(),
+                   (Lld)close_time) << flush;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    Comm *comm = Comm::instance();
+    ConnectionManagerPtr conn_mgr = new ConnectionManager(comm);
+    int timeout = has("dfs-timeout") ? get_i32("dfs-timeout") : 180000;
+    InetAddr addr(get_str("dfs-host"), get_i16("dfs-port"));
+    DfsBroker::ClientPtr dfs = new DfsBroker::Client(conn_mgr, addr, timeout);
+
+    if (!dfs->wait_for_connection(10000)) {
+      HT_ERROR("Unable to connect to DFS Broker, exiting...");
+      exit(1);
+    }
+
+    FilesystemPtr fs = dfs.get();
+    String log_dir = get_str("log-dir");
+    String local_dir = has("local-dir") ? get_str("local-dir")
+        : System::install_dir + "/tmp/commit_log_latency";
+    int count = get_i32("count");
+    size_t block_size = get_i32("block-size");
+
+    dfs->rmdir(log_dir);
+
+    cout << format("%-6s %12s %10s %10s %10s %10s %10s %10s\n", "log",
+                   "commits/s", "mean(us)", "p50(us)", "p99(us)",
+                   "p99.9(us)", "max(us)", "close(ms)");
+    run(fs, "dfs", log_dir + "/dfs", "", count, block_size);
+    run(fs, "local", log_dir + "/local", local_dir, count, block_size);
+
+    dfs->rmdir(log_dir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
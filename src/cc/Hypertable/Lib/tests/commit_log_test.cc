@@ -25,6 +25,7 @@
 
 #include "AsyncComm/Comm.h"
 
+#include "Common/FileUtils.h"
 #include "Common/Init.h"
 #include "Common/Logger.h"
 #include "Common/System.h"
@@ -34,6 +35,7 @@
 #include "Hypertable/Lib/Config.h"
 #include "Hypertable/Lib/CommitLog.h"
 #include "Hypertable/Lib/CommitLogReader.h"
+#include "Hypertable/Lib/CommitLogShipper.h"
 
 #include "DfsBroker/Lib/Client.h"
 
@@ -55,6 +57,7 @@ namespace {
 
   void test1(DfsBroker::Client *dfs_client);
   void test_link(DfsBroker::Client *dfs_client);
+  void test_local(DfsBroker::Client *dfs_client);
   void write_entries(CommitLog *log, int num_entries, uint64_t *sump,
                      CommitLogBase *link_log);
   void read_entries(DfsBroker::Client *dfs_client, CommitLogReader *log_reader,
@@ -85,6 +88,7 @@ int main(int argc, char **argv) {
 
     //test1(dfs);
     test_link(dfs.get());
+    test_local(dfs.get());
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -205,6 +209,61 @@ namespace {
     HT_ASSERT(sum_read == sum_written);
   }
 
+  void test_local(DfsBroker::Client *dfs_client) {
+    String log_dir = "/hypertable/test_log";
+    String local_dir = System::install_dir + "/tmp/commit_log_test";
+    CommitLog *log;
+    CommitLogReaderPtr log_reader_ptr;
+    uint64_t sum_written = 0;
+    uint64_t sum_read = 0;
+    FilesystemPtr fs = dfs_client;
+
+    dfs_client->rmdir(log_dir);
+    dfs_client->mkdirs(log_dir + "/l");
+    dfs_client->mkdirs(log_dir + "/r");
+    FileUtils::mkdirs(local_dir + "/r");
+
+    /**
+     * Write log "l" through local disk and read it back from the DFS
+     */
+    log = new CommitLog(fs, log_dir + "/l", properties, 0, local_dir + "/l");
+    write_entries(log, 20, &sum_written, 0);
+
+    /**
+     * Simulate a crash by copying the current (unsealed, possibly
+     * preallocated) local fragment, followed by zeros, into local
+     * directory "r"
+     */
+    HT_ASSERT(log->sync() == Error::OK);
+    String fragment = log->get_current_fragment_file();
+    fragment = fragment.substr(fragment.rfind('/') + 1);
+    String contents = FileUtils::file_to_string(local_dir + "/l/" + fragment);
+    contents.append(8192, '\0');
+    FileUtils::write(local_dir + "/r/" + fragment, contents);
+
+    delete log;
+
+    HT_ASSERT(!FileUtils::exists(local_dir + "/l/" + fragment));
+    int64_t fragment_length = fs->length(log_dir + "/l/" + fragment);
+
+    log_reader_ptr = new CommitLogReader(fs, log_dir + "/l");
+    read_entries(dfs_client, log_reader_ptr.get(), &sum_read);
+    HT_ASSERT(sum_read == sum_written);
+
+    /**
+     * Recover "r" into the DFS; the trailing zeros are dropped
+     */
+    HT_ASSERT(CommitLogShipper::recover(fs, local_dir + "/r", log_dir + "/r")
+              == 1);
+    HT_ASSERT(!FileUtils::exists(local_dir + "/r/" + fragment));
+    HT_ASSERT(fs->length(log_dir + "/r/" + fragment) == fragment_length);
+
+    sum_read = 0;
+    log_reader_ptr = new CommitLogReader(fs, log_dir + "/r");
+    read_entries(dfs_client, log_reader_ptr.get(), &sum_read);
+    HT_ASSERT(fragment_length == 0 || sum_read > 0);
+  }
+
   void
   write_entries(CommitLog *log, int num_entries, uint64_t *sump,
                 CommitLogBase *link_log) {
@@ -0,0 +1,130 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include "Hypertable/Lib/HqlParser.h"
+
+using namespace Hypertable;
+using namespace Hql;
+using namespace std;
+
+namespace {
+
+  /** Parses <code>hql</code> into <code>state</code>, returns true if the
+   * whole statement was consumed */
+  bool parse_statement(const char *hql, ParserState &state) {
+    Hql::Parser parser(state);
+    parse_info<> info = parse(hql, parser, space_p);
+    return info.full;
+  }
+
+  void check(bool cond, const char *hql, const char *what) {
+    if (!cond) {
+      HT_ERRORF("%s: %s", hql, what);
+      exit(1);
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  // DUMP TABLE ... PARALLEL n
+  {
+    const char *hql = "DUMP TABLE foo INTO FILE 'foo_dir' PARALLEL 4";
+    ParserState state;
+    check(parse_statement(hql, state), hql, "parse failed");
+    check(state.command == COMMAND_DUMP_TABLE, hql, "wrong command");
+    check(state.table_name == "foo", hql, "wrong table name");
+    check(state.scan.parallel == 4, hql, "wrong PARALLEL count");
+    check(state.scan.outfile == "foo_dir", hql, "wrong output file");
+    check(state.escape, hql, "escape is off");
+  }
+
+  {
+    const char *hql = "dump table foo parallel 16 NO_ESCAPE "
+                      "into file \"dfs://backup/foo.gz\"";
+    ParserState state;
+    check(parse_statement(hql, state), hql, "parse failed");
+    check(state.scan.parallel == 16, hql, "wrong PARALLEL count");
+    check(state.scan.outfile == "dfs://backup/foo.gz", hql,
+          "wrong output file");
+    check(!state.escape, hql, "escape is on");
+  }
+
+  {
+    const char *hql = "DUMP TABLE foo INTO FILE 'foo.gz'";
+    ParserState state;
+    check(parse_statement(hql, state), hql, "parse failed");
+    check(state.scan.parallel == 0, hql, "PARALLEL set");
+  }
+
+  {
+    const char *hql = "DUMP TABLE foo PARALLEL";
+    ParserState state;
+    check(!parse_statement(hql, state), hql, "PARALLEL without count parsed");
+  }
+
+  {
+    const char *hql = "DUMP TABLE foo PARALLEL 2 PARALLEL 3";
+    ParserState state;
+    try {
+      parse_statement(hql, state);
+      check(false, hql, "PARALLEL given twice parsed");
+    }
+    catch (Exception &e) {
+      check(e.code() == Error::HQL_PARSE_ERROR, hql, "wrong error");
+    }
+  }
+
+  // statements of a parallel dump's MANIFEST
+  {
+    const char *hql = "LOAD DATA INFILE \"foo_dir/part-00000.tsv\" "
+                      "INTO TABLE foo";
+    ParserState state;
+    check(parse_statement(hql, state), hql, "parse failed");
+    check(state.command == COMMAND_LOAD_DATA, hql, "wrong command");
+    check(state.input_file == "foo_dir/part-00000.tsv", hql,
+          "wrong input file");
+    check(state.table_name == "foo", hql, "wrong table name");
+    check(state.escape, hql, "escape is off");
+  }
+
+  {
+    const char *hql = "LOAD DATA INFILE NO_ESCAPE "
+                      "\"dfs://backup/foo.gz/part-00001.tsv.gz\" INTO TABLE foo";
+    ParserState state;
+    check(parse_statement(hql, state), hql, "parse failed");
+    check(state.input_file == "backup/foo.gz/part-00001.tsv.gz", hql,
+          "wrong input file");
+    check(!state.escape, hql, "escape is on");
+  }
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -29,6 +29,7 @@ extern "C" {
 #include <fcntl.h>
 }
 
+#include "Common/DynamicBuffer.h"
 #include "Common/String.h"
 
 #include "Hypertable/Lib/KeySpec.h"
@@ -39,12 +40,38 @@ extern "C" {
 using namespace Hypertable;
 using namespace std;
 
+namespace {
+
+  void dump_cell(const KeySpec &key, const uint8_t *value) {
+    cerr << "row=" << (const char *)key.row
+         << " column_family=" << key.column_family;
+    if (key.column_qualifier_len > 0)
+      cerr << " column_qualifier=" << (const char *)key.column_qualifier;
+    cerr << " value=" << (const char *)value << endl;
+  }
+
+  /** Redirects stderr to (a truncated) output_fn */
+  bool redirect_stderr(const String &output_fn) {
+    int fd;
+    if ((fd = open(output_fn.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0) {
+      perror("open");
+      return false;
+    }
+    close(2);
+    dup(fd);
+    close(fd);
+    return true;
+  }
+
+}
+
 int main(int argc, char **argv) {
   LoadDataSourcePtr lds;
   KeySpec key;
   uint8_t *value;
   uint32_t value_len;
-  int fd;
+  DynamicBuffer chunk;
+  int64_t first_line;
   std::vector<String> key_columns;
   DfsBroker::ClientPtr null_dfs_client;
 
@@ -56,13 +83,8 @@ int main(int argc, char **argv) {
   for(size_t i = 0; i < testnames.size(); i++) {
     String output_fn = testnames[i] + ".output";
 
-    if ((fd = open(output_fn.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644)) < 0) {
-      perror("open");
+    if (!redirect_stderr(output_fn))
       return 1;
-    }
-
-    close(2);
-    dup(fd);
 
     key_columns.clear();
     String dat_fn = testnames[i] + ".dat";
@@ -70,18 +92,41 @@ int main(int argc, char **argv) {
                                         dat_fn.c_str(), LOCAL_FILE, "", LOCAL_FILE,
                                         key_columns, "");
 
-    while (lds->next(0, &key, &value, &value_len, 0)) {
-      cerr << "row=" << (const char *)key.row
-           << " column_family=" << key.column_family;
-      if (key.column_qualifier_len > 0)
-        cerr << " column_qualifier=" << (const char *)key.column_qualifier;
-      cerr << " value=" << (const char *)value << endl;
-    }
+    while (lds->next(0, &key, &value, &value_len, 0))
+      dump_cell(key, value);
 
     String golden_fn = testnames[i] + ".golden";
     String sys_cmd = "diff " + output_fn + " " + golden_fn;
     if (system(sys_cmd.c_str()) != 0)
       return 1;
+
+    // parse again in tiny chunks, the way parallel LOAD DATA INFILE does
+    output_fn = testnames[i] + ".chunked.output";
+    if (!redirect_stderr(output_fn))
+      return 1;
+
+    lds = LoadDataSourceFactory::create(null_dfs_client,
+                                        dat_fn.c_str(), LOCAL_FILE, "", LOCAL_FILE,
+                                        key_columns, "");
+    LoadDataSourcePtr parser = lds->create_chunk_parser();
+    size_t chunk_count = 0;
+
+    while (lds->next_chunk(16, chunk, &first_line, 0)) {
+      parser->set_chunk((char *)chunk.base, chunk.fill(), first_line);
+      while (parser->next(0, &key, &value, &value_len, 0))
+        dump_cell(key, value);
+      chunk_count++;
+    }
+
+    // the files hold several lines of more than 16 bytes, so must be cut
+    if (chunk_count < 2) {
+      cout << dat_fn << " was not split into chunks" << endl;
+      return 1;
+    }
+
+    sys_cmd = "diff " + output_fn + " " + golden_fn;
+    if (system(sys_cmd.c_str()) != 0)
+      return 1;
   }
 
   return 0;
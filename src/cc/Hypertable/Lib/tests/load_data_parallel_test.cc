@@ -0,0 +1,146 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <unistd.h>
+
+#include "Hypertable/Lib/Config.h"
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/HqlInterpreter.h"
+#include "Hypertable/Lib/LoadDataParallel.h"
+#include "Hypertable/Lib/LoadDataSourceFactory.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+/**
+ * Loads a file in which every row has many versions of the same cell,
+ * spread over many small chunks, with several parsers and mutators, and
+ * checks that the version appearing last in the input is the one that
+ * wins for each row.
+ */
+
+namespace {
+
+  const char *input_fn = "load_data_parallel_test.tsv";
+  const int LINES = 20000;
+  const int ROWS = 500;
+
+  typedef map<String, String> RowValues;
+
+  /** Writes the input file, returning the last value of each row */
+  void write_input(RowValues &last_values) {
+    ofstream out(input_fn);
+    char row[32], value[32];
+
+    out << "rowkey\tcolumnkey\tvalue\n";
+    for (int i=0; i<LINES; i++) {
+      // every third line updates the same row
+      if (i % 3 == 0)
+        strcpy(row, "hot");
+      else
+        sprintf(row, "row%05d", i % ROWS);
+      sprintf(value, "%08d", i);
+      out << row << "\tcol\t" << value << "\n";
+      last_values[row] = value;
+    }
+    HT_ASSERT(out.good());
+  }
+
+  void load(TablePtr &table, size_t parsers, size_t mutators) {
+    DfsBroker::ClientPtr null_dfs_client;
+    vector<String> key_columns;
+    uint32_t consumed;
+
+    LoadDataSourcePtr lds = LoadDataSourceFactory::create(null_dfs_client,
+        input_fn, LOCAL_FILE, "", LOCAL_FILE, key_columns, "");
+    LoadDataParallel loader(lds, table, 0, false, parsers, mutators, 4096);
+    while (loader.read(&consumed))
+      ;
+    loader.finish();
+    HT_ASSERT(loader.get_total_cells() == (uint64_t)LINES);
+  }
+
+  void check_results(TablePtr &table, const RowValues &last_values) {
+    ScanSpecBuilder ssb;
+    Cell cell;
+    size_t rows = 0;
+
+    ssb.set_max_versions(1);
+    TableScannerPtr scanner = table->create_scanner(ssb.get());
+    while (scanner->next(cell)) {
+      RowValues::const_iterator iter = last_values.find(cell.row_key);
+      HT_ASSERT(iter != last_values.end());
+      if (cell.value_len != iter->second.length() ||
+          memcmp(cell.value, iter->second.c_str(), cell.value_len)) {
+        HT_ERRORF("row %s: expected last version %s, got %s", cell.row_key,
+                  iter->second.c_str(),
+                  String((const char *)cell.value, cell.value_len).c_str());
+        _exit(1);
+      }
+      rows++;
+    }
+    HT_ASSERT(rows == last_values.size());
+  }
+
+} // local namespace
+
+
+int main(int argc, char *argv[]) {
+  try {
+    init_with_policy<DefaultClientPolicy>(argc, argv);
+
+    ClientPtr client = new Hypertable::Client();
+    NamespacePtr ns = client->open_namespace("/");
+    HqlInterpreterPtr hql = client->create_hql_interpreter();
+    RowValues last_values;
+
+    write_input(last_values);
+
+    size_t parsers[] = { 4, 4, 8 };
+    size_t mutators[] = { 1, 3, 8 };
+
+    for (size_t i=0; i<sizeof(parsers)/sizeof(size_t); i++) {
+      hql->execute("use '/'");
+      hql->execute("drop table if exists load_data_parallel_test");
+      hql->execute("create table load_data_parallel_test(col)");
+
+      TablePtr table = ns->open_table("load_data_parallel_test");
+
+      load(table, parsers[i], mutators[i]);
+      check_results(table, last_values);
+    }
+
+    unlink(input_fn);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0);
+}
@@ -0,0 +1,238 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/PendingCounters.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /**
+   * Buffers counter updates and deletes the way TableMutatorScatterBuffer
+   * does: an update is folded into a pending one if possible, otherwise it
+   * is appended to the buffer and becomes the pending update of its cell.
+   */
+  class Buffer {
+  public:
+    void update(const char *row, uint8_t cf, const char *qualifier,
+                int64_t count, bool reset=false) {
+      Key key = make_key(FLAG_INSERT, row, cf, qualifier);
+      uint8_t value[9];
+      uint8_t *ptr = value;
+      Serialization::encode_i64(&ptr, count);
+      if (reset)
+        *ptr++ = '=';
+      if (pending.fold(key, value, reset))
+        return;
+      create_key_and_append(accum, FLAG_INSERT, row, cf, qualifier);
+      pending.add(key, &accum, accum.fill());
+      append_as_byte_string(accum, value, ptr-value);
+    }
+
+    void remove(uint8_t flag, const char *row, uint8_t cf=0,
+                const char *qualifier=0) {
+      pending.drop(make_key(flag, row, cf, qualifier), flag);
+      create_key_and_append(accum, flag, row, cf, qualifier);
+      append_as_byte_string(accum, 0, 0);
+    }
+
+    void reset() {
+      accum.clear();
+      pending.clear();
+    }
+
+    /** Returns the buffered cells as "row cf:qualifier value" strings */
+    vector<String> cells() {
+      vector<String> cells;
+      const uint8_t *ptr = accum.base;
+      while (ptr < accum.ptr) {
+        SerializedKey serkey(ptr);
+        Key key;
+        key.load(serkey);
+        ByteString bs(ptr + serkey.length());
+        ptr += serkey.length() + bs.length();
+        String cell = format("%s %d:%s", key.row, (int)key.column_family_code,
+                             key.column_qualifier);
+        if (key.flag != FLAG_INSERT)
+          cell += format(" delete%d", (int)key.flag);
+        else {
+          const uint8_t *data;
+          size_t len = bs.decode_length(&data);
+          size_t remain = 8;
+          cell += format(" %lld", (Lld)Serialization::decode_i64(&data,
+                                                                 &remain));
+          if (len == 9)
+            cell += "=";
+        }
+        cells.push_back(cell);
+      }
+      return cells;
+    }
+
+    DynamicBuffer accum;
+    PendingCounters pending;
+
+  private:
+    Key make_key(uint8_t flag, const char *row, uint8_t cf,
+                 const char *qualifier) {
+      Key key;
+      key.flag = flag;
+      key.row = row;
+      key.column_family_code = cf;
+      key.column_qualifier = qualifier;
+      key.timestamp = AUTO_ASSIGN;
+      return key;
+    }
+  };
+
+  void check(Buffer &buf, const char **expected, const char *what) {
+    vector<String> cells = buf.cells();
+    size_t i = 0;
+    for (; expected[i]; i++) {
+      if (i >= cells.size() || cells[i] != expected[i]) {
+        HT_ERRORF("%s: cell %d is '%s', expected '%s'", what, (int)i,
+                  i < cells.size() ? cells[i].c_str() : "", expected[i]);
+        exit(1);
+      }
+    }
+    if (i != cells.size()) {
+      HT_ERRORF("%s: %d cells buffered, expected %d", what,
+                (int)cells.size(), (int)i);
+      exit(1);
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  Buffer buf;
+
+  // increments of the same cell are folded, other cells are not touched
+  {
+    buf.update("r1", 1, "a", 1);
+    buf.update("r1", 1, "b", 10);
+    buf.update("r1", 1, "a", 2);
+    buf.update("r1", 2, "a", 100);
+    buf.update("r1", 1, "a", 3);
+    buf.update("r2", 1, "a", 7);
+    buf.update("r1", 1, "b", 5);
+    const char *expected[] = { "r1 1:a 6", "r1 1:b 15", "r1 2:a 100",
+                               "r2 1:a 7", 0 };
+    check(buf, expected, "increment folding");
+    HT_ASSERT(buf.pending.size() == 4);
+  }
+
+  // a reset after increments is buffered after them, increments that
+  // follow it are folded into it, keeping the reset flag
+  {
+    buf.reset();
+    buf.update("r1", 1, "a", 4);
+    buf.update("r1", 1, "a", 0, true);
+    buf.update("r1", 1, "a", 2);
+    buf.update("r1", 1, "a", 3);
+    const char *expected[] = { "r1 1:a 4", "r1 1:a 5=", 0 };
+    check(buf, expected, "reset after increment");
+  }
+
+  // a reset replaces a buffered reset
+  {
+    buf.reset();
+    buf.update("r1", 1, "a", 8, true);
+    buf.update("r1", 1, "a", 1);
+    buf.update("r1", 1, "a", 20, true);
+    buf.update("r1", 1, "a", 2);
+    const char *expected[] = { "r1 1:a 22=", 0 };
+    check(buf, expected, "reset over reset");
+  }
+
+  // nothing is folded across a delete of the cell, column family or row
+  {
+    buf.reset();
+    buf.update("r1", 1, "a", 1);
+    buf.update("r1", 1, "b", 1);
+    buf.update("r1", 2, "a", 1);
+    buf.update("r2", 1, "a", 1);
+    buf.update("r10", 1, "a", 1);
+    buf.remove(FLAG_DELETE_CELL, "r1", 1, "a");
+    buf.update("r1", 1, "a", 2);
+    buf.update("r1", 1, "b", 2);
+    buf.update("r1", 2, "a", 2);
+    buf.update("r2", 1, "a", 2);
+    buf.update("r10", 1, "a", 2);
+    const char *expected[] = { "r1 1:a 1", "r1 1:b 3", "r1 2:a 3", "r2 1:a 3",
+                               "r10 1:a 3", "r1 1:a delete2", "r1 1:a 2", 0 };
+    check(buf, expected, "cell delete");
+
+    buf.reset();
+    buf.update("r1", 1, "a", 1);
+    buf.update("r1", 1, "b", 1);
+    buf.update("r1", 2, "a", 1);
+    buf.remove(FLAG_DELETE_COLUMN_FAMILY, "r1", 1);
+    buf.update("r1", 1, "a", 2);
+    buf.update("r1", 1, "b", 2);
+    buf.update("r1", 2, "a", 2);
+    const char *expected_cf[] = { "r1 1:a 1", "r1 1:b 1", "r1 2:a 3",
+                                  "r1 1: delete1", "r1 1:a 2", "r1 1:b 2", 0 };
+    check(buf, expected_cf, "column family delete");
+
+    buf.reset();
+    buf.update("r1", 1, "a", 1);
+    buf.update("r1", 2, "a", 1);
+    buf.update("r10", 1, "a", 1);
+    buf.remove(FLAG_DELETE_ROW, "r1");
+    buf.update("r1", 1, "a", 2);
+    buf.update("r1", 2, "a", 2);
+    buf.update("r10", 1, "a", 2);
+    const char *expected_row[] = { "r1 1:a 1", "r1 2:a 1", "r10 1:a 3",
+                                   "r1 0: delete0", "r1 1:a 2", "r1 2:a 2",
+                                   0 };
+    check(buf, expected_row, "row delete");
+  }
+
+  // once the buffer is sent (or reset), nothing is folded into it
+  {
+    buf.reset();
+    buf.update("r1", 1, "a", 1);
+    buf.update("r1", 1, "a", 0, true);
+    HT_ASSERT(buf.pending.size() == 1);
+    buf.pending.clear();
+    HT_ASSERT(buf.pending.size() == 0);
+    buf.update("r1", 1, "a", 2);
+    buf.update("r1", 1, "a", 3, true);
+    const char *expected[] = { "r1 1:a 1", "r1 1:a 0=", "r1 1:a 2",
+                               "r1 1:a 3=", 0 };
+    check(buf, expected, "clear");
+  }
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
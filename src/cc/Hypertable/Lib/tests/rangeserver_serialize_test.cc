@@ -43,6 +43,13 @@ int main(int argc, char *argv[]) {
   stats1->block_cache_accesses = Random::number64();
   stats1->block_cache_hits = Random::number64();
 
+  stats1->query_cache_shards.resize(16);
+  for (size_t i=0; i<stats1->query_cache_shards.size(); i++) {
+    stats1->query_cache_shards[i].accesses = Random::number64();
+    stats1->query_cache_shards[i].hits = Random::number64();
+    stats1->query_cache_shards[i].negative_hits = Random::number64();
+  }
+
   stats1->system.refresh();
 
   StatsTable table_stat;
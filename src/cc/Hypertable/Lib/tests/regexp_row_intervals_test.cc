@@ -0,0 +1,114 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <cstdlib>
+#include <iostream>
+
+#include <re2/re2.h>
+
+#include "Hypertable/Lib/RegexpRowIntervals.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  struct Expected {
+    const char *regexp;
+    const char *intervals;  // "start,end;start,end;..." or "" if unrestricted
+  };
+
+  Expected expected[] = {
+    { "^user123:", "user123:,user123;" },
+    { "^user1|^user7", "user1,user2;user7,user8" },
+    { "^(user1|user7):", "user1:,user1;;user7:,user7;" },
+    { "^(?:ab|abc)d", "abcd,abce;abd,abe" },
+    { "^a.*", "a,b" },
+    { "^a[bc]d", "abd,b" },
+    { "^(a|)x", "ax,ay;x,y" },
+    { "^(a|b)*", "" },
+    { "user", "" },
+    { "^a|b", "" },
+    { "^", "" },
+    { ".*", "" },
+    { 0, 0 }
+  };
+
+  String format_intervals(const RegexpRowIntervals &intervals) {
+    String str;
+    foreach(const RegexpRowIntervals::Interval &interval, intervals.get()) {
+      if (!str.empty())
+        str += ";";
+      str += interval.start + "," + interval.end;
+    }
+    return str;
+  }
+
+  /**
+   * Checks that every generated row that matches the regexp falls inside
+   * one of the intervals and that find() returns that interval
+   */
+  void check_rows(const char *regexp, const RegexpRowIntervals &intervals) {
+    const char alphabet[] = "abcdeu137:;\xff";
+    RE2 re(regexp);
+    char row[8];
+
+    for (int i=0; i<20000; i++) {
+      size_t len = 1 + random() % 7;
+      for (size_t j=0; j<len; j++)
+        row[j] = alphabet[random() % (sizeof(alphabet)-1)];
+      row[len] = 0;
+      if (!RE2::PartialMatch(row, re))
+        continue;
+      const RegexpRowIntervals::Interval *interval = intervals.find(row);
+      HT_ASSERT(interval);
+      HT_ASSERT(interval->start <= row && row < interval->end);
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  srandom(1);
+
+  for (size_t i=0; expected[i].regexp; i++) {
+    RegexpRowIntervals intervals(expected[i].regexp);
+    String str = format_intervals(intervals);
+    if (str != expected[i].intervals) {
+      cout << "regexp '" << expected[i].regexp << "' gave '" << str
+           << "', expected '" << expected[i].intervals << "'" << endl;
+      return 1;
+    }
+    if (!intervals.empty())
+      check_rows(expected[i].regexp, intervals);
+  }
+
+  // rows past the last interval
+  RegexpRowIntervals intervals("^b");
+  HT_ASSERT(intervals.find("a") && intervals.find("b") && !intervals.find("c"));
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/Logger.h"
+#include "Common/Time.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/Config.h"
+#include "Hypertable/Lib/HqlInterpreter.h"
+#include "Hypertable/Lib/KeySpec.h"
+#include "Hypertable/Lib/RegexpRowIntervals.h"
+#include "Hypertable/Lib/ScanSpec.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+/**
+ * Compares ROW REGEXP scans with and without the row intervals derived
+ * from the regexp (see RegexpRowIntervals).  The scan without them uses
+ * the same pattern wrapped in "(?:...)", which RE2 matches identically
+ * but from which no interval is derived, so both the client and the range
+ * servers fall back to filtering every row of the table.
+ *
+ * With --load the table is first (re)created and filled with --rows rows
+ * named "user<n>:<seq>", spread evenly over --users users, so a regexp
+ * anchored on one user selects 1/users of the table.
+ *
+ * Usage: row_regexp_bench --load --rows 100000000
+ *        row_regexp_bench --regexp '^(user00042|user00777):'
+ */
+
+namespace {
+
+  struct MyPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc().add_options()
+        ("table", str()->default_value("row_regexp_bench"),
+            "Name of the table to scan")
+        ("load", boo()->zero_tokens()->default_value(false),
+            "(Re)create the table and fill it before scanning")
+        ("rows", i64()->default_value(1000000),
+            "Number of rows to load")
+        ("users", i32()->default_value(10000),
+            "Number of distinct row prefixes to load")
+        ("value-size", i32()->default_value(32),
+            "Size of the value of each cell loaded")
+        ("regexp", str()->default_value("^user00042:"),
+            "Row regexp to scan with")
+        ("runs", i32()->default_value(3),
+            "Number of times each scan is timed")
+        ;
+    }
+  };
+
+  typedef Cons<MyPolicy, DefaultClientPolicy> AppPolicy;
+
+  void load(Table *table, int64_t rows, int32_t users, size_t value_size) {
+    TableMutatorPtr mutator = table->create_mutator();
+    String value(value_size, 'v');
+    char row[64];
+    int64_t start = get_ts64();
+
+    for (int64_t i=0; i<rows; i++) {
+      sprintf(row, "user%05d:%012lld", (int)(i % users), (Lld)(i / users));
+      mutator->set(KeySpec(row, "v", ""), value.c_str(), value.length());
+    }
+    mutator->flush();
+
+    double elapsed = (double)(get_ts64() - start) / 1000000000.0;
+    cout << format("loaded %lld rows in %.1f s", (Lld)rows, elapsed)
+         << endl;
+  }
+
+  int64_t scan(Table *table, const String &regexp, double *elapsedp) {
+    ScanSpecBuilder ssb;
+    Cell cell;
+    int64_t cells = 0;
+
+    ssb.set_row_regexp(regexp.c_str());
+    ssb.set_keys_only(true);
+
+    int64_t start = get_ts64();
+    TableScannerPtr scanner = table->create_scanner(ssb.get());
+    while (scanner->next(cell))
+      cells++;
+    *elapsedp = (double)(get_ts64() - start) / 1000000000.0;
+    return cells;
+  }
+
+} // local namespace
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policy<AppPolicy>(argc, argv);
+
+    String table_name = get_str("table");
+    String regexp = get_str("regexp");
+    String unrestricted = String("(?:") + regexp + ")";
+    int runs = get_i32("runs");
+
+    RegexpRowIntervals intervals(regexp.c_str());
+    if (intervals.empty()) {
+      cerr << "error: no row intervals can be derived from '" << regexp
+           << "'" << endl;
+      _exit(1);
+    }
+    HT_ASSERT(RegexpRowIntervals(unrestricted.c_str()).empty());
+
+    ClientPtr client = new Hypertable::Client();
+    NamespacePtr ns = client->open_namespace("/");
+
+    if (get_bool("load")) {
+      HqlInterpreterPtr hql = client->create_hql_interpreter();
+      hql->execute("use '/'");
+      hql->execute(format("drop table if exists %s", table_name.c_str()));
+      hql->execute(format("create table %s (v)", table_name.c_str()));
+    }
+
+    TablePtr table = ns->open_table(table_name);
+
+    if (get_bool("load"))
+      load(table.get(), get_i64("rows"), get_i32("users"),
+           get_i32("value-size"));
+
+    cout << format("%u row interval(s) derived from '%s'",
+                   (unsigned)intervals.get().size(), regexp.c_str()) << endl;
+    cout << format("%-10s %5s %12s %10s %12s\n", "scan", "run", "cells",
+                   "seconds", "cells/s");
+
+    int64_t expected = -1;
+    for (int run=1; run<=runs; run++) {
+      for (int derived=1; derived>=0; derived--) {
+        double elapsed;
+        int64_t cells = scan(table.get(), derived ? regexp : unrestricted,
+                             &elapsed);
+        if (expected < 0)
+          expected = cells;
+        else if (cells != expected) {
+          cerr << format("error: %s scan returned %lld cells, expected %lld",
+                         derived ? "derived" : "full", (Lld)cells,
+                         (Lld)expected) << endl;
+          _exit(1);
+        }
+        cout << format("%-10s %5d %12lld %10.3f %12.1f\n",
+                       derived ? "derived" : "full", run, (Lld)cells, elapsed,
+                       elapsed > 0 ? (double)cells / elapsed : 0.0)
+             << flush;
+      }
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);
+  }
+  _exit(0);
+}
@@ -0,0 +1,165 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "AsyncComm/Event.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanBlock.h"
+#include "Hypertable/Lib/ScanBlockEncoder.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /**
+   * Builds a wide-row block: a few rows, each with many cells of a couple
+   * of column families.  Returns the plain (serialized key, value) cells.
+   */
+  void build_cells(DynamicBuffer &cells, vector<size_t> &offsets) {
+    char row[64], qualifier[32], value[32];
+    for (int r=0; r<5; r++) {
+      sprintf(row, "com.example.www/some/long/row/key/%04d", r);
+      for (int c=0; c<200; c++) {
+        sprintf(qualifier, "q%d", c % 37);
+        sprintf(value, "value-%d-%d", r, c);
+        offsets.push_back(cells.fill());
+        create_key_and_append(cells, FLAG_INSERT, row, 1 + (c % 2), qualifier,
+                              1000000 + c, 1000000 + c);
+        append_as_byte_string(cells, value, strlen(value));
+      }
+    }
+    offsets.push_back(cells.fill());
+  }
+
+  /** Wraps a scan block into a CREATE_SCANNER response event */
+  EventPtr make_response(uint16_t flags, DynamicBuffer &block) {
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    EventPtr event = new Event(Event::MESSAGE, addr);
+    event->payload_len = 10 + block.fill();
+    uint8_t *payload = new uint8_t [event->payload_len];
+    uint8_t *ptr = payload;
+    Serialization::encode_i32(&ptr, Error::OK);
+    Serialization::encode_i16(&ptr, flags);
+    Serialization::encode_i32(&ptr, 42);
+    memcpy(ptr, block.base, block.fill());
+    event->payload = payload;
+    return event;
+  }
+
+  size_t check_block(ScanBlock &scanblock, DynamicBuffer &cells,
+                     vector<size_t> &offsets) {
+    SerializedKey key;
+    ByteString value;
+    size_t i = 0;
+
+    HT_ASSERT(scanblock.size() == offsets.size() - 1);
+    HT_ASSERT(scanblock.get_scanner_id() == 42);
+    HT_ASSERT(scanblock.eos());
+
+    for (int pass=0; pass<2; pass++) {
+      scanblock.reset();
+      for (i=0; scanblock.next(key, value); i++) {
+        size_t len = offsets[i+1] - offsets[i];
+        HT_ASSERT(key.length() + value.length() == len);
+        HT_ASSERT(memcmp(key.ptr, cells.base + offsets[i], key.length()) == 0);
+        HT_ASSERT(memcmp(value.ptr, cells.base + offsets[i] + key.length(),
+                         value.length()) == 0);
+      }
+      HT_ASSERT(i == scanblock.size());
+      HT_ASSERT(!scanblock.more());
+    }
+    return i;
+  }
+
+  size_t encode(DynamicBuffer &cells, vector<size_t> &offsets, bool compress,
+                DynamicBuffer &block) {
+    ScanBlockEncoder encoder(compress);
+    for (size_t i=0; i+1<offsets.size(); i++) {
+      SerializedKey key(cells.base + offsets[i]);
+      size_t key_len = key.length();
+      encoder.add(key, cells.base + offsets[i] + key_len,
+                  offsets[i+1] - offsets[i] - key_len);
+    }
+    HT_ASSERT(encoder.count() == offsets.size() - 1);
+    encoder.finish(block);
+    return block.fill();
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  DynamicBuffer cells;
+  vector<size_t> offsets;
+  ScanBlock scanblock;
+
+  build_cells(cells, offsets);
+
+  // plain block
+  DynamicBuffer plain(4 + cells.fill());
+  Serialization::encode_i32(&plain.ptr, cells.fill());
+  plain.add(cells.base, cells.fill());
+  EventPtr event = make_response(ScanBlock::FLAG_EOS, plain);
+  HT_ASSERT(scanblock.load(event) == Error::OK);
+  check_block(scanblock, cells, offsets);
+
+  // compact block
+  DynamicBuffer compact;
+  size_t compact_len = encode(cells, offsets, false, compact);
+  event = make_response(ScanBlock::FLAG_EOS | ScanBlock::FLAG_COMPACT, compact);
+  HT_ASSERT(scanblock.load(event) == Error::OK);
+  check_block(scanblock, cells, offsets);
+
+  // compact, compressed block
+  DynamicBuffer compressed;
+  size_t compressed_len = encode(cells, offsets, true, compressed);
+  event = make_response(ScanBlock::FLAG_EOS | ScanBlock::FLAG_COMPACT,
+                        compressed);
+  HT_ASSERT(scanblock.load(event) == Error::OK);
+  check_block(scanblock, cells, offsets);
+
+  cout << "plain=" << plain.fill() << " compact=" << compact_len
+       << " compressed=" << compressed_len << endl;
+  HT_ASSERT(compact_len < plain.fill() / 2);
+  HT_ASSERT(compressed_len < compact_len);
+
+  // empty compact block
+  DynamicBuffer empty_cells, empty;
+  vector<size_t> empty_offsets(1, 0);
+  encode(empty_cells, empty_offsets, false, empty);
+  event = make_response(ScanBlock::FLAG_EOS | ScanBlock::FLAG_COMPACT, empty);
+  HT_ASSERT(scanblock.load(event) == Error::OK);
+  check_block(scanblock, empty_cells, empty_offsets);
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
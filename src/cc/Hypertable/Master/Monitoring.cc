@@ -245,6 +245,7 @@ void Monitoring::add(std::vector<RangeServerStatistics> &stats) {
     stats_vec.push_back(*(*iter).second);
   sort(stats_vec.begin(), stats_vec.end(), comp);
   dump_rangeserver_summary_json(stats_vec);
+  dump_rangeserver_latency_json(stats_vec);
 
   // create Table rrd data
   TableStatMap::iterator ts_iter;
@@ -677,6 +678,76 @@ void Monitoring::dump_rangeserver_summary_json(std::vector<RangeServerStatistics
 
 }
 
+namespace {
+  const char *latency_json_header = "{\"RangeServerLatency\": {\n  \"servers\": [\n";
+  const char *latency_json_footer= "\n  ]\n}}\n";
+  const char *latency_format =
+    "{\"count\": \"%llu\", \"mean\": \"%.1f\", \"p50\": \"%llu\","
+    " \"p99\": \"%llu\", \"p999\": \"%llu\", \"max\": \"%llu\"}";
+
+  String format_latency(const LatencyHistogram &hist) {
+    return format(latency_format, (Llu)hist.count(), hist.mean(),
+                  (Llu)hist.percentile(50.0), (Llu)hist.percentile(99.0),
+                  (Llu)hist.percentile(99.9), (Llu)hist.max());
+  }
+
+  String format_latency_entry(const String &location,
+                              const LatencyHistogram *queue_latency,
+                              const LatencyHistogram *response_latency,
+                              const LatencyHistogram *update_phase_latency) {
+    String entry = format("{\"location\": \"%s\"", location.c_str());
+    for (int i=0; i<StatsRangeServer::RPC_TYPE_COUNT; i++)
+      entry += format(", \"%s\": {\"queue\": %s, \"response\": %s}",
+                      StatsRangeServer::rpc_type_name(i),
+                      format_latency(queue_latency[i]).c_str(),
+                      format_latency(response_latency[i]).c_str());
+    entry += ", \"update_phases\": {";
+    for (int i=0; i<StatsRangeServer::UPDATE_PHASE_COUNT; i++)
+      entry += format("%s\"%s\": %s", i ? ", " : "",
+                      StatsRangeServer::update_phase_name(i),
+                      format_latency(update_phase_latency[i]).c_str());
+    return entry + "}}";
+  }
+}
+
+/**
+ * Writes per-server latency percentiles (microseconds) for the last
+ * monitoring interval, followed by an entry with location "all" that
+ * aggregates the histograms of all servers.
+ */
+void Monitoring::dump_rangeserver_latency_json(std::vector<RangeServerStatistics> &stats) {
+  String str = String(latency_json_header);
+  LatencyHistogram all_queue[StatsRangeServer::RPC_TYPE_COUNT];
+  LatencyHistogram all_response[StatsRangeServer::RPC_TYPE_COUNT];
+  LatencyHistogram all_update_phase[StatsRangeServer::UPDATE_PHASE_COUNT];
+
+  for (size_t i=0; i<stats.size(); i++) {
+    if (!stats[i].stats)
+      continue;
+    for (int j=0; j<StatsRangeServer::RPC_TYPE_COUNT; j++) {
+      all_queue[j].merge(stats[i].stats->queue_latency[j]);
+      all_response[j].merge(stats[i].stats->response_latency[j]);
+    }
+    for (int j=0; j<StatsRangeServer::UPDATE_PHASE_COUNT; j++)
+      all_update_phase[j].merge(stats[i].stats->update_phase_latency[j]);
+    str += String("    ") + format_latency_entry(stats[i].location,
+        stats[i].stats->queue_latency, stats[i].stats->response_latency,
+        stats[i].stats->update_phase_latency) + ",\n";
+  }
+
+  str += String("    ") + format_latency_entry("all", all_queue, all_response,
+                                              all_update_phase);
+  str += latency_json_footer;
+
+  String tmp_filename = m_monitoring_dir + "/rangeserver_latency.tmp";
+  String json_filename = m_monitoring_dir + "/rangeserver_latency.json";
+
+  if (FileUtils::write(tmp_filename, str) == -1)
+    return;
+
+  FileUtils::rename(tmp_filename, json_filename);
+}
+
 void Monitoring::dump_table_summary_json() {
   String str = String(table_json_header);
   String entry;
@@ -22,7 +22,6 @@
 #include "Common/Compat.h"
 #include "Common/Error.h"
 #include "Common/FailureInducer.h"
-#include "Common/ScopeGuard.h"
 #include "Common/Serialization.h"
 
 #include "Hyperspace/Session.h"
@@ -156,11 +155,11 @@ void OperationCreateTable::execute() {
 
   case OperationState::FINALIZE:
     {
-      uint64_t handle = 0;
-      HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, m_context->hyperspace, &handle);
       String tablefile = m_context->toplevel_dir + "/tables/" + m_table.id;
-      handle = m_context->hyperspace->open(tablefile, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
-      m_context->hyperspace->attr_set(handle, "x", "", 0);
+      std::vector<Hyperspace::MultiOp> ops;
+      ops.push_back(Hyperspace::MultiOp(Hyperspace::MultiOp::ATTR_SET, tablefile,
+                                        "x", ""));
+      m_context->hyperspace->multi(ops);
     }
     complete_ok();
     break;
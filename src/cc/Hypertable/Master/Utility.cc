@@ -21,7 +21,6 @@
 
 #include "Common/Compat.h"
 #include "Common/FailureInducer.h"
-#include "Common/ScopeGuard.h"
 #include "Common/StringExt.h"
 #include "Common/md5.h"
 
@@ -42,6 +41,23 @@
 
 using namespace Hyperspace;
 
+namespace {
+
+  /**
+   * Returns true if the table file exists and has the "x" attribute, which
+   * is set once the table has been created.  Takes one Hyperspace request.
+   */
+  bool table_file_complete(Hypertable::ContextPtr &context,
+                           const Hypertable::String &tablefile) {
+    std::vector<MultiOp> ops;
+    ops.push_back(MultiOp(MultiOp::ATTR_EXISTS, tablefile, "x",
+                          MultiOp::FLAG_OPTIONAL));
+    context->hyperspace->multi(ops);
+    return ops[0].exists;
+  }
+
+}
+
 namespace Hypertable { namespace Utility {
 
 void get_table_server_set(ContextPtr &context, const String &id, StringSet &servers) {
@@ -86,13 +102,8 @@ bool table_exists(ContextPtr &context, const String &name, String &id) {
   String tablefile = context->toplevel_dir + "/tables/" + id;
 
   try {
-    uint64_t handle = 0;
-    HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, context->hyperspace, &handle);
-    if (context->hyperspace->exists(tablefile)) {
-      handle = context->hyperspace->open(tablefile, OPEN_FLAG_READ);
-      if (context->hyperspace->attr_exists(handle, "x"))
-        return true;
-    }
+    if (table_file_complete(context, tablefile))
+      return true;
   }
   catch (Exception &e) {
     if (e.code() == Error::HYPERSPACE_FILE_NOT_FOUND ||
@@ -109,13 +120,8 @@ bool table_exists(ContextPtr &context, const String &id) {
   String tablefile = context->toplevel_dir + "/tables/" + id;
 
   try {
-    uint64_t handle = 0;
-    HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, context->hyperspace, &handle);
-    if (context->hyperspace->exists(tablefile)) {
-      handle = context->hyperspace->open(tablefile, OPEN_FLAG_READ);
-      if (context->hyperspace->attr_exists(handle, "x"))
-        return true;
-    }
+    if (table_file_complete(context, tablefile))
+      return true;
   }
   catch (Exception &e) {
     if (e.code() == Error::HYPERSPACE_FILE_NOT_FOUND ||
@@ -140,23 +146,16 @@ void verify_table_name_availability(ContextPtr &context, const String &name, Str
 
   String tablefile = context->toplevel_dir + "/tables/" + id;
 
-  uint64_t handle = 0;
-  HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, context->hyperspace, &handle);
-  if (context->hyperspace->exists(tablefile)) {
-    handle = context->hyperspace->open(tablefile, Hyperspace::OPEN_FLAG_READ);
-    if (context->hyperspace->attr_exists(handle, "x"))
-      HT_THROW(Error::MASTER_TABLE_EXISTS, name);
-  }
+  if (table_file_complete(context, tablefile))
+    HT_THROW(Error::MASTER_TABLE_EXISTS, name);
 
 }
 
 
 void create_table_in_hyperspace(ContextPtr &context, const String &name,
                                 const String &schema_str, TableIdentifierManaged *table) {
-  uint64_t handle = 0;
   String table_name = name;
-
-  HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, context->hyperspace, &handle);
+  std::vector<MultiOp> ops;
 
   // String leading '/'
   if (table_name[0] == '/')
@@ -187,17 +186,14 @@ void create_table_in_hyperspace(ContextPtr &context, const String &name,
   String finalschema = "";
   schema->render(finalschema, true);
 
-  // Create table file
+  // Create table file and write schema attribute
   String tablefile = context->toplevel_dir + "/tables/" + table_id;
-  int oflags = OPEN_FLAG_READ|OPEN_FLAG_WRITE|OPEN_FLAG_CREATE;
-  handle = context->hyperspace->open(tablefile, oflags);
+  ops.push_back(MultiOp(MultiOp::CREATE, tablefile, MultiOp::FLAG_OPTIONAL));
+  ops.push_back(MultiOp(MultiOp::ATTR_SET, tablefile, "schema", finalschema));
+  context->hyperspace->multi(ops);
 
   HT_MAYBE_FAIL("Utility-create-table-in-hyperspace-2");
 
-  // Write schema attribute
-  context->hyperspace->attr_set(handle, "schema", finalschema.c_str(),
-                         finalschema.length());
-
   // Create /hypertable/tables/&lt;table&gt;/&lt;accessGroup&gt; directories
   // for this table in DFS
   String table_basedir = context->toplevel_dir + "/tables/" + table_id + "/";
@@ -35,6 +35,7 @@
 #include "CellStoreFactory.h"
 #include "CellStoreReleaseCallback.h"
 #include "CellStoreV5.h"
+#include "FrozenCellListScanner.h"
 #include "Global.h"
 #include "MaintenanceFlag.h"
 #include "MergeScanner.h"
@@ -178,8 +179,11 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
     if (m_immutable_cache)
       scanner->add_scanner(m_immutable_cache->create_scanner(scan_context));
 
+    if (m_frozen_list)
+      scanner->add_scanner(m_frozen_list->create_scanner(scan_context));
+
     if (!m_in_memory) {
-      bool bloom_filter_disabled;
+      uint8_t bloom_filter_mode;
 
       for (size_t i=0; i<m_stores.size(); ++i) {
 
@@ -187,12 +191,16 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
             scan_context->time_interval.second < m_stores[i].timestamp_min)
           continue;
 
-        bloom_filter_disabled = boost::any_cast<uint8_t>(m_stores[i].cs->get_trailer()->get("bloom_filter_mode")) == BLOOM_FILTER_DISABLED;
+        bloom_filter_mode = boost::any_cast<uint8_t>(m_stores[i].cs->get_trailer()->get("bloom_filter_mode"));
 
         // Query bloomfilter only if it is enabled and a start row has been specified
-        // (ie query is not something like select bar from foo;)
-        if (bloom_filter_disabled ||
-            !scan_context->single_row ||
+        // (ie query is not something like select bar from foo;) and the scan
+        // is over a single row or a set of rows, in which case the store is
+        // skipped if it holds none of them.  Prefix filters may also rule
+        // out a range of rows that share a prefix.
+        if (bloom_filter_mode == BLOOM_FILTER_DISABLED ||
+            (!scan_context->single_row && scan_context->rowset.size() < 2 &&
+             bloom_filter_mode != BLOOM_FILTER_ROWS_PREFIX) ||
             scan_context->start_row == "") {
           if (m_stores[i].shadow_cache) {
             scanner->add_scanner(m_stores[i].shadow_cache->create_scanner(scan_context));
@@ -204,7 +212,7 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
         }
         else {
           m_stores[i].bloom_filter_accesses++;
-          if (m_stores[i].cs->may_contain(scan_context)) {
+          if (may_contain_rows(m_stores[i].cs, scan_context)) {
             m_stores[i].bloom_filter_maybes++;
             if (m_stores[i].shadow_cache) {
               scanner->add_scanner(m_stores[i].shadow_cache->create_scanner(scan_context));
@@ -232,6 +240,21 @@ CellListScanner *AccessGroup::create_scanner(ScanContextPtr &scan_context) {
   return scanner;
 }
 
+/**
+ * Probes the bloom filter of a cell store for a scan.  For multi-row scans
+ * each row is probed in turn until one may be in the store.
+ */
+bool
+AccessGroup::may_contain_rows(CellStorePtr &cs, ScanContextPtr &scan_context) {
+  if (scan_context->rowset.size() < 2)
+    return cs->may_contain(scan_context);
+  foreach (const char *row, scan_context->rowset) {
+    if (cs->may_contain(row, scan_context))
+      return true;
+  }
+  return false;
+}
+
 bool AccessGroup::include_in_scan(ScanContextPtr &scan_context) {
   ScopedLock lock(m_mutex);
   for (std::set<uint8_t>::iterator iter = m_column_families.begin();
@@ -274,6 +297,8 @@ AccessGroup::get_split_rows(std::vector<String> &split_rows,
     }
     else if (m_immutable_cache)
       m_immutable_cache->get_split_rows(split_rows);
+    if (m_frozen_list)
+      m_frozen_list->get_split_rows(split_rows);
   }
 }
 
@@ -288,6 +313,8 @@ void AccessGroup::get_cached_rows(std::vector<String> &rows) {
   }
   else if (m_immutable_cache)
     m_immutable_cache->get_rows(rows);
+  if (m_frozen_list)
+    m_frozen_list->get_rows(rows);
 }
 
 
@@ -298,6 +325,7 @@ uint64_t AccessGroup::disk_usage() {
   uint64_t mu = m_cell_cache ? m_cell_cache->memory_used() : 0;
   if (m_immutable_cache)
     mu += m_immutable_cache->memory_used();
+  mu += frozen_data_size();
   usage = du + (uint64_t)(m_compression_ratio * (float)mu);
   return usage;
 }
@@ -307,6 +335,8 @@ uint64_t AccessGroup::memory_usage() {
   uint64_t mu = m_cell_cache ? m_cell_cache->memory_used() : 0;
   if (m_immutable_cache)
     mu += m_immutable_cache->memory_used();
+  if (m_frozen_list)
+    mu += m_frozen_list->memory_used();
 
   if (mu < 0)
     HT_WARN_OUT << "[Issue 339] Memory usage for " << m_full_name << "=" << mu
@@ -320,7 +350,9 @@ void AccessGroup::space_usage(int64_t *memp, int64_t *diskp) {
   if (m_immutable_cache)
     *memp += m_immutable_cache->memory_used();
   *diskp = (m_in_memory) ? 0 : m_disk_usage;
-  *diskp += (int64_t)(m_compression_ratio * (float)*memp);
+  *diskp += (int64_t)(m_compression_ratio * (float)(*memp + frozen_data_size()));
+  if (m_frozen_list)
+    *memp += m_frozen_list->memory_used();
 }
 
 
@@ -390,6 +422,20 @@ AccessGroup::MaintenanceData *AccessGroup::get_maintenance_data(ByteArena &arena
   mdata->compression_ratio = (m_compression_ratio == 0.0) ? 1.0 : m_compression_ratio;
   mdata->cell_count = mdata->cached_items + mdata->immutable_items;
 
+  /**
+   * The frozen list of an IN_MEMORY access group is not counted in
+   * mem_used, so that in-memory compactions are triggered by the
+   * size of the updates since the last one
+   */
+  if (m_frozen_list) {
+    m_frozen_list->get_counts(&cell_count, &key_bytes, &value_bytes);
+    mu += key_bytes + value_bytes;
+    mdata->cell_count += cell_count;
+    mdata->key_bytes += key_bytes;
+    mdata->value_bytes += value_bytes;
+    mdata->mem_allocated += m_frozen_list->memory_used();
+  }
+
   mdata->disk_used = m_disk_usage;
   int64_t du = m_in_memory ? 0 : m_disk_usage;
   mdata->disk_estimate = du + (int64_t)(m_compression_ratio * (float)mu);
@@ -464,11 +510,12 @@ void AccessGroup::add_cell_store(CellStorePtr &cellstore) {
     CellListScannerPtr scanner = cellstore->create_scanner(scan_context);
     ByteString key, value;
     Key key_comps;
-    m_cell_cache = new CellCache();
+    m_frozen_list = new FrozenCellList();
     while (scanner->get(key_comps, value)) {
-      m_cell_cache->add(key_comps, value);
+      m_frozen_list->add(key_comps, value);
       scanner->forward();
     }
+    m_frozen_list->finalize();
   }
 
   m_stores.push_back( cellstore );
@@ -519,7 +566,8 @@ void AccessGroup::run_compaction(int maintenance_flags) {
   MergeScanner *mscanner = 0;
   size_t tableidx = 1;
   CellStorePtr cellstore;
-  CellCachePtr filtered_cache, shadow_cache;
+  CellCachePtr shadow_cache;
+  FrozenCellListPtr frozen_list;
   String metadata_key_str;
   bool abort_loop = true;
   bool minor = false;
@@ -615,7 +663,11 @@ void AccessGroup::run_compaction(int maintenance_flags) {
         mscanner = new MergeScanner(scan_context, false, true);
         scanner = mscanner;
         mscanner->add_scanner(m_immutable_cache->create_scanner(scan_context));
-        filtered_cache = new CellCache();
+        if (m_frozen_list) {
+          mscanner->add_scanner(m_frozen_list->create_scanner(scan_context));
+          max_num_entries += m_frozen_list->size();
+        }
+        frozen_list = new FrozenCellList();
       }
       else if (MaintenanceFlag::major_compaction(maintenance_flags) ||
 	       tableidx < m_stores.size()) {
@@ -643,10 +695,13 @@ void AccessGroup::run_compaction(int maintenance_flags) {
     while (scanner->get(key, value)) {
       cellstore->add(key, value);
       if (m_in_memory)
-        filtered_cache->add(key, value);
+        frozen_list->add(key, value);
       scanner->forward();
     }
 
+    if (m_in_memory)
+      frozen_list->finalize();
+
     CellStoreTrailerV5 *trailer = dynamic_cast<CellStoreTrailerV5 *>(cellstore->get_trailer());
 
     if (tableidx == 0 && mscanner)
@@ -687,8 +742,9 @@ void AccessGroup::run_compaction(int maintenance_flags) {
         HT_ERROR("Revision (clock) skew detected! May result in data loss.");
 
       if (m_in_memory) {
-        m_immutable_cache = filtered_cache;
-        merge_caches();
+        // the cell cache keeps only the updates that arrived meanwhile
+        m_frozen_list = frozen_list;
+        m_immutable_cache = 0;
         for (size_t i=0; i<m_stores.size(); i++)
           removed_files.push_back(m_stores[i].cs->get_filename());
         m_stores.clear();
@@ -756,6 +812,8 @@ void AccessGroup::shrink(String &split_row, bool drop_high) {
   ScopedLock lock(m_mutex);
   CellCachePtr old_cell_cache = m_cell_cache;
   CellCachePtr new_cell_cache;
+  FrozenCellListPtr old_frozen_list = m_frozen_list;
+  FrozenCellListPtr new_frozen_list;
   ScanContextPtr scan_context = new ScanContext(m_schema);
   CellListScannerPtr cell_cache_scanner;
   ByteString key;
@@ -825,6 +883,22 @@ void AccessGroup::shrink(String &split_row, bool drop_high) {
 
     new_cell_cache->unlock();
 
+    /**
+     * Shrink the frozen list of an IN_MEMORY access group
+     */
+    if (old_frozen_list) {
+      new_frozen_list = new FrozenCellList();
+      cell_cache_scanner = old_frozen_list->create_scanner(scan_context);
+      while (cell_cache_scanner->get(key_comps, value)) {
+        cmp = strcmp(key_comps.row, split_row.c_str());
+        if ((cmp > 0 && !drop_high) || (cmp <= 0 && drop_high))
+          new_frozen_list->add(key_comps, value);
+        cell_cache_scanner->forward();
+      }
+      new_frozen_list->finalize();
+      m_frozen_list = new_frozen_list;
+    }
+
     /**
      * Shrink the CellStores
      */
@@ -843,6 +917,7 @@ void AccessGroup::shrink(String &split_row, bool drop_high) {
   catch (Exception &e) {
     m_recovering = false;
     m_cell_cache = old_cell_cache;
+    m_frozen_list = old_frozen_list;
     m_earliest_cached_revision = m_earliest_cached_revision_saved;
     m_earliest_cached_revision_saved = TIMESTAMP_MAX;
     throw;
@@ -994,15 +1069,42 @@ void AccessGroup::recompute_compression_ratio() {
     m_compression_ratio = 1.0;
 }
 
+namespace {
+  void dump_key(std::ofstream &out, SchemaPtr &schema, const Key &key) {
+    Schema::ColumnFamily *cf;
+    const char *family;
+    if ((cf = schema->get_column_family(key.column_family_code, true)))
+      family = cf->name.c_str();
+    else
+      family = "UNKNOWN";
+    out << key.row << " " << family;
+    if (*key.column_qualifier)
+      out << ":" << key.column_qualifier;
+    out << " 0x" << std::hex << (int)key.flag << std::dec
+	<< " ts=" << key.timestamp
+	<< " rev=" << key.revision << "\n";
+  }
+}
+
 void AccessGroup::dump_keys(std::ofstream &out) {
   ScopedLock lock(m_mutex);
-  Schema::ColumnFamily *cf;
-  const char *family;
   KeySet keys;
 
   // write header line
   out << "\n" << m_full_name << " Keys:\n";
 
+  // keys of the frozen list are decoded on the fly, so dump them first
+  if (m_frozen_list) {
+    ScanContextPtr scan_context = new ScanContext(m_schema);
+    CellListScannerPtr scanner = m_frozen_list->create_scanner(scan_context);
+    ByteString value;
+    Key key;
+    while (scanner->get(key, value)) {
+      dump_key(out, m_schema, key);
+      scanner->forward();
+    }
+  }
+
   if (m_immutable_cache)
     m_immutable_cache->populate_key_set(keys);
 
@@ -1010,18 +1112,8 @@ void AccessGroup::dump_keys(std::ofstream &out) {
     m_cell_cache->populate_key_set(keys);
 
   for (KeySet::iterator iter = keys.begin();
-       iter != keys.end(); ++iter) {
-    if ((cf = m_schema->get_column_family((*iter).column_family_code, true)))
-      family = cf->name.c_str();
-    else
-      family = "UNKNOWN";
-    out << (*iter).row << " " << family;
-    if (*(*iter).column_qualifier)
-      out << ":" << (*iter).column_qualifier;
-    out << " 0x" << std::hex << (int)(*iter).flag << std::dec
-	<< " ts=" << (*iter).timestamp
-	<< " rev=" << (*iter).revision << "\n";
-  }
+       iter != keys.end(); ++iter)
+    dump_key(out, m_schema, *iter);
 }
 
 
@@ -44,6 +44,7 @@
 #include "CellCache.h"
 #include "CellStore.h"
 #include "CellStoreTrailerV5.h"
+#include "FrozenCellList.h"
 #include "LiveFileTracker.h"
 #include "MaintenanceFlag.h"
 
@@ -178,6 +179,8 @@ namespace Hypertable {
       int64_t total = m_cell_cache ? m_cell_cache->get_total_entries() : 0;
       if (m_immutable_cache)
         total += m_immutable_cache->get_total_entries();
+      if (m_frozen_list)
+        total += m_frozen_list->get_total_entries();
       if (!m_in_memory) {
         for (size_t i=0; i<m_stores.size(); i++)
           total += m_stores[i].cs->get_total_entries();
@@ -257,8 +260,19 @@ namespace Hypertable {
   private:
 
     void merge_caches();
+
+    /** Returns the key and value bytes held in the frozen list */
+    int64_t frozen_data_size() {
+      size_t cell_count;
+      int64_t key_bytes, value_bytes;
+      if (!m_frozen_list)
+        return 0;
+      m_frozen_list->get_counts(&cell_count, &key_bytes, &value_bytes);
+      return key_bytes + value_bytes;
+    }
     void range_dir_initialize();
     void recompute_compression_ratio();
+    bool may_contain_rows(CellStorePtr &cs, ScanContextPtr &scan_context);
 
     Mutex                m_mutex;
     Mutex                m_outstanding_scanner_mutex;
@@ -277,6 +291,7 @@ namespace Hypertable {
     PropertiesPtr        m_cellstore_props;
     CellCachePtr         m_cell_cache;
     CellCachePtr         m_immutable_cache;
+    FrozenCellListPtr    m_frozen_list;
     uint32_t             m_next_cs_id;
     uint64_t             m_disk_usage;
     float                m_compression_ratio;
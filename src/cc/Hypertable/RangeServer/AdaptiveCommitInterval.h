@@ -0,0 +1,85 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_ADAPTIVECOMMITINTERVAL_H
+#define HYPERTABLE_ADAPTIVECOMMITINTERVAL_H
+
+extern "C" {
+#include <stddef.h>
+#include <stdint.h>
+}
+
+namespace Hypertable {
+
+  /**
+   * Computes how long a group commit leader should wait for followers
+   * before starting its next commit.  The leader reports the duration of
+   * every commit (log write + sync) and the number of requests it carried.
+   * When commits carry a single request the log is not contended and the
+   * next commit starts right away.  Otherwise the leader waits a fraction
+   * of the (exponentially weighted) average commit latency, bounded by
+   * max_wait_ms, so that slow syncs are amortized over larger batches.
+   */
+  class AdaptiveCommitInterval {
+  public:
+    AdaptiveCommitInterval(uint32_t max_wait_ms)
+      : m_max_wait_us((int64_t)max_wait_ms * 1000), m_average_us(0),
+        m_last_requests(0) { }
+
+    /** Records a completed commit.
+     *
+     * @param requests number of update requests in the commit
+     * @param elapsed_us commit duration in microseconds
+     */
+    void record_commit(size_t requests, int64_t elapsed_us) {
+      if (elapsed_us < 0)
+        elapsed_us = 0;
+      if (m_average_us == 0)
+        m_average_us = elapsed_us;
+      else
+        m_average_us = (m_average_us * (WEIGHT - 1) + elapsed_us) / WEIGHT;
+      m_last_requests = requests;
+    }
+
+    /** Returns the time, in milliseconds, to wait before the next commit */
+    uint32_t wait_ms() const {
+      if (m_last_requests <= 1)
+        return 0;
+      int64_t wait_us = m_average_us / 2;
+      if (wait_us > m_max_wait_us)
+        wait_us = m_max_wait_us;
+      return (uint32_t)(wait_us / 1000);
+    }
+
+    /** Returns the average commit latency in microseconds */
+    int64_t average_us() const { return m_average_us; }
+
+  private:
+    enum { WEIGHT = 8 };
+
+    int64_t m_max_wait_us;
+    int64_t m_average_us;
+    size_t m_last_requests;
+  };
+
+}
+
+#endif // HYPERTABLE_ADAPTIVECOMMITINTERVAL_H
@@ -152,6 +152,57 @@ void CellCacheScanner::forward() {
 }
 
 
+/**
+ * Entries already copied into the entry cache are passed over in place.
+ * Beyond them, the cell map is searched for the key under the cache lock,
+ * instead of walking it one entry at a time.
+ */
+void CellCacheScanner::seek(const SerializedKey key) {
+
+  while (m_entry_cache_next < m_entry_cache.size()) {
+    if (!(m_entry_cache[m_entry_cache_next].key.serial < key))
+      return;
+    m_entry_cache_next++;
+  }
+
+  if (m_eos)
+    return;
+
+  // deletes gathered for the start of the scan are few; walk them
+  if (m_in_deletes) {
+    CellListScanner::seek(key);
+    return;
+  }
+
+  {
+    ScopedLock lock(m_cell_cache_mutex);
+
+    if (!(m_cur_entry.key.serial < key))
+      return;
+
+    m_cur_iter = m_cell_cache_ptr->m_cell_map.lower_bound(key);
+    if (m_end_iter != m_cell_cache_ptr->m_cell_map.end() &&
+        (m_cur_iter == m_cell_cache_ptr->m_cell_map.end() ||
+         !((*m_cur_iter).first < (*m_end_iter).first)))
+      m_cur_iter = m_end_iter;
+
+    m_entry_cache_next = 0;
+    m_entry_cache.clear();
+
+    while (m_cur_iter != m_end_iter) {
+      m_cur_entry.key.load( (*m_cur_iter).first );
+      if (m_cur_entry.key.flag == FLAG_DELETE_ROW
+          || m_scan_context_ptr->family_mask[m_cur_entry.key.column_family_code]) {
+        m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
+        return;
+      }
+      ++m_cur_iter;
+    }
+    m_eos = true;
+  }
+}
+
+
 bool CellCacheScanner::internal_get() {
 
   if (m_in_deletes) {
@@ -38,6 +38,7 @@ namespace Hypertable {
     virtual ~CellCacheScanner() { return; }
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual void seek(const SerializedKey key);
 
     typedef std::map<const SerializedKey, uint32_t> CellCacheMap;
 
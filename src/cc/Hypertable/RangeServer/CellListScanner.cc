@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+
+#include "Hypertable/Lib/Key.h"
+
+#include "CellListScanner.h"
+
+using namespace Hypertable;
+
+
+void CellListScanner::seek(const SerializedKey key) {
+  Key current;
+  ByteString value;
+
+  while (get(current, value) && current.serial < key)
+    forward();
+}
+
+
+void CellListScanner::skip_to_next_row() {
+  Key key;
+  ByteString value;
+
+  if (get(key, value))
+    seek(next_row_key(key, m_seek_buf));
+}
+
+
+void CellListScanner::skip_to_next_column() {
+  Key key;
+  ByteString value;
+
+  if (get(key, value))
+    seek(next_column_key(key, m_seek_buf));
+}
+
+
+void CellListScanner::skip_to_next_family() {
+  Key key;
+  ByteString value;
+
+  if (get(key, value))
+    seek(next_family_key(key, m_seek_buf));
+}
+
+
+/**
+ * A row, or qualifier, with "\x01" appended sorts after the keys that end
+ * the original string and before any other string that extends it.  With a
+ * DELETE_ROW flag and TIMESTAMP_MAX the result is the smallest key with
+ * that prefix.
+ */
+SerializedKey
+CellListScanner::next_row_key(const Key &key, DynamicBuffer &buf) {
+  String row(key.row, key.row_len);
+
+  row.append(1, 1);
+  buf.clear();
+  create_key_and_append(buf, FLAG_DELETE_ROW, row.c_str(), 0, "",
+                        TIMESTAMP_MAX, 0);
+  return SerializedKey(buf.base);
+}
+
+
+SerializedKey
+CellListScanner::next_column_key(const Key &key, DynamicBuffer &buf) {
+  String qualifier(key.column_qualifier, key.column_qualifier_len);
+
+  qualifier.append(1, 1);
+  buf.clear();
+  create_key_and_append(buf, FLAG_DELETE_ROW, key.row,
+                        key.column_family_code, qualifier.c_str(),
+                        TIMESTAMP_MAX, 0);
+  return SerializedKey(buf.base);
+}
+
+
+SerializedKey
+CellListScanner::next_family_key(const Key &key, DynamicBuffer &buf) {
+  if (key.column_family_code == 0xff)
+    return next_row_key(key, buf);
+  buf.clear();
+  create_key_and_append(buf, FLAG_DELETE_ROW, key.row,
+                        key.column_family_code + 1, "", TIMESTAMP_MAX, 0);
+  return SerializedKey(buf.base);
+}
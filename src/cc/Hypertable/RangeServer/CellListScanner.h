@@ -40,10 +40,52 @@ namespace Hypertable {
     virtual void forward() = 0;
     virtual bool get(Key &key, ByteString &value) = 0;
 
+    /**
+     * Positions the scanner on the first cell whose key is not less than
+     * <code>key</code>, or at the end of the scan if there is no such cell.
+     * Seeking to a key at or before the current one is a no-op.  The
+     * default implementation forwards one cell at a time; scanners that
+     * can reposition more cheaply override it.
+     *
+     * @param key serialized key to seek to
+     */
+    virtual void seek(const SerializedKey key);
+
+    /** Skips the remaining cells of the current row */
+    void skip_to_next_row();
+
+    /** Skips the remaining versions of the current cell */
+    void skip_to_next_column();
+
+    /** Skips the remaining cells of the current column family */
+    void skip_to_next_family();
+
+    /**
+     * Builds the smallest key that sorts after every key of the row of
+     * <code>key</code>.  The key is written to <code>buf</code>, replacing
+     * its contents.
+     */
+    static SerializedKey next_row_key(const Key &key, DynamicBuffer &buf);
+
+    /**
+     * Builds the smallest key that sorts after every version of the cell
+     * (row, column family, qualifier) of <code>key</code>.
+     */
+    static SerializedKey next_column_key(const Key &key, DynamicBuffer &buf);
+
+    /**
+     * Builds the smallest key that sorts after every key of the column
+     * family of <code>key</code> within its row.
+     */
+    static SerializedKey next_family_key(const Key &key, DynamicBuffer &buf);
+
     ScanContext *scan_context() { return m_scan_context_ptr.get(); }
 
   protected:
     ScanContextPtr m_scan_context_ptr;
+
+  private:
+    DynamicBuffer  m_seek_buf;
   };
 
   typedef boost::intrusive_ptr<CellListScanner> CellListScannerPtr;
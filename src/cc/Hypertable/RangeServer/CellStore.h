@@ -130,6 +130,19 @@ namespace Hypertable {
      */
     virtual bool may_contain(ScanContextPtr &) = 0;
 
+    /**
+     * Variation of the above for one row of a multi-row scan, used to
+     * narrow such scans down to the rows each cell store may hold.  The
+     * default implementation always returns true.
+     *
+     * @param row row key
+     * @param scan_ctx scan context (supplies the column families)
+     * @return true if cell store may contain the row
+     */
+    virtual bool may_contain(const char *row, ScanContextPtr &scan_ctx) {
+      return true;
+    }
+
     /**
      * Returns the disk used by this cell store.  If the cell store is opened
      * with a restricted range, then it returns an estimate of the disk used by
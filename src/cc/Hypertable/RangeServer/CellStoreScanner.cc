@@ -193,5 +193,27 @@ void CellStoreScanner<IndexT>::forward() {
   m_interval_scanners[m_interval_index]->forward();
 }
 
+
+/**
+ * Seeks within the current interval and moves on to the following
+ * intervals while the current one is exhausted by the seek.
+ */
+template <typename IndexT>
+void CellStoreScanner<IndexT>::seek(const SerializedKey key) {
+  Key current;
+  ByteString value;
+
+  if (m_eos)
+    return;
+
+  while (true) {
+    m_interval_scanners[m_interval_index]->seek(key);
+    if (m_interval_index + 1 == m_interval_max ||
+        m_interval_scanners[m_interval_index]->get(current, value))
+      break;
+    m_interval_index++;
+  }
+}
+
 template class CellStoreScanner<CellStoreBlockIndexMap<uint32_t> >;
 template class CellStoreScanner<CellStoreBlockIndexMap<int64_t> >;
@@ -41,6 +41,7 @@ namespace Hypertable {
     virtual ~CellStoreScanner();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual void seek(const SerializedKey key);
 
   private:
     CellStorePtr              m_cellstore;
@@ -32,6 +32,18 @@ namespace Hypertable {
     virtual void forward() = 0;
     virtual bool get(Key &key, ByteString &value) = 0;
     virtual ~CellStoreScannerInterval() { }
+
+    /**
+     * Positions the scanner on the first key not less than
+     * <code>key</code>.  This default forwards one key at a time.
+     */
+    virtual void seek(const SerializedKey key) {
+      Key current;
+      ByteString value;
+      while (get(current, value) && current.serial < key)
+        forward();
+    }
+
   protected:
     struct BlockInfo {
       int64_t offset;
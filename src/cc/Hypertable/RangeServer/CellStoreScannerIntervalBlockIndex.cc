@@ -27,19 +27,30 @@
 
 #include "Hypertable/Lib/BlockCompressionHeader.h"
 #include "Global.h"
+#include "CellListScanner.h"
 #include "CellStoreBlockIndexMap.h"
 
 #include "CellStoreScannerIntervalBlockIndex.h"
 
 using namespace Hypertable;
 
+namespace {
+  /**
+   * Number of consecutive keys forward() passes over before it seeks
+   * past the rest of the family (or the rows ahead of a scan and filter
+   * rows scan) instead of decoding every key
+   */
+  const int SEEK_THRESHOLD = 16;
+}
+
 
 template <typename IndexT>
 CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(CellStore *cellstore,
   IndexT *index, SerializedKey start_key, SerializedKey end_key, ScanContextPtr &scan_ctx) :
   m_cellstore(cellstore), m_index(index), m_start_key(start_key),
   m_end_key(end_key), m_fd(-1), m_check_for_range_end(false),
-  m_scan_ctx(scan_ctx), m_rowset(scan_ctx->rowset) {
+  m_scan_ctx(scan_ctx), m_rowset(scan_ctx->rowset), m_next_row(0),
+  m_filter_rows(false) {
 
   memset(&m_block, 0, sizeof(m_block));
   m_file_id = m_cellstore->get_file_id();
@@ -52,6 +63,19 @@ CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(C
   if (m_start_key && (m_iter = m_index->lower_bound(m_start_key)) == m_index->end())
     return;
 
+  if (m_rowset.size() > 1) {
+    // rows that the bloom filter rules out for this cell store are skipped
+    foreach(const char *row, m_rowset) {
+      if (m_cellstore->may_contain(row, m_scan_ctx))
+        m_rows.push_back(row);
+    }
+    m_filter_rows = m_rows.size() < m_rowset.size();
+    skip_to_next_row();
+    if (m_iter == m_index->end())
+      return;
+    prefetch_rowset_blocks();
+  }
+
   if (!fetch_next_block()) {
     m_iter = m_index->end();
     return;
@@ -116,29 +140,44 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::get(Key &key, ByteString &value
 template <typename IndexT>
 void CellStoreScannerIntervalBlockIndex<IndexT>::forward() {
   const uint8_t *ptr;
+  int skipped = 0;
 
   while (true) {
 
     if (m_iter == m_index->end())
       return;
 
-    ptr = m_cur_value.ptr + m_cur_value.length();
-
-    if (ptr >= m_block.end) {
-      if (!fetch_next_block(true)) {
-        m_iter = m_index->end();
-        return;
+    if (skipped == SEEK_THRESHOLD) {
+      skipped = 0;
+      if (!m_rowset.empty() && strcmp(m_key.row, *m_rowset.begin()) < 0) {
+        m_seek_buf.clear();
+        create_key_and_append(m_seek_buf, FLAG_DELETE_ROW, *m_rowset.begin(),
+                              0, "", TIMESTAMP_MAX, 0);
       }
-      if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
-        m_iter = m_index->end();
+      else
+        CellListScanner::next_family_key(m_key, m_seek_buf);
+      if (!reposition(SerializedKey(m_seek_buf.base)))
         return;
-      }
     }
     else {
-      m_cur_value.ptr = m_key_decompressor->add(ptr);
-      if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
-        m_iter = m_index->end();
-        return;
+      ptr = m_cur_value.ptr + m_cur_value.length();
+
+      if (ptr >= m_block.end) {
+        if (!fetch_next_block(true)) {
+          m_iter = m_index->end();
+          return;
+        }
+        if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
+          m_iter = m_index->end();
+          return;
+        }
+      }
+      else {
+        m_cur_value.ptr = m_key_decompressor->add(ptr);
+        if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
+          m_iter = m_index->end();
+          return;
+        }
       }
     }
 
@@ -151,10 +190,179 @@ void CellStoreScannerIntervalBlockIndex<IndexT>::forward() {
       // forward to next row requested by scan and filter rows
       if (m_rowset.empty() || strcmp(m_key.row, *m_rowset.begin()) >= 0)
         break;
+    skipped++;
   }
 }
 
 
+/**
+ * Keys that lie in the current block are reached by decoding forward,
+ * otherwise the block index is searched for the block holding the key and
+ * the blocks in between are never read.
+ */
+template <typename IndexT>
+void CellStoreScannerIntervalBlockIndex<IndexT>::seek(const SerializedKey key) {
+
+  if (m_iter == m_index->end() || !m_key_decompressor->less_than(key))
+    return;
+
+  if (!reposition(key))
+    return;
+
+  m_key_decompressor->load(m_key);
+  if (m_key.flag == FLAG_DELETE_ROW
+      || m_scan_ctx->family_mask[m_key.column_family_code])
+    if (m_rowset.empty() || strcmp(m_key.row, *m_rowset.begin()) >= 0)
+      return;
+  forward();
+}
+
+
+/**
+ * Moves to the first key not less than <code>key</code>, without applying
+ * the column family and row checks.
+ *
+ * @param key serialized key to move to
+ * @return false if the end of the interval was reached
+ */
+template <typename IndexT>
+bool CellStoreScannerIntervalBlockIndex<IndexT>::reposition(const SerializedKey key) {
+  const uint8_t *ptr;
+
+  if (m_iter.key() < key) {
+    IndexIteratorT iter = m_index->lower_bound(key);
+    if (iter == m_index->end()) {
+      m_iter = m_index->end();
+      return false;
+    }
+    Global::block_cache->checkin(m_file_id, m_block.offset);
+    memset(&m_block, 0, sizeof(m_block));
+    m_iter = iter;
+    if (!fetch_next_block()) {
+      m_iter = m_index->end();
+      return false;
+    }
+  }
+
+  while (m_key_decompressor->less_than(key)) {
+    ptr = m_cur_value.ptr + m_cur_value.length();
+    if (ptr >= m_block.end) {
+      if (!fetch_next_block(true)) {
+        m_iter = m_index->end();
+        return false;
+      }
+    }
+    else
+      m_cur_value.ptr = m_key_decompressor->add(ptr);
+  }
+
+  if (m_end_key && !m_key_decompressor->less_than(m_end_key)) {
+    m_iter = m_index->end();
+    return false;
+  }
+  return true;
+}
+
+
+
+/**
+ * For multi-row scans, this method determines the set of blocks that hold
+ * the requested rows and brings the ones that are not already cached into
+ * the block cache with a single vectored read, instead of paying one DFS
+ * round trip per block as the scan advances.  Failures are not fatal; the
+ * blocks are simply re-read on demand by fetch_next_block().
+ */
+template <typename IndexT>
+void CellStoreScannerIntervalBlockIndex<IndexT>::prefetch_rowset_blocks() {
+  std::vector<Filesystem::ReadRegion> regions;
+  std::vector<uint8_t *> buffers;
+  IndexIteratorT iter = m_iter;
+  IndexIteratorT it_next;
+  int64_t last_offset = -1;
+
+  foreach(const char *row, m_rows) {
+    if (strcmp(row, m_end_row) > 0)
+      break;
+    while (iter != m_index->end() && strcmp(row, iter.key().row()) > 0)
+      ++iter;
+    if (iter == m_index->end())
+      break;
+    if ((int64_t)iter.value() == last_offset)
+      continue;
+    last_offset = iter.value();
+    if (Global::block_cache->contains(m_file_id, (uint32_t)iter.value()))
+      continue;
+    it_next = iter;
+    ++it_next;
+    uint32_t zlength = (it_next == m_index->end())
+        ? m_index->end_of_last_block() - iter.value()
+        : it_next.value() - iter.value();
+    buffers.push_back(new uint8_t [zlength]);
+    regions.push_back(Filesystem::ReadRegion(m_fd, iter.value(), zlength,
+                                             buffers.back()));
+  }
+
+  if (regions.size() > 1) {
+    try {
+      Global::dfs->preadv(regions);
+
+      for (size_t i=0; i<regions.size(); i++) {
+        if (regions[i].nread != regions[i].amount)
+          continue;
+        DynamicBuffer zbuf(0, false);
+        DynamicBuffer expand_buf(0);
+        BlockCompressionHeader header;
+        zbuf.base = buffers[i];
+        zbuf.size = regions[i].amount;
+        zbuf.ptr = zbuf.base + regions[i].amount;
+        m_zcodec->inflate(zbuf, expand_buf, header);
+        if (!header.check_magic(CellStore::DATA_BLOCK_MAGIC))
+          continue;
+        size_t fill;
+        uint8_t *block = expand_buf.release(&fill);
+        if (Global::block_cache->insert_and_checkout(m_file_id,
+                (uint32_t)regions[i].offset, block, fill))
+          Global::block_cache->checkin(m_file_id, (uint32_t)regions[i].offset);
+        else
+          delete [] block;
+      }
+    }
+    catch (Exception &e) {
+      HT_WARN_OUT << "Problem prefetching " << regions.size()
+                  << " blocks from cell store " << m_cellstore->get_filename()
+                  << " - " << e << HT_END;
+    }
+  }
+
+  foreach(uint8_t *buf, buffers)
+    delete [] buf;
+}
+
+
+/**
+ * Positions m_iter at the first block that may hold the next row requested
+ * by a scan and filter rows scan.  Rows ahead of the scan's current row
+ * that the bloom filter rules out for this cell store are passed over, and
+ * the scan of this store ends once none are left.
+ */
+template <typename IndexT>
+void CellStoreScannerIntervalBlockIndex<IndexT>::skip_to_next_row() {
+  const char *row = *m_rowset.begin();
+
+  if (m_filter_rows) {
+    while (m_next_row < m_rows.size() && strcmp(m_rows[m_next_row], row) < 0)
+      ++m_next_row;
+    if (m_next_row == m_rows.size()) {
+      m_iter = m_index->end();
+      return;
+    }
+    row = m_rows[m_next_row];
+  }
+
+  while (m_iter != m_index->end() && strcmp(row, m_iter.key().row()) > 0)
+    ++m_iter;
+}
+
 
 /**
  * This method fetches the 'next' compressed block of key/value pairs from the
@@ -178,10 +386,8 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
     ++m_iter;
 
     // find next block requested by scan and filter rows
-    if (m_rowset.size()) {
-      while (m_iter != m_index->end() && strcmp(*m_rowset.begin(), m_iter.key().row()) > 0)
-        ++m_iter;
-    }
+    if (m_rowset.size())
+      skip_to_next_row();
   }
 
   if (m_block.base == 0 && m_iter != m_index->end()) {
@@ -211,15 +417,27 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
       bool second_try = false;
     try_again:
       try {
-        DynamicBuffer buf(m_block.zlength);
+        DynamicBuffer buf(0, false);
+        DfsBroker::MappedFilePtr mapping;
 
         if (second_try)
           m_fd = m_cellstore->reopen_fd();
 
-        /** Read compressed block **/
-        Global::dfs->pread(m_fd, buf.ptr, m_block.zlength, m_block.offset);
+        if (Global::local_direct)
+          mapping = Global::local_direct->get_mapping(m_fd);
 
-        buf.ptr += m_block.zlength;
+        /** Read compressed block (in place, if the file is mapped) **/
+        if (mapping &&
+            (uint64_t)(m_block.offset + m_block.zlength) <= mapping->length()) {
+          buf.base = (uint8_t *)mapping->base() + m_block.offset;
+          buf.size = m_block.zlength;
+        }
+        else {
+          buf.own = true;
+          buf.reserve(m_block.zlength);
+          Global::dfs->pread(m_fd, buf.ptr, m_block.zlength, m_block.offset);
+        }
+        buf.ptr = buf.base + m_block.zlength;
         /** inflate compressed block **/
         BlockCompressionHeader header;
 
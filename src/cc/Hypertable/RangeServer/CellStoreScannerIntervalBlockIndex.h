@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_CELLSTORESCANNERINTERVALBLOCKINDEX_H
 #define HYPERTABLE_CELLSTORESCANNERINTERVALBLOCKINDEX_H
 
+#include <vector>
+
 #include "Common/DynamicBuffer.h"
 
 #include "CellStore.h"
@@ -44,10 +46,14 @@ namespace Hypertable {
     virtual ~CellStoreScannerIntervalBlockIndex();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual void seek(const SerializedKey key);
 
   private:
 
     bool fetch_next_block(bool eob=false);
+    bool reposition(const SerializedKey key);
+    void prefetch_rowset_blocks();
+    void skip_to_next_row();
 
     CellStorePtr          m_cellstore;
     IndexT               *m_index;
@@ -60,6 +66,7 @@ namespace Hypertable {
     SerializedKey         m_end_key;
     const char *          m_end_row;
     DynamicBuffer         m_key_buf;
+    DynamicBuffer         m_seek_buf;
     BlockCompressionCodec *m_zcodec;
     KeyDecompressor      *m_key_decompressor;
     int32_t               m_fd;
@@ -67,6 +74,9 @@ namespace Hypertable {
     int                   m_file_id;
     ScanContextPtr        m_scan_ctx;
     ScanContext::CstrRowSet& m_rowset;
+    std::vector<const char *> m_rows;
+    size_t                m_next_row;
+    bool                  m_filter_rows;
   };
 
 }
@@ -209,6 +209,8 @@ void CellStoreTrailerV5::display(std::ostream &os) {
     os << ", bloom_filter_mode=ROWS";
   else if (bloom_filter_mode == BLOOM_FILTER_ROWS_COLS)
     os << ", bloom_filter_mode=ROWS_COLS";
+  else if (bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX)
+    os << ", bloom_filter_mode=ROWS_PREFIX";
   else
     os << ", bloom_filter_mode=?(" << bloom_filter_mode << ")";
   os << ", bloom_filter_hash_count=" << bloom_filter_hash_count;
@@ -256,6 +258,8 @@ void CellStoreTrailerV5::display_multiline(std::ostream &os) {
     os << "  bloom_filter_mode=ROWS\n";
   else if (bloom_filter_mode == BLOOM_FILTER_ROWS_COLS)
     os << "  bloom_filter_mode=ROWS_COLS\n";
+  else if (bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX)
+    os << "  bloom_filter_mode=ROWS_PREFIX\n";
   else
     os << "  bloom_filter_mode=?(" << bloom_filter_mode << ")\n";
   os << "  bloom_filter_hash_count=" << (int)bloom_filter_hash_count << "\n";
@@ -89,6 +89,10 @@ BlockCompressionCodec *CellStoreV1::create_block_compression_codec() {
 
 
 const char *CellStoreV1::get_split_row() {
+  if (m_split_row != "")
+    return m_split_row.c_str();
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
   if (m_split_row != "")
     return m_split_row.c_str();
   return 0;
@@ -595,6 +599,13 @@ CellStoreV1::open(const String &fname, const String &start_row,
 
   m_trailer = *static_cast<CellStoreTrailerV1 *>(trailer);
 
+  // The block index is loaded on demand, so until then estimate the disk
+  // usage of a restricted range at 1/2 of the file
+  if (m_restricted_range)
+    m_disk_usage = m_file_length / 2;
+  else
+    m_disk_usage = m_file_length;
+
   /** Sanity check trailer **/
   HT_ASSERT(m_trailer.version == 1);
 
@@ -608,9 +619,6 @@ CellStoreV1::open(const String &fname, const String &start_row,
               "length=%llu, file='%s'", (Lld)m_trailer.fix_index_offset,
            (Lld)m_trailer.var_index_offset, (Llu)m_file_length, fname.c_str());
 
-  if (!(start_row == "" && end_row == Key::END_ROW_MARKER))
-    load_block_index();
-
 }
 
 
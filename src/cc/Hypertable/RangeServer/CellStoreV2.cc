@@ -90,6 +90,10 @@ BlockCompressionCodec *CellStoreV2::create_block_compression_codec() {
 
 
 const char *CellStoreV2::get_split_row() {
+  if (m_split_row != "")
+    return m_split_row.c_str();
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
   if (m_split_row != "")
     return m_split_row.c_str();
   return 0;
@@ -98,6 +98,10 @@ KeyDecompressor *CellStoreV3::create_key_decompressor() {
 
 
 const char *CellStoreV3::get_split_row() {
+  if (m_split_row != "")
+    return m_split_row.c_str();
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
   if (m_split_row != "")
     return m_split_row.c_str();
   return 0;
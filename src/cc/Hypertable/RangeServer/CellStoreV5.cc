@@ -198,6 +198,9 @@ CellStoreV5::create(const char *fname, size_t max_entries,
   m_bloom_filter_mode = props->get<BloomFilterMode>("bloom-filter-mode");
   m_max_approx_items = props->get_i32("max-approx-items");
 
+  if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX)
+    m_prefix_extractor = RowPrefixExtractor(props);
+
   if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED) {
     bool has_num_hashes = props->has("num-hashes");
     bool has_bits_per_item = props->has("bits-per-item");
@@ -341,6 +344,21 @@ void CellStoreV5::load_bloom_filter() {
                 m_filename.c_str(), (Lld)m_bloom_filter->total_size(), (Lld)len);
 
     m_bloom_filter->validate(m_filename);
+
+    if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX &&
+        m_prefix_extractor.empty()) {
+      StaticBuffer buf(HT_DIRECT_IO_ALIGNMENT);
+      int64_t offset = m_trailer.filter_offset + m_bloom_filter->total_size();
+      len = m_filesys->pread(m_fd, buf.base, HT_DIRECT_IO_ALIGNMENT, offset);
+      if (len != HT_DIRECT_IO_ALIGNMENT)
+        HT_THROWF(Error::DFSBROKER_IO_ERROR, "Problem loading bloomfilter "
+                  "prefix extractor for CellStore '%s' : tried to read %d but "
+                  "only got %lld", m_filename.c_str(), HT_DIRECT_IO_ALIGNMENT,
+                  (Lld)len);
+      const uint8_t *ptr = buf.base;
+      size_t remaining = RowPrefixExtractor::ENCODED_LENGTH;
+      m_prefix_extractor.decode(&ptr, &remaining);
+    }
   }
 
   m_index_stats.bloom_filter_memory = m_bloom_filter->total_size();
@@ -458,7 +476,23 @@ void CellStoreV5::add(const Key &key, const ByteString value) {
 
   m_buffer.add_unchecked(value.ptr, value_len);
 
-  if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED) {
+  if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX) {
+    int prefix_len = m_prefix_extractor.extract(key.row, key.row_len);
+    if (prefix_len >= 0) {
+      if (m_bloom_filter_items)
+        m_bloom_filter_items->insert(key.row, prefix_len);
+      else
+        m_bloom_filter->insert(key.row, prefix_len);
+    }
+    if (m_trailer.total_entries == m_max_approx_items - 1 &&
+        m_bloom_filter_items) {
+      m_trailer.filter_items_estimate = (size_t)(((double)m_max_entries
+          / (double)m_max_approx_items) * m_bloom_filter_items->size());
+      if (m_trailer.filter_items_estimate)
+        create_bloom_filter(true);
+    }
+  }
+  else if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED) {
     if (m_trailer.total_entries < m_max_approx_items) {
       m_bloom_filter_items->insert(key.row, key.row_len);
 
@@ -606,6 +640,19 @@ void CellStoreV5::finalize(TableIdentifier *table_identifier) {
       m_filesys->append(m_fd, send_buf, 0, &m_sync_handler);
       m_outstanding_appends++;
       m_offset += m_bloom_filter->total_size();
+
+      // the prefix extractor follows the filter in a block of its own
+      if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX) {
+        zbuf.clear();
+        zbuf.reserve(HT_DIRECT_IO_ALIGNMENT);
+        memset(zbuf.base, 0, HT_DIRECT_IO_ALIGNMENT);
+        m_prefix_extractor.encode(&zbuf.ptr);
+        zbuf.ptr = zbuf.base + HT_DIRECT_IO_ALIGNMENT;
+        send_buf = zbuf;
+        m_filesys->append(m_fd, send_buf, 0, &m_sync_handler);
+        m_outstanding_appends++;
+        m_offset += HT_DIRECT_IO_ALIGNMENT;
+      }
     }
   }
 
@@ -923,6 +970,24 @@ void CellStoreV5::load_block_index() {
 
 bool CellStoreV5::may_contain(ScanContextPtr &scan_context) {
 
+  // a prefix filter can also answer for a range of rows sharing a prefix
+  if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_PREFIX &&
+      !scan_context->single_row && m_trailer.filter_length != 0) {
+    if (m_bloom_filter == 0)
+      load_bloom_filter();
+    int prefix_len = m_prefix_extractor.extract(scan_context->start_row.c_str(),
+        scan_context->end_row.c_str(), scan_context->end_inclusive);
+    if (prefix_len < 0)
+      return true;
+    return may_contain(scan_context->start_row.c_str(), (size_t)prefix_len);
+  }
+
+  return may_contain(scan_context->start_row.c_str(), scan_context);
+}
+
+
+bool CellStoreV5::may_contain(const char *row, ScanContextPtr &scan_context) {
+
   if (m_bloom_filter_mode == BLOOM_FILTER_DISABLED)
     return true;
   else if (m_trailer.filter_length == 0) // bloom filter is empty
@@ -932,15 +997,24 @@ bool CellStoreV5::may_contain(ScanContextPtr &scan_context) {
 
   m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
 
+  size_t rowlen = strlen(row);
+
   switch (m_bloom_filter_mode) {
     case BLOOM_FILTER_ROWS:
-      return may_contain(scan_context->start_row);
+      return may_contain(row, rowlen);
+    case BLOOM_FILTER_ROWS_PREFIX: {
+        // rows without a prefix are not in the filter
+        int prefix_len = m_prefix_extractor.extract(row, rowlen);
+        return prefix_len < 0 || may_contain(row, (size_t)prefix_len);
+      }
     case BLOOM_FILTER_ROWS_COLS:
-      if (may_contain(scan_context->start_row)) {
+      if (may_contain(row, rowlen)) {
+        // every row is in the filter on its own as well
+        if (scan_context->spec->columns.empty())
+          return true;
         SchemaPtr &schema = scan_context->schema;
-        size_t rowlen = scan_context->start_row.length();
         boost::scoped_array<char> rowcol(new char[rowlen + 2]);
-        memcpy(rowcol.get(), scan_context->start_row.c_str(), rowlen + 1);
+        memcpy(rowcol.get(), row, rowlen + 1);
 
         foreach(const char *col, scan_context->spec->columns) {
           uint8_t column_family_id = schema->get_column_family(col)->id;
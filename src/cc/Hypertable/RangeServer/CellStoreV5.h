@@ -46,6 +46,7 @@
 #include "CellStore.h"
 #include "CellStoreTrailerV5.h"
 #include "KeyCompressor.h"
+#include "RowPrefixExtractor.h"
 
 
 /**
@@ -92,6 +93,7 @@ namespace Hypertable {
       return may_contain(key.data(), key.size());
     }
     virtual bool may_contain(ScanContextPtr &);
+    virtual bool may_contain(const char *row, ScanContextPtr &);
     virtual uint64_t disk_usage() {
       if (m_disk_usage < 0)
         HT_WARN_OUT << "[Issue 339] Disk usage for " << m_filename << "=" << m_disk_usage
@@ -168,6 +170,7 @@ namespace Hypertable {
     BloomFilterMode        m_bloom_filter_mode;
     BloomFilterWithChecksum *m_bloom_filter;
     BloomFilterItems      *m_bloom_filter_items;
+    RowPrefixExtractor     m_prefix_extractor;
     int64_t                m_max_approx_items;
     float                  m_bloom_bits_per_item;
     float                  m_filter_false_positive_prob;
@@ -39,6 +39,7 @@ extern "C" {
 #include "RequestHandlerCompact.h"
 #include "RequestHandlerDestroyScanner.h"
 #include "RequestHandlerDump.h"
+#include "RequestHandlerDumpTraces.h"
 #include "RequestHandlerGetStatistics.h"
 #include "RequestHandlerLoadRange.h"
 #include "RequestHandlerUpdateSchema.h"
@@ -187,6 +188,9 @@ void ConnectionHandler::handle(EventPtr &event) {
       case RangeServerProtocol::COMMAND_COMMIT_LOG_SYNC:
         handler = new RequestHandlerCommitLogSync(m_comm, m_range_server_ptr.get(), event);
         break;
+      case RangeServerProtocol::COMMAND_DUMP_TRACES:
+        handler = new RequestHandlerDumpTraces(m_comm, event);
+        break;
       default:
         HT_THROWF(PROTOCOL_ERROR, "Unimplemented command (%llu)",
                   (Llu)event->header.command);
@@ -20,6 +20,10 @@
  */
 
 #include "Common/Compat.h"
+
+#include "Hypertable/Lib/RangeServerProtocol.h"
+#include "Hypertable/Lib/ScanBlockEncoder.h"
+
 #include "FillScanBlock.h"
 
 namespace Hypertable {
@@ -38,6 +42,11 @@ namespace Hypertable {
     char numbuf[17];
     DynamicBuffer counter_value;
     bool counter;
+    bool compact = scan_context->result_flags != 0;
+    ScanBlockEncoder encoder((scan_context->result_flags &
+                              RangeServerProtocol::CREATE_SCANNER_FLAG_COMPRESS)
+                             != 0);
+    DynamicBuffer last_key_buf;
 
     assert(dbuf.base == 0);
 
@@ -82,6 +91,24 @@ namespace Hypertable {
       else
         value_len = value.length();
 
+      // The compact encoding is limited by the size the cells would take
+      // in a plain block, so both return the same cells
+      if (compact) {
+        if (encoder.count() > 0 && key.length + value_len > remaining)
+          break;
+        encoder.add(key.serial, counter ? counter_value.base : value.ptr,
+                    value_len);
+        remaining -= std::min(remaining, (size_t)(key.length + value_len));
+
+        last_key_buf.set(key.serial.ptr, key.length);
+        last_key.row = (const char *)last_key_buf.base +
+          (key.row - (const char *)key.serial.ptr);
+        last_key.column_qualifier = (const char *)last_key_buf.base +
+          (key.column_qualifier - (const char *)key.serial.ptr);
+        scanner->forward();
+        continue;
+      }
+
       if (dbuf.base == 0) {
         if (key.length + value_len > limit) {
           limit = key.length + value_len;
@@ -111,6 +138,11 @@ namespace Hypertable {
         break;
     }
 
+    if (compact) {
+      encoder.finish(dbuf);
+      return more;
+    }
+
     if (dbuf.base == 0) {
       dbuf.reserve(4);
       dbuf.ptr = dbuf.base + 4;
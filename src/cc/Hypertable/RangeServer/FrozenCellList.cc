@@ -0,0 +1,161 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Hypertable/Lib/Key.h"
+
+#include "FrozenCellList.h"
+#include "FrozenCellListScanner.h"
+#include "Global.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+
+namespace {
+  // room in front of a decoded key for its vi32 length
+  const size_t KEY_HEADER = 5;
+}
+
+
+FrozenCellList::FrozenCellList()
+  : m_entries(0), m_key_bytes(0), m_value_bytes(0), m_finalized(false) {
+}
+
+
+FrozenCellList::~FrozenCellList() {
+  if (m_finalized)
+    Global::memory_tracker->subtract(memory_used());
+}
+
+
+void FrozenCellList::add(const Key &key, const ByteString value) {
+  const uint8_t *body;
+  size_t body_len = key.serial.decode_length(&body);
+  size_t value_len = value.length();
+  size_t shared = 0;
+
+  HT_ASSERT(!m_finalized);
+
+  if (m_entries % RESTART_INTERVAL == 0)
+    m_restarts.push_back(m_data.fill());
+  else {
+    size_t max_shared = std::min(body_len, m_last_key.fill());
+    while (shared < max_shared && body[shared] == m_last_key.base[shared])
+      ++shared;
+  }
+
+  m_data.ensure(10 + (body_len - shared) + value_len);
+  encode_vi32(&m_data.ptr, shared);
+  encode_vi32(&m_data.ptr, body_len - shared);
+  m_data.add_unchecked(body + shared, body_len - shared);
+  m_data.ptr += value.write(m_data.ptr);
+
+  m_last_key.set(body, body_len);
+
+  m_entries++;
+  m_key_bytes += key.length;
+  m_value_bytes += value_len;
+}
+
+
+void FrozenCellList::finalize() {
+  HT_ASSERT(!m_finalized);
+  if (m_data.size > m_data.fill())
+    m_data.grow(m_data.fill());
+  std::vector<uint32_t>(m_restarts).swap(m_restarts);
+  m_last_key.free();
+  m_finalized = true;
+  Global::memory_tracker->add(memory_used());
+}
+
+
+SerializedKey
+FrozenCellList::decode_entry(const uint8_t **bufp, DynamicBuffer &key_buf,
+                             ByteString &value) {
+  uint32_t shared = decode_vi32(bufp);
+  uint32_t unshared = decode_vi32(bufp);
+
+  if (key_buf.size < KEY_HEADER)
+    key_buf.grow(256);
+
+  key_buf.ptr = key_buf.base + KEY_HEADER + shared;
+  key_buf.ensure(unshared);
+  key_buf.add_unchecked(*bufp, unshared);
+  *bufp += unshared;
+
+  value.ptr = *bufp;
+  *bufp += value.length();
+
+  // write the key length right in front of the key
+  uint32_t key_len = shared + unshared;
+  uint8_t *key_ptr = key_buf.base + KEY_HEADER - encoded_length_vi32(key_len);
+  uint8_t *ptr = key_ptr;
+  encode_vi32(&ptr, key_len);
+
+  return SerializedKey(key_ptr);
+}
+
+
+const char *FrozenCellList::get_split_row() {
+  HT_ASSERT(!"FrozenCellList::get_split_row not implemented!");
+  return 0;
+}
+
+
+void FrozenCellList::get_split_rows(std::vector<String> &split_rows) {
+  if (m_entries > 2) {
+    // restart points hold the full key, starting with the control byte
+    const uint8_t *ptr = m_data.base + m_restarts[m_restarts.size() / 2];
+    decode_vi32(&ptr);
+    decode_vi32(&ptr);
+    split_rows.push_back((const char *)ptr + 1);
+  }
+}
+
+
+void FrozenCellList::get_rows(std::vector<String> &rows) {
+  const uint8_t *ptr = m_data.base;
+  const uint8_t *end = m_data.base + m_data.fill();
+  DynamicBuffer key_buf;
+  ByteString value;
+  String last_row;
+  const char *row;
+
+  while (ptr < end) {
+    row = decode_entry(&ptr, key_buf, value).row();
+    if (last_row != row) {
+      rows.push_back(row);
+      last_row = row;
+    }
+  }
+}
+
+
+CellListScanner *FrozenCellList::create_scanner(ScanContextPtr &scan_ctx) {
+  FrozenCellListPtr cell_list(this);
+  return new FrozenCellListScanner(cell_list, scan_ctx);
+}
@@ -0,0 +1,130 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_FROZENCELLLIST_H
+#define HYPERTABLE_FROZENCELLLIST_H
+
+#include <vector>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/String.h"
+
+#include "Hypertable/Lib/SerializedKey.h"
+
+#include "CellList.h"
+
+namespace Hypertable {
+
+  /**
+   * Immutable, sorted list of key/value pairs held in one contiguous
+   * buffer.  Used to hold the compacted contents of IN_MEMORY access
+   * groups, with a CellCache on top holding the updates since the last
+   * in-memory compaction.
+   *
+   * Each entry is stored as (vi32 shared, vi32 unshared, unshared key
+   * bytes, value) where <i>shared</i> is the number of leading bytes the
+   * key has in common with the previous key.  Every RESTART_INTERVAL
+   * entries the key is stored in full and its offset is recorded in a
+   * sparse index, which is binary searched to position scanners.
+   *
+   * The list is built by calling #add with keys in ascending order
+   * followed by #finalize; it must not be scanned before it is finalized.
+   */
+  class FrozenCellList : public CellList {
+
+  public:
+    enum { RESTART_INTERVAL = 16 };
+
+    FrozenCellList();
+    virtual ~FrozenCellList();
+
+    /**
+     * Appends a key/value pair.  Keys must be added in ascending order.
+     *
+     * @param key key to be added
+     * @param value value to be added
+     */
+    virtual void add(const Key &key, const ByteString value);
+
+    /**
+     * Trims the buffer and index to their final size.  No more entries
+     * may be added afterwards.
+     */
+    void finalize();
+
+    virtual const char *get_split_row();
+
+    virtual void get_split_rows(std::vector<String> &split_rows);
+
+    virtual void get_rows(std::vector<String> &rows);
+
+    virtual int64_t get_total_entries() { return m_entries; }
+
+    virtual CellListScanner *create_scanner(ScanContextPtr &scan_ctx);
+
+    size_t size() { return m_entries; }
+
+    bool empty() { return m_entries == 0; }
+
+    /** Returns the number of bytes held by the buffer and index */
+    int64_t memory_used() {
+      return m_data.size + m_restarts.capacity() * sizeof(uint32_t);
+    }
+
+    void get_counts(size_t *cellsp, int64_t *key_bytesp,
+                    int64_t *value_bytesp) {
+      *cellsp = m_entries;
+      *key_bytesp = m_key_bytes;
+      *value_bytesp = m_value_bytes;
+    }
+
+    /**
+     * Decodes the entry at <code>*bufp</code>.  <code>key_buf</code> must
+     * hold the previous key, as left by the previous call, unless the entry
+     * is a restart point.  The returned key points into
+     * <code>key_buf</code> and stays valid until the next call.
+     *
+     * @param bufp address of pointer to entry, advanced past the entry
+     * @param key_buf buffer holding the decoded key
+     * @param value set to the value of the entry
+     * @return serialized key of the entry
+     */
+    static SerializedKey decode_entry(const uint8_t **bufp,
+                                      DynamicBuffer &key_buf,
+                                      ByteString &value);
+
+    friend class FrozenCellListScanner;
+
+  private:
+    DynamicBuffer         m_data;
+    std::vector<uint32_t> m_restarts;
+    DynamicBuffer         m_last_key;
+    size_t                m_entries;
+    int64_t               m_key_bytes;
+    int64_t               m_value_bytes;
+    bool                  m_finalized;
+  };
+
+  typedef intrusive_ptr<FrozenCellList> FrozenCellListPtr;
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_FROZENCELLLIST_H
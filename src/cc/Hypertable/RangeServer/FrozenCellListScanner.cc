@@ -0,0 +1,192 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <cstring>
+
+#include "Hypertable/Lib/Key.h"
+
+#include "FrozenCellListScanner.h"
+
+using namespace Hypertable;
+
+
+FrozenCellListScanner::FrozenCellListScanner(FrozenCellListPtr &cell_list,
+                                             ScanContextPtr &scan_ctx)
+  : CellListScanner(scan_ctx), m_cell_list(cell_list), m_next(0), m_end(0),
+    m_delete_next(0), m_eos(false), m_keys_only(false) {
+
+  m_keys_only = (scan_ctx->spec) ? scan_ctx->spec->keys_only : false;
+  m_end = m_cell_list->m_data.base + m_cell_list->m_data.fill();
+
+  /**
+   * As in CellCacheScanner, a scan that starts in the middle of a row
+   * has to pick up the DELETE_ROW (and DELETE_COLUMN_FAMILY) records that
+   * sort in front of its start key.  They are copied out and returned
+   * ahead of the scan.
+   */
+  if (scan_ctx->has_cell_interval) {
+    DynamicBuffer buf(scan_ctx->start_key.row_len + 32);
+
+    create_key_and_append(buf, FLAG_DELETE_ROW, scan_ctx->start_key.row, 0,
+                          "", TIMESTAMP_MAX, 0);
+    collect_deletes(SerializedKey(buf.base), FLAG_DELETE_ROW);
+
+    if (scan_ctx->has_start_cf_qualifier) {
+      buf.clear();
+      create_key_and_append(buf, FLAG_DELETE_COLUMN_FAMILY,
+                            scan_ctx->start_key.row,
+                            scan_ctx->start_key.column_family_code,
+                            "", TIMESTAMP_MAX, 0);
+      collect_deletes(SerializedKey(buf.base), FLAG_DELETE_COLUMN_FAMILY);
+    }
+  }
+
+  locate(scan_ctx->start_serkey);
+  skip_to_match();
+}
+
+
+bool FrozenCellListScanner::get(Key &key, ByteString &value) {
+
+  if (m_delete_next < m_delete_offsets.size()) {
+    key.load(SerializedKey(m_deletes.base + m_delete_offsets[m_delete_next]));
+    value.ptr = key.serial.ptr + key.length;
+    return true;
+  }
+
+  if (m_eos)
+    return false;
+
+  memcpy(&key, &m_key, sizeof(key));
+  if (m_keys_only)
+    value = (ByteString)0;
+  else
+    value = m_value;
+  return true;
+}
+
+
+void FrozenCellListScanner::forward() {
+
+  if (m_delete_next < m_delete_offsets.size()) {
+    m_delete_next++;
+    return;
+  }
+
+  if (!m_eos) {
+    load_next();
+    skip_to_match();
+  }
+}
+
+
+void FrozenCellListScanner::seek(const SerializedKey key) {
+
+  while (m_delete_next < m_delete_offsets.size()) {
+    if (!(SerializedKey(m_deletes.base + m_delete_offsets[m_delete_next]) < key))
+      return;
+    m_delete_next++;
+  }
+
+  if (m_eos || !(m_key.serial < key))
+    return;
+
+  locate(key);
+  skip_to_match();
+}
+
+
+/**
+ * Positions the scanner on the first entry whose key is not less than
+ * <code>serkey</code>.  The restart index is binary searched for the last
+ * restart point in front of the key and the entries that follow it are
+ * decoded until the key is reached.
+ */
+void FrozenCellListScanner::locate(const SerializedKey serkey) {
+  const std::vector<uint32_t> &restarts = m_cell_list->m_restarts;
+  const uint8_t *base = m_cell_list->m_data.base;
+  const uint8_t *ptr;
+  ByteString value;
+  size_t lo = 0, hi = restarts.size(), mid;
+
+  while (lo < hi) {
+    mid = (lo + hi) / 2;
+    ptr = base + restarts[mid];
+    if (FrozenCellList::decode_entry(&ptr, m_key_buf, value) < serkey)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  m_next = (lo == 0) ? base : base + restarts[lo - 1];
+  m_eos = false;
+
+  while (load_next()) {
+    if (!(m_key.serial < serkey))
+      break;
+  }
+}
+
+
+bool FrozenCellListScanner::load_next() {
+  if (m_next >= m_end) {
+    m_eos = true;
+    return false;
+  }
+  m_key.load(FrozenCellList::decode_entry(&m_next, m_key_buf, m_value));
+  return true;
+}
+
+
+void FrozenCellListScanner::skip_to_match() {
+  while (!m_eos) {
+    if (!(m_key.serial < m_scan_context_ptr->end_serkey)) {
+      m_eos = true;
+      return;
+    }
+    if (m_key.flag == FLAG_DELETE_ROW
+        || m_scan_context_ptr->family_mask[m_key.column_family_code])
+      return;
+    load_next();
+  }
+}
+
+
+void
+FrozenCellListScanner::collect_deletes(const SerializedKey serkey,
+                                       uint8_t flag) {
+  ScanContext *scan_ctx = m_scan_context_ptr.get();
+
+  for (locate(serkey); !m_eos; load_next()) {
+    if (m_key.flag != flag || strcmp(m_key.row, scan_ctx->start_key.row))
+      break;
+    if (flag == FLAG_DELETE_COLUMN_FAMILY &&
+        m_key.column_family_code != scan_ctx->start_key.column_family_code)
+      break;
+    m_delete_offsets.push_back(m_deletes.fill());
+    m_deletes.add(m_key.serial.ptr, m_key.length);
+    m_deletes.ensure(m_value.length());
+    m_deletes.ptr += m_value.write(m_deletes.ptr);
+  }
+}
@@ -0,0 +1,70 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_FROZENCELLLISTSCANNER_H
+#define HYPERTABLE_FROZENCELLLISTSCANNER_H
+
+#include <vector>
+
+#include "Common/DynamicBuffer.h"
+
+#include "CellListScanner.h"
+#include "FrozenCellList.h"
+#include "ScanContext.h"
+
+namespace Hypertable {
+
+  /**
+   * Provides a scanning interface to a FrozenCellList.  The list is
+   * immutable, so no locking is needed; the scanner is positioned with a
+   * binary search of the restart index and then decodes entries in order.
+   */
+  class FrozenCellListScanner : public CellListScanner {
+  public:
+    FrozenCellListScanner(FrozenCellListPtr &cell_list,
+                          ScanContextPtr &scan_ctx);
+    virtual ~FrozenCellListScanner() { return; }
+    virtual void forward();
+    virtual bool get(Key &key, ByteString &value);
+    virtual void seek(const SerializedKey key);
+
+  private:
+    void locate(const SerializedKey serkey);
+    bool load_next();
+    void skip_to_match();
+    void collect_deletes(const SerializedKey serkey, uint8_t flag);
+
+    FrozenCellListPtr   m_cell_list;
+    const uint8_t      *m_next;
+    const uint8_t      *m_end;
+    DynamicBuffer       m_key_buf;
+    Key                 m_key;
+    ByteString          m_value;
+    DynamicBuffer       m_deletes;
+    std::vector<size_t> m_delete_offsets;
+    size_t              m_delete_next;
+    bool                m_eos;
+    bool                m_keys_only;
+  };
+
+}
+
+#endif // HYPERTABLE_FROZENCELLLISTSCANNER_H
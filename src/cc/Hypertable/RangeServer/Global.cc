@@ -34,6 +34,7 @@ namespace Hypertable {
   SessionPtr             Global::hyperspace = 0;
   FilesystemPtr          Global::dfs;
   FilesystemPtr          Global::log_dfs;
+  DfsBroker::LocalDirectPtr Global::local_direct;
   MaintenanceQueuePtr    Global::maintenance_queue;
   RangeServerProtocol   *Global::protocol = 0;
   RangeLocatorPtr        Global::range_locator = 0;
@@ -44,6 +45,7 @@ namespace Hypertable {
   CommitLog             *Global::root_log = 0;
   MetaLog::WriterPtr     Global::rsml_writer;
   std::string            Global::log_dir = "";
+  std::string            Global::local_log_dir = "";
   LocationInitializerPtr Global::location_initializer;
   int64_t                Global::range_split_size = 0;
   int64_t                Global::range_maximum_size = 0;
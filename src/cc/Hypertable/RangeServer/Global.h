@@ -31,6 +31,7 @@
 #include "Common/Filesystem.h"
 
 #include "AsyncComm/Comm.h"
+#include "DfsBroker/Lib/LocalDirect.h"
 #include "Hyperspace/Session.h"
 #include "Hypertable/Lib/CommitLog.h"
 #include "Hypertable/Lib/MetaLogWriter.h"
@@ -56,6 +57,7 @@ namespace Hypertable {
     static Hyperspace::SessionPtr hyperspace;
     static Hypertable::FilesystemPtr dfs;
     static Hypertable::FilesystemPtr log_dfs;
+    static DfsBroker::LocalDirectPtr local_direct;
     static Hypertable::MaintenanceQueuePtr maintenance_queue;
     static Hypertable::RangeServerProtocol *protocol;
     static Hypertable::RangeLocatorPtr range_locator;
@@ -66,6 +68,7 @@ namespace Hypertable {
     static CommitLog     *root_log;
     static MetaLog::WriterPtr rsml_writer;
     static std::string    log_dir;
+    static std::string    local_log_dir;
     static LocationInitializerPtr location_initializer;
     static int64_t        range_split_size;
     static int64_t        range_maximum_size;
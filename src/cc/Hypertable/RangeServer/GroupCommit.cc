@@ -20,6 +20,9 @@
  */
 #include "Common/Compat.h"
 #include "Common/Config.h"
+#include "Common/Time.h"
+
+#include <poll.h>
 
 #include "GroupCommit.h"
 #include "RangeServer.h"
@@ -28,16 +31,125 @@
 using namespace Hypertable;
 using namespace Hypertable::Config;
 
-GroupCommit::GroupCommit(RangeServer *range_server) : m_range_server(range_server), m_counter(0) {
+GroupCommit::GroupCommit(RangeServer *range_server)
+  : m_range_server(range_server), m_counter(0), m_leader_active(false),
+    m_adaptive_interval(get_i32("Hypertable.RangeServer.GroupCommit.MaxWait")) {
 
   m_commit_interval = get_i32("Hypertable.RangeServer.CommitInterval");
+  m_adaptive = get_bool("Hypertable.RangeServer.GroupCommit.Adaptive");
 
 }
 
 
 void GroupCommit::add(EventPtr &event, SchemaPtr &schema, const TableIdentifier *table,
                       uint32_t count, StaticBuffer &buffer, uint32_t flags, bool do_sync) {
-  ScopedLock lock(m_mutex);
+
+  {
+    ScopedLock lock(m_mutex);
+    enqueue(event, schema, table, count, buffer, do_sync);
+    // In adaptive mode, an update that arrives while a leader is active is
+    // committed by that leader in its next batch
+    if (!m_adaptive || m_leader_active)
+      return;
+    m_leader_active = true;
+  }
+
+  lead();
+}
+
+
+namespace {
+
+  void free_updates(std::vector<TableUpdate *> &updates) {
+    foreach (TableUpdate *table_update, updates) {
+      foreach (UpdateRequest *request, table_update->requests)
+        delete request;
+      delete table_update;
+    }
+    updates.clear();
+  }
+
+}
+
+
+/**
+ * Commits queued updates until the queue is empty.  Called with
+ * m_leader_active set, which keeps other writers from becoming leader.
+ * The flag is cleared on every way out, including an exception, or
+ * queued updates would never be committed.
+ */
+void GroupCommit::lead() {
+  std::vector<TableUpdate *> updates;
+  boost::xtime expire_time;
+  size_t request_count;
+  uint32_t wait_ms = 0;
+  int64_t start;
+
+  try {
+    while (true) {
+
+      if (wait_ms)
+        poll(0, 0, wait_ms);
+
+      memset(&expire_time, 0, sizeof(expire_time));
+      request_count = 0;
+
+      {
+        ScopedLock lock(m_mutex);
+        if (m_table_map.empty()) {
+          m_leader_active = false;
+          return;
+        }
+        // reserve first so the batch is either taken in full or not at all
+        updates.reserve(m_table_map.size());
+        for (TableUpdateMap::iterator iter = m_table_map.begin();
+             iter != m_table_map.end(); ++iter) {
+          if (iter->second->expire_time.sec > expire_time.sec)
+            expire_time = iter->second->expire_time;
+          request_count += iter->second->requests.size();
+          updates.push_back(iter->second);
+        }
+        m_table_map.clear();
+      }
+
+      start = get_ts64();
+      try {
+        commit(updates, expire_time);
+      }
+      catch (Exception &e) {
+        HT_ERROR_OUT << "Problem committing group update - " << e << HT_END;
+      }
+      catch (std::exception &e) {
+        HT_ERRORF("Problem committing group update - %s", e.what());
+      }
+      catch (...) {
+        HT_ERROR("Problem committing group update - unknown exception");
+      }
+      m_adaptive_interval.record_commit(request_count,
+                                        (get_ts64() - start) / 1000);
+      wait_ms = m_adaptive_interval.wait_ms();
+
+      free_updates(updates);
+    }
+  }
+  catch (...) {
+    free_updates(updates);
+    ScopedLock lock(m_mutex);
+    m_leader_active = false;
+    throw;
+  }
+}
+
+
+void GroupCommit::commit(std::vector<TableUpdate *> &updates,
+                         boost::xtime expire_time) {
+  m_range_server->batch_update(updates, expire_time);
+}
+
+
+void GroupCommit::enqueue(EventPtr &event, SchemaPtr &schema,
+                          const TableIdentifier *table, uint32_t count,
+                          StaticBuffer &buffer, bool do_sync) {
   TableUpdateMap::iterator iter;
   UpdateRequest *request = new UpdateRequest();
   boost::xtime expire_time = event->expiration_time();
@@ -80,6 +192,10 @@ void GroupCommit::trigger() {
   std::vector<TableUpdate *> updates;
   boost::xtime expire_time;
 
+  // In adaptive mode updates are committed by the leader
+  if (m_adaptive)
+    return;
+
   // Clear to Jan 1, 1970
   memset(&expire_time, 0, sizeof(expire_time));
 
@@ -100,14 +216,10 @@ void GroupCommit::trigger() {
   }
 
   if (!updates.empty()) {
-    m_range_server->batch_update(updates, expire_time);
+    commit(updates, expire_time);
 
     // Free objects
-    foreach (TableUpdate *table_update, updates) {
-      foreach (UpdateRequest *request, table_update->requests)
-        delete request;
-      delete table_update;
-    }
+    free_updates(updates);
   }
 
 }
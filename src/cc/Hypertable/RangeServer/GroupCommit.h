@@ -26,12 +26,21 @@
 #include "Common/Mutex.h"
 #include "Common/FlyweightString.h"
 
+#include "AdaptiveCommitInterval.h"
 #include "GroupCommitInterface.h"
 #include "RangeServer.h"
 
 namespace Hypertable {
 
   /**
+   * Batches updates to tables with a group commit interval.  By default
+   * the batched updates are committed by the GroupCommitTimerHandler every
+   * CommitInterval milliseconds.  In adaptive mode
+   * (Hypertable.RangeServer.GroupCommit.Adaptive) the first writer becomes
+   * the leader and commits right away; writers that arrive while the
+   * leader's commit is in progress are queued and committed together by
+   * the leader in its next batch, after a wait derived from the observed
+   * commit latency (see AdaptiveCommitInterval).
    */
   class GroupCommit : public GroupCommitInterface {
 
@@ -41,12 +50,24 @@ namespace Hypertable {
                      uint32_t count, StaticBuffer &buffer, uint32_t flags, bool do_sync);
     virtual void trigger();
 
+  protected:
+    /** Commits a batch of table updates; calls RangeServer::batch_update */
+    virtual void commit(std::vector<TableUpdate *> &updates,
+                        boost::xtime expire_time);
+
   private:
+    void enqueue(EventPtr &event, SchemaPtr &schema, const TableIdentifier *table,
+                 uint32_t count, StaticBuffer &buffer, bool do_sync);
+    void lead();
+
     Mutex         m_mutex;
     RangeServer  *m_range_server;
     uint32_t      m_commit_interval;
     int           m_counter;
     FlyweightString m_flyweight_strings;
+    bool          m_adaptive;
+    bool          m_leader_active;
+    AdaptiveCommitInterval m_adaptive_interval;
 
     typedef hash_map<TableIdentifier, TableUpdate *, __gnu_cxx::hash<TableIdentifier>, eqtid> TableUpdateMap;
     TableUpdateMap m_table_map;
@@ -41,11 +41,14 @@ MergeScanner::MergeScanner(ScanContextPtr &scan_ctx, bool return_deletes, bool a
     m_row_count(0), m_row_limit(0), m_cell_count(0), m_cell_limit(0), m_revs_count(0),
     m_revs_limit(0), m_cell_cutoff(0), m_bytes_input(0), m_bytes_output(0),
     m_cells_input(0), m_cells_output(0),
-    m_cur_bytes(0), m_prev_key(0), m_prev_cf(-1) {
+    m_cur_bytes(0), m_prev_key(0), m_prev_cf(-1), m_seek_pending(false),
+    m_skip_rows(true) {
 
   if (scan_ctx->spec != 0) {
     m_row_limit = scan_ctx->spec->row_limit;
     m_cell_limit = scan_ctx->spec->cell_limit;
+    // skipped rows may hold deletes that the scan wants returned
+    m_skip_rows = !scan_ctx->spec->return_deletes;
   }
 
   m_start_timestamp = scan_ctx->time_interval.first;
@@ -103,6 +106,10 @@ void MergeScanner::forward() {
        */
       if (m_no_forward)
         m_no_forward = false;
+      else if (m_seek_pending) {
+        m_seek_pending = false;
+        sstate.scanner->seek(SerializedKey(m_seek_key.base));
+      }
       else
         sstate.scanner->forward();
 
@@ -130,10 +137,20 @@ void MergeScanner::forward() {
       m_cell_cutoff = m_scan_context_ptr->family_info[
         sstate.key.column_family_code].cutoff_time;
 
-      if(sstate.key.timestamp < m_cell_cutoff )
+      /**
+       * Versions are sorted newest first, so once an inserted cell falls
+       * out of the time interval so do the rest of its versions, which the
+       * scanner can skip over
+       */
+      if(sstate.key.timestamp < m_cell_cutoff ) {
+        if (sstate.key.flag == FLAG_INSERT)
+          seek_past_column(sstate.key);
         continue;
+      }
 
       if (sstate.key.timestamp < m_start_timestamp && !m_return_deletes) {
+        if (sstate.key.flag == FLAG_INSERT)
+          seek_past_column(sstate.key);
         continue;
       }
       else if (sstate.key.revision > m_revision
@@ -231,8 +248,16 @@ void MergeScanner::forward() {
             int cmp = 1;
             while (!m_scan_context_ptr->rowset.empty() && (cmp = strcmp(*m_scan_context_ptr->rowset.begin(), sstate.key.row)) < 0)
               m_scan_context_ptr->rowset.erase(m_scan_context_ptr->rowset.begin());
-            if (cmp > 0)
+            if (cmp > 0) {
+              if (m_skip_rows) {
+                m_seek_key.clear();
+                create_key_and_append(m_seek_key, FLAG_DELETE_ROW,
+                    *m_scan_context_ptr->rowset.begin(), 0, "",
+                    TIMESTAMP_MAX, 0);
+                m_seek_pending = true;
+              }
               continue;
+            }
           }
           // row regexp .. we only need to do this in ag scanners
           if (m_scan_context_ptr->row_regexp) {
@@ -242,8 +267,11 @@ void MergeScanner::forward() {
               match = RE2::PartialMatch(sstate.key.row, *(m_scan_context_ptr->row_regexp));
               m_regexp_cache.set_rowkey(sstate.key.row, match);
             }
-            if (!match)
+            if (!match) {
+              if (m_skip_rows)
+                seek_past_row(sstate.key);
               continue;
+            }
           }
           // column qualifier match
           if(!m_scan_context_ptr->family_info[
@@ -257,11 +285,14 @@ void MergeScanner::forward() {
               m_regexp_cache.set_column(sstate.key.column_family_code,
                   sstate.key.column_qualifier, match);
             }
-            if (!match)
+            if (!match) {
+              seek_past_column(sstate.key);
               continue;
+            }
           }
           else if (!m_scan_context_ptr->family_info[
               sstate.key.column_family_code].qualifier_matches(sstate.key.column_qualifier)) {
+            seek_past_column(sstate.key);
             continue;
           }
 
@@ -365,8 +396,11 @@ void MergeScanner::forward() {
       // even though the cells are not returned
       if (incr_revs_count) {
         m_revs_count++;
-        if (m_revs_count >= m_revs_limit)
+        if (m_revs_count >= m_revs_limit) {
+          if (sstate.key.flag == FLAG_INSERT)
+            seek_past_column(sstate.key);
           continue;
+        }
       }
 
       if (incr_cf_count) {
@@ -389,6 +423,32 @@ void MergeScanner::forward() {
   m_cells_output++;
 }
 
+/**
+ * When the row regexp restricts the rows that can match, rows up to the
+ * next such interval are skipped too.
+ */
+void MergeScanner::seek_past_row(const Key &key) {
+  const RegexpRowIntervals *intervals = m_scan_context_ptr->row_regexp_intervals;
+
+  m_seek_pending = true;
+
+  if (intervals && !intervals->empty()) {
+    const RegexpRowIntervals::Interval *interval = intervals->find(key.row);
+    const char *row = 0;
+    if (interval == 0)
+      row = Key::END_ROW_MARKER;
+    else if (strcmp(interval->start.c_str(), key.row) > 0)
+      row = interval->start.c_str();
+    if (row) {
+      m_seek_key.clear();
+      create_key_and_append(m_seek_key, FLAG_DELETE_ROW, row, 0, "",
+                            TIMESTAMP_MAX, 0);
+      return;
+    }
+  }
+  next_row_key(key, m_seek_key);
+}
+
 bool MergeScanner::get(Key &key, ByteString &value) {
   if (!m_initialized)
     initialize();
@@ -541,7 +601,13 @@ void MergeScanner::initialize() {
         if (m_scan_context_ptr->row_regexp)
           if (!RE2::PartialMatch(sstate.key.row, *(m_scan_context_ptr->row_regexp))) {
             m_queue.pop();
-            sstate.scanner->forward();
+            if (m_skip_rows) {
+              seek_past_row(sstate.key);
+              m_seek_pending = false;
+              sstate.scanner->seek(SerializedKey(m_seek_key.base));
+            }
+            else
+              sstate.scanner->forward();
             if (sstate.scanner->get(sstate.key, sstate.value))
               m_queue.push(sstate);
             continue;
@@ -172,6 +172,18 @@ namespace Hypertable {
     }
     void finish_count();
 
+    /**
+     * Arranges for the scanner on top of the queue to be moved past the
+     * row, or past the remaining versions of the cell, of <code>key</code>
+     * when it is next advanced, rather than forwarded one cell at a time.
+     * Used when every cell it would pass over is going to be filtered out.
+     */
+    void seek_past_row(const Key &key);
+    void seek_past_column(const Key &key) {
+      next_column_key(key, m_seek_key);
+      m_seek_pending = true;
+    }
+
     bool          m_done;
     bool          m_initialized;
     std::vector<CellListScanner *>  m_scanners;
@@ -216,6 +228,10 @@ namespace Hypertable {
     DynamicBuffer m_prev_key;
     int32_t       m_prev_cf;
     RegexpInfo    m_regexp_cache;
+    bool          m_seek_pending;   // seek the top scanner instead of
+                                    // forwarding it
+    bool          m_skip_rows;      // whole rows may be skipped
+    DynamicBuffer m_seek_key;
     CellStoreReleaseCallback m_release_callback;
   };
 
@@ -30,61 +30,82 @@ using std::pair;
 
 #define OVERHEAD 64
 
+QueryCache::QueryCache(uint64_t max_memory, size_t shard_count)
+  : m_shard_count(shard_count ? shard_count : 1), m_max_memory(max_memory) {
+  m_shards = new Shard [m_shard_count];
+  for (size_t i=0; i<m_shard_count; i++)
+    m_shards[i].max_memory = max_memory / m_shard_count;
+  // give the remainder to the first shard so the shards add up
+  m_shards[0].max_memory += max_memory % m_shard_count;
+  for (size_t i=0; i<m_shard_count; i++)
+    m_shards[i].avail_memory = m_shards[i].max_memory;
+}
+
+
+QueryCache::~QueryCache() {
+  delete [] m_shards;
+}
+
+
 bool QueryCache::insert(Key *key, const char *tablename, const char *row,
+                        const ColumnSet &columns,
 			boost::shared_array<uint8_t> &result,
-			uint32_t result_length) {
-  ScopedLock lock(m_mutex);
-  LookupHashIndex &hash_index = m_cache.get<1>();
+			uint32_t result_length, uint32_t cell_count) {
+  QueryCacheEntry entry(*key, tablename, row, columns, result, result_length,
+                        cell_count);
+  Shard &s = shard(entry.row_key);
+  ScopedLock lock(s.mutex);
+  LookupHashIndex &hash_index = s.cache.get<1>();
   LookupHashIndex::iterator lookup_iter;
   uint64_t length = result_length + OVERHEAD + strlen(row);
 
-  if (length > m_max_memory)
+  if (length > s.max_memory)
     return false;
 
   if ((lookup_iter = hash_index.find(*key)) != hash_index.end()) {
-    m_avail_memory += (*lookup_iter).result_length + OVERHEAD + strlen((*lookup_iter).row_key.row);
+    s.avail_memory += (*lookup_iter).result_length + OVERHEAD + strlen((*lookup_iter).row_key.row);
     hash_index.erase(lookup_iter);
   }
 
   // make room
-  if (m_avail_memory < length) {
-    Cache::iterator iter = m_cache.begin();
-    while (iter != m_cache.end()) {
-      m_avail_memory += (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
-      iter = m_cache.erase(iter);
-      if (m_avail_memory >= length)
+  if (s.avail_memory < length) {
+    Cache::iterator iter = s.cache.begin();
+    while (iter != s.cache.end()) {
+      s.avail_memory += (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
+      iter = s.cache.erase(iter);
+      if (s.avail_memory >= length)
 	break;
     }
   }
 
-  if (m_avail_memory < length)
+  if (s.avail_memory < length)
     return false;
 
-  QueryCacheEntry entry(*key, tablename, row, result, result_length);
-
-  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  pair<Sequence::iterator, bool> insert_result = s.cache.push_back(entry);
   assert(insert_result.second);
 
-  m_avail_memory -= length;
+  s.avail_memory -= length;
 
   return true;
 }
 
 
-bool QueryCache::lookup(Key *key, boost::shared_array<uint8_t> &result,
-			uint32_t *lenp) {
-  ScopedLock lock(m_mutex);
-  LookupHashIndex &hash_index = m_cache.get<1>();
+bool QueryCache::lookup(Key *key, const char *tablename, const char *row,
+                        boost::shared_array<uint8_t> &result, uint32_t *lenp) {
+  Shard &s = shard(RowKey(tablename, row));
+  ScopedLock lock(s.mutex);
+  LookupHashIndex &hash_index = s.cache.get<1>();
   LookupHashIndex::iterator iter;
 
-  if (m_total_lookup_count > 0 && (m_total_lookup_count % 1000) == 0) {
-    HT_INFOF("QueryCache hit rate over last 1000 lookups, cumulative = %f, %f",
-             ((double)m_recent_hit_count / (double)1000)*100.0,
-             ((double)m_total_hit_count / (double)m_total_lookup_count)*100.0);
-    m_recent_hit_count = 0;
+  if (s.total_lookup_count > 0 && (s.total_lookup_count % 1000) == 0) {
+    HT_INFOF("QueryCache shard %d hit rate over last 1000 lookups, "
+             "cumulative = %f, %f", (int)(&s - m_shards),
+             ((double)s.recent_hit_count / (double)1000)*100.0,
+             ((double)s.total_hit_count / (double)s.total_lookup_count)*100.0);
+    s.recent_hit_count = 0;
   }
 
-  m_total_lookup_count++;
+  s.total_lookup_count++;
 
   if ((iter = hash_index.find(*key)) == hash_index.end())
     return false;
@@ -93,40 +114,71 @@ bool QueryCache::lookup(Key *key, boost::shared_array<uint8_t> &result,
 
   hash_index.erase(iter);
 
-  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  pair<Sequence::iterator, bool> insert_result = s.cache.push_back(entry);
   assert(insert_result.second);
 
   result = (*insert_result.first).result;
   *lenp = (*insert_result.first).result_length;
 
-  m_total_hit_count++;
-  m_recent_hit_count++;
+  s.total_hit_count++;
+  s.recent_hit_count++;
+  if ((*insert_result.first).cell_count == 0)
+    s.negative_hit_count++;
   return true;
 }
 
+
+uint64_t QueryCache::available_memory() {
+  uint64_t avail = 0;
+  for (size_t i=0; i<m_shard_count; i++) {
+    ScopedLock lock(m_shards[i].mutex);
+    avail += m_shards[i].avail_memory;
+  }
+  return avail;
+}
+
+
 void QueryCache::get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                            uint64_t *total_lookupsp, uint64_t *total_hitsp)
 {
-  ScopedLock lock(m_mutex);
-  *total_lookupsp = m_total_lookup_count;
-  *total_hitsp = m_total_hit_count;
   *max_memoryp = m_max_memory;
-  *available_memoryp = m_avail_memory;
+  *available_memoryp = *total_lookupsp = *total_hitsp = 0;
+  for (size_t i=0; i<m_shard_count; i++) {
+    ScopedLock lock(m_shards[i].mutex);
+    *total_lookupsp += m_shards[i].total_lookup_count;
+    *total_hitsp += m_shards[i].total_hit_count;
+    *available_memoryp += m_shards[i].avail_memory;
+  }
+}
+
+
+void QueryCache::get_shard_stats(size_t shard, uint64_t *lookupsp,
+                                 uint64_t *hitsp, uint64_t *negative_hitsp) {
+  HT_ASSERT(shard < m_shard_count);
+  Shard &s = m_shards[shard];
+  ScopedLock lock(s.mutex);
+  *lookupsp = s.total_lookup_count;
+  *hitsp = s.total_hit_count;
+  *negative_hitsp = s.negative_hit_count;
 }
 
-void QueryCache::invalidate(const char *tablename, const char *row) {
-  ScopedLock lock(m_mutex);
-  InvalidateHashIndex &hash_index = m_cache.get<2>();
-  InvalidateHashIndex::iterator iter;
+
+void QueryCache::invalidate(const char *tablename, const char *row,
+                            uint8_t column_family) {
   RowKey row_key(tablename, row);
+  Shard &s = shard(row_key);
+  ScopedLock lock(s.mutex);
+  InvalidateHashIndex &hash_index = s.cache.get<2>();
   pair<InvalidateHashIndex::iterator, InvalidateHashIndex::iterator> p = hash_index.equal_range(row_key);
   uint64_t length;
 
   while (p.first != p.second) {
+    if (column_family && !(*p.first).columns.test(column_family)) {
+      ++p.first;
+      continue;
+    }
     length = (*p.first).result_length + OVERHEAD + strlen((*p.first).row_key.row);
-    /** HT_ASSERT(strcmp((*p.first).row_key.tablename, tablename) == 0 &&
-        strcmp((*p.first).row_key.row.c_str(), row) == 0); **/
-    m_avail_memory += length;
+    s.avail_memory += length;
     p.first = hash_index.erase(p.first);
   }
 
@@ -134,26 +186,30 @@ void QueryCache::invalidate(const char *tablename, const char *row) {
 
 
 void QueryCache::dump() {
-  ScopedLock lock(m_mutex);
-  Sequence &index0 = m_cache.get<0>();
-  LookupHashIndex &index1 = m_cache.get<1>();
-  InvalidateHashIndex &index2 = m_cache.get<2>();
-
-  std::cout << "index0:" << std::endl;
-  for (Sequence::iterator iter = index0.begin(); iter != index0.end(); ++iter) {
-    QueryCacheEntry entry(*iter);
-    entry.dump();
-  }
+  for (size_t i=0; i<m_shard_count; i++) {
+    ScopedLock lock(m_shards[i].mutex);
+    Sequence &index0 = m_shards[i].cache.get<0>();
+    LookupHashIndex &index1 = m_shards[i].cache.get<1>();
+    InvalidateHashIndex &index2 = m_shards[i].cache.get<2>();
+
+    std::cout << "shard " << i << ":" << std::endl;
+
+    std::cout << "index0:" << std::endl;
+    for (Sequence::iterator iter = index0.begin(); iter != index0.end(); ++iter) {
+      QueryCacheEntry entry(*iter);
+      entry.dump();
+    }
 
-  std::cout << "index1:" << std::endl;
-  for (LookupHashIndex::iterator iter = index1.begin(); iter != index1.end(); ++iter) {
-    QueryCacheEntry entry(*iter);
-    entry.dump();
-  }
+    std::cout << "index1:" << std::endl;
+    for (LookupHashIndex::iterator iter = index1.begin(); iter != index1.end(); ++iter) {
+      QueryCacheEntry entry(*iter);
+      entry.dump();
+    }
 
-  std::cout << "index2:" << std::endl;
-  for (InvalidateHashIndex::iterator iter = index2.begin(); iter != index2.end(); ++iter) {
-    QueryCacheEntry entry(*iter);
-    entry.dump();
+    std::cout << "index2:" << std::endl;
+    for (InvalidateHashIndex::iterator iter = index2.begin(); iter != index2.end(); ++iter) {
+      QueryCacheEntry entry(*iter);
+      entry.dump();
+    }
   }
 }
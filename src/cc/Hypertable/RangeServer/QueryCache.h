@@ -22,6 +22,7 @@
 #ifndef HYPERTABLE_QUERYCACHE_H
 #define HYPERTABLE_QUERYCACHE_H
 
+#include <bitset>
 #include <cstring>
 
 #include <boost/multi_index_container.hpp>
@@ -34,15 +35,31 @@
 
 #include "Common/Mutex.h"
 #include "Common/atomic.h"
-#include "Common/Checksum.h"
+#include "Common/MurmurHash.h"
 
 namespace Hypertable {
   using namespace boost::multi_index;
 
+  /**
+   * Caches the results of single-row scans.  The cache is split into a
+   * number of lock-striped shards, each an independent LRU holding an
+   * equal share of the memory budget.  An entry is placed in the shard
+   * selected by the hash of its table and row, so a lookup or an
+   * invalidation only locks one shard.  Each entry records the set of
+   * column families its scan covered, and invalidating a row for one
+   * column family leaves results for other families in place.  Empty
+   * results are cached as negative entries, so repeated existence checks
+   * for missing rows are answered from the cache.
+   */
   class QueryCache {
 
   public:
 
+    enum { DEFAULT_SHARDS = 16 };
+
+    /** Set of column family codes covered by a cached result */
+    typedef std::bitset<256> ColumnSet;
+
     class Key {
     public:
       bool operator==(const Key &other) const {
@@ -54,48 +71,78 @@ namespace Hypertable {
     class RowKey {
     public:
       RowKey(const char *tname, const char *r) : tablename(tname), row(r) {
-	hash = fletcher32(tname, strlen(tname)) ^ fletcher32(row, strlen(row));
+        hash = murmurhash64(row, strlen(row),
+                            murmurhash64(tname, strlen(tname), 0));
       }
       bool operator==(const RowKey &other) const {
-	return !strcmp(tablename, other.tablename) && !strcmp(row, other.row);
+	return hash == other.hash && !strcmp(row, other.row) &&
+          !strcmp(tablename, other.tablename);
       }
       const char *tablename;
       const char *row;
-      uint32_t hash;
+      uint64_t hash;
     };
 
-    QueryCache(uint64_t max_memory)
-      : m_max_memory(max_memory), m_avail_memory(max_memory),
-        m_total_lookup_count(0), m_total_hit_count(0), m_recent_hit_count(0) { }
-
+    QueryCache(uint64_t max_memory, size_t shard_count=DEFAULT_SHARDS);
+    ~QueryCache();
+
+    /** Inserts a scan result.  A <code>cell_count</code> of zero inserts a
+     * negative entry recording that the scan found nothing; its result is
+     * the encoded empty scan block that is sent back on a hit.
+     *
+     * @param key digest of the scan request
+     * @param tablename table id (must stay valid as long as the entry)
+     * @param row row key (must stay valid as long as the entry)
+     * @param columns column families covered by the scan
+     * @param result result buffer
+     * @param result_length length of the result
+     * @param cell_count number of cells in the result
+     * @return true if the result was inserted
+     */
     bool insert(Key *key, const char *tablename, const char *row,
-                boost::shared_array<uint8_t> &result, uint32_t result_length);
+                const ColumnSet &columns, boost::shared_array<uint8_t> &result,
+                uint32_t result_length, uint32_t cell_count);
 
-    bool lookup(Key *key, boost::shared_array<uint8_t> &result, uint32_t *lenp);
+    bool lookup(Key *key, const char *tablename, const char *row,
+                boost::shared_array<uint8_t> &result, uint32_t *lenp);
 
-    void invalidate(const char * tablename, const char *row);
+    /** Removes the cached results for a row whose scans covered the given
+     * column family.  A column family of 0 (row delete) removes all of
+     * the row's results.
+     */
+    void invalidate(const char *tablename, const char *row,
+                    uint8_t column_family);
 
     void dump();
 
-    uint64_t available_memory() { return m_avail_memory; }
+    uint64_t available_memory();
 
     void get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                    uint64_t *total_lookupsp, uint64_t *total_hitsp);
 
+    size_t shard_count() const { return m_shard_count; }
+
+    void get_shard_stats(size_t shard, uint64_t *lookupsp, uint64_t *hitsp,
+                         uint64_t *negative_hitsp);
+
   private:
 
     class QueryCacheEntry {
     public:
       QueryCacheEntry(Key &k, const char *tname, const char *rw,
-		      boost::shared_array<uint8_t> &res, uint32_t rlen) :
-	key(k), row_key(tname, rw), result(res), result_length(rlen) { }
+                      const ColumnSet &cols, boost::shared_array<uint8_t> &res,
+                      uint32_t rlen, uint32_t count) :
+	key(k), row_key(tname, rw), columns(cols), result(res),
+        result_length(rlen), cell_count(count) { }
       Key lookup_key() const { return key; }
       RowKey invalidate_key() const { return row_key; }
       void dump() { std::cout << row_key.tablename << ":" << row_key.row << "\n"; }
       Key key;
       RowKey row_key;
+      ColumnSet columns;
       boost::shared_array<uint8_t> result;
       uint32_t result_length;
+      uint32_t cell_count;
     };
 
     struct KeyHash {
@@ -126,13 +173,29 @@ namespace Hypertable {
     typedef Cache::nth_index<1>::type LookupHashIndex;
     typedef Cache::nth_index<2>::type InvalidateHashIndex;
 
-    Mutex     m_mutex;
-    Cache     m_cache;
+    struct Shard {
+      Shard() : max_memory(0), avail_memory(0), total_lookup_count(0),
+                total_hit_count(0), negative_hit_count(0),
+                recent_hit_count(0) { }
+      Mutex     mutex;
+      Cache     cache;
+      uint64_t  max_memory;
+      uint64_t  avail_memory;
+      uint64_t  total_lookup_count;
+      uint64_t  total_hit_count;
+      uint64_t  negative_hit_count;
+      uint32_t  recent_hit_count;
+    };
+
+    /** Shards are selected with the high bits of the row key hash, the
+     * hash indexes within a shard use the low bits */
+    Shard &shard(const RowKey &row_key) {
+      return m_shards[(row_key.hash >> 32) % m_shard_count];
+    }
+
+    Shard    *m_shards;
+    size_t    m_shard_count;
     uint64_t  m_max_memory;
-    uint64_t  m_avail_memory;
-    uint64_t  m_total_lookup_count;
-    uint64_t  m_total_hit_count;
-    uint32_t  m_recent_hit_count;
   };
 
 }
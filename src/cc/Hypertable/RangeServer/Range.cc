@@ -36,7 +36,9 @@ extern "C" {
 #include "Common/FailureInducer.h"
 #include "Common/FileUtils.h"
 #include "Common/md5.h"
+#include "Common/Stopwatch.h"
 #include "Common/StringExt.h"
+#include "Common/Thread.h"
 
 #include "Hypertable/Lib/CommitLog.h"
 #include "Hypertable/Lib/CommitLogReader.h"
@@ -235,25 +237,83 @@ void Range::update_schema(SchemaPtr &schema) {
   return;
 }
 
+namespace {
+
+  struct CellStoreOpenJob {
+    CellStoreOpenJob(AccessGroup *ag_, const String &name_)
+      : ag(ag_), name(name_), error(Error::OK) { }
+    AccessGroup *ag;
+    String name;
+    CellStorePtr cellstore;
+    int error;
+    String message;
+  };
+
+  /**
+   * Opens CellStores from a shared job list until it is exhausted.  Only the
+   * trailer is read at open time; the block index and bloom filter are loaded
+   * on first access.
+   */
+  class CellStoreOpenWorker {
+  public:
+    CellStoreOpenWorker(std::vector<CellStoreOpenJob> &jobs,
+                        const String &basename, const char *start_row,
+                        const char *end_row, Mutex &mutex, size_t &next)
+      : m_jobs(jobs), m_basename(basename), m_start_row(start_row),
+        m_end_row(end_row), m_mutex(mutex), m_next(next) { }
+
+    void operator()() {
+      size_t i;
+      while (true) {
+        {
+          ScopedLock lock(m_mutex);
+          if (m_next == m_jobs.size())
+            return;
+          i = m_next++;
+        }
+        HT_INFOF("Loading CellStore %s", m_jobs[i].name.c_str());
+        try {
+          m_jobs[i].cellstore = CellStoreFactory::open(m_basename + m_jobs[i].name,
+                                                       m_start_row, m_end_row);
+        }
+        catch (Exception &e) {
+          m_jobs[i].error = e.code();
+          m_jobs[i].message = e.what();
+        }
+      }
+    }
+
+  private:
+    std::vector<CellStoreOpenJob> &m_jobs;
+    const String &m_basename;
+    const char *m_start_row;
+    const char *m_end_row;
+    Mutex &m_mutex;
+    size_t &m_next;
+  };
+
+}
+
 /**
- *
+ * Reads the CellStore lists for all of the access groups from METADATA and
+ * then opens the CellStores concurrently (bounded by
+ * Hypertable.RangeServer.CellStore.OpenThreads).  The stores are added to
+ * their access groups in the order in which they appear in METADATA.
  */
 void Range::load_cell_stores(Metadata *metadata) {
   AccessGroup *ag;
-  CellStorePtr cellstore;
   const char *base, *ptr, *end;
-  std::vector<String> csvec;
+  std::vector<CellStoreOpenJob> jobs;
   String ag_name;
   String files;
   String file_str;
-  bool need_update;
   uint32_t nextcsid;
+  Stopwatch stopwatch;
+  double metadata_time, open_time, add_time;
 
   metadata->reset_files_scan();
 
   while (metadata->get_next_files(ag_name, files, &nextcsid)) {
-    csvec.clear();
-    need_update = false;
 
     if ((ag = m_access_group_map[ag_name]) == 0) {
       HT_ERRORF("Unrecognized access group name '%s' found in METADATA for "
@@ -273,59 +333,70 @@ void Range::load_cell_stores(Metadata *metadata) {
       file_str = String(base, ptr-base);
       boost::trim(file_str);
 
-      if (!file_str.empty()) {
-        if (file_str[0] == '#') {
-          ++ptr;
-          base = ptr;
-          need_update = true;
-          continue;
-        }
+      if (!file_str.empty() && file_str[0] != '#')
+        jobs.push_back(CellStoreOpenJob(ag, file_str));
 
-        csvec.push_back(file_str);
-      }
       ++ptr;
       base = ptr;
     }
+  }
 
-    files = "";
+  metadata_time = stopwatch.elapsed();
 
-    String file_basename = Global::toplevel_dir + "/tables/";
+  if (jobs.empty())
+    return;
 
-    bool skip_not_found = Config::properties->get_bool("Hypertable.RangeServer.CellStore.SkipNotFound");
+  String file_basename = Global::toplevel_dir + "/tables/";
 
-    for (size_t i=0; i<csvec.size(); i++) {
+  bool skip_not_found = Config::properties->get_bool("Hypertable.RangeServer.CellStore.SkipNotFound");
+  size_t thread_count = Config::properties->get_i32("Hypertable.RangeServer.CellStore.OpenThreads");
+  size_t next = 0;
+  Mutex mutex;
 
-      files += csvec[i] + ";\n";
+  if (thread_count == 0)
+    thread_count = 1;
+  if (thread_count > jobs.size())
+    thread_count = jobs.size();
 
-      HT_INFOF("Loading CellStore %s", csvec[i].c_str());
+  CellStoreOpenWorker worker(jobs, file_basename, m_metalog_entity->spec.start_row,
+                             m_metalog_entity->spec.end_row, mutex, next);
+  if (thread_count == 1)
+    worker();
+  else {
+    ThreadGroup threads;
+    for (size_t i=0; i<thread_count; i++)
+      threads.create_thread(worker);
+    threads.join_all();
+  }
 
-      try {
-        cellstore = CellStoreFactory::open(file_basename + csvec[i], m_metalog_entity->spec.start_row, m_metalog_entity->spec.end_row);
-      }
-      catch (Exception &e) {
-        if (e.code() == Error::DFSBROKER_FILE_NOT_FOUND && skip_not_found) {
-          HT_WARNF("CellStore file '%s' not found, skipping", csvec[i].c_str());
-          continue;
-        }
-        HT_FATALF("Problem opening CellStore file '%s' - %s", csvec[i].c_str(),
-                  Error::get_text(e.code()));
-      }
+  open_time = stopwatch.elapsed() - metadata_time;
 
-      int64_t revision = boost::any_cast<int64_t>
-        (cellstore->get_trailer()->get("revision"));
-      if (revision > m_latest_revision)
-        m_latest_revision = revision;
+  foreach(CellStoreOpenJob &job, jobs) {
 
-      ag->add_cell_store(cellstore);
+    if (job.error != Error::OK) {
+      if (job.error == Error::DFSBROKER_FILE_NOT_FOUND && skip_not_found) {
+        HT_WARNF("CellStore file '%s' not found, skipping", job.name.c_str());
+        continue;
+      }
+      HT_FATALF("Problem opening CellStore file '%s' - %s (%s)", job.name.c_str(),
+                Error::get_text(job.error), job.message.c_str());
     }
 
-    /** this causes startup deadlock (and is not needed) ..
-    if (need_update)
-      metadata->write_files(ag_name, files);
-    */
+    int64_t revision = boost::any_cast<int64_t>
+      (job.cellstore->get_trailer()->get("revision"));
+    if (revision > m_latest_revision)
+      m_latest_revision = revision;
 
+    job.ag->add_cell_store(job.cellstore);
   }
 
+  add_time = stopwatch.elapsed() - (metadata_time + open_time);
+
+  HT_INFOF("Loaded %u CellStores for range %s[%s..%s] with %u threads "
+           "(metadata=%.3fs open=%.3fs add=%.3fs)", (unsigned)jobs.size(),
+           m_metalog_entity->table.id, m_metalog_entity->spec.start_row,
+           m_metalog_entity->spec.end_row, (unsigned)thread_count,
+           metadata_time, open_time, add_time);
 }
 
 
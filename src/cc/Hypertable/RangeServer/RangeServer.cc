@@ -40,16 +40,23 @@ extern "C" {
 #include "Common/FileUtils.h"
 #include "Common/HashMap.h"
 #include "Common/md5.h"
+#include "Common/Path.h"
 #include "Common/Random.h"
+#include "Common/Stopwatch.h"
 #include "Common/StringExt.h"
 #include "Common/SystemInfo.h"
+#include "Common/Thread.h"
+#include "Common/Trace.h"
 
 #include "Hypertable/Lib/CommitLog.h"
+#include "Hypertable/Lib/CommitLogShipper.h"
+#include "Hypertable/Lib/CompressorFactory.h"
 #include "Hypertable/Lib/Key.h"
 #include "Hypertable/Lib/MetaLogDefinition.h"
 #include "Hypertable/Lib/MetaLogReader.h"
 #include "Hypertable/Lib/MetaLogWriter.h"
 #include "Hypertable/Lib/RangeServerProtocol.h"
+#include "Hypertable/Lib/ScanBlock.h"
 #include "Hypertable/Lib/old/RangeServerMetaLogReader.h"
 #include "Hypertable/Lib/old/RangeServerMetaLogEntries.h"
 
@@ -82,7 +89,7 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
     m_system_replay_finished(false), m_replay_finished(false), m_props(props),
     m_verbose(false), m_comm(conn_mgr->get_comm()), m_conn_manager(conn_mgr),
     m_app_queue(app_queue), m_hyperspace(hyperspace), m_timer_handler(0),
-    m_group_commit_timer_handler(0), m_query_cache(0),
+    m_group_commit_timer_handler(0), m_query_cache(0), m_update_apply_threads(0),
     m_last_revision(TIMESTAMP_MIN), m_loadavg_accum(0.0), m_page_in_accum(0),
     m_page_out_accum(0), m_metric_samples(0), m_pending_metrics_updates(0)
 {
@@ -106,6 +113,9 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
   maintenance_threads = cfg.get_i32("MaintenanceThreads", maintenance_threads);
   port = cfg.get_i16("Port");
 
+  // clients may compress update payloads
+  CompressorFactory::register_comm_codecs();
+
   Global::toplevel_dir = props->get_str("Hypertable.Directory");
   boost::trim_if(Global::toplevel_dir, boost::is_any_of("/"));
   Global::toplevel_dir = String("/") + Global::toplevel_dir;
@@ -117,6 +127,8 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
 
   m_server_stats = new RSStats(collector_periods);
   m_stats = new StatsRangeServer(m_props);
+  m_latency_interval = interval * 1000000LL;
+  m_latency_timestamp = 0;
 
   m_namemap = new NameIdMapper(m_hyperspace, Global::toplevel_dir);
 
@@ -168,6 +180,10 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
 
   m_update_delay = cfg.get_i32("UpdateDelay", 0);
 
+  m_update_apply_threads = cfg.get_i32("UpdateApply.Threads");
+  if (m_update_apply_threads > 0)
+    m_update_apply_queue = new ApplicationQueue(m_update_apply_threads);
+
   int64_t block_cache_min = cfg.get_i64("BlockCache.MinMemory");
   int64_t block_cache_max;
   if (cfg.has("BlockCache.MaxMemory"))
@@ -198,7 +214,8 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
       props->set("Hypertable.RangeServer.QueryCache.MaxMemory", query_cache_memory);
       HT_INFOF("Maximum size of query cache has been reduced to %.2fMB", (double)query_cache_memory / Property::MiB);
     }
-    m_query_cache = new QueryCache(query_cache_memory);
+    m_query_cache = new QueryCache(query_cache_memory,
+                                   cfg.get_i32("QueryCache.Shards"));
   }
 
   Global::memory_tracker = new MemoryTracker(Global::block_cache);
@@ -219,6 +236,22 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
 
   Global::dfs = dfsclient;
 
+  /**
+   * Serve CellStore reads in-process from the local broker root directory
+   */
+  if (cfg.get_bool("DfsBroker.LocalDirect")) {
+    Path root = props->get_str("DfsBroker.Local.Root", "fs/local");
+    if (!root.is_complete()) {
+      Path data_dir = props->get_str("Hypertable.DataDirectory");
+      root = data_dir / root;
+    }
+    // only CellStores, which are immutable once written, get mapped
+    Global::local_direct =
+        new DfsBroker::LocalDirect(Global::dfs, root.directory_string(),
+                                   Global::toplevel_dir + "/tables/");
+    Global::dfs = Global::local_direct.get();
+  }
+
   m_log_roll_limit = cfg.get_i64("CommitLog.RollLimit");
 
   m_dropped_table_id_cache = new TableIdCache(50);
@@ -239,7 +272,7 @@ RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_mgr,
     Global::log_dfs = dfsclient;
   }
   else
-    Global::log_dfs = Global::dfs;
+    Global::log_dfs = dfsclient;
 
   // Create the maintenance queue
   Global::maintenance_queue = new MaintenanceQueue(maintenance_threads);
@@ -320,6 +353,9 @@ void RangeServer::shutdown() {
     if (m_group_commit_timer_handler)
       m_group_commit_timer_handler->shutdown();
 
+    if (m_update_apply_queue)
+      m_update_apply_queue->shutdown();
+
     // stop maintenance queue
     Global::maintenance_queue->shutdown();
 #if defined(CLEAN_SHUTDOWN)
@@ -359,6 +395,7 @@ void RangeServer::shutdown() {
     Global::hyperspace = 0;
 
     Global::log_dfs = 0;
+    Global::local_direct = 0;
     Global::dfs = 0;
 
     delete Global::protocol;
@@ -430,6 +467,20 @@ void RangeServer::initialize(PropertiesPtr &props) {
   }
 
   HT_INFO_OUT << "log_dir=" << Global::log_dir << HT_END;
+
+  /**
+   * Ship user commit log fragments left on local disk by a previous
+   * incarnation before the user log is replayed
+   */
+  String local_dir =
+    props->get_str("Hypertable.RangeServer.CommitLog.Local.Directory", "");
+  if (!local_dir.empty()) {
+    Global::local_log_dir = local_dir + Global::log_dir + "/user";
+    size_t count = CommitLogShipper::recover(Global::log_dfs,
+                                             Global::local_log_dir, path);
+    HT_INFO_OUT << "local_log_dir=" << Global::local_log_dir << " ("
+                << count << " fragments recovered)" << HT_END;
+  }
 }
 
 namespace {
@@ -460,6 +511,197 @@ namespace {
     }
   }
 
+  /**
+   * Replay loads ranges from a shared list until it is exhausted.  Several
+   * of these are run concurrently by RangeServer::replay_load_ranges().
+   */
+  class ReplayLoadWorker {
+  public:
+    ReplayLoadWorker(RangeServer *rs,
+                     std::vector<MetaLog::EntityRange *> &entities,
+                     Mutex &mutex, size_t &next)
+      : m_rs(rs), m_entities(entities), m_mutex(mutex), m_next(next) { }
+
+    void operator()() {
+      size_t i;
+      while (true) {
+        {
+          ScopedLock lock(m_mutex);
+          if (m_next == m_entities.size())
+            return;
+          i = m_next++;
+        }
+        m_rs->replay_load_range(0, m_entities[i], false);
+      }
+    }
+
+  private:
+    RangeServer *m_rs;
+    std::vector<MetaLog::EntityRange *> &m_entities;
+    Mutex &m_mutex;
+    size_t &m_next;
+  };
+
+  /**
+   * Records an "rs.batch_update" span (and for group commit tables, an
+   * "rs.group_commit.wait" span) for each traced request in a batch
+   * update.  The first trace id is made current for the duration of the
+   * batch so that the commit log writes it issues are traced through to the
+   * DfsBroker.
+   */
+  class BatchUpdateTrace {
+  public:
+    BatchUpdateTrace(std::vector<TableUpdate *> &updates)
+      : m_start(0), m_saved_trace_id(0) {
+      uint64_t trace_id;
+      foreach (TableUpdate *table_update, updates) {
+        foreach (UpdateRequest *request, table_update->requests) {
+          if (!request->event || !(trace_id = request->event->header.trace_id))
+            continue;
+          if (m_trace_ids.empty())
+            m_start = get_ts64();
+          // time spent waiting for the group commit timer
+          if (table_update->commit_interval)
+            Trace::record(trace_id, "rs.group_commit.wait",
+                          request->event->arrival_hrtime, m_start);
+          m_trace_ids.push_back(trace_id);
+        }
+      }
+      if (!m_trace_ids.empty()) {
+        m_saved_trace_id = Trace::current();
+        Trace::set_current(m_trace_ids[0]);
+      }
+    }
+
+    ~BatchUpdateTrace() {
+      if (!m_trace_ids.empty()) {
+        int64_t end = get_ts64();
+        foreach (uint64_t trace_id, m_trace_ids)
+          Trace::record(trace_id, "rs.batch_update", m_start, end);
+        Trace::set_current(m_saved_trace_id);
+      }
+    }
+
+  private:
+    std::vector<uint64_t> m_trace_ids;
+    int64_t m_start;
+    uint64_t m_saved_trace_id;
+  };
+
+  typedef std::pair<TableUpdate *, RangeUpdateList *> RangeApplyWork;
+
+  /**
+   * State of one apply phase of RangeServer::batch_update().  Each
+   * RangeUpdateList is a unit of work; the calling thread and the update
+   * apply threads claim units by index until all of them have been
+   * applied.  Since the cells of a range are applied by a single thread,
+   * in order, per-range revision order is preserved.  The calling thread
+   * only waits for helpers that have claimed work, so a helper that never
+   * runs (e.g. because the queue was shut down) does not block it; the
+   * state is reference counted so that such a helper can still run later.
+   */
+  class UpdateApplyState : public ReferenceCount {
+  public:
+    UpdateApplyState(RangeServer *rs, std::vector<RangeApplyWork> &work)
+      : m_rs(rs), m_work(work), m_count(work.size()), m_next(0),
+        m_active(0), m_bytes_added(0) { }
+
+    void apply() {
+      uint64_t bytes_added = 0;
+      uint64_t nbytes;
+      size_t i;
+      while (true) {
+        {
+          ScopedLock lock(m_mutex);
+          if (m_next == m_count)
+            break;
+          i = m_next++;
+        }
+        try {
+          nbytes = m_rs->apply_range_updates(m_work[i].first, m_work[i].second);
+          if (!m_work[i].first->id.is_metadata())
+            bytes_added += nbytes;
+        }
+        catch (Exception &e) {
+          HT_ERROR_OUT << "Problem applying updates to range "
+                       << m_work[i].second->range->get_name() << " - " << e
+                       << HT_END;
+          set_error(m_work[i].first, e.code(), e.what());
+        }
+        catch (std::exception &e) {
+          HT_ERRORF("Problem applying updates to range %s - %s",
+                    m_work[i].second->range->get_name().c_str(), e.what());
+          set_error(m_work[i].first, Error::EXTERNAL, e.what());
+        }
+      }
+      ScopedLock lock(m_mutex);
+      m_bytes_added += bytes_added;
+    }
+
+    /** Called by a helper before apply(); returns false if there is no
+     * work left, in which case the helper must not call apply().
+     */
+    bool helper_started() {
+      ScopedLock lock(m_mutex);
+      if (m_next == m_count)
+        return false;
+      m_active++;
+      return true;
+    }
+
+    void helper_finished() {
+      ScopedLock lock(m_mutex);
+      if (--m_active == 0)
+        m_cond.notify_all();
+    }
+
+    /** Called by the calling thread after apply().  Waits for the helpers
+     * still applying updates and returns the number of (non-METADATA)
+     * bytes applied.
+     */
+    uint64_t wait() {
+      ScopedLock lock(m_mutex);
+      while (m_active > 0)
+        m_cond.wait(lock);
+      return m_bytes_added;
+    }
+
+  private:
+    /** Fails the requests of the table update; the first error wins */
+    void set_error(TableUpdate *table_update, int error, const String &msg) {
+      ScopedLock lock(m_mutex);
+      if (table_update->error == Error::OK) {
+        table_update->error = error;
+        table_update->error_msg = msg;
+      }
+    }
+
+    RangeServer *m_rs;
+    std::vector<RangeApplyWork> &m_work;
+    size_t m_count;
+    Mutex m_mutex;
+    boost::condition m_cond;
+    size_t m_next;
+    size_t m_active;
+    uint64_t m_bytes_added;
+  };
+  typedef intrusive_ptr<UpdateApplyState> UpdateApplyStatePtr;
+
+  class UpdateApplyHandler : public ApplicationHandler {
+  public:
+    UpdateApplyHandler(UpdateApplyStatePtr &state) : m_state(state) { }
+
+    virtual void run() {
+      if (m_state->helper_started()) {
+        m_state->apply();
+        m_state->helper_finished();
+      }
+    }
+
+  private:
+    UpdateApplyStatePtr m_state;
+  };
+
 }
 
 
@@ -474,6 +716,7 @@ void RangeServer::local_recover() {
   std::vector<RangePtr> rangev;
   std::vector<MetaLog::EntityPtr> entities;
   MetaLog::EntityRange *range_entity;
+  std::vector<MetaLog::EntityRange *> load_entities;
 
   try {
     std::vector<MaintenanceTask*> maintenance_tasks;
@@ -512,13 +755,14 @@ void RangeServer::local_recover() {
       // clear the replay map
       m_replay_map->clear();
 
+      load_entities.clear();
       foreach(MetaLog::EntityPtr &entity, entities) {
         range_entity = dynamic_cast<MetaLog::EntityRange *>(entity.get());
         if (range_entity->table.is_metadata() &&
-            range_entity->spec.end_row && !strcmp(range_entity->spec.end_row, Key::END_ROOT_ROW)) {
-          replay_load_range(0, range_entity, false);
-        }
+            range_entity->spec.end_row && !strcmp(range_entity->spec.end_row, Key::END_ROOT_ROW))
+          load_entities.push_back(range_entity);
       }
+      replay_load_ranges(load_entities);
 
       if (!m_replay_map->empty()) {
         root_log_reader = new CommitLogReader(Global::log_dfs,
@@ -568,14 +812,15 @@ void RangeServer::local_recover() {
       // clear the replay map
       m_replay_map->clear();
 
+      load_entities.clear();
       foreach(MetaLog::EntityPtr &entity, entities) {
         range_entity = dynamic_cast<MetaLog::EntityRange *>(entity.get());
         if (range_entity->table.is_metadata() &&
             !(range_entity->spec.end_row &&
-              !strcmp(range_entity->spec.end_row, Key::END_ROOT_ROW))) {
-          replay_load_range(0, range_entity, false);
-        }
+              !strcmp(range_entity->spec.end_row, Key::END_ROOT_ROW)))
+          load_entities.push_back(range_entity);
       }
+      replay_load_ranges(load_entities);
 
       if (!m_replay_map->empty()) {
         metadata_log_reader =
@@ -627,11 +872,13 @@ void RangeServer::local_recover() {
       // clear the replay map
       m_replay_map->clear();
 
+      load_entities.clear();
       foreach(MetaLog::EntityPtr &entity, entities) {
         range_entity = dynamic_cast<MetaLog::EntityRange *>(entity.get());
         if (range_entity->table.is_system() && !range_entity->table.is_metadata())
-          replay_load_range(0, range_entity, false);
+          load_entities.push_back(range_entity);
       }
+      replay_load_ranges(load_entities);
 
       if (!m_replay_map->empty()) {
         system_log_reader =
@@ -683,11 +930,13 @@ void RangeServer::local_recover() {
       // clear the replay map
       m_replay_map->clear();
 
+      load_entities.clear();
       foreach(MetaLog::EntityPtr &entity, entities) {
         range_entity = dynamic_cast<MetaLog::EntityRange *>(entity.get());
         if (!range_entity->table.is_system())
-          replay_load_range(0, range_entity, false);
+          load_entities.push_back(range_entity);
       }
+      replay_load_ranges(load_entities);
 
       if (!m_replay_map->empty()) {
         user_log_reader = new CommitLogReader(Global::log_dfs,
@@ -717,7 +966,8 @@ void RangeServer::local_recover() {
 	  m_live_map->merge(m_replay_map);
 
         Global::user_log = new CommitLog(Global::log_dfs, Global::log_dir
-            + "/user", m_props, user_log_reader.get());
+            + "/user", m_props, user_log_reader.get(),
+          Global::local_log_dir);
         m_replay_finished = true;
         m_replay_finished_cond.notify_all();
       }
@@ -752,7 +1002,8 @@ void RangeServer::local_recover() {
             + "/system", m_props, system_log_reader.get());
 
       Global::user_log = new CommitLog(Global::log_dfs, Global::log_dir
-          + "/user", m_props, user_log_reader.get());
+          + "/user", m_props, user_log_reader.get(),
+          Global::local_log_dir);
 
       Global::rsml_writer = new MetaLog::Writer(Global::log_dfs, rsml_definition,
                                                 Global::log_dir + "/" + rsml_definition->name(),
@@ -907,7 +1158,7 @@ RangeServer::compact(ResponseCallback *cb, const TableIdentifier *table,
 void
 RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
     const TableIdentifier *table, const RangeSpec *range_spec,
-    const ScanSpec *scan_spec, QueryCache::Key *cache_key) {
+    const ScanSpec *scan_spec, QueryCache::Key *cache_key, uint32_t flags) {
   int error = Error::OK;
   String errmsg;
   TableInfoPtr table_info;
@@ -919,6 +1170,7 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
   ScanContextPtr scan_ctx;
   bool decrement_needed=false;
   const char *row = "";
+  short compact_flag = flags ? ScanBlock::FLAG_COMPACT : 0;
 
   HT_DEBUG_OUT <<"Creating scanner:\n"<< *table << *range_spec
                << *scan_spec << HT_END;
@@ -982,10 +1234,12 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
     if (cache_key && m_query_cache && !table->is_metadata()) {
       boost::shared_array<uint8_t> ext_buffer;
       uint32_t ext_len;
-      if (m_query_cache->lookup(cache_key, ext_buffer, &ext_len)) {
+      if (m_query_cache->lookup(cache_key, table->id, scan_spec->cache_key(),
+                                ext_buffer, &ext_len)) {
         // The first argument to the response method is flags and the
         // 0th bit is the EOS (end-of-scan) bit, hence the 1
-        if ((error = cb->response(1, id, ext_buffer, ext_len)) != Error::OK)
+        if ((error = cb->response(ScanBlock::FLAG_EOS | compact_flag, id,
+                                  ext_buffer, ext_len)) != Error::OK)
           HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
         range->decrement_scan_counter();
         decrement_needed = false;
@@ -995,6 +1249,7 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
 
     scan_ctx = new ScanContext(range->get_scan_revision(),
                                scan_spec, range_spec, schema);
+    scan_ctx->result_flags = flags;
 
     scanner = range->create_scanner(scan_ctx);
 
@@ -1042,13 +1297,27 @@ RangeServer::create_scanner(ResponseCallbackCreateScanner *cb,
       tablename_ptr = row_key_ptr + strlen(row_key_ptr) + 1;
       strcpy(tablename_ptr, table->id);
       boost::shared_array<uint8_t> ext_buffer(buffer);
-      if ((error = cb->response(1, id, ext_buffer, rbuf.fill())) != Error::OK) {
+      if ((error = cb->response(ScanBlock::FLAG_EOS | compact_flag, id,
+                                ext_buffer, rbuf.fill())) != Error::OK) {
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
       }
-      m_query_cache->insert(cache_key, tablename_ptr, row_key_ptr, ext_buffer, rbuf.fill());
+      // Record the column families the result depends on so that updates
+      // to other families don't invalidate it.  A scan of all columns
+      // depends on every family, including ones added later.
+      QueryCache::ColumnSet columns;
+      if (scan_spec->columns.empty())
+        columns.set();
+      else {
+        for (size_t i=0; i<256; i++)
+          if (scan_ctx->family_mask[i])
+            columns.set(i);
+      }
+      // The result is a single block, so cells_returned is its cell count
+      m_query_cache->insert(cache_key, tablename_ptr, row_key_ptr, columns,
+                            ext_buffer, rbuf.fill(), cells_returned);
     }
     else {
-      short moreflag = more ? 0 : 1;
+      short moreflag = (more ? 0 : ScanBlock::FLAG_EOS) | compact_flag;
       StaticBuffer ext(rbuf);
       if ((error = cb->response(moreflag, id, ext)) != Error::OK) {
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
@@ -1135,7 +1404,9 @@ RangeServer::fetch_scanblock(ResponseCallbackFetchScanblock *cb,
      *  Send back data
      */
     {
-      short moreflag = more ? 0 : 1;
+      short moreflag = more ? 0 : ScanBlock::FLAG_EOS;
+      if (scanner->scan_context()->result_flags)
+        moreflag |= ScanBlock::FLAG_COMPACT;
       StaticBuffer ext(rbuf);
 
       if ((error = cb->response(moreflag, scanner_id, ext)) != Error::OK)
@@ -1732,7 +2003,7 @@ RangeServer::update(ResponseCallbackUpdate *cb, const TableIdentifier *table,
 void
 RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expire_time) {
   const uint8_t *mod, *mod_end;
-  const char *row, *last_row;
+  const char *row;
   bool a_locked = false;
   bool b_locked = false;
   SerializedKey key;
@@ -1760,6 +2031,9 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
   uint32_t total_added = 0;
   uint32_t total_syncs = 0;
   uint64_t total_bytes_added = 0;
+  std::vector<RangeApplyWork> apply_work;
+  int64_t decode_start, log_write_start, apply_start, sync_time = 0;
+  BatchUpdateTrace batch_trace(updates);
 
   // This probably shouldn't happen for group commit, but since
   // it's only for testing purposes, we'll leave it here
@@ -1773,6 +2047,7 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
 
   m_update_mutex_a.lock();
   a_locked = true;
+  decode_start = Hypertable::get_ts64();
 
   // hack to workaround xen timestamp issue
   if (auto_revision < m_last_revision)
@@ -2138,8 +2413,13 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
 
   last_revision = m_last_revision;
 
+  log_write_start = Hypertable::get_ts64();
+  record_update_phase(StatsRangeServer::UPDATE_PHASE_DECODE,
+                      log_write_start - decode_start);
+
   m_update_mutex_b.lock();
   b_locked = true;
+  log_write_start = Hypertable::get_ts64();
 
   m_update_mutex_a.unlock();
   a_locked = false;
@@ -2203,48 +2483,33 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
         user_log_needs_syncing = true;
     }
 
-    // Iterate through all of the ranges, inserting updates
-    for (hash_map<Range *, RangeUpdateList *>::iterator iter = table_update->range_map.begin(); iter != table_update->range_map.end(); ++iter) {
-      ByteString value;
-      Key key_comps;
-
-      foreach (RangeUpdate &update, (*iter).second->updates) {
-        Range *rangep = (*iter).first;
-        Locker<Range> lock(*rangep);
-        uint8_t *ptr = update.bufp->base + update.offset;
-        uint8_t *end = ptr + update.len;
-
-        if (!table_update->id.is_metadata())
-          total_bytes_added += update.len;
-
-        rangep->add_bytes_written( update.len );
-        last_row = "";
-        uint64_t count = 0;
-        while (ptr < end) {
-          key.ptr = ptr;
-          key_comps.load(key);
-          count++;
-          if (key_comps.column_family_code == 0 && key_comps.flag != FLAG_DELETE_ROW) {
-            HT_ERRORF("Skipping bad key - column family not specified in non-delete row update on %s row=%s",
-                      table_update->id.id, key_comps.row);
-          }
-          ptr += key_comps.length;
-          value.ptr = ptr;
-          ptr += value.length();
-          rangep->add(key_comps, value);
-          // invalidate
-          if (m_query_cache && strcmp(last_row, key_comps.row))
-            m_query_cache->invalidate(table_update->id.id, key_comps.row);
-          last_row = key_comps.row;
-        }
-        rangep->add_cells_written(count);
-      }
-    }
+    // Queue up the ranges for inserting updates
+    for (hash_map<Range *, RangeUpdateList *>::iterator iter = table_update->range_map.begin(); iter != table_update->range_map.end(); ++iter)
+      apply_work.push_back(RangeApplyWork(table_update, (*iter).second));
   }
 
+  /**
+   * Insert the updates into the ranges, fanning the ranges out across the
+   * update apply threads if there is more than one of them
+   */
+  apply_start = Hypertable::get_ts64();
+  {
+    size_t helpers = 0;
+    if (m_update_apply_queue && apply_work.size() > 1)
+      helpers = std::min(m_update_apply_threads, apply_work.size() - 1);
+    UpdateApplyStatePtr apply_state = new UpdateApplyState(this, apply_work);
+    for (size_t i=0; i<helpers; i++)
+      m_update_apply_queue->add(new UpdateApplyHandler(apply_state));
+    apply_state->apply();
+    total_bytes_added += apply_state->wait();
+  }
+  record_update_phase(StatsRangeServer::UPDATE_PHASE_APPLY,
+                      Hypertable::get_ts64() - apply_start);
+
   // Now sync the USER commit log if needed
   if (user_log_needs_syncing) {
     size_t retry_count = 0;
+    sync_time = Hypertable::get_ts64();
     total_syncs++;
     while ((error = Global::user_log->sync()) != Error::OK) {
       HT_ERRORF("Problem sync'ing user log fragment (%s) - %s",
@@ -2254,7 +2519,10 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
         break;
       poll(0, 0, 10000);
     }
+    sync_time = Hypertable::get_ts64() - sync_time;
   }
+  record_update_phase(StatsRangeServer::UPDATE_PHASE_LOG_WRITE,
+                      (apply_start - log_write_start) + sync_time);
 
   if (Global::verbose && misses)
     HT_INFOF("Sent back %d updates because out-of-range", misses);
@@ -2335,6 +2603,7 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
         if ((error = cb.error(request->error, "")) != Error::OK)
           HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
       }
+      record_response_latency(StatsRangeServer::RPC_UPDATE, request->event.get());
     }
 
   }
@@ -2354,6 +2623,56 @@ RangeServer::batch_update(std::vector<TableUpdate *> &updates, boost::xtime expi
 }
 
 
+uint64_t
+RangeServer::apply_range_updates(TableUpdate *table_update,
+                                 RangeUpdateList *rulist) {
+  Range *rangep = rulist->range.get();
+  SerializedKey key;
+  ByteString value;
+  Key key_comps;
+  const char *last_row;
+  uint8_t last_column_family;
+  uint64_t bytes_added = 0;
+
+  foreach (RangeUpdate &update, rulist->updates) {
+    Locker<Range> lock(*rangep);
+    uint8_t *ptr = update.bufp->base + update.offset;
+    uint8_t *end = ptr + update.len;
+
+    bytes_added += update.len;
+
+    rangep->add_bytes_written( update.len );
+    last_row = "";
+    last_column_family = 0;
+    uint64_t count = 0;
+    while (ptr < end) {
+      key.ptr = ptr;
+      key_comps.load(key);
+      count++;
+      if (key_comps.column_family_code == 0 && key_comps.flag != FLAG_DELETE_ROW) {
+        HT_ERRORF("Skipping bad key - column family not specified in non-delete row update on %s row=%s",
+                  table_update->id.id, key_comps.row);
+      }
+      ptr += key_comps.length;
+      value.ptr = ptr;
+      ptr += value.length();
+      rangep->add(key_comps, value);
+      // invalidate
+      if (m_query_cache &&
+          (key_comps.column_family_code != last_column_family ||
+           strcmp(last_row, key_comps.row)))
+        m_query_cache->invalidate(table_update->id.id, key_comps.row,
+                                  key_comps.column_family_code);
+      last_row = key_comps.row;
+      last_column_family = key_comps.column_family_code;
+    }
+    rangep->add_cells_written(count);
+  }
+
+  return bytes_added;
+}
+
+
 
 void
 RangeServer::drop_table(ResponseCallback *cb, const TableIdentifier *table) {
@@ -2564,6 +2883,18 @@ void RangeServer::get_statistics(ResponseCallbackGetStatistics *cb) {
                                    &m_stats->block_cache_accesses,
                                    &m_stats->block_cache_hits);
 
+  // Latency histograms cover the same period as the monitoring counters;
+  // fetches within a period return the previous period's histograms
+  if (timestamp - m_latency_timestamp >= m_latency_interval) {
+    for (int i=0; i<StatsRangeServer::RPC_TYPE_COUNT; i++) {
+      m_queue_latency[i].reset_into(m_stats->queue_latency[i]);
+      m_response_latency[i].reset_into(m_stats->response_latency[i]);
+    }
+    for (int i=0; i<StatsRangeServer::UPDATE_PHASE_COUNT; i++)
+      m_update_phase_latency[i].reset_into(m_stats->update_phase_latency[i]);
+    m_latency_timestamp = timestamp;
+  }
+
   TableMutatorPtr mutator;
   if (now > m_next_metrics_update) {
     ScopedLock lock(m_mutex);
@@ -2668,12 +2999,19 @@ void RangeServer::get_statistics(ResponseCallbackGetStatistics *cb) {
                              &m_stats->query_cache_available_memory,
                              &m_stats->query_cache_accesses,
                              &m_stats->query_cache_hits);
+    m_stats->query_cache_shards.resize(m_query_cache->shard_count());
+    for (size_t i=0; i<m_stats->query_cache_shards.size(); i++) {
+      StatsRangeServer::QueryCacheShard &shard = m_stats->query_cache_shards[i];
+      m_query_cache->get_shard_stats(i, &shard.accesses, &shard.hits,
+                                     &shard.negative_hits);
+    }
   }
   else {
     m_stats->query_cache_max_memory = 0;
     m_stats->query_cache_available_memory = 0;
     m_stats->query_cache_accesses = 0;
     m_stats->query_cache_hits = 0;
+    m_stats->query_cache_shards.clear();
   }
 
   if (Global::block_cache) {
@@ -2786,55 +3124,74 @@ RangeServer::replay_load_range(ResponseCallback *cb,
 
   try {
 
-    /** Get TableInfo from replay map, or copy it from live map, or create if
-     * doesn't exist **/
-    if (!m_replay_map->get(range_entity->table.id, table_info)) {
-      table_info = new TableInfo(m_master_client, &range_entity->table, schema);
-      register_table = true;
-    }
+    /**
+     * Ranges may be replay loaded concurrently (see replay_load_ranges), so
+     * the table registration is serialized but the (expensive) Range
+     * construction, which opens the CellStores, is not.
+     */
+    {
+      ScopedLock lock(m_replay_load_mutex);
 
-    if (!m_live_map->get(range_entity->table.id, live_table_info))
-      live_table_info = table_info;
+      /** Get TableInfo from replay map, or copy it from live map, or create if
+       * doesn't exist **/
+      if (!m_replay_map->get(range_entity->table.id, table_info)) {
+        table_info = new TableInfo(m_master_client, &range_entity->table, schema);
+        register_table = true;
+      }
 
-    // Verify schema, this will create the Schema object and add it to
-    // table_info if it doesn't exist
-    verify_schema(table_info, range_entity->table.generation);
+      if (!m_live_map->get(range_entity->table.id, live_table_info))
+        live_table_info = table_info;
 
-    if (register_table)
-      m_replay_map->set(range_entity->table.id, table_info);
+      // Verify schema, this will create the Schema object and add it to
+      // table_info if it doesn't exist
+      verify_schema(table_info, range_entity->table.generation);
 
-    /**
-     * Make sure this range is not already loaded
-     */
-    if (table_info->get_range(&range_entity->spec, range) ||
-        live_table_info->get_range(&range_entity->spec, range))
-      HT_THROWF(Error::RANGESERVER_RANGE_ALREADY_LOADED, "%s[%s..%s]",
-                range_entity->table.id, range_entity->spec.start_row, range_entity->spec.end_row);
+      if (register_table)
+        m_replay_map->set(range_entity->table.id, table_info);
 
-    /**
-     * Lazily create sys/METADATA table pointer
-     */
-    if (!Global::metadata_table) {
-      ScopedLock lock(m_mutex);
-      uint32_t timeout_ms = m_props->get_i32("Hypertable.Request.Timeout");
-      if (!Global::range_locator)
-        Global::range_locator = new Hypertable::RangeLocator(m_props, m_conn_manager,
-                                                             Global::hyperspace, timeout_ms);
-      Global::metadata_table = new Table(m_props, Global::range_locator, m_conn_manager,
-          Global::hyperspace, m_app_queue, m_namemap, TableIdentifier::METADATA_NAME,
-          timeout_ms);
-    }
+      /**
+       * Make sure this range is not already loaded
+       */
+      if (table_info->get_range(&range_entity->spec, range) ||
+          live_table_info->get_range(&range_entity->spec, range))
+        HT_THROWF(Error::RANGESERVER_RANGE_ALREADY_LOADED, "%s[%s..%s]",
+                  range_entity->table.id, range_entity->spec.start_row, range_entity->spec.end_row);
 
-    schema = table_info->get_schema();
+      /**
+       * Lazily create sys/METADATA table pointer
+       */
+      if (!Global::metadata_table) {
+        ScopedLock lock(m_mutex);
+        uint32_t timeout_ms = m_props->get_i32("Hypertable.Request.Timeout");
+        if (!Global::range_locator)
+          Global::range_locator = new Hypertable::RangeLocator(m_props, m_conn_manager,
+                                                               Global::hyperspace, timeout_ms);
+        Global::metadata_table = new Table(m_props, Global::range_locator, m_conn_manager,
+            Global::hyperspace, m_app_queue, m_namemap, TableIdentifier::METADATA_NAME,
+            timeout_ms);
+      }
+
+      schema = table_info->get_schema();
+    }
 
     range = new Range(m_master_client, schema, range_entity, live_table_info.get());
 
     range->recovery_initialize();
 
-    table_info->add_range(range);
+    {
+      ScopedLock lock(m_replay_load_mutex);
+      RangePtr loaded_range;
 
-    if (write_rsml)
-      Global::rsml_writer->record_state( range->metalog_entity() );
+      // Another worker may have loaded the same range in the meantime
+      if (table_info->get_range(&range_entity->spec, loaded_range) ||
+          live_table_info->get_range(&range_entity->spec, loaded_range))
+        HT_THROWF(Error::RANGESERVER_RANGE_ALREADY_LOADED, "%s[%s..%s]",
+                  range_entity->table.id, range_entity->spec.start_row, range_entity->spec.end_row);
+
+      table_info->add_range(range);
+      if (write_rsml)
+        Global::rsml_writer->record_state( range->metalog_entity() );
+    }
 
     if (cb && (error = cb->response_ok()) != Error::OK) {
       HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
@@ -2850,10 +3207,46 @@ RangeServer::replay_load_range(ResponseCallback *cb,
     if (cb && (error = cb->error(e.code(), e.what())) != Error::OK)
       HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
   }
+  catch (std::exception &e) {
+    HT_ERRORF("Problem replay loading range %s[%s..%s] - %s",
+              range_entity->table.id, range_entity->spec.start_row,
+              range_entity->spec.end_row, e.what());
+    if (cb && (error = cb->error(Error::LOCAL_IO_ERROR, e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
 }
 
 
 
+void
+RangeServer::replay_load_ranges(std::vector<MetaLog::EntityRange *> &entities) {
+  Stopwatch stopwatch;
+  size_t thread_count = m_props->get_i32("Hypertable.RangeServer.Range.LoadThreads");
+  size_t next = 0;
+  Mutex mutex;
+
+  if (entities.empty())
+    return;
+
+  if (thread_count == 0)
+    thread_count = 1;
+  if (thread_count > entities.size())
+    thread_count = entities.size();
+
+  {
+    ThreadGroup threads;
+    for (size_t i=0; i<thread_count; i++)
+      threads.create_thread(ReplayLoadWorker(this, entities, mutex, next));
+    threads.join_all();
+  }
+
+  stopwatch.stop();
+  HT_INFOF("Replay loaded %u ranges with %u threads in %.3f seconds",
+           (unsigned)entities.size(), (unsigned)thread_count,
+           stopwatch.elapsed());
+}
+
+
 void
 RangeServer::replay_update(ResponseCallback *cb, const uint8_t *data,
                            size_t len) {
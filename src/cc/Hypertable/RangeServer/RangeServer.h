@@ -27,8 +27,10 @@
 #include <map>
 
 #include "Common/Logger.h"
+#include "Common/LatencyHistogram.h"
 #include "Common/Properties.h"
 #include "Common/HashMap.h"
+#include "Common/Time.h"
 
 #include "AsyncComm/ApplicationQueue.h"
 #include "AsyncComm/Comm.h"
@@ -64,6 +66,7 @@ namespace Hypertable {
   using namespace Hyperspace;
 
   class ConnectionHandler;
+  class RangeUpdateList;
   class TableUpdate;
 
   class RangeServer : public ReferenceCount {
@@ -78,7 +81,7 @@ namespace Hypertable {
     void create_scanner(ResponseCallbackCreateScanner *,
                         const TableIdentifier *,
                         const  RangeSpec *, const ScanSpec *,
-			QueryCache::Key *);
+			QueryCache::Key *, uint32_t flags = 0);
     void destroy_scanner(ResponseCallback *cb, uint32_t scanner_id);
     void fetch_scanblock(ResponseCallbackFetchScanblock *, uint32_t scanner_id);
     void load_range(ResponseCallback *, const TableIdentifier *,
@@ -92,6 +95,17 @@ namespace Hypertable {
                 uint32_t count, StaticBuffer &, uint32_t flags);
     void batch_update(std::vector<TableUpdate *> &updates, boost::xtime expire_time);
 
+    /** Inserts the cells accumulated for one range by batch_update() into
+     * the range.  Called from the update apply threads, at most one thread
+     * per range at a time.
+     *
+     * @param table_update table update the cells belong to
+     * @param rulist cells to insert
+     * @return number of bytes inserted
+     */
+    uint64_t apply_range_updates(TableUpdate *table_update,
+                                 RangeUpdateList *rulist);
+
     void commit_log_sync(ResponseCallback *, const TableIdentifier *);
     void drop_table(ResponseCallback *, const TableIdentifier *);
     void dump(ResponseCallback *, const char *, bool);
@@ -146,16 +160,42 @@ namespace Hypertable {
 
     void shutdown();
 
+    /** Records the time a request spent queued before being picked up by
+     * a worker thread.  Lock-free; called from the request handlers.
+     */
+    void record_queue_latency(int rpc_type, const Event *event) {
+      if (event->arrival_hrtime)
+        m_queue_latency[rpc_type].record(elapsed_micros(event));
+    }
+
+    /** Records the time from request arrival until its response was sent.
+     */
+    void record_response_latency(int rpc_type, const Event *event) {
+      if (event->arrival_hrtime)
+        m_response_latency[rpc_type].record(elapsed_micros(event));
+    }
+
   private:
     void initialize(PropertiesPtr &);
     void local_recover();
     void replay_log(CommitLogReaderPtr &log_reader);
+    void replay_load_ranges(std::vector<MetaLog::EntityRange *> &entities);
     void verify_schema(TableInfoPtr &, uint32_t generation);
     void transform_key(ByteString &bskey, DynamicBuffer *dest_bufp,
                        int64_t revision, int64_t *revisionp);
 
+    void record_update_phase(int phase, int64_t nanos) {
+      m_update_phase_latency[phase].record(nanos > 0 ? (uint64_t)nanos / 1000 : 0);
+    }
+
+    static uint64_t elapsed_micros(const Event *event) {
+      int64_t elapsed = get_ts64() - event->arrival_hrtime;
+      return elapsed > 0 ? (uint64_t)elapsed / 1000 : 0;
+    }
+
     Mutex                  m_mutex;
     Mutex                  m_drop_table_mutex;
+    Mutex                  m_replay_load_mutex;
     boost::condition       m_root_replay_finished_cond;
     boost::condition       m_metadata_replay_finished_cond;
     boost::condition       m_system_replay_finished_cond;
@@ -200,6 +240,8 @@ namespace Hypertable {
     GroupCommitTimerHandler *m_group_commit_timer_handler;
     uint32_t               m_update_delay;
     QueryCache            *m_query_cache;
+    ApplicationQueuePtr    m_update_apply_queue;
+    size_t                 m_update_apply_threads;
     int64_t                m_last_revision;
     int64_t                m_scanner_buffer_size;
     time_t                 m_next_metrics_update;
@@ -209,6 +251,11 @@ namespace Hypertable {
     size_t                 m_metric_samples;
     size_t                 m_cores;
     CellsBuilder          *m_pending_metrics_updates;
+    LatencyHistogram       m_queue_latency[StatsRangeServer::RPC_TYPE_COUNT];
+    LatencyHistogram       m_response_latency[StatsRangeServer::RPC_TYPE_COUNT];
+    LatencyHistogram       m_update_phase_latency[StatsRangeServer::UPDATE_PHASE_COUNT];
+    int64_t                m_latency_interval;
+    int64_t                m_latency_timestamp;
   };
 
   typedef intrusive_ptr<RangeServer> RangeServerPtr;
@@ -48,21 +48,36 @@ void RequestHandlerCreateScanner::run() {
   const uint8_t *base;
   QueryCache::Key key;
 
+  m_range_server->record_queue_latency(StatsRangeServer::RPC_CREATE_SCANNER,
+                                       m_event_ptr.get());
+
   try {
     base = decode_ptr;
     table.decode(&decode_ptr, &decode_remain);
     range.decode(&decode_ptr, &decode_remain);
     scan_spec.decode(&decode_ptr, &decode_remain);
 
+    // Optional create scanner flags, sent only by clients that use them
+    uint32_t flags = 0;
+    if (decode_remain >= 4)
+      flags = Serialization::decode_i32(&decode_ptr, &decode_remain);
+
+    // The flags are part of the cache key, since they select the encoding
+    // of the cached scan block
     if (scan_spec.cacheable()) {
       md5_csum((unsigned char *)base, decode_ptr-base, key.digest);
-      m_range_server->create_scanner(&cb, &table, &range, &scan_spec, &key);
+      m_range_server->create_scanner(&cb, &table, &range, &scan_spec, &key,
+                                     flags);
     }
     else
-      m_range_server->create_scanner(&cb, &table, &range, &scan_spec, 0);
+      m_range_server->create_scanner(&cb, &table, &range, &scan_spec, 0,
+                                     flags);
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
     cb.error(Error::PROTOCOL_ERROR, "Error handling create scanner message");
   }
+
+  m_range_server->record_response_latency(StatsRangeServer::RPC_CREATE_SCANNER,
+                                          m_event_ptr.get());
 }
@@ -42,6 +42,9 @@ void RequestHandlerFetchScanblock::run() {
   const uint8_t *decode_ptr = m_event_ptr->payload;
   size_t decode_remain = m_event_ptr->payload_len;
 
+  m_range_server->record_queue_latency(StatsRangeServer::RPC_FETCH_SCANBLOCK,
+                                       m_event_ptr.get());
+
   try {
     uint32_t scanner_id = decode_i32(&decode_ptr, &decode_remain);
 
@@ -51,4 +54,7 @@ void RequestHandlerFetchScanblock::run() {
     HT_ERROR_OUT << e << HT_END;
     cb.error(e.code(), "Error handling FetchScanblock message");
   }
+
+  m_range_server->record_response_latency(StatsRangeServer::RPC_FETCH_SCANBLOCK,
+                                          m_event_ptr.get());
 }
@@ -47,6 +47,9 @@ void RequestHandlerLoadRange::run() {
   const uint8_t *decode_ptr = m_event_ptr->payload;
   size_t decode_remain = m_event_ptr->payload_len;
 
+  m_range_server->record_queue_latency(StatsRangeServer::RPC_LOAD_RANGE,
+                                       m_event_ptr.get());
+
   try {
     table.decode(&decode_ptr, &decode_remain);
     range.decode(&decode_ptr, &decode_remain);
@@ -60,4 +63,7 @@ void RequestHandlerLoadRange::run() {
     HT_ERROR_OUT << e << HT_END;
     cb.error(e.code(), "Error handling LoadRange message");
   }
+
+  m_range_server->record_response_latency(StatsRangeServer::RPC_LOAD_RANGE,
+                                          m_event_ptr.get());
 }
@@ -22,6 +22,8 @@
 #include "Common/Compat.h"
 #include "Common/Error.h"
 #include "Common/Logger.h"
+#include "Common/Time.h"
+#include "Common/Trace.h"
 
 #include "AsyncComm/ResponseCallback.h"
 #include "Common/Serialization.h"
@@ -43,6 +45,15 @@ void RequestHandlerUpdate::run() {
   size_t decode_remain = m_event_ptr->payload_len;
   StaticBuffer mods;
 
+  m_range_server->record_queue_latency(StatsRangeServer::RPC_UPDATE,
+                                       m_event_ptr.get());
+
+  uint64_t trace_id = m_event_ptr->header.trace_id;
+  if (trace_id)
+    Trace::record(trace_id, "rs.update.queue", m_event_ptr->arrival_hrtime,
+                  get_ts64());
+  TraceScope trace(trace_id, "rs.update");
+
   try {
     table.decode(&decode_ptr, &decode_remain);
     uint32_t count = Serialization::decode_i32(&decode_ptr, &decode_remain);
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Serialization.h"
+
+#include <cstring>
+
+#include "RowPrefixExtractor.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+
+
+RowPrefixExtractor::RowPrefixExtractor(PropertiesPtr &props)
+  : m_type(NONE), m_delimiter(0), m_value(0) {
+  int32_t length = props->get_i32("prefix-length", 0);
+  int32_t count = props->get_i32("prefix-delimiter-count", 0);
+  String delimiter = props->get_str("prefix-delimiter", String(":"));
+
+  if (length > 0) {
+    m_type = FIXED_LENGTH;
+    m_value = length;
+  }
+  else if (count > 0) {
+    if (delimiter.length() != 1)
+      HT_THROWF(Error::BAD_SCHEMA, "bad bloom filter prefix delimiter '%s', "
+                "must be a single character", delimiter.c_str());
+    m_type = DELIMITER;
+    m_delimiter = delimiter[0];
+    m_value = count;
+  }
+  else
+    HT_THROW(Error::BAD_SCHEMA, "prefix bloom filter requires "
+             "--prefix-length or --prefix-delimiter-count");
+}
+
+
+int RowPrefixExtractor::extract(const char *row, size_t len) const {
+
+  if (m_type == FIXED_LENGTH)
+    return len >= m_value ? (int)m_value : -1;
+
+  if (m_type == DELIMITER) {
+    uint32_t seen = 0;
+    for (size_t i=0; i<len; i++) {
+      if (row[i] == m_delimiter && ++seen == m_value)
+        return (int)i;
+    }
+  }
+
+  return -1;
+}
+
+
+/**
+ * Every row between two rows shares their common prefix.  If the end row
+ * is exclusive and is the start row's prefix with the last byte
+ * incremented (the form of a "starts with" interval), the rows also share
+ * the start row up to and including that byte.
+ */
+int RowPrefixExtractor::extract(const char *start_row, const char *end_row,
+                                bool end_inclusive) const {
+  size_t common = 0;
+
+  while (start_row[common] && start_row[common] == end_row[common])
+    ++common;
+
+  if (!end_inclusive && start_row[common] && end_row[common + 1] == 0 &&
+      (uint8_t)end_row[common] == (uint8_t)start_row[common] + 1)
+    ++common;
+
+  return extract(start_row, common);
+}
+
+
+void RowPrefixExtractor::encode(uint8_t **bufp) const {
+  encode_i8(bufp, m_type);
+  encode_i8(bufp, (uint8_t)m_delimiter);
+  encode_i32(bufp, m_value);
+}
+
+
+void RowPrefixExtractor::decode(const uint8_t **bufp, size_t *remainp) {
+  m_type = decode_i8(bufp, remainp);
+  m_delimiter = (char)decode_i8(bufp, remainp);
+  m_value = decode_i32(bufp, remainp);
+}
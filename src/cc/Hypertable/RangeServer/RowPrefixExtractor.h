@@ -0,0 +1,84 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_ROWPREFIXEXTRACTOR_H
+#define HYPERTABLE_ROWPREFIXEXTRACTOR_H
+
+#include "Common/Properties.h"
+
+namespace Hypertable {
+
+  /**
+   * Maps a row key to the prefix under which it is entered into a
+   * BLOOM_FILTER_ROWS_PREFIX bloom filter: either the first <i>length</i>
+   * bytes of the row, or everything before the <i>count</i>th occurrence
+   * of a delimiter character.  Rows that are too short have no prefix and
+   * are not entered into the filter.
+   */
+  class RowPrefixExtractor {
+  public:
+    enum Type { NONE = 0, FIXED_LENGTH = 1, DELIMITER = 2 };
+
+    static const size_t ENCODED_LENGTH = 6;
+
+    RowPrefixExtractor() : m_type(NONE), m_delimiter(0), m_value(0) { }
+
+    /** Sets up the extractor from parsed bloom filter options
+     * (--prefix-length, or --prefix-delimiter and --prefix-delimiter-count).
+     * Throws an Exception if neither is given.
+     */
+    RowPrefixExtractor(PropertiesPtr &props);
+
+    bool empty() const { return m_type == NONE; }
+
+    /** Returns the length of the prefix of a row, or -1 if the row has
+     * no prefix.
+     *
+     * @param row row key
+     * @param len length of row key
+     * @return length of prefix, or -1
+     */
+    int extract(const char *row, size_t len) const;
+
+    /** Returns the length of the prefix shared by every row in a row
+     * interval, or -1 if the rows of the interval may have different
+     * prefixes.  The prefix is taken from the start row.
+     *
+     * @param start_row start row (inclusive)
+     * @param end_row end row
+     * @param end_inclusive true if end_row itself is part of the interval
+     * @return length of prefix, or -1
+     */
+    int extract(const char *start_row, const char *end_row,
+                bool end_inclusive) const;
+
+    void encode(uint8_t **bufp) const;
+    void decode(const uint8_t **bufp, size_t *remainp);
+
+  private:
+    uint8_t m_type;
+    char m_delimiter;
+    uint32_t m_value;
+  };
+
+}
+
+#endif // HYPERTABLE_ROWPREFIXEXTRACTOR_H
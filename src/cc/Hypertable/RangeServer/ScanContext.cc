@@ -49,6 +49,7 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
   now = ((int64_t)xtnow.sec * 1000000000LL) + (int64_t)xtnow.nsec;
 
   revision = (rev == TIMESTAMP_NULL) ? TIMESTAMP_MAX : rev;
+  result_flags = 0;
 
   // set time interval
   if (ss) {
@@ -350,6 +351,7 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
         HT_THROW(Error::BAD_SCAN_SPEC, (String)"Can't convert row_regexp "
             + spec->row_regexp + " to regexp -" + row_regexp->error_arg());
       }
+      row_regexp_intervals = new RegexpRowIntervals(spec->row_regexp);
     }
     if (spec->value_regexp && *spec->value_regexp != 0) {
       value_regexp = new RE2(spec->value_regexp);
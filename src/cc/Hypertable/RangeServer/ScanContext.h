@@ -34,6 +34,7 @@
 #include "Common/StringExt.h"
 
 #include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/RegexpRowIntervals.h"
 #include "Hypertable/Lib/Schema.h"
 #include "Hypertable/Lib/ScanSpec.h"
 #include "Hypertable/Lib/Types.h"
@@ -142,9 +143,11 @@ namespace Hypertable {
     bool family_mask[256];
     vector<CellFilterInfo> family_info;
     RE2 *row_regexp;
+    RegexpRowIntervals *row_regexp_intervals;  // rows row_regexp can match
     RE2 *value_regexp;
     typedef std::set<const char *, LtCstr, CstrAlloc> CstrRowSet;
     CstrRowSet rowset;
+    uint32_t result_flags;  // RangeServerProtocol::CREATE_SCANNER_FLAG_*
 
     /**
      * Constructor.
@@ -155,7 +158,8 @@ namespace Hypertable {
      * @param schema smart pointer to schema object
      */
     ScanContext(int64_t rev, const ScanSpec *ss, const RangeSpec *range,
-                SchemaPtr &schema) : family_info(256), row_regexp(0), value_regexp(0) {
+                SchemaPtr &schema) : family_info(256), row_regexp(0),
+        row_regexp_intervals(0), value_regexp(0) {
       initialize(rev, ss, range, schema);
     }
 
@@ -166,7 +170,7 @@ namespace Hypertable {
      * @param schema smart pointer to schema object
      */
     ScanContext(int64_t rev, SchemaPtr &schema) : family_info(256), row_regexp(0),
-        value_regexp(0) {
+        row_regexp_intervals(0), value_regexp(0) {
       initialize(rev, 0, 0, schema);
     }
 
@@ -175,7 +179,8 @@ namespace Hypertable {
      *
      * @param rev scan revision
      */
-    ScanContext(int64_t rev=TIMESTAMP_MAX) : family_info(256), row_regexp(0), value_regexp(0) {
+    ScanContext(int64_t rev=TIMESTAMP_MAX) : family_info(256), row_regexp(0),
+        row_regexp_intervals(0), value_regexp(0) {
       SchemaPtr schema;
       initialize(rev, 0, 0, schema);
     }
@@ -185,7 +190,8 @@ namespace Hypertable {
      *
      * @param schema smart pointer to schema object
      */
-    ScanContext(SchemaPtr &schema) : family_info(256), row_regexp(0), value_regexp(0) {
+    ScanContext(SchemaPtr &schema) : family_info(256), row_regexp(0),
+        row_regexp_intervals(0), value_regexp(0) {
       initialize(TIMESTAMP_MAX, 0, 0, schema);
     }
 
@@ -193,6 +199,7 @@ namespace Hypertable {
       if (row_regexp != 0) {
         delete row_regexp;
       }
+      delete row_regexp_intervals;
       if (value_regexp != 0) {
         delete value_regexp;
       }
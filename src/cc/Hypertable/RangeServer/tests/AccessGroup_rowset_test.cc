@@ -0,0 +1,308 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/Usage.h"
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanSpec.h"
+#include "Hypertable/Lib/Schema.h"
+#include "Hypertable/Lib/SerializedKey.h"
+
+#include "../AccessGroup.h"
+#include "../CellStoreV5.h"
+#include "../FileBlockCache.h"
+#include "../Global.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: AccessGroup_rowset_test",
+    "",
+    "  This program tests scan and filter rows scans over an access group",
+    "  with several bloom filtered cell stores.  Each scan asks for a set",
+    "  of rows, some of which are held by only one of the stores and some",
+    "  by none, and must return every cell of the requested rows.",
+    (const char *)0
+  };
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>tag</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const int ROW_COUNT = 200;
+
+  typedef map<String, vector<String> > CellMap;
+
+  String row_key(int i) {
+    return format("row%04d", i);
+  }
+
+  /**
+   * Creates a cell store holding <code>qualifiers</code> cells of column
+   * family "tag" for each of the given rows, and records the cells in
+   * <code>cells</code>.  The blocks are small, so that rows straddle block
+   * boundaries.
+   */
+  CellStorePtr create_store(const String &fname, SchemaPtr &schema,
+                            const vector<int> &rows, const char *prefix,
+                            int qualifiers, CellMap &cells) {
+    TableIdentifier table_id("1");
+    PropertiesPtr cs_props = new Properties();
+    cs_props->set("blocksize", uint32_t(64));
+    Schema::parse_bloom_filter("rows", cs_props);
+
+    CellStorePtr cs = new CellStoreV5(Global::dfs.get(), schema.get());
+    cs->create(fname.c_str(), rows.size() * qualifiers, cs_props);
+
+    uint8_t valuebuf[16];
+    uint8_t *uptr = valuebuf;
+    Serialization::encode_vi32(&uptr, 1);
+    *uptr = 'v';
+    ByteString bsvalue;
+    bsvalue.ptr = valuebuf;
+
+    // room for every key up front, so earlier keys never move
+    DynamicBuffer dbuf(rows.size() * qualifiers * 64);
+    SerializedKey serkey;
+    Key key;
+    int64_t timestamp = 1;
+
+    foreach(int i, rows) {
+      String row = row_key(i);
+      for (int q=0; q<qualifiers; q++) {
+        String qualifier = format("%s%d", prefix, q);
+        serkey.ptr = dbuf.ptr;
+        create_key_and_append(dbuf, FLAG_INSERT, row.c_str(), 1,
+                              qualifier.c_str(), timestamp, timestamp);
+        timestamp++;
+        key.load(serkey);
+        cs->add(key, bsvalue);
+        cells[row].push_back(qualifier);
+      }
+    }
+
+    cs->finalize(&table_id);
+    return cs;
+  }
+
+  /**
+   * Scans the access group for the given rows and checks that exactly the
+   * cells of the requested rows come back, in order.
+   */
+  void check_scan(AccessGroup &ag, SchemaPtr &schema, RangeSpec &range,
+                  const set<String> &rows, CellMap &cells) {
+    ScanSpecBuilder ssbuilder;
+    vector<String> expected, found;
+
+    ssbuilder.set_scan_and_filter_rows(true);
+    foreach(const String &row, rows) {
+      ssbuilder.add_row(row.c_str());
+      CellMap::iterator iter = cells.find(row);
+      if (iter != cells.end()) {
+        set<String> qualifiers(iter->second.begin(), iter->second.end());
+        foreach(const String &qualifier, qualifiers)
+          expected.push_back(row + " " + qualifier);
+      }
+    }
+
+    ScanContextPtr scan_ctx = new ScanContext(TIMESTAMP_MAX,
+        &(ssbuilder.get()), &range, schema);
+    CellListScannerPtr scanner = ag.create_scanner(scan_ctx);
+    Key key;
+    ByteString value;
+
+    while (scanner->get(key, value)) {
+      found.push_back(String(key.row) + " " + key.column_qualifier);
+      scanner->forward();
+    }
+
+    if (found != expected) {
+      HT_ERRORF("Scan of %d rows (%s..%s) returned %d cells, expected %d",
+                (int)rows.size(), rows.begin()->c_str(),
+                rows.rbegin()->c_str(), (int)found.size(),
+                (int)expected.size());
+      for (size_t i=0; i<found.size() || i<expected.size(); i++) {
+        if (i >= found.size() || i >= expected.size() ||
+            found[i] != expected[i]) {
+          HT_ERRORF("first difference at %d: got '%s', expected '%s'", (int)i,
+                    i < found.size() ? found[i].c_str() : "",
+                    i < expected.size() ? expected[i].c_str() : "");
+          break;
+        }
+      }
+      exit(1);
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs.get();
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::block_cache = new FileBlockCache(100000LL, 100000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    String testdir = "/AccessGroup_rowset_test";
+    client->rmdir(testdir);
+    client->mkdirs(testdir);
+    Global::toplevel_dir = testdir;
+
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+    if (!schema->is_valid()) {
+      HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+      exit(1);
+    }
+
+    CellMap cells;
+    vector<int> all_rows, some_rows, high_rows;
+
+    for (int i=0; i<ROW_COUNT; i++) {
+      all_rows.push_back(i);
+      if (i % 10 == 3)
+        some_rows.push_back(i);
+    }
+    for (int i=ROW_COUNT+100; i<ROW_COUNT+150; i++)
+      high_rows.push_back(i);
+
+    // rows 200..299 are in none of the stores
+    CellStorePtr cs0 = create_store(testdir + "/cs0", schema, all_rows,
+                                    "a", 3, cells);
+    CellStorePtr cs1 = create_store(testdir + "/cs1", schema, some_rows,
+                                    "x", 2, cells);
+    CellStorePtr cs2 = create_store(testdir + "/cs2", schema, high_rows,
+                                    "m", 1, cells);
+
+    TableIdentifier table_id("1");
+    RangeSpec range;
+    range.start_row = "";
+    range.end_row = Key::END_ROW_MARKER;
+
+    AccessGroup ag(&table_id, schema, schema->get_access_group("default"),
+                   &range);
+    ag.add_cell_store(cs0);
+    ag.add_cell_store(cs1);
+    ag.add_cell_store(cs2);
+
+    /**
+     * Every stride and offset, so that each row is asked for at the start
+     * and at the end of a block of each store, together with rows that no
+     * store holds, including ones before the first and after the last row
+     */
+    int strides[] = { 1, 2, 3, 7, 16, 0 };
+    for (int s=0; strides[s]; s++) {
+      for (int offset=0; offset<strides[s]; offset++) {
+        set<String> rows;
+        for (int i=offset; i<ROW_COUNT+150; i+=strides[s]) {
+          rows.insert(row_key(i));
+          if (i % 5 == 0)
+            rows.insert(row_key(i) + "a");
+        }
+        check_scan(ag, schema, range, rows, cells);
+        rows.insert("aaa");
+        rows.insert("zzz");
+        check_scan(ag, schema, range, rows, cells);
+      }
+    }
+
+    // rows held by a single store only
+    {
+      set<String> rows;
+      foreach(int i, some_rows)
+        rows.insert(row_key(i));
+      check_scan(ag, schema, range, rows, cells);
+      rows.clear();
+      foreach(int i, high_rows)
+        rows.insert(row_key(i));
+      check_scan(ag, schema, range, rows, cells);
+    }
+
+    // first and last row of the table
+    {
+      set<String> rows;
+      rows.insert(row_key(0));
+      rows.insert(row_key(ROW_COUNT+149));
+      check_scan(ag, schema, range, rows, cells);
+    }
+
+    // rows that no store holds
+    {
+      set<String> rows;
+      rows.insert(row_key(5) + "a");
+      rows.insert(row_key(ROW_COUNT+50));
+      rows.insert("zzz");
+      check_scan(ag, schema, range, rows, cells);
+    }
+
+    client->rmdir(testdir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
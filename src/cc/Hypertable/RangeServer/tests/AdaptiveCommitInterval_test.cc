@@ -0,0 +1,98 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <iostream>
+
+#include "Hypertable/RangeServer/AdaptiveCommitInterval.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  void check_uncontended() {
+    AdaptiveCommitInterval interval(10);
+
+    HT_ASSERT(interval.wait_ms() == 0);
+    HT_ASSERT(interval.average_us() == 0);
+
+    // a single request per commit never waits, however slow the sync
+    interval.record_commit(1, 40000);
+    HT_ASSERT(interval.average_us() == 40000);
+    HT_ASSERT(interval.wait_ms() == 0);
+  }
+
+  void check_average() {
+    AdaptiveCommitInterval interval(10);
+
+    // the first commit seeds the average
+    interval.record_commit(3, 4000);
+    HT_ASSERT(interval.average_us() == 4000);
+    HT_ASSERT(interval.wait_ms() == 2);
+
+    // later commits are weighted 1/8
+    interval.record_commit(2, 12000);
+    HT_ASSERT(interval.average_us() == 5000);
+    HT_ASSERT(interval.wait_ms() == 2);
+
+    for (int i=0; i<100; i++)
+      interval.record_commit(2, 12000);
+    HT_ASSERT(interval.average_us() > 11000 && interval.average_us() <= 12000);
+    HT_ASSERT(interval.wait_ms() == 5);
+
+    // back to one request per commit
+    interval.record_commit(1, 12000);
+    HT_ASSERT(interval.wait_ms() == 0);
+  }
+
+  void check_max_wait() {
+    AdaptiveCommitInterval interval(1);
+    interval.record_commit(5, 100000);
+    HT_ASSERT(interval.wait_ms() == 1);
+
+    AdaptiveCommitInterval no_wait(0);
+    no_wait.record_commit(5, 100000);
+    HT_ASSERT(no_wait.wait_ms() == 0);
+  }
+
+  void check_negative_elapsed() {
+    AdaptiveCommitInterval interval(10);
+    interval.record_commit(2, -5);
+    HT_ASSERT(interval.average_us() == 0);
+    HT_ASSERT(interval.wait_ms() == 0);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  check_uncontended();
+  check_average();
+  check_max_wait();
+  check_negative_elapsed();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/Logger.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "Hypertable/RangeServer/FrozenCellList.h"
+#include "Hypertable/RangeServer/Global.h"
+#include "Hypertable/RangeServer/MemoryTracker.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\" inMemory=\"true\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>tag</Name>\n"
+  "    </ColumnFamily>\n"
+  "    <ColumnFamily id=\"2\">\n"
+  "      <Name>foo</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const char *qualifiers[] = { "a", "b", "c", "d", 0 };
+
+  const int ROWS = 1000;
+  const char *DELETE_ROW = "row00500";
+
+  struct Cell {
+    size_t key_offset;
+    size_t value_offset;
+  };
+
+  DynamicBuffer keys(0);
+  DynamicBuffer values(0);
+  vector<Cell> cells;
+
+  void add_cell(uint8_t flag, const char *row, uint8_t cf,
+                const char *qualifier, int64_t timestamp, const char *value) {
+    Cell cell;
+    cell.key_offset = keys.fill();
+    create_key_and_append(keys, flag, row, cf, qualifier, timestamp,
+                          timestamp);
+    cell.value_offset = values.fill();
+    append_as_byte_string(values, value);
+    cells.push_back(cell);
+  }
+
+  void populate(FrozenCellList *cell_list) {
+    char row[32], value[32];
+    int64_t timestamp = 1000000;
+    Key key;
+
+    for (int i=0; i<ROWS; i++) {
+      sprintf(row, "row%05d", i);
+      if (!strcmp(row, DELETE_ROW))
+        add_cell(FLAG_DELETE_ROW, row, 0, "", timestamp++, "");
+      for (size_t j=0; qualifiers[j]; j++) {
+        sprintf(value, "value%d", i);
+        add_cell(FLAG_INSERT, row, 1, qualifiers[j], timestamp++, value);
+      }
+    }
+
+    for (size_t i=0; i<cells.size(); i++) {
+      key.load(SerializedKey(keys.base + cells[i].key_offset));
+      cell_list->add(key, ByteString(values.base + cells[i].value_offset));
+    }
+    cell_list->finalize();
+  }
+
+  /**
+   * Scans the list and checks that it returns cells [first, first+count)
+   */
+  void check_scan(FrozenCellListPtr &cell_list, ScanContextPtr &scan_ctx,
+                  size_t first, size_t count) {
+    CellListScannerPtr scanner = cell_list->create_scanner(scan_ctx);
+    ByteString value;
+    Key key;
+    size_t n = 0;
+
+    while (scanner->get(key, value)) {
+      HT_ASSERT(first + n < cells.size());
+      SerializedKey expected_key(keys.base + cells[first+n].key_offset);
+      ByteString expected_value(values.base + cells[first+n].value_offset);
+      HT_ASSERT(key.length == expected_key.length());
+      HT_ASSERT(!memcmp(key.serial.ptr, expected_key.ptr, key.length));
+      HT_ASSERT(value.length() == expected_value.length());
+      HT_ASSERT(!memcmp(value.ptr, expected_value.ptr, value.length()));
+      scanner->forward();
+      n++;
+    }
+    HT_ASSERT(n == count);
+  }
+
+  size_t find_row(const char *row) {
+    for (size_t i=0; i<cells.size(); i++) {
+      if (!strcmp(SerializedKey(keys.base + cells[i].key_offset).row(), row))
+        return i;
+    }
+    return cells.size();
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+  FrozenCellListPtr cell_list = new FrozenCellList();
+  ScanSpecBuilder ssbuilder;
+  ScanContextPtr scan_ctx;
+  RangeSpec range;
+  size_t cell_count;
+  int64_t key_bytes, value_bytes;
+
+  HT_ASSERT(schema->is_valid());
+
+  Global::memory_tracker = new MemoryTracker(0);
+
+  range.start_row = "";
+  range.end_row = Key::END_ROW_MARKER;
+
+  populate(cell_list.get());
+
+  cell_list->get_counts(&cell_count, &key_bytes, &value_bytes);
+  HT_ASSERT(cell_count == cells.size());
+  HT_ASSERT(key_bytes == (int64_t)keys.fill());
+  HT_ASSERT(cell_list->memory_used() < key_bytes + value_bytes);
+
+  // full scan
+  scan_ctx = new ScanContext(schema);
+  check_scan(cell_list, scan_ctx, 0, cells.size());
+
+  // row interval that starts and ends on restart points and in between
+  for (int start=0; start<ROWS; start += 97) {
+    char start_row[32], end_row[32];
+    sprintf(start_row, "row%05d", start);
+    sprintf(end_row, "row%05d", start + 10);
+    ssbuilder.clear();
+    ssbuilder.add_row_interval(start_row, true, end_row, false);
+    scan_ctx = new ScanContext(TIMESTAMP_MAX, &(ssbuilder.get()), &range,
+                               schema);
+    size_t first = find_row(start_row);
+    size_t last = find_row(end_row);
+    check_scan(cell_list, scan_ctx, first, last - first);
+  }
+
+  // cell lookup in the middle of a deleted row returns the delete first
+  ssbuilder.clear();
+  ssbuilder.add_cell(DELETE_ROW, "tag:c");
+  scan_ctx = new ScanContext(TIMESTAMP_MAX, &(ssbuilder.get()), &range,
+                             schema);
+  {
+    CellListScannerPtr scanner = cell_list->create_scanner(scan_ctx);
+    ByteString value;
+    Key key;
+    HT_ASSERT(scanner->get(key, value) && key.flag == FLAG_DELETE_ROW);
+    scanner->forward();
+    HT_ASSERT(scanner->get(key, value) && key.flag == FLAG_INSERT);
+    HT_ASSERT(!strcmp(key.row, DELETE_ROW) &&
+              !strcmp(key.column_qualifier, "c"));
+  }
+
+  // seek, and skip to the next column and row
+  scan_ctx = new ScanContext(schema);
+  {
+    CellListScannerPtr scanner = cell_list->create_scanner(scan_ctx);
+    ByteString value;
+    Key key;
+    for (size_t i=0; i+1<cells.size(); i += 37) {
+      SerializedKey expected_key(keys.base + cells[i].key_offset);
+      scanner->seek(expected_key);
+      HT_ASSERT(scanner->get(key, value));
+      HT_ASSERT(!memcmp(key.serial.ptr, expected_key.ptr, key.length));
+      scanner->skip_to_next_column();
+      HT_ASSERT(scanner->get(key, value));
+      expected_key.ptr = keys.base + cells[i+1].key_offset;
+      HT_ASSERT(!memcmp(key.serial.ptr, expected_key.ptr, key.length));
+      String row(key.row);
+      scanner->skip_to_next_row();
+      if (scanner->get(key, value)) {
+        size_t next = find_row(key.row);
+        HT_ASSERT(strcmp(key.row, row.c_str()) > 0);
+        HT_ASSERT(next > 0 && strcmp(SerializedKey(keys.base +
+                  cells[next-1].key_offset).row(), row.c_str()) == 0);
+        i = next;
+      }
+    }
+  }
+
+  // past the end
+  ssbuilder.clear();
+  ssbuilder.add_row_interval("zzz", true, "zzzz", true);
+  scan_ctx = new ScanContext(TIMESTAMP_MAX, &(ssbuilder.get()), &range,
+                             schema);
+  check_scan(cell_list, scan_ctx, 0, 0);
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/Logger.h"
+
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include "AsyncComm/Event.h"
+
+#include "Hypertable/Lib/Schema.h"
+
+#include "Hypertable/RangeServer/GroupCommit.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+/**
+ * Checks that an adaptive GroupCommit leader whose commit fails with an
+ * exception other than Hypertable::Exception steps down, so that the next
+ * writer becomes leader and its update is committed.
+ */
+
+namespace {
+
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily>\n"
+  "      <Name>tag</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  /** GroupCommit with batch_update() replaced by a failing stub */
+  class Committer : public GroupCommit {
+  public:
+    Committer() : GroupCommit(0), commits(0), failures(0) {
+      m_schema = Schema::new_instance(schema_str, strlen(schema_str));
+      m_table.id = "1";
+      m_table.generation = 1;
+    }
+
+    void add_update() {
+      EventPtr event = new Hypertable::Event(Hypertable::Event::MESSAGE);
+      StaticBuffer buffer(16);
+      memset(buffer.base, 0, 16);
+      add(event, m_schema, &m_table, 1, buffer, 0, false);
+    }
+
+    int commits;
+    int failures;
+
+  protected:
+    virtual void commit(std::vector<TableUpdate *> &updates,
+                        boost::xtime expire_time) {
+      commits++;
+      if (failures > 0) {
+        failures--;
+        throw std::bad_alloc();
+      }
+    }
+
+  private:
+    SchemaPtr m_schema;
+    TableIdentifier m_table;
+  };
+  typedef intrusive_ptr<Committer> CommitterPtr;
+
+}
+
+
+int main(int argc, char **argv) {
+  Config::init(argc, argv);
+
+  properties->set("Hypertable.RangeServer.GroupCommit.Adaptive", true);
+  properties->set("Hypertable.RangeServer.GroupCommit.MaxWait", (int32_t)0);
+
+  CommitterPtr committer = new Committer();
+
+  // no other writers, so each add() leads and commits its own update
+  committer->add_update();
+  HT_ASSERT(committer->commits == 1);
+
+  // a failed commit is logged and the leader steps down
+  committer->failures = 1;
+  committer->add_update();
+  HT_ASSERT(committer->commits == 2);
+  HT_ASSERT(committer->failures == 0);
+
+  committer->add_update();
+  HT_ASSERT(committer->commits == 3);
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
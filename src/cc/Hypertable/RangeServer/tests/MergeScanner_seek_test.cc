@@ -0,0 +1,432 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/DynamicBuffer.h"
+#include "Common/InetAddr.h"
+#include "Common/Serialization.h"
+#include "Common/Usage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanSpec.h"
+#include "Hypertable/Lib/Schema.h"
+#include "Hypertable/Lib/SerializedKey.h"
+
+#include "../CellCache.h"
+#include "../CellStoreV5.h"
+#include "../FileBlockCache.h"
+#include "../Global.h"
+#include "../MergeScanner.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: MergeScanner_seek_test",
+    "",
+    "  This program tests the MergeScanner over a cell store and a cell",
+    "  cache holding random versions, deletes and counter increments.  The",
+    "  merge scanner seeks its children past versions that it filters out,",
+    "  and the result of each scan is checked against a simple model.",
+    (const char *)0
+  };
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>tag</Name>\n"
+  "      <MaxVersions>2</MaxVersions>\n"
+  "    </ColumnFamily>\n"
+  "    <ColumnFamily id=\"2\">\n"
+  "      <Name>cnt</Name>\n"
+  "      <Counter>true</Counter>\n"
+  "    </ColumnFamily>\n"
+  "    <ColumnFamily id=\"3\">\n"
+  "      <Name>plain</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const int ROWS = 40;
+  const uint8_t TAG = 1;
+  const uint8_t CNT = 2;
+  const uint8_t PLAIN = 3;
+  const uint32_t TAG_MAX_VERSIONS = 2;
+
+  // qualifiers that share prefixes, in sort order
+  const char *qualifiers[] = { "", "a", "a-", "aa", "b", 0 };
+
+  struct StoredCell {
+    size_t key_offset;
+    size_t value_offset;
+    bool in_store;
+  };
+
+  DynamicBuffer keys(0);
+  DynamicBuffer values(0);
+  vector<StoredCell> cells;
+
+  struct Version {
+    int64_t timestamp;
+    int64_t count;
+    bool reset;
+  };
+
+  typedef pair<pair<String, int>, String> CellId;
+  typedef map<CellId, vector<Version> > VersionMap;
+
+  // model of the contents
+  VersionMap versions;
+  map<String, int64_t> row_deletes;
+  map<pair<String, int>, int64_t> family_deletes;
+  map<CellId, int64_t> cell_deletes;
+
+  void add_cell(uint8_t flag, const String &row, uint8_t cf,
+                const char *qualifier, int64_t timestamp,
+                const uint8_t *value, size_t value_len) {
+    StoredCell cell;
+    cell.key_offset = keys.fill();
+    create_key_and_append(keys, flag, row.c_str(), cf, qualifier, timestamp,
+                          timestamp);
+    cell.value_offset = values.fill();
+    append_as_byte_string(values, value, value_len);
+    cell.in_store = (random() % 2) == 0;
+    cells.push_back(cell);
+  }
+
+  /**
+   * Inserts get even timestamps and deletes odd ones, so that no two
+   * keys collide and a delete never ties with the cell it covers
+   */
+  void populate() {
+    int64_t timestamp = 0;
+    uint8_t buf[9];
+    uint8_t *ptr;
+
+    for (int i=0; i<ROWS; i++) {
+      String row = format("r%02d", i);
+      for (uint8_t cf=TAG; cf<=PLAIN; cf++) {
+        for (size_t j=0; qualifiers[j]; j++) {
+          if (random() % 5 < 2)
+            continue;
+          CellId id(make_pair(row, (int)cf), qualifiers[j]);
+          int nversions = 1 + random() % 6;
+          for (int v=0; v<nversions; v++) {
+            Version version;
+            timestamp += 2;
+            version.timestamp = timestamp;
+            version.count = 1 + random() % 9;
+            version.reset = false;
+            if (cf == CNT) {
+              ptr = buf;
+              Serialization::encode_i64(&ptr, version.count);
+              if (random() % 7 == 0) {
+                version.reset = true;
+                *ptr++ = '=';
+              }
+              add_cell(FLAG_INSERT, row, cf, qualifiers[j], timestamp,
+                       buf, ptr - buf);
+            }
+            else {
+              String value = format("v%lld", (Lld)timestamp);
+              add_cell(FLAG_INSERT, row, cf, qualifiers[j], timestamp,
+                       (const uint8_t *)value.c_str(), value.length());
+            }
+            versions[id].push_back(version);
+          }
+          if (random() % 5 == 0) {
+            int64_t delete_ts = 1 + 2 * (random() % (timestamp / 2 + 2));
+            add_cell(FLAG_DELETE_CELL, row, cf, qualifiers[j], delete_ts,
+                     (const uint8_t *)"", 0);
+            cell_deletes[id] = delete_ts;
+          }
+        }
+        if (random() % 8 == 0) {
+          int64_t delete_ts = 1 + 2 * (random() % (timestamp / 2 + 2));
+          add_cell(FLAG_DELETE_COLUMN_FAMILY, row, cf, "", delete_ts,
+                   (const uint8_t *)"", 0);
+          family_deletes[make_pair(row, (int)cf)] = delete_ts;
+        }
+      }
+      if (random() % 10 == 0) {
+        int64_t delete_ts = 1 + 2 * (random() % (timestamp / 2 + 2));
+        add_cell(FLAG_DELETE_ROW, row, 0, "", delete_ts,
+                 (const uint8_t *)"", 0);
+        row_deletes[row] = delete_ts;
+      }
+    }
+  }
+
+  struct LtCellKey {
+    bool operator()(const StoredCell &x, const StoredCell &y) const {
+      return SerializedKey(keys.base + x.key_offset) <
+             SerializedKey(keys.base + y.key_offset);
+    }
+  };
+
+  /**
+   * Writes the cells that are not in the cache to a cell store with very
+   * small blocks, so that seeks move across blocks through the block index
+   */
+  CellStorePtr create_store(const String &fname, SchemaPtr &schema) {
+    TableIdentifier table_id("1");
+    PropertiesPtr cs_props = new Properties();
+    cs_props->set("blocksize", uint32_t(32));
+
+    vector<StoredCell> sorted;
+    foreach(const StoredCell &cell, cells) {
+      if (cell.in_store)
+        sorted.push_back(cell);
+    }
+    sort(sorted.begin(), sorted.end(), LtCellKey());
+
+    CellStorePtr cs = new CellStoreV5(Global::dfs.get(), schema.get());
+    cs->create(fname.c_str(), sorted.size(), cs_props);
+
+    Key key;
+    foreach(const StoredCell &cell, sorted) {
+      key.load(SerializedKey(keys.base + cell.key_offset));
+      cs->add(key, ByteString(values.base + cell.value_offset));
+    }
+    cs->finalize(&table_id);
+    return cs;
+  }
+
+  CellCachePtr create_cache() {
+    CellCachePtr cache = new CellCache();
+    Key key;
+    foreach(const StoredCell &cell, cells) {
+      if (!cell.in_store) {
+        key.load(SerializedKey(keys.base + cell.key_offset));
+        cache->add(key, ByteString(values.base + cell.value_offset));
+      }
+    }
+    return cache;
+  }
+
+  bool selected(const CellId &id, const vector<String> &columns) {
+    if (columns.empty())
+      return true;
+    const char *family = id.first.second == TAG ? "tag" :
+                         id.first.second == CNT ? "cnt" : "plain";
+    foreach(const String &column, columns) {
+      if (column == family || column == String(family) + ":" + id.second)
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * Returns what a scan of all rows, of the given columns and from the
+   * given start time, should return
+   */
+  void expected_scan(int64_t start_time, const vector<String> &columns,
+                     vector<String> &result) {
+    result.clear();
+    foreach(const VersionMap::value_type &v, versions) {
+      const CellId &id = v.first;
+      if (!selected(id, columns))
+        continue;
+
+      int64_t deleted_before = 0;
+      if (row_deletes.count(id.first.first))
+        deleted_before = row_deletes[id.first.first];
+      if (family_deletes.count(id.first))
+        deleted_before = max(deleted_before, family_deletes[id.first]);
+      if (cell_deletes.count(id))
+        deleted_before = max(deleted_before, cell_deletes[id]);
+
+      String prefix = format("%s %d '%s'", id.first.first.c_str(),
+                             id.first.second, id.second.c_str());
+      int64_t count = 0;
+      uint32_t returned = 0;
+      bool counted = false;
+
+      // versions were generated oldest first
+      for (size_t i=v.second.size(); i>0; i--) {
+        const Version &version = v.second[i-1];
+        if (version.timestamp < start_time ||
+            version.timestamp < deleted_before)
+          continue;
+        if (id.first.second == CNT) {
+          count += version.count;
+          counted = true;
+          if (version.reset)
+            break;
+        }
+        else {
+          if (id.first.second == TAG && returned == TAG_MAX_VERSIONS)
+            break;
+          result.push_back(format("%s %lld", prefix.c_str(),
+                                  (Lld)version.timestamp));
+          returned++;
+        }
+      }
+      if (counted)
+        result.push_back(format("%s =%lld", prefix.c_str(), (Lld)count));
+    }
+  }
+
+  void check_scan(CellStorePtr &cs, CellCachePtr &cache, SchemaPtr &schema,
+                  int64_t start_time, const vector<String> &columns) {
+    ScanSpecBuilder ssbuilder;
+    RangeSpec range;
+    vector<String> expected, found;
+
+    range.start_row = "";
+    range.end_row = Key::END_ROW_MARKER;
+    foreach(const String &column, columns)
+      ssbuilder.add_column(column.c_str());
+    if (start_time)
+      ssbuilder.set_start_time(start_time);
+
+    ScanContextPtr scan_ctx = new ScanContext(TIMESTAMP_MAX,
+        &(ssbuilder.get()), &range, schema);
+    MergeScanner *mscanner = new MergeScanner(scan_ctx, false, true);
+    mscanner->add_scanner(cs->create_scanner(scan_ctx));
+    mscanner->add_scanner(cache->create_scanner(scan_ctx));
+    CellListScannerPtr scanner = mscanner;
+
+    Key key;
+    ByteString value;
+    while (scanner->get(key, value)) {
+      String prefix = format("%s %d '%s'", key.row,
+                             (int)key.column_family_code,
+                             key.column_qualifier);
+      if (key.column_family_code == CNT) {
+        const uint8_t *decode;
+        size_t remain = value.decode_length(&decode);
+        int64_t count = Serialization::decode_i64(&decode, &remain);
+        found.push_back(format("%s =%lld", prefix.c_str(), (Lld)count));
+      }
+      else
+        found.push_back(format("%s %lld", prefix.c_str(),
+                               (Lld)key.timestamp));
+      scanner->forward();
+    }
+
+    expected_scan(start_time, columns, expected);
+
+    if (found != expected) {
+      HT_ERRORF("Scan from %lld of %d columns returned %d cells, expected %d",
+                (Lld)start_time, (int)columns.size(), (int)found.size(),
+                (int)expected.size());
+      for (size_t i=0; i<found.size() || i<expected.size(); i++) {
+        if (i >= found.size() || i >= expected.size() ||
+            found[i] != expected[i]) {
+          HT_ERRORF("first difference at %d: got \"%s\", expected \"%s\"",
+                    (int)i, i < found.size() ? found[i].c_str() : "",
+                    i < expected.size() ? expected[i].c_str() : "");
+          break;
+        }
+      }
+      exit(1);
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    Global::dfs = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    // force broker client to be destroyed before connection manager
+    client = (DfsBroker::Client *)Global::dfs.get();
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::block_cache = new FileBlockCache(100000LL, 100000LL);
+    Global::memory_tracker = new MemoryTracker(Global::block_cache);
+
+    String testdir = "/MergeScanner_seek_test";
+    client->mkdirs(testdir);
+
+    SchemaPtr schema = Schema::new_instance(schema_str, strlen(schema_str));
+    if (!schema->is_valid()) {
+      HT_ERRORF("Schema Parse Error: %s", schema->get_error_string());
+      exit(1);
+    }
+
+    srandom(1);
+    populate();
+
+    CellStorePtr cs = create_store(testdir + "/cs0", schema);
+    CellCachePtr cache = create_cache();
+
+    int64_t middle = 0;
+    foreach(const StoredCell &cell, cells) {
+      Key key(SerializedKey(keys.base + cell.key_offset));
+      middle = max(middle, key.timestamp / 2);
+    }
+
+    vector<String> columns;
+    check_scan(cs, cache, schema, 0, columns);
+    check_scan(cs, cache, schema, middle, columns);
+
+    // qualifier restrictions seek past the cells of the other qualifiers
+    columns.push_back("tag:a");
+    columns.push_back("cnt");
+    columns.push_back("plain:aa");
+    check_scan(cs, cache, schema, 0, columns);
+    check_scan(cs, cache, schema, middle, columns);
+
+    client->rmdir(testdir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -38,6 +38,11 @@ extern "C" {
 #include "Common/md5.h"
 #include "Common/System.h"
 
+#include "Hypertable/Lib/RangeServerProtocol.h"
+#include "Hypertable/Lib/ScanSpec.h"
+
+#include "Hypertable/RangeServer/CellListScanner.h"
+#include "Hypertable/RangeServer/FillScanBlock.h"
 #include "Hypertable/RangeServer/QueryCache.h"
 
 using namespace Hypertable;
@@ -53,6 +58,140 @@ typedef struct {
   char row[3];
 } TrackRecT;
 
+namespace {
+
+  void make_key(const char *str, QueryCache::Key *key) {
+    md5_csum((unsigned char *)str, strlen(str), key->digest);
+  }
+
+  class EmptyScanner : public CellListScanner {
+  public:
+    EmptyScanner(ScanContextPtr &scan_ctx) : CellListScanner(scan_ctx) { }
+    virtual void forward() { }
+    virtual bool get(Key &key, ByteString &value) { return false; }
+  };
+
+  /**
+   * Builds the scan block that create_scanner sends back for a scan that
+   * finds nothing
+   */
+  boost::shared_array<uint8_t> empty_block(uint32_t result_flags,
+                                           uint32_t *lenp) {
+    ScanSpec scan_spec;
+    SchemaPtr schema;
+    ScanContextPtr scan_ctx = new ScanContext(TIMESTAMP_MAX, &scan_spec, 0,
+                                              schema);
+    scan_ctx->result_flags = result_flags;
+    CellListScannerPtr scanner = new EmptyScanner(scan_ctx);
+    DynamicBuffer dbuf;
+
+    HT_ASSERT(!FillScanBlock(scanner, dbuf, 64*1024));
+    *lenp = dbuf.fill();
+    boost::shared_array<uint8_t> block(new uint8_t [*lenp]);
+    memcpy(block.get(), dbuf.base, *lenp);
+    return block;
+  }
+
+  /**
+   * Column-family aware invalidation, negative entries and per-shard
+   * statistics on a sharded cache
+   */
+  void check_sharded(boost::shared_array<uint8_t> &result) {
+    QueryCache cache(MAX_MEMORY, 8);
+    QueryCache::ColumnSet family1, family2, all_columns;
+    QueryCache::Key key1, key2, key_all, key_missing, key_missing_compact;
+    uint32_t result_length, empty_length, empty_compact_length;
+    char row[32];
+
+    // empty results are not zero length, negative entries are recognized
+    // by their cell count
+    boost::shared_array<uint8_t> empty = empty_block(0, &empty_length);
+    boost::shared_array<uint8_t> empty_compact =
+      empty_block(RangeServerProtocol::CREATE_SCANNER_FLAG_COMPACT,
+                  &empty_compact_length);
+    HT_ASSERT(empty_length >= 4 && empty_compact_length > 0);
+
+    HT_ASSERT(cache.shard_count() == 8);
+    HT_ASSERT(cache.available_memory() == MAX_MEMORY);
+
+    family1.set(1);
+    family2.set(2);
+    all_columns.set();
+
+    for (int i=0; i<100; i++) {
+      sprintf(row, "row%d", i);
+      make_key((String(row) + "-cf1").c_str(), &key1);
+      make_key((String(row) + "-cf2").c_str(), &key2);
+      make_key((String(row) + "-all").c_str(), &key_all);
+      make_key((String(row) + "-missing").c_str(), &key_missing);
+      make_key((String(row) + "-missing-compact").c_str(),
+               &key_missing_compact);
+      HT_ASSERT(cache.insert(&key1, "/1", row, family1, result, 100, 1));
+      HT_ASSERT(cache.insert(&key2, "/1", row, family2, result, 100, 1));
+      HT_ASSERT(cache.insert(&key_all, "/1", row, all_columns, result, 100, 1));
+      HT_ASSERT(cache.insert(&key_missing, "/1", row, family1, empty,
+                             empty_length, 0));
+      HT_ASSERT(cache.insert(&key_missing_compact, "/1", row, family1,
+                             empty_compact, empty_compact_length, 0));
+    }
+
+    for (int i=0; i<100; i++) {
+      sprintf(row, "row%d", i);
+      make_key((String(row) + "-cf1").c_str(), &key1);
+      make_key((String(row) + "-cf2").c_str(), &key2);
+      make_key((String(row) + "-all").c_str(), &key_all);
+      make_key((String(row) + "-missing").c_str(), &key_missing);
+      make_key((String(row) + "-missing-compact").c_str(),
+               &key_missing_compact);
+
+      boost::shared_array<uint8_t> cached;
+      HT_ASSERT(cache.lookup(&key_missing, "/1", row, cached, &result_length));
+      HT_ASSERT(result_length == empty_length &&
+                !memcmp(cached.get(), empty.get(), empty_length));
+      HT_ASSERT(cache.lookup(&key_missing_compact, "/1", row, cached,
+                             &result_length));
+      HT_ASSERT(result_length == empty_compact_length);
+
+      // an update to family 2 leaves results for family 1 in place
+      cache.invalidate("/1", row, 2);
+      HT_ASSERT(cache.lookup(&key1, "/1", row, result, &result_length));
+      HT_ASSERT(result_length == 100);
+      HT_ASSERT(!cache.lookup(&key2, "/1", row, result, &result_length));
+      HT_ASSERT(!cache.lookup(&key_all, "/1", row, result, &result_length));
+      HT_ASSERT(cache.lookup(&key_missing, "/1", row, result, &result_length));
+
+      // a row delete invalidates everything
+      cache.invalidate("/1", row, 0);
+      HT_ASSERT(!cache.lookup(&key1, "/1", row, result, &result_length));
+      HT_ASSERT(!cache.lookup(&key_missing, "/1", row, result, &result_length));
+    }
+
+    HT_ASSERT(cache.available_memory() == MAX_MEMORY);
+
+    uint64_t max_memory, available_memory, lookups, hits;
+    uint64_t shard_lookups, shard_hits, shard_negative_hits;
+    uint64_t total_lookups = 0, total_hits = 0, total_negative_hits = 0;
+    size_t used_shards = 0;
+
+    cache.get_stats(&max_memory, &available_memory, &lookups, &hits);
+    HT_ASSERT(lookups == 800 && hits == 400);
+
+    for (size_t i=0; i<cache.shard_count(); i++) {
+      cache.get_shard_stats(i, &shard_lookups, &shard_hits,
+                            &shard_negative_hits);
+      total_lookups += shard_lookups;
+      total_hits += shard_hits;
+      total_negative_hits += shard_negative_hits;
+      if (shard_lookups)
+        used_shards++;
+    }
+    HT_ASSERT(total_lookups == lookups && total_hits == hits);
+    HT_ASSERT(total_negative_hits == 300);
+    HT_ASSERT(used_shards > 1);
+  }
+
+}
+
 int main(int argc, char **argv) {
   QueryCache *cache;
   unsigned long seed = (unsigned long)getpid();
@@ -63,6 +202,9 @@ int main(int argc, char **argv) {
   char keybuf[32];
   TrackRecT  track_buf[TRACK_BUFFER_SIZE];
   size_t track_buf_i = 0;
+  QueryCache::ColumnSet all_columns;
+
+  all_columns.set();
 
   System::initialize(System::locate_install_dir(argv[0]));
 
@@ -71,16 +213,17 @@ int main(int argc, char **argv) {
       seed = atoi(&argv[i][7]);
   }
 
-  cache = new QueryCache(MAX_MEMORY);
+  // a single shard gives exact LRU behavior for the checks below
+  cache = new QueryCache(MAX_MEMORY, 1);
 
   md5_csum((unsigned char *)"aa", 2, key.digest);
 
-  if (cache->insert(&key, "/1", "aa", result, MAX_MEMORY+1)) {
+  if (cache->insert(&key, "/1", "aa", all_columns, result, MAX_MEMORY+1, 1)) {
     cout << "Error: insert should have failed." << endl;
     exit(1);
   }
 
-  if (cache->lookup(&key, result, &result_length)) {
+  if (cache->lookup(&key, "/1", "aa", result, &result_length)) {
     cout << "Error: key should not exist in cache." << endl;
     exit(1);
   }
@@ -92,7 +235,7 @@ int main(int argc, char **argv) {
     for (size_t i=0; i<100; i++) {
       sprintf(keybuf, "%s-%d", row, (int)i);
       md5_csum((unsigned char *)keybuf, strlen(keybuf), key.digest);
-      if (!cache->insert(&key, "/1", row, result, 1000)) {
+      if (!cache->insert(&key, "/1", row, all_columns, result, 1000, 1)) {
 	cout << "Error: insert failed." << endl;
 	exit(1);
       }
@@ -106,18 +249,18 @@ int main(int argc, char **argv) {
   for (size_t i=0; i<100; i++) {
     sprintf(keybuf, "%s-%d", row, (int)i);
     md5_csum((unsigned char *)keybuf, strlen(keybuf), key.digest);
-    if (!cache->lookup(&key, result, &result_length)) {
+    if (!cache->lookup(&key, "/1", row, result, &result_length)) {
       cout << "Error: key not found." << endl;
       exit(1);
     }
   }
 
-  cache->invalidate("/1", row);
+  cache->invalidate("/1", row, 1);
 
   for (size_t i=0; i<100; i++) {
     sprintf(keybuf, "%s-%d", row, (int)i);
     md5_csum((unsigned char *)keybuf, strlen(keybuf), key.digest);
-    if (cache->lookup(&key, result, &result_length)) {
+    if (cache->lookup(&key, "/1", row, result, &result_length)) {
       cout << "Error: key found." << endl;
       exit(1);
     }
@@ -127,7 +270,7 @@ int main(int argc, char **argv) {
     row[0] = (char)rowi;
     row[1] = (char)rowi;
     row[2] = 0;
-    cache->invalidate("/1", row);
+    cache->invalidate("/1", row, 1);
   }
 
   HT_ASSERT(cache->available_memory() == MAX_MEMORY);
@@ -144,7 +287,8 @@ int main(int argc, char **argv) {
     track_buf[track_buf_i].row[0] = (char)charno;
     track_buf[track_buf_i].row[1] = (char)charno;
     track_buf[track_buf_i].row[2] = 0;
-    cache->insert(&track_buf[track_buf_i].key, "/1", track_buf[track_buf_i].row, result, 1000);
+    cache->insert(&track_buf[track_buf_i].key, "/1", track_buf[track_buf_i].row,
+                  all_columns, result, 1000, 1);
     track_buf_i = (track_buf_i + 1) % TRACK_BUFFER_SIZE;
   }
 
@@ -152,16 +296,18 @@ int main(int argc, char **argv) {
   row[0] = charno;
   row[1] = charno;
   row[2] = 0;
-  cache->invalidate("/1", row);
+  cache->invalidate("/1", row, 1);
 
   for (size_t i=0; i<TRACK_BUFFER_SIZE; i++) {
     if (track_buf[i].row[0] == (char)charno)
-      HT_ASSERT( !cache->lookup(&track_buf[i].key, result, &result_length) );
+      HT_ASSERT( !cache->lookup(&track_buf[i].key, "/1", track_buf[i].row, result, &result_length) );
     else
-      HT_ASSERT( cache->lookup(&track_buf[i].key, result, &result_length) );
+      HT_ASSERT( cache->lookup(&track_buf[i].key, "/1", track_buf[i].row, result, &result_length) );
   }
 
   delete cache;
 
+  check_sharded(result);
+
   return 0;
 }
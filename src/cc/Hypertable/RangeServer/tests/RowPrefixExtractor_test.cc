@@ -0,0 +1,103 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Logger.h"
+
+#include <cstring>
+#include <iostream>
+
+#include "Hypertable/RangeServer/RowPrefixExtractor.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  int extract(RowPrefixExtractor &extractor, const char *row) {
+    return extractor.extract(row, strlen(row));
+  }
+
+  void check_fixed_length() {
+    PropertiesPtr props = new Properties();
+    props->set("prefix-length", (int32_t)3);
+    RowPrefixExtractor extractor(props);
+
+    HT_ASSERT(extract(extractor, "abcdef") == 3);
+    HT_ASSERT(extract(extractor, "abc") == 3);
+    HT_ASSERT(extract(extractor, "ab") == -1);
+
+    HT_ASSERT(extractor.extract("abcd", "abcz", true) == 3);
+    HT_ASSERT(extractor.extract("abd", "abe", false) == 3);
+    HT_ASSERT(extractor.extract("ab", "ac", false) == -1);
+    HT_ASSERT(extractor.extract("abc", "abd", true) == -1);
+  }
+
+  void check_delimiter() {
+    PropertiesPtr props = new Properties();
+    props->set("prefix-delimiter", String("/"));
+    props->set("prefix-delimiter-count", (int32_t)2);
+    RowPrefixExtractor extractor(props);
+
+    HT_ASSERT(extract(extractor, "com/example/index") == 11);
+    HT_ASSERT(extract(extractor, "com/example/") == 11);
+    HT_ASSERT(extract(extractor, "com/example") == -1);
+
+    HT_ASSERT(extractor.extract("com/example/", "com/example0", false) == 11);
+    HT_ASSERT(extractor.extract("com/example/a", "com/example/z", true) == 11);
+    HT_ASSERT(extractor.extract("com/example", "com/examplf", false) == -1);
+
+    uint8_t buf[RowPrefixExtractor::ENCODED_LENGTH];
+    uint8_t *ptr = buf;
+    extractor.encode(&ptr);
+    HT_ASSERT((size_t)(ptr - buf) == RowPrefixExtractor::ENCODED_LENGTH);
+
+    RowPrefixExtractor decoded;
+    const uint8_t *cptr = buf;
+    size_t remain = sizeof(buf);
+    decoded.decode(&cptr, &remain);
+    HT_ASSERT(remain == 0 && !decoded.empty());
+    HT_ASSERT(extract(decoded, "org/example/x") == 11);
+  }
+
+  void check_missing_options() {
+    PropertiesPtr props = new Properties();
+    try {
+      RowPrefixExtractor extractor(props);
+      HT_ASSERT(!"missing options not detected");
+    }
+    catch (Exception &e) {
+      HT_ASSERT(e.code() == Error::BAD_SCHEMA);
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  check_fixed_length();
+  check_delimiter();
+  check_missing_options();
+
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -0,0 +1,283 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <set>
+
+#include <boost/thread/condition.hpp>
+
+#include "Common/DynamicBuffer.h"
+#include "Common/Init.h"
+#include "Common/LatencyHistogram.h"
+#include "Common/Logger.h"
+#include "Common/Mutex.h"
+#include "Common/Thread.h"
+#include "Common/Time.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/ConnectionManager.h"
+#include "AsyncComm/Event.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/CommitLog.h"
+#include "Hypertable/Lib/Config.h"
+
+#include "Hypertable/Lib/Schema.h"
+
+#include "../GroupCommit.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+/**
+ * Measures commit throughput and latency against a DFS broker as the
+ * number of concurrent writers grows, for three commit schemes:
+ *
+ *   sync       - every writer does its own CommitLog write + sync
+ *   group      - GroupCommit in adaptive (leader/follower) mode with a
+ *                maximum wait of 0: the first writer commits right away and
+ *                writers arriving during a commit are batched into the next
+ *                one
+ *   adaptive   - the same, with the leader waiting for followers as
+ *                suggested by AdaptiveCommitInterval
+ *
+ * Usage: group_commit_bench --dfs-host localhost --dfs-port 38030
+ */
+
+namespace {
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc().add_options()
+        ("max-writers", i32()->default_value(32),
+            "Benchmark 1, 2, 4, ... up to this many concurrent writers")
+        ("duration", i32()->default_value(5),
+            "Duration of each run in seconds")
+        ("block-size", i32()->default_value(256),
+            "Size of each commit in bytes")
+        ("max-wait", i32()->default_value(10),
+            "Maximum adaptive leader wait in milliseconds")
+        ("log-dir", str()->default_value("/hypertable/group_commit_bench"),
+            "DFS directory for the benchmark commit logs")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DfsClientPolicy, DefaultCommPolicy> Policies;
+
+  enum Mode { SYNC, GROUP, ADAPTIVE };
+
+  const char *mode_names[] = { "sync", "group", "adaptive" };
+
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily>\n"
+  "      <Name>tag</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  /**
+   * Drives the RangeServer's GroupCommit with batch_update() replaced by a
+   * write + sync of the batched request buffers to a CommitLog.  In sync
+   * mode every writer does its own write + sync instead.
+   */
+  class Committer : public GroupCommit {
+  public:
+    Committer(CommitLog *log, Mode mode)
+      : GroupCommit(0), m_log(log), m_mode(mode), m_syncs(0) {
+      m_schema = Schema::new_instance(schema_str, strlen(schema_str));
+      m_table.id = "1";
+      m_table.generation = 1;
+    }
+
+    /** Commits a block and waits until it is durable */
+    void commit_block(const uint8_t *data, size_t len) {
+
+      if (m_mode == SYNC) {
+        DynamicBuffer buf(len);
+        buf.add(data, len);
+        if (m_log->write(buf, get_ts64(), true) != Error::OK)
+          HT_FATAL("Problem writing commit log");
+        ScopedLock lock(m_mutex);
+        m_syncs++;
+        return;
+      }
+
+      EventPtr event = new Hypertable::Event(Hypertable::Event::MESSAGE);
+      StaticBuffer buffer(len);
+      memcpy(buffer.base, data, len);
+
+      // Returns after the batch is committed if this writer became the
+      // leader, otherwise right after queueing the block
+      add(event, m_schema, &m_table, 1, buffer, 0, true);
+
+      ScopedLock lock(m_mutex);
+      while (m_committed.count(event.get()) == 0)
+        m_cond.wait(lock);
+      m_committed.erase(event.get());
+    }
+
+    uint64_t syncs() { ScopedLock lock(m_mutex); return m_syncs; }
+
+  protected:
+    virtual void commit(std::vector<TableUpdate *> &updates,
+                        boost::xtime expire_time) {
+      DynamicBuffer buf;
+
+      foreach (TableUpdate *table_update, updates)
+        foreach (UpdateRequest *request, table_update->requests)
+          buf.add(request->buffer.base, request->buffer.size);
+
+      if (m_log->write(buf, get_ts64(), true) != Error::OK)
+        HT_FATAL("Problem writing commit log");
+
+      ScopedLock lock(m_mutex);
+      m_syncs++;
+      foreach (TableUpdate *table_update, updates)
+        foreach (UpdateRequest *request, table_update->requests)
+          m_committed.insert(request->event.get());
+      m_cond.notify_all();
+    }
+
+  private:
+    CommitLog *m_log;
+    Mode m_mode;
+    SchemaPtr m_schema;
+    TableIdentifier m_table;
+    Mutex m_mutex;
+    boost::condition m_cond;
+    std::set<Hypertable::Event *> m_committed;
+    uint64_t m_syncs;
+  };
+  typedef intrusive_ptr<Committer> CommitterPtr;
+
+  class Writer {
+  public:
+    Writer(Committer *committer, size_t block_size, int64_t stop_time,
+           LatencyHistogram *latency)
+      : m_committer(committer), m_block_size(block_size),
+        m_stop_time(stop_time), m_latency(latency) { }
+
+    void operator()() {
+      uint8_t *block = new uint8_t [m_block_size];
+      for (size_t i=0; i<m_block_size; i++)
+        block[i] = (uint8_t)random();
+      int64_t start;
+      while ((start = get_ts64()) < m_stop_time) {
+        m_committer->commit_block(block, m_block_size);
+        m_latency->record((get_ts64() - start) / 1000);
+      }
+      delete [] block;
+    }
+
+  private:
+    Committer *m_committer;
+    size_t m_block_size;
+    int64_t m_stop_time;
+    LatencyHistogram *m_latency;
+  };
+
+  void run(DfsBroker::Client *dfs, const String &log_dir, Mode mode,
+           int writers, int duration, size_t block_size, uint32_t max_wait) {
+    FilesystemPtr fs = dfs;
+    String dir = format("%s/%s-%d", log_dir.c_str(), mode_names[mode],
+                        writers);
+    dfs->mkdirs(dir);
+
+    // GROUP is the adaptive GroupCommit with the leader never waiting
+    properties->set("Hypertable.RangeServer.GroupCommit.Adaptive", true);
+    properties->set("Hypertable.RangeServer.GroupCommit.MaxWait",
+                    (int32_t)(mode == ADAPTIVE ? max_wait : 0));
+
+    CommitLog *log = new CommitLog(fs, dir, properties);
+    CommitterPtr committer = new Committer(log, mode);
+    LatencyHistogram latency;
+    int64_t start = get_ts64();
+    ThreadGroup threads;
+
+    for (int i=0; i<writers; i++)
+      threads.create_thread(Writer(committer.get(), block_size,
+                                   start + (int64_t)duration * 1000000000LL,
+                                   &latency));
+    threads.join_all();
+
+    double elapsed = (double)(get_ts64() - start) / 1000000000.0;
+    cout << format("%-9s %7d %12.1f %10.1f %10.1f %10llu %10llu %10llu\n",
+                   mode_names[mode], writers,
+                   (double)latency.count() / elapsed,
+                   (double)committer->syncs() / elapsed, latency.mean(),
+                   (Llu)latency.percentile(50.0),
+                   (Llu)latency.percentile(99.0), (Llu)latency.max())
+         << flush;
+
+    log->close();
+    delete log;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    Comm *comm = Comm::instance();
+    ConnectionManagerPtr conn_mgr = new ConnectionManager(comm);
+    int timeout = has("dfs-timeout") ? get_i32("dfs-timeout") : 180000;
+    InetAddr addr(get_str("dfs-host"), get_i16("dfs-port"));
+    DfsBroker::ClientPtr dfs = new DfsBroker::Client(conn_mgr, addr, timeout);
+
+    if (!dfs->wait_for_connection(10000)) {
+      HT_ERROR("Unable to connect to DFS Broker, exiting...");
+      exit(1);
+    }
+
+    String log_dir = get_str("log-dir");
+    int max_writers = get_i32("max-writers");
+    int duration = get_i32("duration");
+    size_t block_size = get_i32("block-size");
+    uint32_t max_wait = get_i32("max-wait");
+
+    dfs->rmdir(log_dir);
+
+    cout << format("%-9s %7s %12s %10s %10s %10s %10s %10s\n", "mode",
+                   "writers", "commits/s", "syncs/s", "mean(us)", "p50(us)",
+                   "p99(us)", "max(us)");
+    for (int writers=1; writers<=max_writers; writers*=2)
+      for (int mode=SYNC; mode<=ADAPTIVE; mode++)
+        run(dfs.get(), log_dir, (Mode)mode, writers, duration, block_size,
+            max_wait);
+
+    dfs->rmdir(log_dir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
@@ -54,10 +54,15 @@ void init_thrift_broker_options() {
     ("pidfile", str(), "File to contain the process id")
     ("log-api", boo()->default_value(false), "Enable or disable API logging")
     ("workers", i32()->default_value(50), "Worker threads")
+    ("server-type", str()->default_value("threaded"), "Server model: "
+        "threaded (a thread per connection), pool (connections served by "
+        "the worker threads) or nonblocking (requests served by the worker "
+        "threads, ThriftBroker.Timeout not supported)")
     ;
   alias("port", "ThriftBroker.Port");
   alias("log-api", "ThriftBroker.API.Logging");
   alias("workers", "ThriftBroker.Workers");
+  alias("server-type", "ThriftBroker.ServerType");
   // hidden aliases
   alias("thrift-timeout", "ThriftBroker.Timeout");
 }
@@ -63,8 +63,12 @@ namespace Hypertable {
     }
 
     bool empty() { return m_buf.empty(); }    
-    
-    void clear() { m_buf.clear(); }
+
+    /** Returns the size of the buffer, which add() grows as needed */
+    size_t capacity() { return m_buf.size; }
+
+    /** Empties the buffer, keeping its memory, so the writer can be reused */
+    void clear() { m_buf.clear(); m_finalized = false; }
 
   private:
     DynamicBuffer m_buf;
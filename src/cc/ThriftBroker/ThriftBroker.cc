@@ -23,9 +23,13 @@
 #include "Common/Random.h"
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/tss.hpp>
 
+#include <concurrency/PosixThreadFactory.h>
 #include <concurrency/ThreadManager.h>
 #include <protocol/TBinaryProtocol.h>
+#include <server/TNonblockingServer.h>
+#include <server/TThreadPoolServer.h>
 #include <server/TThreadedServer.h>
 #include <transport/TBufferTransports.h>
 #include <transport/TServerSocket.h>
@@ -135,13 +139,63 @@ inline bool operator < (const SharedMutatorMapKey &skey1, const SharedMutatorMap
 
 typedef Meta::list<ThriftBrokerPolicy, DefaultCommPolicy> Policies;
 
+/**
+ * Map from object id to object, split into shards that each have their own
+ * mutex, so that concurrent requests on different objects seldom contend
+ * for the same lock.
+ */
+template <class ObjectT>
+class ShardedObjectMap {
+public:
+  void insert(::int64_t id, const ObjectT &obj) {
+    Shard &shard = get_shard(id);
+    ScopedLock lock(shard.mutex);
+    shard.map.insert(make_pair(id, obj)); // no overwrite
+  }
+
+  bool get(::int64_t id, ObjectT &obj) {
+    Shard &shard = get_shard(id);
+    ScopedLock lock(shard.mutex);
+    typename ObjectMap::iterator it = shard.map.find(id);
+
+    if (it == shard.map.end())
+      return false;
+    obj = it->second;
+    return true;
+  }
+
+  bool remove(::int64_t id) {
+    Shard &shard = get_shard(id);
+    ScopedLock lock(shard.mutex);
+    return shard.map.erase(id) > 0;
+  }
+
+private:
+  enum { SHARDS = 32 };
+
+  typedef hash_map< ::int64_t, ObjectT> ObjectMap;
+
+  struct Shard {
+    Mutex mutex;
+    ObjectMap map;
+  };
+
+  // ids are either sequential or object addresses; mix the bits so that
+  // both kinds spread evenly across the shards
+  Shard &get_shard(::int64_t id) {
+    return m_shards[(((::uint64_t)id * 0x9E3779B97F4A7C15ULL) >> 32) % SHARDS];
+  }
+
+  Shard m_shards[SHARDS];
+};
+
 typedef std::map<SharedMutatorMapKey, TableMutatorPtr> SharedMutatorMap;
-typedef hash_map< ::int64_t, TableScannerPtr> ScannerMap;
+typedef ShardedObjectMap<TableScannerPtr> ScannerMap;
 typedef hash_map< ::int64_t, TableScannerAsyncPtr> ScannerAsyncMap;
 typedef hash_map< ::int64_t, ::int64_t> ReverseScannerAsyncMap;
-typedef hash_map< ::int64_t, TableMutatorPtr> MutatorMap;
-typedef hash_map< ::int64_t, NamespacePtr> NamespaceMap;
-typedef hash_map< ::int64_t, FuturePtr> FutureMap;
+typedef ShardedObjectMap<TableMutatorPtr> MutatorMap;
+typedef ShardedObjectMap<NamespacePtr> NamespaceMap;
+typedef ShardedObjectMap<FuturePtr> FutureMap;
 typedef hash_map< ::int64_t, HqlInterpreterPtr> HqlInterpreterMap;
 typedef std::vector<ThriftGen::Cell> ThriftCells;
 typedef std::vector<CellAsArray> ThriftCellsAsArrays;
@@ -571,7 +625,7 @@ public:
     LOG_API("scanner="<< scanner_id);
 
     try {
-      SerializedCellsWriter writer(m_next_threshold);
+      SerializedCellsWriter &writer = get_next_writer();
       Hypertable::Cell cell;
 
       TableScannerPtr scanner = get_scanner(scanner_id);
@@ -590,7 +644,7 @@ public:
         }
       }
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      result.assign((char *)writer.get_buffer(), writer.get_buffer_length());
       LOG_API("scanner="<< scanner_id <<" result.size="<< result.size());
     } RETHROW()
   }
@@ -835,7 +889,7 @@ public:
     LOG_API("future=" << ff);
 
     try {
-      FuturePtr &future_ptr = get_future(ff);
+      FuturePtr future_ptr = get_future(ff);
       ResultPtr hresult;
       bool done = !(future_ptr->get(hresult));
       if (done) {
@@ -857,7 +911,7 @@ public:
     LOG_API("future=" << ff);
 
     try {
-      FuturePtr &future_ptr = get_future(ff);
+      FuturePtr future_ptr = get_future(ff);
       ResultPtr hresult;
       bool done = !(future_ptr->get(hresult));
       if (done) {
@@ -879,7 +933,7 @@ public:
     LOG_API("future=" << ff);
 
     try {
-      FuturePtr &future_ptr = get_future(ff);
+      FuturePtr future_ptr = get_future(ff);
       ResultPtr hresult;
       bool done = !(future_ptr->get(hresult));
       if (done) {
@@ -901,7 +955,7 @@ public:
     LOG_API("future=" << ff);
 
     try {
-      FuturePtr &future_ptr = get_future(ff);
+      FuturePtr future_ptr = get_future(ff);
       future_ptr->cancel();
     } RETHROW()
   }
@@ -1275,7 +1329,7 @@ public:
                       bool retry_table_not_found) {
     NamespacePtr namespace_ptr = get_namespace(ns);
     TablePtr t = namespace_ptr->open_table(table);
-    FuturePtr &future_ptr = get_future(ff);
+    FuturePtr future_ptr = get_future(ff);
 
     Hypertable::ScanSpec hss;
     convert_scan_spec(ss, hss);
@@ -1388,12 +1442,30 @@ public:
     get_mutator(mutator)->set_cells(cb.get());
   }
 
-  FuturePtr& get_future(::int64_t id) {
-    ScopedLock lock(m_future_mutex);
-    FutureMap::iterator it = m_future_map.find(id);
+  /**
+   * Returns the writer that next_cells_serialized() fills on this thread.
+   * Cells are copied from the scanner's ScanCells buffers straight into it,
+   * and reusing it saves allocating and faulting in a new buffer of
+   * ThriftBroker.NextThreshold bytes on every call.  A writer that had to
+   * grow past the threshold for an oversized cell is replaced.
+   */
+  SerializedCellsWriter &get_next_writer() {
+    SerializedCellsWriter *writer = m_next_writer.get();
 
-    if (it != m_future_map.end())
-      return it->second;
+    if (writer && writer->capacity() <= (size_t)m_next_threshold)
+      writer->clear();
+    else {
+      writer = new SerializedCellsWriter(m_next_threshold);
+      m_next_writer.reset(writer);
+    }
+    return *writer;
+  }
+
+  FuturePtr get_future(::int64_t id) {
+    FuturePtr ff;
+
+    if (m_future_map.get(id, ff))
+      return ff;
 
     HT_ERROR_OUT << "Bad future id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_FUTURE_ID,
@@ -1402,12 +1474,11 @@ public:
   }
 
 
-  NamespacePtr& get_namespace(::int64_t id) {
-    ScopedLock lock(m_namespace_mutex);
-    NamespaceMap::iterator it = m_namespace_map.find(id);
+  NamespacePtr get_namespace(::int64_t id) {
+    NamespacePtr ns;
 
-    if (it != m_namespace_map.end())
-      return it->second;
+    if (m_namespace_map.get(id, ns))
+      return ns;
 
     HT_ERROR_OUT << "Bad namespace id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_NAMESPACE_ID,
@@ -1417,27 +1488,32 @@ public:
 
   // returned id is guaranteed to be unique and non-zero
   ::int64_t get_future_id(FuturePtr *ff) {
-    ScopedLock lock(m_future_mutex);
-    ::int64_t id = m_next_future_id++;
-
-    m_future_map.insert(make_pair(id, *ff)); // no overwrite
+    ::int64_t id;
+    {
+      ScopedLock lock(m_id_mutex);
+      id = m_next_future_id++;
+    }
+    m_future_map.insert(id, *ff); // no overwrite
     return id;
   }
 
 
   // returned id is guaranteed to be unique and non-zero
   ::int64_t get_namespace_id(NamespacePtr *ns) {
-    ScopedLock lock(m_namespace_mutex);
     // generate unique random 64 bit int id
     // TODO make id random for security reasons
     //::int64_t id = Random::number64();
-    ::int64_t id = m_next_namespace_id++;
+    ::int64_t id;
+    {
+      ScopedLock lock(m_id_mutex);
+      id = m_next_namespace_id++;
+    }
 
     // TODO make id random for security reasons
     //while (m_namespace_map.find(id) != m_namespace_map.end() || id == 0) {
     //  id = Random::number64();
     //}
-    m_namespace_map.insert(make_pair(id, *ns)); // no overwrite
+    m_namespace_map.insert(id, *ns); // no overwrite
     return id;
   }
 
@@ -1470,18 +1546,16 @@ public:
   }
 
   ::int64_t get_scanner_id(TableScanner *scanner) {
-    ScopedLock lock(m_scanner_mutex);
     ::int64_t id = (::int64_t)scanner;
-    m_scanner_map.insert(make_pair(id, scanner)); // no overwrite
+    m_scanner_map.insert(id, scanner); // no overwrite
     return id;
   }
 
   TableScannerPtr get_scanner(::int64_t id) {
-    ScopedLock lock(m_scanner_mutex);
-    ScannerMap::iterator it = m_scanner_map.find(id);
+    TableScannerPtr scanner;
 
-    if (it != m_scanner_map.end())
-      return it->second;
+    if (m_scanner_map.get(id, scanner))
+      return scanner;
 
     HT_ERROR_OUT << "Bad scanner id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_SCANNER_ID,
@@ -1489,13 +1563,8 @@ public:
   }
 
   void remove_scanner(::int64_t id) {
-    ScopedLock lock(m_scanner_mutex);
-    ScannerMap::iterator it = m_scanner_map.find(id);
-
-    if (it != m_scanner_map.end()) {
-      m_scanner_map.erase(it);
+    if (m_scanner_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad scanner id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_SCANNER_ID,
@@ -1520,9 +1589,8 @@ public:
   }
 
   ::int64_t get_mutator_id(TableMutator *mutator) {
-    ScopedLock lock(m_mutator_mutex);
     ::int64_t id = (::int64_t)mutator;
-    m_mutator_map.insert(make_pair(id, mutator)); // no overwrite
+    m_mutator_map.insert(id, mutator); // no overwrite
     return id;
   }
 
@@ -1575,11 +1643,10 @@ public:
   }
 
   TableMutatorPtr get_mutator(::int64_t id) {
-    ScopedLock lock(m_mutator_mutex);
-    MutatorMap::iterator it = m_mutator_map.find(id);
+    TableMutatorPtr mutator;
 
-    if (it != m_mutator_map.end())
-      return it->second;
+    if (m_mutator_map.get(id, mutator))
+      return mutator;
 
     HT_ERROR_OUT << "Bad mutator id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_MUTATOR_ID,
@@ -1587,13 +1654,8 @@ public:
   }
 
   void remove_future_from_map(::int64_t id) {
-    ScopedLock lock(m_future_mutex);
-    FutureMap::iterator it = m_future_map.find(id);
-
-    if (it != m_future_map.end()) {
-      m_future_map.erase(it);
+    if (m_future_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad future id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_FUTURE_ID,
@@ -1601,13 +1663,8 @@ public:
   }
 
   void remove_namespace_from_map(::int64_t id) {
-    ScopedLock lock(m_namespace_mutex);
-    NamespaceMap::iterator it = m_namespace_map.find(id);
-
-    if (it != m_namespace_map.end()) {
-      m_namespace_map.erase(it);
+    if (m_namespace_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad namespace id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_NAMESPACE_ID,
@@ -1616,13 +1673,8 @@ public:
 
 
   void remove_mutator(::int64_t id) {
-    ScopedLock lock(m_mutator_mutex);
-    MutatorMap::iterator it = m_mutator_map.find(id);
-
-    if (it != m_mutator_map.end()) {
-      m_mutator_map.erase(it);
+    if (m_mutator_map.remove(id))
       return;
-    }
 
     HT_ERROR_OUT << "Bad mutator id - " << id << HT_END;
     THROW_TE(Error::THRIFTBROKER_BAD_MUTATOR_ID,
@@ -1631,23 +1683,21 @@ public:
 
 private:
   bool             m_log_api;
-  Mutex            m_scanner_mutex;
   ScannerMap       m_scanner_map;
-  Mutex            m_mutator_mutex;
   MutatorMap       m_mutator_map;
   Mutex            m_shared_mutator_mutex;
   ::int64_t        m_next_namespace_id;
   NamespaceMap     m_namespace_map;
-  Mutex            m_namespace_mutex;
   ScannerAsyncMap  m_scanner_async_map;
   ReverseScannerAsyncMap m_reverse_scanner_async_map;
   Mutex            m_scanner_async_mutex;
   ::int64_t        m_next_future_id;
   FutureMap        m_future_map;
-  Mutex            m_future_mutex;
+  Mutex            m_id_mutex;
   ::int32_t        m_future_queue_size;
   SharedMutatorMap m_shared_mutator_map;
   ::int32_t        m_next_threshold;
+  boost::thread_specific_ptr<SerializedCellsWriter> m_next_writer;
   ClientPtr        m_client;
   Mutex            m_interp_mutex;
   HqlInterpreterMap m_hql_interp_map;
@@ -1700,25 +1750,56 @@ int main(int argc, char **argv) {
     init_with_policies<Policies>(argc, argv);
 
     ::uint16_t port = get_i16("port");
+    String server_type = get_str("server-type");
     boost::shared_ptr<TProtocolFactory> protocolFactory(new TBinaryProtocolFactory());
     boost::shared_ptr<ServerHandler> handler(new ServerHandler());
     boost::shared_ptr<TProcessor> processor(new HqlServiceProcessor(handler));
+    boost::shared_ptr<ThreadManager> threadManager;
+    boost::shared_ptr<TServer> server;
+
+    if (server_type == "pool" || server_type == "nonblocking") {
+      threadManager = ThreadManager::newSimpleThreadManager(get_i32("workers"));
+      threadManager->threadFactory(
+          boost::shared_ptr<PosixThreadFactory>(new PosixThreadFactory()));
+      threadManager->start();
+    }
 
-    boost::shared_ptr<TServerTransport> serverTransport;
-
-    if (has("thrift-timeout")) {
-      int timeout_ms = get_i32("thrift-timeout");
-      serverTransport.reset( new TServerSocket(port, timeout_ms, timeout_ms) );
+    if (server_type == "nonblocking") {
+      // TNonblockingServer has no socket timeout; fail rather than serve
+      // without the timeout that was asked for
+      if (has("thrift-timeout"))
+        HT_THROW(Error::CONFIG_BAD_VALUE, "ThriftBroker.Timeout is not "
+                 "supported by the nonblocking server type");
+      // connections are multiplexed on an event loop and only a request
+      // being processed occupies a worker thread
+      server.reset(new TNonblockingServer(processor, protocolFactory, port,
+                                          threadManager));
     }
-    else
-      serverTransport.reset( new TServerSocket(port) );
+    else {
+      boost::shared_ptr<TServerTransport> serverTransport;
+
+      if (has("thrift-timeout")) {
+        int timeout_ms = get_i32("thrift-timeout");
+        serverTransport.reset( new TServerSocket(port, timeout_ms, timeout_ms) );
+      }
+      else
+        serverTransport.reset( new TServerSocket(port) );
 
-    boost::shared_ptr<TTransportFactory> transportFactory(new TFramedTransportFactory());
+      boost::shared_ptr<TTransportFactory> transportFactory(new TFramedTransportFactory());
 
-    TThreadedServer server(processor, serverTransport, transportFactory, protocolFactory);
+      if (server_type == "pool")
+        server.reset(new TThreadPoolServer(processor, serverTransport,
+            transportFactory, protocolFactory, threadManager));
+      else if (server_type == "threaded")
+        server.reset(new TThreadedServer(processor, serverTransport,
+            transportFactory, protocolFactory));
+      else
+        HT_THROWF(Error::CONFIG_BAD_VALUE, "Unknown server type '%s'",
+                  server_type.c_str());
+    }
 
-    HT_INFO("Starting the server...");
-    server.serve();
+    HT_INFOF("Starting the server (%s)...", server_type.c_str());
+    server->serve();
     HT_INFO("Exiting.\n");
   }
   catch (Hypertable::Exception &e) {
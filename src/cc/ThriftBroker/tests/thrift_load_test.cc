@@ -0,0 +1,283 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Init.h"
+#include "Common/Mutex.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "ThriftBroker/Client.h"
+#include "ThriftBroker/Config.h"
+#include "ThriftBroker/SerializedCellsReader.h"
+#include "ThriftBroker/SerializedCellsWriter.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "usage: thrift_load_test [options]\n\n"
+    "Description:\n"
+    "  Loads cells into a table through the ThriftBroker and scans them\n"
+    "  back, once for each of the given numbers of concurrent connections,\n"
+    "  and reports the cells/s achieved at each connection count.  Every\n"
+    "  connection writes and scans its own range of rows with the\n"
+    "  serialized cells API.";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("connections", str()->default_value("1,10,100"),
+            "Comma separated list of connection counts to run with")
+        ("cells", i32()->default_value(10000),
+            "Number of cells written and scanned by each connection")
+        ("value-size", i32()->default_value(100), "Size of each value")
+        ("batch-size", i32()->default_value(1000),
+            "Number of cells sent in each set_cells_serialized call")
+        ("table", str()->default_value("ThriftLoadTest"),
+            "Table to load (created in the root namespace if missing)")
+        ("no-scan", boo()->zero_tokens()->default_value(false),
+            "Only load the cells")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, ThriftClientPolicy, DefaultPolicy> Policies;
+
+  struct LoadSpec {
+    String host;
+    int port;
+    String table;
+    int32_t cells;
+    int32_t value_size;
+    int32_t batch_size;
+  };
+
+  /**
+   * One connection's share of the load.  Writes its cells under the row
+   * prefix "<run>-<connection>-" and, in the second phase, scans them back.
+   */
+  class Connection {
+  public:
+    Connection(const LoadSpec &spec, const String &prefix)
+      : m_spec(spec), m_prefix(prefix), m_cells_scanned(0), m_error(false) { }
+
+    void load() {
+      try {
+        Thrift::Client client(m_spec.host, m_spec.port);
+        ThriftGen::Namespace ns = client.open_namespace("/");
+        ThriftGen::Mutator mutator = client.open_mutator(ns, m_spec.table, 0, 0);
+        String value(m_spec.value_size, 'v');
+        SerializedCellsWriter writer(0, true);
+        std::string cells;
+
+        for (int32_t i = 0; i < m_spec.cells; i++) {
+          String row = format("%s%09d", m_prefix.c_str(), i);
+          writer.add(row.c_str(), "data", "", AUTO_ASSIGN, value.c_str(),
+                     value.length());
+          if ((i + 1) % m_spec.batch_size == 0 || i + 1 == m_spec.cells) {
+            writer.finalize(SerializedCellsFlag::EOB);
+            cells.assign((char *)writer.get_buffer(),
+                         writer.get_buffer_length());
+            client.set_cells_serialized(mutator, cells, false);
+            writer.clear();
+          }
+        }
+        client.close_mutator(mutator, true);
+        client.close_namespace(ns);
+      }
+      catch (ThriftGen::ClientException &e) {
+        report(e.message);
+      }
+      catch (std::exception &e) {
+        report(e.what());
+      }
+    }
+
+    void scan() {
+      try {
+        Thrift::Client client(m_spec.host, m_spec.port);
+        ThriftGen::Namespace ns = client.open_namespace("/");
+        ThriftGen::ScanSpec ss;
+        ThriftGen::RowInterval ri;
+
+        ri.start_row = m_prefix;
+        ri.__isset.start_row = true;
+        ri.end_row = m_prefix + "~";
+        ri.__isset.end_row = true;
+        ss.row_intervals.push_back(ri);
+        ss.__isset.row_intervals = true;
+
+        ThriftGen::Scanner scanner = client.open_scanner(ns, m_spec.table, ss,
+                                                         true);
+        bool eos = false;
+        std::string cells;
+
+        while (!eos) {
+          client.next_cells_serialized(cells, scanner);
+          SerializedCellsReader reader((void *)cells.c_str(),
+                                       (uint32_t)cells.length());
+          while (reader.next())
+            m_cells_scanned++;
+          eos = reader.eos();
+        }
+        client.close_scanner(scanner);
+        client.close_namespace(ns);
+      }
+      catch (ThriftGen::ClientException &e) {
+        report(e.message);
+      }
+      catch (std::exception &e) {
+        report(e.what());
+      }
+    }
+
+    int64_t cells_scanned() const { return m_cells_scanned; }
+    bool error() const { return m_error; }
+
+  private:
+    void report(const String &message) {
+      static Mutex mutex;
+      ScopedLock lock(mutex);
+      cerr << "Connection " << m_prefix << ": " << message << endl;
+      m_error = true;
+    }
+
+    const LoadSpec &m_spec;
+    String m_prefix;
+    int64_t m_cells_scanned;
+    bool m_error;
+  };
+
+  /**
+   * Runs <code>phase</code> on every connection, each on its own thread,
+   * and returns the elapsed seconds
+   */
+  double run(vector<Connection *> &connections, void (Connection::*phase)()) {
+    boost::thread_group threads;
+    Stopwatch stopwatch;
+
+    foreach(Connection *connection, connections)
+      threads.create_thread(boost::bind(phase, connection));
+    threads.join_all();
+    stopwatch.stop();
+    return stopwatch.elapsed();
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  LoadSpec spec;
+  vector<String> counts;
+  bool failed = false;
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    spec.host = get_str("thrift-host");
+    spec.port = get_i16("thrift-port");
+    spec.table = get_str("table");
+    spec.cells = get_i32("cells");
+    spec.value_size = get_i32("value-size");
+    spec.batch_size = get_i32("batch-size");
+    bool scan = !get_bool("no-scan");
+
+    String connections_str = get_str("connections");
+    boost::split(counts, connections_str, boost::is_any_of(","));
+
+    {
+      Thrift::Client client(spec.host, spec.port);
+      ThriftGen::Namespace ns = client.open_namespace("/");
+      if (!client.exists_table(ns, spec.table))
+        client.create_table(ns, spec.table, "<Schema><AccessGroup name=\"default\">"
+                            "<ColumnFamily><Name>data</Name></ColumnFamily>"
+                            "</AccessGroup></Schema>");
+      client.close_namespace(ns);
+    }
+
+    printf("%12s %14s %14s %12s\n", "connections", "load cells/s", "scan cells/s",
+           "errors");
+
+    for (size_t run_id = 0; run_id < counts.size(); run_id++) {
+      int count = atoi(counts[run_id].c_str());
+      vector<Connection *> connections;
+      double load_elapsed, scan_elapsed = 0.0;
+      int64_t total_cells = (int64_t)count * spec.cells;
+      int64_t scanned = 0;
+      int errors = 0;
+
+      if (count <= 0)
+        continue;
+
+      for (int i = 0; i < count; i++)
+        connections.push_back(new Connection(spec,
+            format("%d-%d-%d-", (int)getpid(), (int)run_id, i)));
+
+      load_elapsed = run(connections, &Connection::load);
+      if (scan)
+        scan_elapsed = run(connections, &Connection::scan);
+
+      foreach(Connection *connection, connections) {
+        scanned += connection->cells_scanned();
+        if (connection->error())
+          errors++;
+        delete connection;
+      }
+
+      if (scan && scanned != total_cells && errors == 0) {
+        cerr << "Scanned " << scanned << " cells, expected " << total_cells
+             << endl;
+        failed = true;
+      }
+      if (errors)
+        failed = true;
+
+      printf("%12d %14.2f %14.2f %12d\n", count,
+             (double)total_cells / load_elapsed,
+             scan ? (double)scanned / scan_elapsed : 0.0, errors);
+      fflush(stdout);
+    }
+  }
+  catch (ThriftGen::ClientException &e) {
+    cerr << e.message << endl;
+    return 1;
+  }
+  catch (std::exception &e) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include "Common/Init.h"
+#include "Common/Error.h"
+#include "Common/FileUtils.h"
+#include "Common/InetAddr.h"
+#include "Common/Logger.h"
+#include "Common/Path.h"
+#include "Common/StaticBuffer.h"
+#include "Common/System.h"
+#include "Common/Usage.h"
+
+#include "AsyncComm/ConnectionManager.h"
+#include "AsyncComm/ReactorFactory.h"
+
+#include "DfsBroker/Lib/Client.h"
+#include "DfsBroker/Lib/LocalDirect.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: localDirectTest",
+    "",
+    "  This program writes files through the local DFS broker and reads",
+    "  them back through DfsBroker::LocalDirect, with pread, read and seek",
+    "  at block edges and past the end of file.  Files under the mapped",
+    "  prefix must be served from a mapping, all others by the broker.",
+    "  It assumes a local DFS broker is listening at DfsBroker.Port.",
+    (const char *)0
+  };
+
+  const size_t BLOCK_SIZE = 4096;
+  const size_t FILE_SIZE = 3 * BLOCK_SIZE + 100;
+
+  uint8_t expected[FILE_SIZE];
+
+  void write_file(Filesystem *fs, const String &fname) {
+    int fd = fs->create(fname, Filesystem::OPEN_FLAG_OVERWRITE, -1, -1, -1);
+    StaticBuffer sbuf(FILE_SIZE);
+    memcpy(sbuf.base, expected, FILE_SIZE);
+    fs->append(fd, sbuf);
+    fs->close(fd);
+  }
+
+  void check_data(const uint8_t *buf, size_t len, size_t nread,
+                  uint64_t offset, size_t expected_len, const char *what) {
+    if (nread != expected_len ||
+        memcmp(buf, expected + offset, expected_len)) {
+      HT_ERRORF("%s at offset %llu, length %d: got %d bytes, expected %d",
+                what, (Llu)offset, (int)len, (int)nread, (int)expected_len);
+      exit(1);
+    }
+  }
+
+  size_t expected_length(uint64_t offset, size_t len) {
+    if (offset >= FILE_SIZE)
+      return 0;
+    return offset + len > FILE_SIZE ? FILE_SIZE - offset : len;
+  }
+
+  /**
+   * Reads the file with pread, read and seek at block edges and past the
+   * end of file, and checks the data against what was written
+   */
+  void check_reads(DfsBroker::LocalDirect *ld, int fd) {
+    uint8_t buf[2 * BLOCK_SIZE];
+    uint64_t offsets[] = { 0, 1, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1,
+                           2 * BLOCK_SIZE, FILE_SIZE - 1, FILE_SIZE,
+                           FILE_SIZE + 1, FILE_SIZE + BLOCK_SIZE };
+    size_t lengths[] = { 1, 2, BLOCK_SIZE - 1, BLOCK_SIZE, BLOCK_SIZE + 1,
+                         2 * BLOCK_SIZE };
+
+    for (size_t i=0; i<sizeof(offsets)/sizeof(uint64_t); i++) {
+      for (size_t j=0; j<sizeof(lengths)/sizeof(size_t); j++) {
+        uint64_t offset = offsets[i];
+        size_t len = lengths[j];
+        size_t elen = expected_length(offset, len);
+
+        size_t nread = ld->pread(fd, buf, len, offset);
+        check_data(buf, len, nread, offset, elen, "pread");
+
+        ld->seek(fd, offset);
+        nread = ld->read(fd, buf, len);
+        check_data(buf, len, nread, offset, elen, "read");
+
+        // the position advances by what was read
+        nread = ld->read(fd, buf, BLOCK_SIZE);
+        check_data(buf, BLOCK_SIZE, nread, offset + elen,
+                   expected_length(offset + elen, BLOCK_SIZE),
+                   "read after read");
+      }
+    }
+
+    // sequential read of the whole file in odd sized pieces
+    ld->seek(fd, 0);
+    uint64_t offset = 0;
+    size_t nread;
+    while ((nread = ld->read(fd, buf, 1000)) > 0) {
+      check_data(buf, 1000, nread, offset, expected_length(offset, 1000),
+                 "sequential read");
+      offset += nread;
+    }
+    HT_ASSERT(offset == FILE_SIZE);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (argc != 1)
+      Usage::dump_and_exit(usage);
+
+    System::initialize(argv[0]);
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    client = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    // same root as the RangeServer computes for DfsBroker.LocalDirect
+    Path root = Config::properties->get_str("DfsBroker.Local.Root",
+                                            "fs/local");
+    if (!root.is_complete()) {
+      Path data_dir = Config::properties->get_str("Hypertable.DataDirectory");
+      root = data_dir / root;
+    }
+
+    for (size_t i=0; i<FILE_SIZE; i++)
+      expected[i] = (uint8_t)((i * 7 + i / BLOCK_SIZE) & 0xff);
+
+    String testdir = format("/localDirectTest%d", (int)getpid());
+    String mapped_file = testdir + "/tables/cs0";
+    String log_file = testdir + "/log/0";
+    client->mkdirs(testdir + "/tables");
+    client->mkdirs(testdir + "/log");
+    write_file(client.get(), mapped_file);
+    write_file(client.get(), log_file);
+
+    if (!FileUtils::exists(root.string() + mapped_file)) {
+      HT_ERRORF("%s not found under %s, is the broker a local broker?",
+                mapped_file.c_str(), root.string().c_str());
+      return 1;
+    }
+
+    FilesystemPtr broker = client.get();
+    DfsBroker::LocalDirectPtr ld =
+        new DfsBroker::LocalDirect(broker, root.string(), testdir + "/tables/");
+
+    // CellStore path, served from the mapping
+    int fd = ld->open(mapped_file);
+    HT_ASSERT(ld->get_mapping(fd));
+    HT_ASSERT(ld->get_mapping(fd)->length() == FILE_SIZE);
+    check_reads(ld.get(), fd);
+    ld->close(fd);
+    HT_ASSERT(!ld->get_mapping(fd));
+
+    fd = ld->open_buffered(mapped_file, 0, BLOCK_SIZE, 2);
+    HT_ASSERT(ld->get_mapping(fd));
+    check_reads(ld.get(), fd);
+
+    // any other path falls back to the broker
+    int log_fd = ld->open(log_file);
+    HT_ASSERT(!ld->get_mapping(log_fd));
+    check_reads(ld.get(), log_fd);
+
+    // preadv over both kinds of descriptors
+    {
+      uint8_t buf[4][BLOCK_SIZE];
+      vector<Filesystem::ReadRegion> regions;
+      regions.push_back(Filesystem::ReadRegion(fd, BLOCK_SIZE - 10,
+                                               BLOCK_SIZE, buf[0]));
+      regions.push_back(Filesystem::ReadRegion(log_fd, 2 * BLOCK_SIZE + 5,
+                                               100, buf[1]));
+      regions.push_back(Filesystem::ReadRegion(fd, FILE_SIZE - 50,
+                                               BLOCK_SIZE, buf[2]));
+      regions.push_back(Filesystem::ReadRegion(log_fd, FILE_SIZE - 50,
+                                               BLOCK_SIZE, buf[3]));
+      ld->preadv(regions);
+      for (size_t i=0; i<regions.size(); i++)
+        check_data(buf[i], regions[i].amount, regions[i].nread,
+                   regions[i].offset,
+                   expected_length(regions[i].offset, regions[i].amount),
+                   "preadv");
+    }
+
+    ld->close(fd);
+    ld->close(log_fd);
+
+    client->rmdir(testdir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -0,0 +1,267 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include "Common/Config.h"
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include "Common/Init.h"
+#include "Common/Error.h"
+#include "Common/InetAddr.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+#include "Common/StaticBuffer.h"
+#include "Common/System.h"
+#include "Common/Usage.h"
+
+#include "AsyncComm/ConnectionManager.h"
+#include "AsyncComm/Event.h"
+#include "AsyncComm/ReactorFactory.h"
+
+#include "DfsBroker/Lib/Client.h"
+#include "DfsBroker/Lib/Protocol.h"
+
+using namespace Hypertable;
+using namespace Serialization;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: preadvTest",
+    "",
+    "  This program tests the encoding and decoding of preadv requests and",
+    "  responses, the classification of error responses that make the",
+    "  client fall back to pread, and preadv against the DFS broker",
+    "  listening at DfsBroker.Port.",
+    (const char *)0
+  };
+
+  typedef Filesystem::ReadRegion ReadRegion;
+
+  void test_request_encoding() {
+    vector<ReadRegion> regions;
+    regions.push_back(ReadRegion(3, 0, 100, 0));
+    regions.push_back(ReadRegion(7, 1LL << 33, 4096, 0));
+    regions.push_back(ReadRegion(-1, 12345, 0, 0));
+
+    CommBufPtr cbp(DfsBroker::Protocol::create_preadv_request(regions));
+    HT_ASSERT(cbp->header.command == DfsBroker::Protocol::COMMAND_PREADV);
+
+    const uint8_t *decode_ptr = cbp->data.base + cbp->header.encoded_length();
+    size_t decode_remain = (const uint8_t *)cbp->get_data_ptr() - decode_ptr;
+    HT_ASSERT(decode_remain == 4 + 16 * regions.size());
+
+    HT_ASSERT(decode_i32(&decode_ptr, &decode_remain) == regions.size());
+    for (size_t i=0; i<regions.size(); i++) {
+      HT_ASSERT((int32_t)decode_i32(&decode_ptr, &decode_remain)
+                == regions[i].fd);
+      HT_ASSERT(decode_i64(&decode_ptr, &decode_remain) == regions[i].offset);
+      HT_ASSERT(decode_i32(&decode_ptr, &decode_remain) == regions[i].amount);
+    }
+    HT_ASSERT(decode_remain == 0);
+  }
+
+  /**
+   * Builds a preadv response in the broker's format: error, region count,
+   * bytes read per region, then one slot of <code>amount</code> bytes per
+   * region.  <code>slot_bytes</code> is the number of slot bytes actually
+   * included, to produce truncated responses.
+   */
+  EventPtr make_response(int error, const vector<ReadRegion> &regions,
+                         const vector<uint32_t> &nread, size_t slot_bytes) {
+    EventPtr event = new Event(Event::MESSAGE, Error::OK);
+    size_t len = 8 + 4 * nread.size() + slot_bytes;
+    uint8_t *buf = new uint8_t [len];
+    event->payload = buf;
+    event->payload_len = len;
+    encode_i32(&buf, error);
+    encode_i32(&buf, nread.size());
+    for (size_t i=0; i<nread.size(); i++)
+      encode_i32(&buf, nread[i]);
+    for (size_t i=0; i<regions.size() && slot_bytes; i++) {
+      size_t n = min((size_t)regions[i].amount, slot_bytes);
+      for (size_t j=0; j<n; j++)
+        *buf++ = (uint8_t)(i + j);
+      slot_bytes -= n;
+    }
+    return event;
+  }
+
+  int decode_error(EventPtr &event, vector<ReadRegion> &regions) {
+    try {
+      Filesystem::decode_response_preadv(event, regions);
+    }
+    catch (Exception &e) {
+      return e.code();
+    }
+    return Error::OK;
+  }
+
+  void test_response_decoding() {
+    uint8_t dst[2][300];
+    vector<ReadRegion> regions;
+    regions.push_back(ReadRegion(3, 0, 100, dst[0]));
+    regions.push_back(ReadRegion(4, 500, 300, dst[1]));
+    vector<uint32_t> nread;
+    nread.push_back(100);
+    nread.push_back(40);   // short read at end of file
+
+    EventPtr event = make_response(Error::OK, regions, nread, 400);
+    Filesystem::decode_response_preadv(event, regions);
+    HT_ASSERT(regions[0].nread == 100 && regions[1].nread == 40);
+    for (size_t j=0; j<100; j++)
+      HT_ASSERT(dst[0][j] == (uint8_t)j);
+    for (size_t j=0; j<40; j++)
+      HT_ASSERT(dst[1][j] == (uint8_t)(1 + j));
+
+    // the broker's error code is passed on
+    event = make_response(Error::DFSBROKER_BAD_FILE_HANDLE, regions, nread, 0);
+    HT_ASSERT(decode_error(event, regions) == Error::DFSBROKER_BAD_FILE_HANDLE);
+
+    // a response for a different number of regions
+    vector<uint32_t> one(1, 100);
+    event = make_response(Error::OK, regions, one, 100);
+    HT_ASSERT(decode_error(event, regions) == Error::PROTOCOL_ERROR);
+
+    // data slots cut short
+    event = make_response(Error::OK, regions, nread, 399);
+    HT_ASSERT(decode_error(event, regions) == Error::RESPONSE_TRUNCATED);
+    event = make_response(Error::OK, regions, nread, 50);
+    HT_ASSERT(decode_error(event, regions) == Error::RESPONSE_TRUNCATED);
+
+    // more bytes read than asked for
+    nread[1] = 301;
+    event = make_response(Error::OK, regions, nread, 400);
+    HT_ASSERT(decode_error(event, regions) == Error::RESPONSE_TRUNCATED);
+  }
+
+  void test_unknown_command() {
+    using DfsBroker::Protocol;
+    HT_ASSERT(Protocol::is_unknown_command(Error::NOT_IMPLEMENTED, ""));
+    HT_ASSERT(Protocol::is_unknown_command(Error::PROTOCOL_ERROR,
+        "Invalid command (12) - HYPERTABLE protocol error"));
+    HT_ASSERT(Protocol::is_unknown_command(Error::PROTOCOL_ERROR,
+        "Unimplemented command (12) - HYPERTABLE protocol error"));
+    // a malformed request to a broker that does know preadv
+    HT_ASSERT(!Protocol::is_unknown_command(Error::PROTOCOL_ERROR,
+        "Error handling PREADV message"));
+    HT_ASSERT(!Protocol::is_unknown_command(Error::DFSBROKER_INVALID_ARGUMENT,
+        "Invalid command (12)"));
+  }
+
+  void test_broker(DfsBroker::Client *client, const String &testdir) {
+    const size_t file_size = 10000;
+    String fname = testdir + "/preadv";
+    uint8_t expected[file_size];
+
+    for (size_t i=0; i<file_size; i++)
+      expected[i] = (uint8_t)(i * 13);
+
+    int fd = client->create(fname, Filesystem::OPEN_FLAG_OVERWRITE, -1, -1, -1);
+    StaticBuffer sbuf(file_size);
+    memcpy(sbuf.base, expected, file_size);
+    client->append(fd, sbuf);
+    client->close(fd);
+
+    fd = client->open(fname);
+
+    uint8_t dst[4][4096];
+    vector<ReadRegion> regions;
+    regions.push_back(ReadRegion(fd, 0, 4096, dst[0]));
+    regions.push_back(ReadRegion(fd, 4095, 2, dst[1]));
+    regions.push_back(ReadRegion(fd, file_size - 100, 4096, dst[2]));
+    regions.push_back(ReadRegion(fd, file_size + 10, 100, dst[3]));
+    client->preadv(regions);
+
+    for (size_t i=0; i<regions.size(); i++) {
+      uint64_t offset = regions[i].offset;
+      size_t len = offset >= file_size ? 0
+          : min((size_t)regions[i].amount, (size_t)(file_size - offset));
+      HT_ASSERT(regions[i].nread == len);
+      HT_ASSERT(memcmp(dst[i], expected + offset, len) == 0);
+    }
+
+    // a bad descriptor is an error, not a reason to fall back
+    vector<ReadRegion> bad(1, ReadRegion(fd + 1000, 0, 10, dst[0]));
+    bool threw = false;
+    try {
+      client->preadv(bad);
+    }
+    catch (Exception &e) {
+      threw = true;
+    }
+    HT_ASSERT(threw);
+
+    client->close(fd);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+    ConnectionManagerPtr conn_mgr;
+    DfsBroker::ClientPtr client;
+
+    Config::init(argc, argv);
+
+    if (argc != 1)
+      Usage::dump_and_exit(usage);
+
+    System::initialize(argv[0]);
+
+    test_request_encoding();
+    test_response_decoding();
+    test_unknown_command();
+
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("DfsBroker.Port");
+    InetAddr::initialize(&addr, "localhost", port);
+
+    conn_mgr = new ConnectionManager();
+    client = new DfsBroker::Client(conn_mgr, addr, 15000);
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    String testdir = format("/preadvTest%d", (int)getpid());
+    client->mkdirs(testdir);
+    test_broker(client.get(), testdir);
+    client->rmdir(testdir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  cout << "SUCCESS" << endl;
+  return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+
+#include "Common/Init.h"
+#include "Common/Error.h"
+#include "Common/Mutex.h"
+#include "Common/ServerLauncher.h"
+#include "Common/Stopwatch.h"
+#include "Common/String.h"
+#include "Common/System.h"
+#include "Common/Thread.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/Config.h"
+
+#include "Hyperspace/Config.h"
+#include "Hyperspace/Session.h"
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace Hyperspace;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "usage: hyperspaceBench [options]\n\n"
+    "Description:\n"
+    "  Measures Hyperspace master throughput.  Launches a Hyperspace server\n"
+    "  rooted at ./hsroot (like hyperspaceTest) and, for each of the given\n"
+    "  numbers of client threads, has every thread issue a mix of attr_get,\n"
+    "  exists and attr_set requests through its own session, reporting the\n"
+    "  ops/s achieved.  The runs are repeated against a master started with\n"
+    "  Hyperspace.GroupCommit and Hyperspace.SnapshotReads disabled.  Run it\n"
+    "  from the hyperspaceTest directory with --config=./hyperspaceTest.cfg";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("threads", str()->default_value("1,2,4,8,16,32"),
+            "Comma separated list of client thread counts to run with")
+        ("ops", i32()->default_value(5000),
+            "Number of requests issued by each thread")
+        ("read-percent", i32()->default_value(80),
+            "Percentage of requests that are reads (attr_get or exists)")
+        ("value-size", i32()->default_value(64), "Size of attribute values")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, HyperspaceClientPolicy, DefaultCommPolicy>
+          Policies;
+
+  struct BenchSpec {
+    int32_t ops;
+    int32_t read_percent;
+    int32_t value_size;
+  };
+
+  /**
+   * One client thread.  Creates its own file /bench/<run>-<thread> and
+   * issues the request mix against it.
+   */
+  class Client {
+  public:
+    Client(const BenchSpec &spec, const String &fname)
+      : m_spec(spec), m_fname(fname), m_error(false) { }
+
+    void operator()() {
+      try {
+        SessionPtr session = new Hyperspace::Session(Comm::instance(),
+                                                     properties);
+        if (!session->wait_for_connection(30000))
+          HT_THROW(Error::REQUEST_TIMEOUT, "Unable to connect to Hyperspace");
+
+        String value(m_spec.value_size, 'v');
+        DynamicBuffer dbuf;
+        uint64_t handle = session->open(m_fname, OPEN_FLAG_READ |
+                                        OPEN_FLAG_WRITE | OPEN_FLAG_CREATE);
+        session->attr_set(handle, "value", value.c_str(), value.length());
+
+        for (int32_t i = 0; i < m_spec.ops; i++) {
+          if ((int32_t)(System::rand32() % 100) >= m_spec.read_percent)
+            session->attr_set(handle, "value", value.c_str(), value.length());
+          else if (i % 2)
+            session->exists(m_fname);
+          else
+            session->attr_get(handle, "value", dbuf);
+        }
+
+        session->close(handle);
+        session->unlink(m_fname);
+      }
+      catch (Exception &e) {
+        static Mutex mutex;
+        ScopedLock lock(mutex);
+        cerr << m_fname << ": " << e << endl;
+        m_error = true;
+      }
+    }
+
+    bool error() const { return m_error; }
+
+  private:
+    const BenchSpec &m_spec;
+    String m_fname;
+    bool m_error;
+  };
+
+  /**
+   * Launches a master with the given extra arguments and runs every thread
+   * count against it.  Returns the number of clients that failed.
+   */
+  int run_master(const BenchSpec &spec, const char *label,
+                 vector<String> &master_args, vector<String> &counts) {
+    vector<const char *> argv;
+    int errors = 0;
+
+    if (system("/bin/rm -rf ./hsroot") != 0 ||
+        system("mkdir -p ./hsroot") != 0) {
+      HT_ERROR("Unable to recreate ./hsroot directory");
+      exit(1);
+    }
+
+    argv.push_back("Hyperspace.Master");
+    foreach(const String &arg, master_args)
+      argv.push_back(arg.c_str());
+    argv.push_back((const char *)0);
+
+    ServerLauncher master("./Hyperspace.Master", (char * const *)&argv[0],
+                          "hyperspaceBench.out", true);
+
+    {
+      SessionPtr session = new Hyperspace::Session(Comm::instance(),
+                                                   properties);
+      if (!session->wait_for_connection(30000))
+        HT_THROW(Error::REQUEST_TIMEOUT, "Unable to connect to Hyperspace");
+      if (!session->exists("/bench"))
+        session->mkdir("/bench");
+    }
+
+    for (size_t run_id = 0; run_id < counts.size(); run_id++) {
+      int count = atoi(counts[run_id].c_str());
+      vector<Client *> clients;
+      ThreadGroup threads;
+      int run_errors = 0;
+
+      if (count <= 0)
+        continue;
+
+      for (int i = 0; i < count; i++)
+        clients.push_back(new Client(spec, format("/bench/%d-%d",
+                                                  (int)run_id, i)));
+
+      Stopwatch stopwatch;
+      foreach(Client *client, clients)
+        threads.create_thread(boost::bind(&Client::operator(), client));
+      threads.join_all();
+      stopwatch.stop();
+
+      foreach(Client *client, clients) {
+        if (client->error())
+          run_errors++;
+        delete client;
+      }
+      errors += run_errors;
+
+      printf("%-12s %8d %12.2f %8d\n", label, count,
+             (double)count * spec.ops / stopwatch.elapsed(), run_errors);
+      fflush(stdout);
+    }
+
+    return errors;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  BenchSpec spec;
+  vector<String> counts;
+  vector<String> master_args;
+  int errors = 0;
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    spec.ops = get_i32("ops");
+    spec.read_percent = get_i32("read-percent");
+    spec.value_size = get_i32("value-size");
+
+    String threads_str = get_str("threads");
+    boost::split(counts, threads_str, boost::is_any_of(","));
+
+    unlink("./Hyperspace.Master");
+    HT_ASSERT(link("../../Hyperspace/Hyperspace.Master",
+                   "./Hyperspace.Master") == 0);
+
+    printf("%-12s %8s %12s %8s\n", "master", "threads", "ops/s", "errors");
+
+    master_args.push_back(format("--config=%s", get_str("config").c_str()));
+    errors += run_master(spec, "default", master_args, counts);
+
+    master_args.push_back("--Hyperspace.GroupCommit=false");
+    master_args.push_back("--Hyperspace.SnapshotReads=false");
+    errors += run_master(spec, "sync-commit", master_args, counts);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+
+  return errors ? 1 : 0;
+}
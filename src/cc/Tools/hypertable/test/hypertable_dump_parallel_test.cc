@@ -0,0 +1,125 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+extern "C" {
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#include "Common/StringExt.h"
+#include "Common/FileUtils.h"
+#include "Common/Logger.h"
+#include "Common/System.h"
+
+using namespace Hypertable;
+using namespace std;
+
+
+namespace {
+  const char *required_files[] = {
+    "./hypertable_dump_parallel_test",
+    "./hypertable.cfg",
+    "./hypertable_test.tsv.gz",
+    0
+  };
+
+  const String shell = "./hypertable --test-mode --config hypertable.cfg";
+
+  void run_command(const String &cmd_str) {
+    if (system(cmd_str.c_str()) != 0) {
+      HT_ERRORF("Command failed: %s", cmd_str.c_str());
+      _exit(1);
+    }
+  }
+
+  void run_hql(const String &hql) {
+    run_command(shell + " --exec '" + hql + "'");
+  }
+
+  /**
+   * Dumps the table into <code>dir</code> with PARALLEL, checks the part
+   * files and MANIFEST, reloads the table from the MANIFEST and checks that
+   * it holds what it held before
+   */
+  void dump_and_reload(const String &dir, const String &options,
+                       const String &part_suffix) {
+    run_command("rm -rf " + dir);
+
+    run_hql("USE \"/test\"; DUMP TABLE dump_parallel INTO FILE \"" + dir +
+            "\" PARALLEL 4 " + options + ";");
+
+    String part = dir + "/part-00000.tsv" + part_suffix;
+    String manifest = dir + "/MANIFEST";
+    if (!FileUtils::exists(part) || !FileUtils::exists(manifest)) {
+      HT_ERRORF("Missing '%s' or '%s'", part.c_str(), manifest.c_str());
+      _exit(1);
+    }
+
+    // the MANIFEST loads every part, unescaped unless dumped NO_ESCAPE
+    run_command("grep -q 'LOAD DATA INFILE " + options + "[ ]*\"" + part +
+                "\" INTO TABLE dump_parallel;' " + manifest);
+
+    run_hql("USE \"/test\"; DROP TABLE IF EXISTS dump_parallel;"
+            " CREATE TABLE dump_parallel ( TestColumnFamily );");
+    run_command("(echo 'USE \"/test\";'; cat " + manifest + ") | " + shell +
+                " > hypertable_dump_parallel_test.load 2>&1");
+
+    run_command("rm -f hypertable_dump_parallel_test.after");
+    run_hql("USE \"/test\"; SELECT * FROM dump_parallel INTO FILE"
+            " \"hypertable_dump_parallel_test.after\";");
+    run_command("diff hypertable_dump_parallel_test.before "
+                "hypertable_dump_parallel_test.after");
+  }
+}
+
+
+int main(int argc, char **argv) {
+  System::initialize(argv[0]);
+
+  for (int i=0; required_files[i]; i++) {
+    if (!FileUtils::exists(required_files[i])) {
+      HT_ERRORF("Unable to find '%s'", required_files[i]);
+      _exit(1);
+    }
+  }
+
+  run_command("rm -f hypertable_dump_parallel_test.before");
+  run_hql((String)"USE \"/test\";" +
+          " DROP TABLE IF EXISTS dump_parallel;" +
+          " CREATE TABLE dump_parallel ( TestColumnFamily );" +
+          " LOAD DATA INFILE ROW_KEY_COLUMN=rowkey" +
+          " \"hypertable_test.tsv.gz\" INTO TABLE dump_parallel;" +
+          " SELECT * FROM dump_parallel INTO FILE" +
+          " \"hypertable_dump_parallel_test.before\";");
+
+  dump_and_reload("hypertable_dump_parallel_test.dir", "", "");
+  dump_and_reload("hypertable_dump_parallel_test.gz", "NO_ESCAPE", ".gz");
+
+  run_command("rm -rf hypertable_dump_parallel_test.dir "
+              "hypertable_dump_parallel_test.gz");
+
+  _exit(0);
+}
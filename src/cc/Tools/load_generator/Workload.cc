@@ -0,0 +1,434 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <cstdio>
+
+extern "C" {
+#include <time.h>
+}
+
+#include <boost/bind.hpp>
+
+#include "Common/DiscreteRandomGeneratorZipf.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Thread.h"
+#include "Common/Time.h"
+
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanSpec.h"
+
+#include "Workload.h"
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *op_names[] = {
+    "READ", "UPDATE", "INSERT", "SCAN", "READ-MODIFY-WRITE"
+  };
+
+  /**
+   * Zipf samples as ranks: 0 is the most likely value, 1 the next most
+   * likely and so on (the base class hands out a random permutation).
+   */
+  class ZipfRankGenerator : public DiscreteRandomGeneratorZipf {
+  public:
+    ZipfRankGenerator(double s) : DiscreteRandomGeneratorZipf(s) { }
+
+  protected:
+    virtual void generate_cmf() {
+      DiscreteRandomGeneratorZipf::generate_cmf();
+      for (uint64_t i=0; i<m_value_count; i++)
+        m_numbers[i] = i;
+    }
+  };
+
+  /** Bijective mix of the record number, spreads records over the table */
+  uint64_t scramble(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  String row_key(uint64_t record) {
+    return format("user%020llu", (Llu)scramble(record));
+  }
+
+  void sleep_ns(int64_t ns) {
+    struct timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    nanosleep(&ts, 0);
+  }
+
+}
+
+
+Workload::Workload(TablePtr &table, const Spec &spec)
+  : m_table(table), m_spec(spec), m_total_proportion(0), m_active(0),
+    m_record_count(spec.record_count), m_stop_time(0) {
+
+  if (m_spec.record_count == 0)
+    HT_THROW(Error::CONFIG_BAD_VALUE, "Workload record count is zero");
+  if (m_spec.threads <= 0)
+    m_spec.threads = 1;
+
+  for (int i=0; i<OP_MAX; i++) {
+    m_total_proportion += m_spec.proportions[i];
+    m_errors[i] = 0;
+  }
+
+  if (m_spec.distribution != UNIFORM) {
+    m_zipf = new ZipfRankGenerator(m_spec.zipf_s);
+    m_zipf->set_seed(m_spec.seed);
+    m_zipf->set_value_count(m_spec.record_count);
+  }
+}
+
+
+const char *Workload::op_name(int op) {
+  HT_ASSERT(op >= 0 && op < OP_MAX);
+  return op_names[op];
+}
+
+
+int Workload::parse_distribution(const String &name) {
+  if (name == "uniform")
+    return UNIFORM;
+  else if (name == "zipfian")
+    return ZIPFIAN;
+  else if (name == "latest")
+    return LATEST;
+  HT_THROWF(Error::CONFIG_BAD_VALUE, "Unrecognized request distribution (%s)",
+            name.c_str());
+}
+
+
+void Workload::load() {
+  ThreadGroup threads;
+  int64_t start = get_ts64();
+
+  for (int32_t i=0; i<m_spec.threads; i++)
+    threads.create_thread(boost::bind(&Workload::load_thread, this, i));
+  threads.join_all();
+
+  double elapsed = (double)(get_ts64() - start) / 1000000000.0;
+  printf("\n");
+  printf("     Records loaded: %llu\n", (Llu)m_spec.record_count);
+  printf("       Elapsed time: %.2f s\n", elapsed);
+  printf("Throughput (recs/s): %.2f\n", (double)m_spec.record_count / elapsed);
+  printf("\n");
+  fflush(stdout);
+}
+
+
+void Workload::run() {
+  ThreadGroup threads;
+  int64_t start = get_ts64();
+  int64_t interval_start = start;
+
+  if (m_total_proportion <= 0)
+    HT_THROW(Error::CONFIG_BAD_VALUE, "Workload operation proportions are "
+             "all zero");
+  if (m_spec.operation_count == 0 && m_spec.duration == 0)
+    HT_THROW(Error::CONFIG_BAD_VALUE, "Workload needs an operation count or "
+             "a duration");
+
+  if (m_spec.duration)
+    m_stop_time = start + (int64_t)m_spec.duration * 1000000000LL;
+
+  printf("%8s  %-17s %10s %10s %8s %8s %8s %8s %8s %8s\n", "elapsed", "op",
+         "ops", "ops/s", "avg", "p50", "p95", "p99", "p999", "max");
+  fflush(stdout);
+
+  m_active = m_spec.threads;
+  for (int32_t i=0; i<m_spec.threads; i++)
+    threads.create_thread(boost::bind(&Workload::run_thread, this, i));
+
+  bool finished = false;
+  while (!finished) {
+    {
+      ScopedLock lock(m_mutex);
+      if (m_spec.report_interval > 0) {
+        HiResTime expire;
+        expire += m_spec.report_interval * 1000;
+        while (m_active > 0)
+          if (!m_done_cond.timed_wait(lock, expire))
+            break;
+      }
+      else {
+        while (m_active > 0)
+          m_done_cond.wait(lock);
+      }
+      finished = m_active == 0;
+    }
+    if (!finished) {
+      report(start, interval_start, false);
+      interval_start = get_ts64();
+    }
+  }
+
+  threads.join_all();
+  report(start, interval_start, true);
+}
+
+
+void Workload::load_thread(int32_t index) {
+  ThreadState state(m_spec.seed + index);
+
+  state.value = String(2 * m_spec.value_size, 'v');
+  for (size_t i=0; i<state.value.length(); i++)
+    state.value[i] = 'a' + state.rng() % 26;
+
+  try {
+    state.mutator = m_table->create_mutator();
+    for (uint64_t record = index; record < m_spec.record_count;
+         record += m_spec.threads)
+      write(state, row_key(record), false);
+    state.mutator->flush();
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+  }
+}
+
+
+void Workload::run_thread(int32_t index) {
+  ThreadState state(m_spec.seed + index);
+  uint64_t ops = m_spec.operation_count / m_spec.threads;
+  int64_t interval = 0, scheduled = get_ts64(), start;
+
+  if ((uint64_t)index < m_spec.operation_count % m_spec.threads)
+    ops++;
+
+  // stagger the schedules of the threads over one interval
+  if (m_spec.target_rate > 0) {
+    interval = (int64_t)(1000000000.0 * m_spec.threads / m_spec.target_rate);
+    scheduled += index * interval / m_spec.threads;
+  }
+
+  state.value = String(2 * m_spec.value_size, 'v');
+  for (size_t i=0; i<state.value.length(); i++)
+    state.value[i] = 'a' + state.rng() % 26;
+
+  try {
+    state.mutator = m_table->create_mutator();
+
+    for (uint64_t i=0; m_spec.operation_count == 0 || i < ops; i++) {
+      start = get_ts64();
+      if (m_stop_time && start >= m_stop_time)
+        break;
+
+      if (interval) {
+        if (scheduled > start)
+          sleep_ns(scheduled - start);
+        start = scheduled;
+        scheduled += interval;
+      }
+
+      int op = choose_op(state);
+      try {
+        do_op(state, op);
+      }
+      catch (Exception &e) {
+        ScopedLock lock(m_mutex);
+        if (m_errors[op]++ < 10)
+          HT_ERROR_OUT << op_name(op) << ": " << e << HT_END;
+        continue;
+      }
+      m_latency[op].record((get_ts64() - start) / 1000);
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+  }
+
+  ScopedLock lock(m_mutex);
+  m_active--;
+  m_done_cond.notify_all();
+}
+
+
+int Workload::choose_op(ThreadState &state) {
+  double u = (double)state.rng() / 4294967296.0 * m_total_proportion;
+  int op;
+
+  for (op=0; op<OP_MAX-1; op++) {
+    if (u < m_spec.proportions[op])
+      break;
+    u -= m_spec.proportions[op];
+  }
+  // rounding may leave u just above the last proportion
+  while (m_spec.proportions[op] <= 0)
+    op--;
+  return op;
+}
+
+
+uint64_t Workload::choose_record(ThreadState &state) {
+  uint64_t count, rank;
+
+  {
+    ScopedLock lock(m_mutex);
+    count = m_record_count;
+  }
+
+  if (m_spec.distribution == UNIFORM)
+    return (((uint64_t)state.rng() << 32) | state.rng()) % count;
+
+  {
+    ScopedLock lock(m_zipf_mutex);
+    rank = m_zipf->get_sample();
+  }
+
+  if (m_spec.distribution == LATEST)
+    return count - 1 - (rank % count);
+  return rank;
+}
+
+
+uint64_t Workload::next_insert() {
+  ScopedLock lock(m_mutex);
+  return m_record_count++;
+}
+
+
+void Workload::do_op(ThreadState &state, int op) {
+  switch (op) {
+  case READ:
+    read(row_key(choose_record(state)));
+    break;
+  case UPDATE:
+    write(state, row_key(choose_record(state)), true);
+    break;
+  case INSERT:
+    write(state, row_key(next_insert()), true);
+    break;
+  case SCAN:
+    scan(row_key(choose_record(state)),
+         1 + state.rng() % m_spec.max_scan_length);
+    break;
+  case READ_MODIFY_WRITE:
+    {
+      String row = row_key(choose_record(state));
+      read(row);
+      write(state, row, true);
+    }
+    break;
+  default:
+    HT_ASSERT(!"unknown workload operation");
+  }
+}
+
+
+void Workload::read(const String &row) {
+  ScanSpecBuilder ssb;
+  Cell cell;
+
+  ssb.add_row(row.c_str());
+  ssb.add_column(m_spec.column_family.c_str());
+  ssb.set_max_versions(1);
+
+  TableScannerPtr scanner = m_table->create_scanner(ssb.get());
+  while (scanner->next(cell))
+    ;
+}
+
+
+void Workload::scan(const String &row, int32_t length) {
+  ScanSpecBuilder ssb;
+  Cell cell;
+
+  ssb.add_row_interval(row.c_str(), true, Key::END_ROW_MARKER, true);
+  ssb.add_column(m_spec.column_family.c_str());
+  ssb.set_max_versions(1);
+  ssb.set_row_limit(length);
+
+  TableScannerPtr scanner = m_table->create_scanner(ssb.get());
+  while (scanner->next(cell))
+    ;
+}
+
+
+void Workload::write(ThreadState &state, const String &row, bool flush) {
+  KeySpec key;
+  size_t offset = state.rng() % (m_spec.value_size + 1);
+
+  key.row = row.c_str();
+  key.row_len = row.length();
+  key.column_family = m_spec.column_family.c_str();
+
+  state.mutator->set(key, state.value.data() + offset, m_spec.value_size);
+  if (flush)
+    state.mutator->flush();
+}
+
+
+void Workload::report(int64_t start, int64_t interval_start, bool final) {
+  int64_t now = get_ts64();
+  double elapsed = (double)(now - start) / 1000000000.0;
+  double interval = (double)(now - interval_start) / 1000000000.0;
+  uint64_t total_ops = 0, total_errors = 0;
+
+  for (int op=0; op<OP_MAX; op++) {
+    LatencyHistogram hist;
+    m_latency[op].reset_into(hist);
+    m_total[op].merge(hist);
+    if (!final && hist.count())
+      printf("%7.0fs  %-17s %10llu %10.1f %8.0f %8llu %8llu %8llu %8llu "
+             "%8llu\n", elapsed, op_name(op), (Llu)hist.count(),
+             (double)hist.count() / interval, hist.mean(),
+             (Llu)hist.percentile(50.0), (Llu)hist.percentile(95.0),
+             (Llu)hist.percentile(99.0), (Llu)hist.percentile(99.9),
+             (Llu)hist.max());
+  }
+
+  if (!final) {
+    fflush(stdout);
+    return;
+  }
+
+  printf("\nSummary (latencies in usec)\n\n");
+  printf("%-17s %10s %10s %8s %8s %8s %8s %8s %8s %8s\n", "op", "ops",
+         "ops/s", "avg", "p50", "p95", "p99", "p999", "max", "errors");
+  for (int op=0; op<OP_MAX; op++) {
+    LatencyHistogram &hist = m_total[op];
+    if (hist.count() == 0 && m_errors[op] == 0)
+      continue;
+    total_ops += hist.count();
+    total_errors += m_errors[op];
+    printf("%-17s %10llu %10.1f %8.0f %8llu %8llu %8llu %8llu %8llu %8llu\n",
+           op_name(op), (Llu)hist.count(), (double)hist.count() / elapsed,
+           hist.mean(), (Llu)hist.percentile(50.0),
+           (Llu)hist.percentile(95.0), (Llu)hist.percentile(99.0),
+           (Llu)hist.percentile(99.9), (Llu)hist.max(), (Llu)m_errors[op]);
+  }
+  printf("\n");
+  printf("       Elapsed time: %.2f s\n", elapsed);
+  printf("   Total operations: %llu\n", (Llu)total_ops);
+  printf("Throughput (ops/s): %.2f\n", (double)total_ops / elapsed);
+  printf("       Total errors: %llu\n", (Llu)total_errors);
+  printf("\n");
+  fflush(stdout);
+}
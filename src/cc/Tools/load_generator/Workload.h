@@ -0,0 +1,148 @@
+/** -*- c++ -*-
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef HYPERTABLE_WORKLOAD_H
+#define HYPERTABLE_WORKLOAD_H
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "Common/DiscreteRandomGenerator.h"
+#include "Common/LatencyHistogram.h"
+#include "Common/Mutex.h"
+#include "Common/String.h"
+
+#include "Hypertable/Lib/Namespace.h"
+#include "Hypertable/Lib/Table.h"
+#include "Hypertable/Lib/TableMutator.h"
+
+namespace Hypertable {
+
+  /**
+   * YCSB style workload: a mix of read, update, insert, scan and
+   * read-modify-write operations on records chosen from a uniform, zipfian
+   * or latest distribution.  Record i has row key "user" followed by a
+   * scrambled form of i, so consecutive records (and the popular ones) are
+   * spread over the table, and a single cell in the column family given
+   * by the spec.
+   */
+  class Workload {
+  public:
+    enum {
+      READ,
+      UPDATE,
+      INSERT,
+      SCAN,
+      READ_MODIFY_WRITE,
+      OP_MAX
+    };
+
+    enum {
+      UNIFORM,
+      ZIPFIAN,
+      /** Zipfian over the most recently inserted records */
+      LATEST
+    };
+
+    struct Spec {
+      Spec() : record_count(0), operation_count(0), duration(0),
+               distribution(ZIPFIAN), zipf_s(0.99), max_scan_length(100),
+               value_size(100), target_rate(0), report_interval(10),
+               threads(1), seed(1) {
+        for (int i=0; i<OP_MAX; i++)
+          proportions[i] = 0;
+      }
+      String column_family;
+      uint64_t record_count;
+      /** Total number of operations (0 for no limit) */
+      uint64_t operation_count;
+      /** Run time limit in seconds (0 for no limit) */
+      int32_t duration;
+      double proportions[OP_MAX];
+      int distribution;
+      double zipf_s;
+      int32_t max_scan_length;
+      int32_t value_size;
+      /** Aggregate operations per second, 0 to run as fast as possible */
+      double target_rate;
+      /** Seconds between interval reports, 0 for a final report only */
+      int32_t report_interval;
+      int32_t threads;
+      uint32_t seed;
+    };
+
+    Workload(TablePtr &table, const Spec &spec);
+
+    /**
+     * Inserts records 0 through record_count-1, each thread writing its
+     * share through a buffered mutator, and reports the throughput.
+     */
+    void load();
+
+    /**
+     * Runs the operation mix and reports latency percentiles per
+     * operation type every report_interval seconds and at the end.  In
+     * target rate (open loop) mode, operations are issued on a fixed
+     * schedule and latency is measured from the scheduled start time, so
+     * that queueing behind slow operations is not hidden.
+     */
+    void run();
+
+    static const char *op_name(int op);
+    static int parse_distribution(const String &name);
+
+  private:
+    struct ThreadState {
+      ThreadState(uint32_t seed) : rng(seed) { }
+      boost::mt19937 rng;
+      TableMutatorPtr mutator;
+      String value;
+    };
+
+    void load_thread(int32_t index);
+    void run_thread(int32_t index);
+    int choose_op(ThreadState &state);
+    uint64_t choose_record(ThreadState &state);
+    uint64_t next_insert();
+    void do_op(ThreadState &state, int op);
+    void read(const String &row);
+    void scan(const String &row, int32_t length);
+    void write(ThreadState &state, const String &row, bool flush);
+    void report(int64_t start, int64_t interval_start, bool final);
+
+    TablePtr m_table;
+    Spec m_spec;
+    double m_total_proportion;
+    DiscreteRandomGeneratorPtr m_zipf;
+    Mutex m_zipf_mutex;
+    Mutex m_mutex;
+    boost::condition m_done_cond;
+    int32_t m_active;
+    uint64_t m_record_count;
+    uint64_t m_errors[OP_MAX];
+    LatencyHistogram m_latency[OP_MAX];
+    LatencyHistogram m_total[OP_MAX];
+    int64_t m_stop_time;
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_WORKLOAD_H
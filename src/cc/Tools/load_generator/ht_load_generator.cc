@@ -54,6 +54,7 @@ extern "C" {
 #include "LoadClient.h"
 #include "LoadThread.h"
 #include "ParallelLoad.h"
+#include "Workload.h"
 
 using namespace Hypertable;
 using namespace Hypertable::Config;
@@ -68,7 +69,14 @@ namespace {
     "Description:\n"
     "  This program is used to generate load on a Hypertable\n"
     "  cluster.  The <type> argument indicates the type of load\n"
-    "  to generate ('query' or 'update').\n\n"
+    "  to generate ('query', 'update' or 'workload').\n\n"
+    "  The 'workload' type runs a YCSB style mix of read, update,\n"
+    "  insert, scan and read-modify-write operations (see the\n"
+    "  --*-proportion options) with --parallel threads against records\n"
+    "  'user<n>' holding one cell in --column-family, and reports\n"
+    "  per-operation latency percentiles every --report-interval\n"
+    "  seconds and at the end.  Use --load-records to insert the\n"
+    "  --record-count records first.\n\n"
     "Options";
 
   struct AppPolicy : Config::Policy {
@@ -104,6 +112,39 @@ namespace {
         ("thrift", boo()->zero_tokens()->default_value(false),
          "Generate load via Thrift interface instead of C++ client library")
         ("version", "Show version information and exit")
+        ("record-count", i64()->default_value(100000),
+         "Number of records in the workload key space")
+        ("operation-count", i64()->default_value(100000),
+         "Number of workload operations to run (0 = until --duration)")
+        ("duration", i32()->default_value(0),
+         "Stop the workload after this many seconds (0 = no limit)")
+        ("load-records", boo()->zero_tokens()->default_value(false),
+         "Insert the workload records before running the operations")
+        ("read-proportion", f64()->default_value(0.95),
+         "Proportion of workload operations that are reads")
+        ("update-proportion", f64()->default_value(0.05),
+         "Proportion of workload operations that are updates")
+        ("insert-proportion", f64()->default_value(0.0),
+         "Proportion of workload operations that insert new records")
+        ("scan-proportion", f64()->default_value(0.0),
+         "Proportion of workload operations that are short scans")
+        ("rmw-proportion", f64()->default_value(0.0),
+         "Proportion of workload operations that are read-modify-writes")
+        ("request-distribution", str()->default_value("zipfian"),
+         "Distribution of workload records: uniform, zipfian or latest")
+        ("zipf-s", f64()->default_value(0.99),
+         "Exponent of the zipfian and latest distributions (0 < s < 1)")
+        ("max-scan-length", i32()->default_value(100),
+         "Maximum number of rows returned by a workload scan")
+        ("value-size", i32()->default_value(100),
+         "Size of the values written by the workload")
+        ("column-family", str()->default_value("Field"),
+         "Column family of the workload records")
+        ("target-rate", f64()->default_value(0.0),
+         "Issue workload operations at this aggregate rate (ops/s) on a "
+         "fixed schedule; 0 = as fast as possible")
+        ("report-interval", i32()->default_value(10),
+         "Seconds between workload latency reports (0 = final report only)")
         ;
       alias("delete-percentage", "DataGenerator.DeletePercentage");
       alias("max-bytes", "DataGenerator.MaxBytes");
@@ -128,6 +169,7 @@ void generate_update_load_parallel(PropertiesPtr &props, String &tablename, ::in
                                    ::int32_t delete_pct, bool thrift);
 void generate_query_load(PropertiesPtr &props, String &tablename, bool to_stdout,
                          ::int32_t delay, String &sample_fname, bool thrift);
+void run_workload(String &tablename, ::int32_t parallel);
 double std_dev(::uint64_t nn, double sum, double sq_sum);
 void parse_command_line(int argc, char **argv, PropertiesPtr &props);
 
@@ -188,10 +230,14 @@ int main(int argc, char **argv) {
       delete_pct = generator_props->get_i32("DataGenerator.DeletePercentage");
     }
     
-    if (parallel > 0 && load_type == "query")
+    if (load_type == "workload") {
+      if (thrift || to_stdout)
+        HT_FATAL("thrift and stdout options not supported for workload");
+      run_workload(table, parallel);
+    }
+    else if (parallel > 0 && load_type == "query")
       HT_FATAL("parallel support for query load not yet implemented");
-
-    if (load_type == "update" && parallel > 0)
+    else if (load_type == "update" && parallel > 0)
       generate_update_load_parallel(generator_props, table, parallel, flush,
                                     no_log_sync, flush_interval, delete_pct, thrift);
     else if (load_type == "update")
@@ -676,6 +722,47 @@ void generate_query_load(PropertiesPtr &props, String &tablename, bool to_stdout
 
 
 
+void run_workload(String &tablename, ::int32_t parallel)
+{
+  Workload::Spec spec;
+
+  spec.column_family = get_str("column-family");
+  spec.record_count = get_i64("record-count");
+  spec.operation_count = get_i64("operation-count");
+  spec.duration = get_i32("duration");
+  spec.proportions[Workload::READ] = get_f64("read-proportion");
+  spec.proportions[Workload::UPDATE] = get_f64("update-proportion");
+  spec.proportions[Workload::INSERT] = get_f64("insert-proportion");
+  spec.proportions[Workload::SCAN] = get_f64("scan-proportion");
+  spec.proportions[Workload::READ_MODIFY_WRITE] = get_f64("rmw-proportion");
+  spec.distribution =
+      Workload::parse_distribution(get_str("request-distribution"));
+  spec.zipf_s = get_f64("zipf-s");
+  spec.max_scan_length = get_i32("max-scan-length");
+  spec.value_size = get_i32("value-size");
+  spec.target_rate = get_f64("target-rate");
+  spec.report_interval = get_i32("report-interval");
+  spec.threads = parallel > 0 ? parallel : 1;
+  spec.seed = get_i32("seed");
+
+  if (spec.distribution != Workload::UNIFORM &&
+      (spec.zipf_s <= 0 || spec.zipf_s >= 1))
+    HT_THROW(Error::CONFIG_BAD_VALUE, "--zipf-s must be between 0 and 1");
+  if (spec.max_scan_length <= 0 || spec.value_size <= 0)
+    HT_THROW(Error::CONFIG_BAD_VALUE,
+             "--max-scan-length and --value-size must be positive");
+
+  ClientPtr client = new Hypertable::Client(get_str("config"));
+  NamespacePtr ht_namespace = client->open_namespace("/");
+  TablePtr table = ht_namespace->open_table(tablename);
+
+  Workload workload(table, spec);
+  if (get_bool("load-records"))
+    workload.load();
+  workload.run();
+}
+
+
 /**
  * @param nn Size of set of numbers
  * @param sum Sum of numbers in set
@@ -58,6 +58,46 @@ int main(int argc, char **argv) {
     String stats_str;
 
     client->get_statistics(addr, stats);
+
+    std::cout << "RPC latency over last monitoring interval (microseconds)\n";
+    std::cout << format("%-16s %-9s %10s %10s %10s %10s %10s %10s\n", "rpc",
+                        "phase", "count", "mean", "p50", "p99", "p999", "max");
+    for (int i=0; i<StatsRangeServer::RPC_TYPE_COUNT; i++) {
+      const LatencyHistogram *hist[2] = { &stats.queue_latency[i],
+                                          &stats.response_latency[i] };
+      const char *phase[2] = { "queue", "response" };
+      for (int j=0; j<2; j++)
+        std::cout << format("%-16s %-9s %10llu %10.1f %10llu %10llu %10llu %10llu\n",
+                            j == 0 ? StatsRangeServer::rpc_type_name(i) : "",
+                            phase[j], (Llu)hist[j]->count(), hist[j]->mean(),
+                            (Llu)hist[j]->percentile(50.0),
+                            (Llu)hist[j]->percentile(99.0),
+                            (Llu)hist[j]->percentile(99.9),
+                            (Llu)hist[j]->max());
+    }
+    for (int i=0; i<StatsRangeServer::UPDATE_PHASE_COUNT; i++) {
+      const LatencyHistogram &hist = stats.update_phase_latency[i];
+      std::cout << format("%-16s %-9s %10llu %10.1f %10llu %10llu %10llu %10llu\n",
+                          i == 0 ? "batch_update" : "",
+                          StatsRangeServer::update_phase_name(i),
+                          (Llu)hist.count(), hist.mean(),
+                          (Llu)hist.percentile(50.0), (Llu)hist.percentile(99.0),
+                          (Llu)hist.percentile(99.9), (Llu)hist.max());
+    }
+    if (!stats.query_cache_shards.empty()) {
+      std::cout << format("\n%-16s %10s %10s %10s %10s\n", "query_cache",
+                          "lookups", "hits", "hit%", "negative");
+      for (size_t i=0; i<stats.query_cache_shards.size(); i++) {
+        const StatsRangeServer::QueryCacheShard &shard =
+          stats.query_cache_shards[i];
+        std::cout << format("shard %-10d %10llu %10llu %10.1f %10llu\n",
+                            (int)i, (Llu)shard.accesses, (Llu)shard.hits,
+                            shard.accesses ? ((double)shard.hits * 100.0) /
+                            (double)shard.accesses : 0.0,
+                            (Llu)shard.negative_hits);
+      }
+    }
+    std::cout << std::flush;
     /** FIXME!!
     stats->dump_str(stats_str);
 
@@ -0,0 +1,166 @@
+/**
+ * Copyright (C) 2011 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+#include "Common/Init.h"
+#include "Common/InetAddr.h"
+#include "Common/Logger.h"
+#include "Common/Trace.h"
+
+#include "AsyncComm/Comm.h"
+#include "AsyncComm/ConnectionManager.h"
+
+#include "DfsBroker/Lib/Client.h"
+
+#include "Hypertable/Lib/Config.h"
+#include "Hypertable/Lib/RangeServerClient.h"
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc("Usage: %s [options]\n\n"
+        "  Fetches the sampled request traces from the given RangeServers\n"
+        "  and DFS brokers and prints each trace as a timeline.  Span\n"
+        "  offsets are relative to the earliest span of the trace and are\n"
+        "  subject to clock skew between hosts.\n\nOptions")
+        .add_options()
+        ("range-server", strs(), "RangeServer to fetch traces from (host:port)")
+        ("dfs-broker", strs(), "DFS broker to fetch traces from (host:port)")
+        ("trace-id", str(), "Only display the trace with this id (hex)")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DefaultCommPolicy> Policies;
+
+  struct SourcedSpan {
+    Trace::Span span;
+    String source;
+  };
+
+  struct LtSpanStart {
+    bool operator()(const SourcedSpan &a, const SourcedSpan &b) const {
+      if (a.span.start == b.span.start)
+        return a.span.end > b.span.end;
+      return a.span.start < b.span.start;
+    }
+  };
+
+  typedef std::map<uint64_t, std::vector<SourcedSpan> > TraceMap;
+
+  void add_spans(TraceMap &traces, const String &source,
+                 std::vector<Trace::Span> &spans, uint64_t only_trace_id) {
+    SourcedSpan ss;
+    ss.source = source;
+    foreach (const Trace::Span &span, spans) {
+      if (only_trace_id && span.trace_id != only_trace_id)
+        continue;
+      ss.span = span;
+      traces[span.trace_id].push_back(ss);
+    }
+  }
+
+  void display_trace(uint64_t trace_id, std::vector<SourcedSpan> &spans) {
+    sort(spans.begin(), spans.end(), LtSpanStart());
+    int64_t origin = spans.front().span.start;
+    int64_t finish = origin;
+    foreach (const SourcedSpan &ss, spans)
+      finish = std::max(finish, ss.span.end);
+
+    cout << format("trace %016llx  (%.3f ms)\n", (Llu)trace_id,
+                   (double)(finish - origin) / 1000000.0);
+    cout << format("  %12s %12s  %-24s %s\n", "offset(us)", "dur(us)",
+                   "source", "span");
+    foreach (const SourcedSpan &ss, spans)
+      cout << format("  %12.1f %12.1f  %-24s %s\n",
+                     (double)(ss.span.start - origin) / 1000.0,
+                     (double)(ss.span.end - ss.span.start) / 1000.0,
+                     ss.source.c_str(), ss.span.name.c_str());
+    cout << "\n";
+  }
+
+} // local namespace
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    Comm *comm = Comm::instance();
+    ConnectionManagerPtr conn_mgr = new ConnectionManager(comm);
+    int timeout = get_i32("timeout");
+    Strings range_servers = get("range-server", Strings());
+    Strings dfs_brokers = get("dfs-broker", Strings());
+    uint64_t only_trace_id = 0;
+    std::vector<Trace::Span> spans;
+    TraceMap traces;
+
+    if (has("trace-id"))
+      only_trace_id = strtoull(get_str("trace-id").c_str(), 0, 16);
+
+    if (range_servers.empty() && dfs_brokers.empty()) {
+      cout << cmdline_desc() << endl;
+      _exit(1);
+    }
+
+    RangeServerClient rs_client(comm, timeout);
+
+    foreach (const String &endpoint, range_servers) {
+      InetAddr addr(endpoint);
+      conn_mgr->add(addr, timeout, "Range Server");
+      if (!conn_mgr->wait_for_connection(addr, timeout))
+        HT_THROWF(Error::REQUEST_TIMEOUT, "connecting to range server %s",
+                  endpoint.c_str());
+      rs_client.dump_traces(addr, spans);
+      add_spans(traces, "rs:" + endpoint, spans, only_trace_id);
+    }
+
+    foreach (const String &endpoint, dfs_brokers) {
+      DfsBroker::ClientPtr dfs_client =
+        new DfsBroker::Client(conn_mgr, InetAddr(endpoint), timeout);
+      if (!dfs_client->wait_for_connection(timeout))
+        HT_THROWF(Error::REQUEST_TIMEOUT, "connecting to DFS broker %s",
+                  endpoint.c_str());
+      dfs_client->dump_traces(spans);
+      add_spans(traces, "dfs:" + endpoint, spans, only_trace_id);
+    }
+
+    for (TraceMap::iterator iter = traces.begin(); iter != traces.end(); ++iter)
+      display_trace((*iter).first, (*iter).second);
+
+    cout << flush;
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    _exit(1);   // don't bother with static objects
+  }
+  _exit(0);     // ditto
+}